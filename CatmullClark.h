@@ -13,6 +13,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 // point data
 typedef union {
@@ -33,121 +34,160 @@ typedef struct {
     float sharpness;
 } cc_Crease_f;
 
+// floating-point type used for storage and arithmetic; defining
+// CC_SINGLE_PRECISION halves the memory footprint of the vertex data
+#ifdef CC_SINGLE_PRECISION
+typedef float cc_Real;
+#else
+typedef double cc_Real;
+#endif
+
+// integer type used for element IDs and counts; defining CC_INDEX64 lifts
+// the 2^31 limit on the number of halfedges (and vertices) of a subd
+#ifdef CC_INDEX64
+typedef int64_t cc_Index;
+#define CC_INDEX_MAX INT64_MAX
+#else
+typedef int32_t cc_Index;
+#define CC_INDEX_MAX INT32_MAX
+#endif
+
 // point data
 typedef union {
-    struct { double x, y, z;};
-    double array[3];
+    struct { cc_Real x, y, z;};
+    cc_Real array[3];
 } cc_VertexPoint;
 
 // uv data
 typedef union {
-    struct {double u, v;};
-    double array[2];
+    struct {cc_Real u, v;};
+    cc_Real array[2];
 } cc_VertexUv;
 
 // crease data
 typedef struct {
-    int32_t nextID;
-    int32_t prevID;
-    double sharpness;
+    cc_Index nextID;
+    cc_Index prevID;
+    cc_Real sharpness;
 } cc_Crease;
 
 // generic halfedge data
 typedef struct {
-    int32_t twinID;
-    int32_t nextID;
-    int32_t prevID;
-    int32_t faceID;
-    int32_t edgeID;
-    int32_t vertexID;
-    int32_t uvID;
+    cc_Index twinID;
+    cc_Index nextID;
+    cc_Index prevID;
+    cc_Index faceID;
+    cc_Index edgeID;
+    cc_Index vertexID;
+    cc_Index uvID;
 } cc_Halfedge;
 
 // specialized halfedge data for semi-regular (e.g., quad-only) meshes
 typedef struct {
-    int32_t twinID;
-    int32_t edgeID;
-    int32_t vertexID;
+    cc_Index twinID;
+    cc_Index edgeID;
+    cc_Index vertexID;
 #ifndef CC_DISABLE_UV
-    int32_t uvID;
+    cc_Index uvID;
 #endif
 } cc_Halfedge_SemiRegular;
 
 // mesh data-structure
 typedef struct {
-    int32_t vertexCount;
-    int32_t uvCount;
-    int32_t halfedgeCount;
-    int32_t edgeCount;
-    int32_t faceCount;
-    int32_t *vertexToHalfedgeIDs;
-    int32_t *edgeToHalfedgeIDs;
-    int32_t *faceToHalfedgeIDs;
+    cc_Index vertexCount;
+    cc_Index uvCount;
+    cc_Index halfedgeCount;
+    cc_Index edgeCount;
+    cc_Index faceCount;
+    cc_Index *vertexToHalfedgeIDs;
+    cc_Index *edgeToHalfedgeIDs;
+    cc_Index *faceToHalfedgeIDs;
     cc_VertexPoint *vertexPoints;
     cc_VertexUv *uvs;
     cc_Halfedge *halfedges;
     cc_Crease *creases;
+    void *mappedData;           // file mapping of ccm_LoadMapped (NULL if none)
+    size_t mappedByteCount;
 } cc_Mesh;
 
 // ctor / dtor
 CCDEF cc_Mesh *ccm_Load(const char *filename);
-CCDEF cc_Mesh *ccm_Create(int32_t vertexCount,
-                          int32_t uvCount,
-                          int32_t halfedgeCount,
-                          int32_t edgeCount,
-                          int32_t faceCount);
+CCDEF cc_Mesh *ccm_LoadMapped(const char *filename); // arrays point into the file
+CCDEF cc_Mesh *ccm_Create(cc_Index vertexCount,
+                          cc_Index uvCount,
+                          cc_Index halfedgeCount,
+                          cc_Index edgeCount,
+                          cc_Index faceCount);
 CCDEF void ccm_Release(cc_Mesh *mesh);
 
-// export
+// chunked import on multiple threads; the topology loads first, so that it can
+// be refined while ccm_LoadVertexPoints runs on another thread (see Loader)
+typedef struct ccm_Loader ccm_Loader;
+CCDEF ccm_Loader *ccm_CreateLoader(const char *filename);
+CCDEF void ccm_ReleaseLoader(ccm_Loader *loader);
+CCDEF cc_Mesh *ccm_LoadTopology(ccm_Loader *loader); // the mesh belongs to the caller
+CCDEF bool ccm_LoadVertexPoints(ccm_Loader *loader);
+CCDEF double ccm_LoaderProgress(const ccm_Loader *loader); // in [0, 1], from any thread
+CCDEF cc_Mesh *ccm_LoadParallel(const char *filename);
+
+// export (ccm_Save_V1 writes the version 1 format read by older tools)
 CCDEF bool ccm_Save(const cc_Mesh *mesh, const char *filename);
+CCDEF bool ccm_Save_V1(const cc_Mesh *mesh, const char *filename);
+// compressed export; a positive tolerance quantizes the vertex points (see Encoding)
+CCDEF bool ccm_SaveCompressed(const cc_Mesh *mesh,
+                              const char *filename,
+                              double vertexPointTolerance);
 
 // count queries
-CCDEF int32_t ccm_FaceCount(const cc_Mesh *mesh);
-CCDEF int32_t ccm_EdgeCount(const cc_Mesh *mesh);
-CCDEF int32_t ccm_HalfedgeCount(const cc_Mesh *mesh);
-CCDEF int32_t ccm_CreaseCount(const cc_Mesh *mesh);
-CCDEF int32_t ccm_VertexCount(const cc_Mesh *mesh);
-CCDEF int32_t ccm_UvCount(const cc_Mesh *mesh);
+CCDEF cc_Index ccm_FaceCount(const cc_Mesh *mesh);
+CCDEF cc_Index ccm_EdgeCount(const cc_Mesh *mesh);
+CCDEF cc_Index ccm_HalfedgeCount(const cc_Mesh *mesh);
+CCDEF cc_Index ccm_CreaseCount(const cc_Mesh *mesh);
+CCDEF cc_Index ccm_VertexCount(const cc_Mesh *mesh);
+CCDEF cc_Index ccm_UvCount(const cc_Mesh *mesh);
 
 // counts at a given Catmull-Clark subdivision depth
-CCDEF int32_t ccm_HalfedgeCountAtDepth(const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccm_CreaseCountAtDepth(const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccm_FaceCountAtDepth     (const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccm_FaceCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccm_EdgeCountAtDepth     (const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccm_EdgeCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccm_VertexCountAtDepth     (const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccm_VertexCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccm_HalfedgeCountAtDepth(const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccm_CreaseCountAtDepth(const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccm_FaceCountAtDepth     (const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccm_FaceCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccm_EdgeCountAtDepth     (const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccm_EdgeCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccm_VertexCountAtDepth     (const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccm_VertexCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth);
 
 // data-access (O(1))
-CCDEF int32_t ccm_HalfedgeTwinID(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF int32_t ccm_HalfedgeNextID(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF int32_t ccm_HalfedgePrevID(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF int32_t ccm_HalfedgeFaceID(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF int32_t ccm_HalfedgeEdgeID(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF int32_t ccm_HalfedgeVertexID(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF int32_t ccm_HalfedgeUvID(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF double ccm_HalfedgeSharpness(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF cc_VertexPoint ccm_HalfedgeVertexPoint(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF cc_VertexUv ccm_HalfedgeVertexUv(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF int32_t ccm_CreaseNextID(const cc_Mesh *mesh, int32_t edgeID);
-CCDEF int32_t ccm_CreasePrevID(const cc_Mesh *mesh, int32_t edgeID);
-CCDEF double ccm_CreaseSharpness(const cc_Mesh *mesh, int32_t edgeID);
-CCDEF cc_VertexPoint ccm_VertexPoint(const cc_Mesh *mesh, int32_t vertexID);
-CCDEF cc_VertexUv ccm_Uv(const cc_Mesh *mesh, int32_t uvID);
-CCDEF int32_t ccm_HalfedgeNextID_Quad(int32_t halfedgeID);
-CCDEF int32_t ccm_HalfedgePrevID_Quad(int32_t halfedgeID);
-CCDEF int32_t ccm_HalfedgeFaceID_Quad(int32_t halfedgeID);
+CCDEF cc_Index ccm_HalfedgeTwinID(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_Index ccm_HalfedgeNextID(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_Index ccm_HalfedgePrevID(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_Index ccm_HalfedgeFaceID(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_Index ccm_HalfedgeEdgeID(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_Index ccm_HalfedgeVertexID(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_Index ccm_HalfedgeUvID(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_Real ccm_HalfedgeSharpness(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_VertexPoint ccm_HalfedgeVertexPoint(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_VertexUv ccm_HalfedgeVertexUv(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_Index ccm_CreaseNextID(const cc_Mesh *mesh, cc_Index edgeID);
+CCDEF cc_Index ccm_CreasePrevID(const cc_Mesh *mesh, cc_Index edgeID);
+CCDEF cc_Real ccm_CreaseSharpness(const cc_Mesh *mesh, cc_Index edgeID);
+CCDEF cc_VertexPoint ccm_VertexPoint(const cc_Mesh *mesh, cc_Index vertexID);
+CCDEF cc_VertexUv ccm_Uv(const cc_Mesh *mesh, cc_Index uvID);
+CCDEF cc_Index ccm_HalfedgeNextID_Quad(cc_Index halfedgeID);
+CCDEF cc_Index ccm_HalfedgePrevID_Quad(cc_Index halfedgeID);
+CCDEF cc_Index ccm_HalfedgeFaceID_Quad(cc_Index halfedgeID);
 
 // (vertex, edge, face) -> halfedge mappings (O(1))
-CCDEF int32_t ccm_VertexToHalfedgeID(const cc_Mesh *mesh, int32_t vertexID);
-CCDEF int32_t ccm_EdgeToHalfedgeID(const cc_Mesh *mesh, int32_t edgeID);
-CCDEF int32_t ccm_FaceToHalfedgeID(const cc_Mesh *mesh, int32_t faceID);
-CCDEF int32_t ccm_FaceToHalfedgeID_Quad(int32_t faceID);
+CCDEF cc_Index ccm_VertexToHalfedgeID(const cc_Mesh *mesh, cc_Index vertexID);
+CCDEF cc_Index ccm_EdgeToHalfedgeID(const cc_Mesh *mesh, cc_Index edgeID);
+CCDEF cc_Index ccm_FaceToHalfedgeID(const cc_Mesh *mesh, cc_Index faceID);
+CCDEF cc_Index ccm_FaceToHalfedgeID_Quad(cc_Index faceID);
 
 // halfedge remappings (O(1))
-CCDEF int32_t ccm_NextVertexHalfedgeID(const cc_Mesh *mesh, int32_t halfedgeID);
-CCDEF int32_t ccm_PrevVertexHalfedgeID(const cc_Mesh *mesh, int32_t halfedgeID);
+CCDEF cc_Index ccm_NextVertexHalfedgeID(const cc_Mesh *mesh, cc_Index halfedgeID);
+CCDEF cc_Index ccm_PrevVertexHalfedgeID(const cc_Mesh *mesh, cc_Index halfedgeID);
+
+// topology fingerprint (halfedges, creases, and uvs)
+CCDEF uint64_t ccm_TopologyFingerprint(const cc_Mesh *mesh);
 
 // subdivision surface API
 
@@ -157,62 +197,188 @@ typedef struct {
     cc_VertexPoint *vertexPoints;
     cc_Halfedge_SemiRegular *halfedges;
     cc_Crease *creases;
+    cc_Index *vertexToHalfedgeIDs;  // per-depth mappings (NULL if not stored)
+    cc_Index *edgeToHalfedgeIDs;    // per-depth mappings (NULL if not stored)
+    cc_Index *cageRingOffsets;      // cage one-rings in CSR form (NULL if not stored)
+    cc_Index *cageRingHalfedgeIDs;
+    int32_t *vertexValences;        // per-depth valences (negative on boundaries)
+    cc_Index *vertexClassIDs;       // per-depth regular then irregular vertices
+    cc_Index *regularVertexCounts;  // per-depth (NULL if not stored)
+    cc_Index *boundaryHalfedgeIDs;  // per-depth boundary halfedges
+    cc_Index boundaryHalfedgeCount; // at the cage (doubles at each depth)
+    cc_Real *maxCreaseSharpness;    // per-depth, over the interior edges
+    cc_Real *minBoundarySharpness;  // per-depth, over the boundary edges (up to 1)
+    uint64_t *creaseBits;           // cage edges whose creases are stored
+    cc_Index *creaseRanks;          // bits set before each word of creaseBits
+    cc_Index *creaseEdgeIDs;        // cage edges whose creases are stored
+    cc_Index creaseEdgeCount;       // (all of the above are unused if dense)
     int32_t maxDepth;
+    uint32_t flags;
+    uint64_t topologyFingerprint;   // fingerprint of the cage topology (0 if none)
+    cc_Index cageVertexCount;       // cage counts of the topology (see ccs_UpdatePoints)
+    cc_Index cageHalfedgeCount;
+    cc_Index cageEdgeCount;
+    cc_Index cageFaceCount;
+    cc_Index cageCreaseCount;
+    cc_Index parallelGrain;         // chunk size of the "Gather" loops
+    void *mappedData;               // file mapping of ccs_Load (NULL if none)
+    size_t mappedByteCount;
 } cc_Subd;
 
+// subd creation flags
+enum {
+    CC_SUBD_DEFAULT = 0,
+    CC_SUBD_FINAL_LEVEL_ONLY = 1 << 0,  // only store the last two levels
+    CC_SUBD_HALFEDGE_MAPPINGS = 1 << 1, // store vertex/edge to halfedge tables
+    CC_SUBD_VERTEX_RINGS = 1 << 2,      // store the cage one-rings and valences
+    CC_SUBD_VERTEX_CLASSES = 1 << 3,    // store regular/irregular vertex lists
+    CC_SUBD_SPARSE_CREASES = 1 << 4,    // only store the creases of sharp edges
+    CC_SUBD_FIRST_TOUCH = 1 << 5        // page-align and first-touch the level buffers
+};
+
 // ctor / dtor
 CCDEF cc_Subd *ccs_Create(const cc_Mesh *cage, int32_t maxDepth);
+CCDEF cc_Subd *ccs_CreateWithFlags(const cc_Mesh *cage, int32_t maxDepth, uint32_t flags);
 CCDEF void ccs_Release(cc_Subd *subd);
 
+// cache files of refined subds (ccs_Load fails if the cage topology or the
+// precision and index width of the build differ)
+CCDEF bool ccs_Save(const cc_Subd *subd, const char *filename);
+CCDEF cc_Subd *ccs_Load(const cc_Mesh *cage, const char *filename);
+CCDEF cc_Subd *ccs_LoadOrCreate(const cc_Mesh *cage,
+                                int32_t maxDepth,
+                                uint32_t flags,
+                                const char *filename);
+
+// memory placement of the level buffers (pages per NUMA node, -1 if unknown)
+CCDEF int64_t ccs_PagePlacement(const cc_Subd *subd, int64_t *pageCounts, int32_t nodeCount);
+
 // subd queries
 CCDEF int32_t ccs_MaxDepth(const cc_Subd *subd);
-CCDEF int32_t ccs_VertexCount(const cc_Subd *subd);
-CCDEF int32_t ccs_CumulativeFaceCount(const cc_Subd *subd);
-CCDEF int32_t ccs_CumulativeEdgeCount(const cc_Subd *subd);
-CCDEF int32_t ccs_CumulativeCreaseCount(const cc_Subd *subd);
-CCDEF int32_t ccs_CumulativeVertexCount(const cc_Subd *subd);
-CCDEF int32_t ccs_CumulativeHalfedgeCount(const cc_Subd *subd);
-CCDEF int32_t ccs_CumulativeHalfedgeCountAtDepth(const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccs_CumulativeVertexCountAtDepth(const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccs_CumulativeFaceCountAtDepth(const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccs_CumulativeEdgeCountAtDepth(const cc_Mesh *cage, int32_t depth);
-CCDEF int32_t ccs_CumulativeCreaseCountAtDepth(const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccs_VertexCount(const cc_Subd *subd);
+CCDEF cc_Index ccs_CumulativeFaceCount(const cc_Subd *subd);
+CCDEF cc_Index ccs_CumulativeEdgeCount(const cc_Subd *subd);
+CCDEF cc_Index ccs_CumulativeCreaseCount(const cc_Subd *subd);
+CCDEF cc_Index ccs_CumulativeVertexCount(const cc_Subd *subd);
+CCDEF cc_Index ccs_CumulativeHalfedgeCount(const cc_Subd *subd);
+CCDEF cc_Index ccs_CumulativeHalfedgeCountAtDepth(const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccs_CumulativeVertexCountAtDepth(const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccs_CumulativeFaceCountAtDepth(const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccs_CumulativeEdgeCountAtDepth(const cc_Mesh *cage, int32_t depth);
+CCDEF cc_Index ccs_CumulativeCreaseCountAtDepth(const cc_Mesh *cage, int32_t depth);
 
 // O(1) data-access
-CCDEF int32_t ccs_HalfedgeTwinID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
-CCDEF int32_t ccs_HalfedgeNextID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
-CCDEF int32_t ccs_HalfedgePrevID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
-CCDEF int32_t ccs_HalfedgeFaceID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
-CCDEF int32_t ccs_HalfedgeEdgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
-CCDEF int32_t ccs_HalfedgeVertexID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
-CCDEF cc_VertexPoint ccs_HalfedgeVertexPoint(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
+CCDEF cc_Index ccs_HalfedgeTwinID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
+CCDEF cc_Index ccs_HalfedgeNextID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
+CCDEF cc_Index ccs_HalfedgePrevID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
+CCDEF cc_Index ccs_HalfedgeFaceID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
+CCDEF cc_Index ccs_HalfedgeEdgeID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
+CCDEF cc_Index ccs_HalfedgeVertexID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
+CCDEF cc_VertexPoint ccs_HalfedgeVertexPoint(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
 #ifndef CC_DISABLE_UV
-CCDEF cc_VertexUv ccs_HalfedgeVertexUv(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
+CCDEF cc_VertexUv ccs_HalfedgeVertexUv(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
 #endif
-CCDEF double ccs_HalfedgeSharpness   (const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
-CCDEF int32_t ccs_CreaseNextID_Fast (const cc_Subd *subd, int32_t edgeID, int32_t depth);
-CCDEF int32_t ccs_CreaseNextID      (const cc_Subd *subd, int32_t edgeID, int32_t depth);
-CCDEF int32_t ccs_CreasePrevID_Fast (const cc_Subd *subd, int32_t edgeID, int32_t depth);
-CCDEF int32_t ccs_CreasePrevID      (const cc_Subd *subd, int32_t edgeID, int32_t depth);
-CCDEF double ccs_CreaseSharpness_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth);
-CCDEF double ccs_CreaseSharpness     (const cc_Subd *subd, int32_t edgeID, int32_t depth);
-CCDEF cc_VertexPoint ccs_VertexPoint(const cc_Subd *subd, int32_t vertexID, int32_t depth);
+CCDEF cc_Real ccs_HalfedgeSharpness   (const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
+CCDEF cc_Index ccs_CreaseNextID_Fast (const cc_Subd *subd, cc_Index edgeID, int32_t depth);
+CCDEF cc_Index ccs_CreaseNextID      (const cc_Subd *subd, cc_Index edgeID, int32_t depth);
+CCDEF cc_Index ccs_CreasePrevID_Fast (const cc_Subd *subd, cc_Index edgeID, int32_t depth);
+CCDEF cc_Index ccs_CreasePrevID      (const cc_Subd *subd, cc_Index edgeID, int32_t depth);
+CCDEF cc_Real ccs_CreaseSharpness_Fast(const cc_Subd *subd, cc_Index edgeID, int32_t depth);
+CCDEF cc_Real ccs_CreaseSharpness     (const cc_Subd *subd, cc_Index edgeID, int32_t depth);
+CCDEF cc_VertexPoint ccs_VertexPoint(const cc_Subd *subd, cc_Index vertexID, int32_t depth);
 
 // halfedge remapping (O(1))
-CCDEF int32_t ccs_NextVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
-CCDEF int32_t ccs_PrevVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
+CCDEF cc_Index ccs_NextVertexHalfedgeID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
+CCDEF cc_Index ccs_PrevVertexHalfedgeID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth);
 
 // (vertex, edge, face) -> halfedge mappings
-CCDEF int32_t ccs_VertexToHalfedgeID(const cc_Subd *subd,
-                                     int32_t vertexID,
+CCDEF cc_Index ccs_VertexToHalfedgeID(const cc_Subd *subd,
+                                     cc_Index vertexID,
                                      int32_t depth);
-CCDEF int32_t ccs_EdgeToHalfedgeID(const cc_Subd *mesh,
-                                   int32_t edgeID,
+CCDEF cc_Index ccs_EdgeToHalfedgeID(const cc_Subd *mesh,
+                                   cc_Index edgeID,
                                    int32_t depth);
-CCDEF int32_t ccs_FaceToHalfedgeID(const cc_Subd *mesh,
-                                   int32_t faceID,
+CCDEF cc_Index ccs_FaceToHalfedgeID(const cc_Subd *mesh,
+                                   cc_Index faceID,
                                    int32_t depth);
 
+// subd level data-structure (pre-resolved view of a single subd depth)
+typedef struct {
+    const cc_Mesh *cage;
+    cc_VertexPoint *vertexPoints;
+    cc_Halfedge_SemiRegular *halfedges;
+    cc_Crease *creases;
+    cc_Index *vertexToHalfedgeIDs;  // NULL if not stored by the subd
+    cc_Index *edgeToHalfedgeIDs;    // NULL if not stored by the subd
+    int32_t *vertexValences;        // NULL if not stored by the subd
+    cc_Index *vertexClassIDs;       // NULL if not stored by the subd
+    cc_Index regularVertexCount;    // leading entries of vertexClassIDs
+    cc_Index *boundaryHalfedgeIDs;
+    cc_Index boundaryHalfedgeCount;
+    const uint64_t *creaseBits;     // NULL unless the creases are sparse
+    const cc_Index *creaseRanks;
+    int32_t depth;
+    cc_Index vertexCount;
+    cc_Index halfedgeCount;
+    cc_Index edgeCount;
+    cc_Index faceCount;
+    cc_Index creaseCount;
+} cc_SubdLevel;
+
+// level view ctor
+CCDEF cc_SubdLevel ccs_Level(const cc_Subd *subd, int32_t depth);
+
+// level queries
+CCDEF int32_t ccl_Depth(const cc_SubdLevel *level);
+CCDEF cc_Index ccl_VertexCount(const cc_SubdLevel *level);
+CCDEF cc_Index ccl_HalfedgeCount(const cc_SubdLevel *level);
+CCDEF cc_Index ccl_EdgeCount(const cc_SubdLevel *level);
+CCDEF cc_Index ccl_FaceCount(const cc_SubdLevel *level);
+CCDEF cc_Index ccl_CreaseCount(const cc_SubdLevel *level);
+
+// O(1) data-access
+CCDEF cc_Index ccl_HalfedgeTwinID(const cc_SubdLevel *level, cc_Index halfedgeID);
+CCDEF cc_Index ccl_HalfedgeNextID(const cc_SubdLevel *level, cc_Index halfedgeID);
+CCDEF cc_Index ccl_HalfedgePrevID(const cc_SubdLevel *level, cc_Index halfedgeID);
+CCDEF cc_Index ccl_HalfedgeFaceID(const cc_SubdLevel *level, cc_Index halfedgeID);
+CCDEF cc_Index ccl_HalfedgeEdgeID(const cc_SubdLevel *level, cc_Index halfedgeID);
+CCDEF cc_Index ccl_HalfedgeVertexID(const cc_SubdLevel *level, cc_Index halfedgeID);
+CCDEF cc_VertexPoint ccl_HalfedgeVertexPoint(const cc_SubdLevel *level, cc_Index halfedgeID);
+#ifndef CC_DISABLE_UV
+CCDEF cc_VertexUv ccl_HalfedgeVertexUv(const cc_SubdLevel *level, cc_Index halfedgeID);
+#endif
+CCDEF cc_Real ccl_HalfedgeSharpness   (const cc_SubdLevel *level, cc_Index halfedgeID);
+CCDEF cc_Index ccl_CreaseNextID_Fast (const cc_SubdLevel *level, cc_Index edgeID);
+CCDEF cc_Index ccl_CreaseNextID      (const cc_SubdLevel *level, cc_Index edgeID);
+CCDEF cc_Index ccl_CreasePrevID_Fast (const cc_SubdLevel *level, cc_Index edgeID);
+CCDEF cc_Index ccl_CreasePrevID      (const cc_SubdLevel *level, cc_Index edgeID);
+CCDEF cc_Real ccl_CreaseSharpness_Fast(const cc_SubdLevel *level, cc_Index edgeID);
+CCDEF cc_Real ccl_CreaseSharpness     (const cc_SubdLevel *level, cc_Index edgeID);
+CCDEF cc_VertexPoint ccl_VertexPoint(const cc_SubdLevel *level, cc_Index vertexID);
+
+// halfedge remapping (O(1))
+CCDEF cc_Index ccl_NextVertexHalfedgeID(const cc_SubdLevel *level, cc_Index halfedgeID);
+CCDEF cc_Index ccl_PrevVertexHalfedgeID(const cc_SubdLevel *level, cc_Index halfedgeID);
+
+// (vertex, edge, face) -> halfedge mappings
+CCDEF cc_Index ccl_VertexToHalfedgeID(const cc_SubdLevel *level, cc_Index vertexID);
+CCDEF cc_Index ccl_EdgeToHalfedgeID(const cc_SubdLevel *level, cc_Index edgeID);
+CCDEF cc_Index ccl_FaceToHalfedgeID(const cc_SubdLevel *level, cc_Index faceID);
+
+// deterministic scatter plan (halfedge to point segmentation)
+typedef struct {
+    int32_t maxDepth;
+    cc_Index *cageFaceOffsets;
+    cc_Index *cageFaceHalfedgeIDs;
+    cc_Index *vertexOffsets;
+    cc_Index *vertexHalfedgeIDs;
+    cc_VertexPoint *contributions;
+} cc_ScatterPlan;
+
+// plan ctor / dtor (the halfedges of the subd must be refined beforehand)
+CCDEF cc_ScatterPlan *ccs_CreateScatterPlan(const cc_Subd *subd);
+CCDEF void ccs_ReleaseScatterPlan(cc_ScatterPlan *plan);
+
 // (re-)compute catmull clark subdivision
 CCDEF void ccs_Refine_Gather(cc_Subd *subd);
 CCDEF void ccs_Refine_Scatter(cc_Subd *subd);
@@ -230,6 +396,111 @@ CCDEF void ccs_Refine_NoCreases_Scatter(cc_Subd *subd);
 CCDEF void ccs_RefineVertexPoints_NoCreases_Gather(cc_Subd *subd);
 CCDEF void ccs_RefineVertexPoints_NoCreases_Scatter(cc_Subd *subd);
 
+// two-phase refinement: build the topology once, then update the points
+CCDEF void ccs_BuildTopology(cc_Subd *subd);
+CCDEF bool ccs_IsTopologyUpToDate(const cc_Subd *subd);
+CCDEF bool ccs_UpdatePoints(cc_Subd *subd);
+
+// tiled refinement (streams the final level one cluster of cage faces at a time;
+// with OpenMP, the tiles may run concurrently, so the consumer must be thread-safe)
+typedef struct {
+    cc_Index faceBegin, faceCount;   // cage faces covered by the patch
+    cc_Index halfedgeCount;          // number of cage halfedges of these faces
+    const cc_Index *cageHalfedgeIDs; // cage halfedges of the faces (in face order)
+    const cc_Index *tileHalfedgeIDs; // same halfedges in the tile (local IDs)
+    cc_SubdLevel level;             // final level of the tile (local IDs)
+} cc_Patch;
+typedef void (*cc_PatchConsumer)(const cc_Patch *patch, void *userData);
+CCDEF void ccs_RefineTiled(const cc_Mesh *cage,
+                           int32_t maxDepth,
+                           cc_Index faceCountPerTile,
+                           cc_PatchConsumer consumer,
+                           void *userData);
+
+// (re-)compute catmull clark subdivision without atomics (bitwise reproducible)
+CCDEF void ccs_RefineVertexPoints_SegmentedScatter(cc_Subd *subd, cc_ScatterPlan *plan);
+CCDEF void ccs_RefineVertexPoints_NoCreases_SegmentedScatter(cc_Subd *subd, cc_ScatterPlan *plan);
+
+// stencil table (refined vertex points as weighted sums of cage vertex points)
+typedef struct {
+    int32_t minDepth, maxDepth;
+    cc_Index pointCount;
+    cc_Index *offsets;
+    cc_Index *vertexIDs;
+    cc_Real *weights;
+} cc_StencilTable;
+
+// table ctor / dtor (the halfedges and creases of the subd must be refined beforehand)
+CCDEF cc_StencilTable *ccs_CreateStencilTable(const cc_Subd *subd, int32_t minDepth);
+CCDEF void ccs_ReleaseStencilTable(cc_StencilTable *table);
+
+// (re-)compute catmull clark vertex points from a stencil table
+CCDEF void ccs_EvaluateStencilTable(const cc_StencilTable *table,
+                                    const cc_Mesh *cage,
+                                    cc_VertexPoint *vertexPoints);
+CCDEF void ccs_RefineVertexPoints_Stencil(cc_Subd *subd, const cc_StencilTable *table);
+
+// parallel backend (runs the topology refinement, the "Gather" vertex point
+// refinement and the stencil tables; see ParallelBackend for the remainder)
+typedef void (*cc_ParallelForCallback)(cc_Index begin, cc_Index end, void *userData);
+typedef struct {
+    void (*parallelFor)(cc_Index begin, cc_Index end, cc_Index grain,
+                        cc_ParallelForCallback callback, void *userData,
+                        void *backendData);
+    void *backendData;
+} cc_ParallelBackend;
+
+// built-in backends (the thread pool returns NULL without C11 threads)
+CCDEF const cc_ParallelBackend *cc_OpenMPBackend(void);
+CCDEF const cc_ParallelBackend *cc_SerialBackend(void);
+CCDEF cc_ParallelBackend *cc_CreateThreadPoolBackend(int32_t threadCount);
+CCDEF void cc_ReleaseThreadPoolBackend(cc_ParallelBackend *backend);
+
+// backend selection (NULL selects the OpenMP backend, which is the default)
+CCDEF void cc_SetParallelBackend(const cc_ParallelBackend *backend);
+CCDEF const cc_ParallelBackend *cc_GetParallelBackend(void);
+CCDEF void cc_ParallelFor(cc_Index begin,
+                          cc_Index end,
+                          cc_Index grain,
+                          cc_ParallelForCallback callback,
+                          void *userData);
+
+// kernel autotuning (times the vertex point kernels of each depth on the first
+// refinements of a subd, then locks in the fastest)
+enum {
+    CC_KERNEL_GATHER = 0,
+    CC_KERNEL_SCATTER = 1
+};
+typedef struct {
+    int32_t kernel;         // CC_KERNEL_GATHER or CC_KERNEL_SCATTER
+    int32_t grain;          // chunk size of the "Gather" loops
+    int32_t threadCount;    // OpenMP threads (0 leaves them to the backend)
+} cc_KernelChoice;
+typedef struct {
+    int32_t maxDepth;
+    int32_t sampleCount;            // timed refinements per candidate
+    int32_t candidateCount;
+    int32_t runCount;               // tuning refinements done so far
+    cc_KernelChoice *candidates;
+    double *times;                  // per depth and candidate, in seconds
+    cc_KernelChoice *choices;       // per depth (valid once locked)
+} cc_TuningPlan;
+
+// plan ctor / dtor (a loaded plan is locked)
+CCDEF cc_TuningPlan *ccs_CreateTuningPlan(const cc_Subd *subd, int32_t sampleCount);
+CCDEF cc_TuningPlan *ccs_LoadTuningPlan(const char *filename);
+CCDEF void ccs_ReleaseTuningPlan(cc_TuningPlan *plan);
+
+// export (the plan must be locked)
+CCDEF bool ccs_SaveTuningPlan(const cc_TuningPlan *plan, const char *filename);
+
+// queries
+CCDEF bool ccs_IsTuningPlanLocked(const cc_TuningPlan *plan);
+
+// (re-)compute catmull clark subdivision with the kernels of a plan
+CCDEF void ccs_Refine_Tuned(cc_Subd *subd, cc_TuningPlan *plan);
+CCDEF void ccs_RefineVertexPoints_Tuned(cc_Subd *subd, cc_TuningPlan *plan);
+
 
 #ifdef __cplusplus
 } // extern "C"
@@ -280,59 +551,195 @@ CCDEF void ccs_RefineVertexPoints_NoCreases_Scatter(cc_Subd *subd);
 #   ifndef CC_PARALLEL_FOR
 #       define CC_PARALLEL_FOR
 #   endif
+#   ifndef CC_PARALLEL
+#       define CC_PARALLEL
+#   endif
+#   ifndef CC_PARALLEL_THREADS
+#       define CC_PARALLEL_THREADS(n)
+#   endif
+#   ifndef CC_FOR
+#       define CC_FOR
+#   endif
+#   ifndef CC_SINGLE
+#       define CC_SINGLE
+#   endif
+#   ifndef CC_SINGLE_COPY
+#       define CC_SINGLE_COPY(x)
+#   endif
 #   ifndef CC_BARRIER
 #       define CC_BARRIER
 #   endif
 #else
 #   if defined(_WIN32)
+#       define CC__PRAGMA(x) __pragma(#x)
 #       ifndef CC_ATOMIC
 #           define CC_ATOMIC          __pragma("omp atomic" )
 #       endif
 #       ifndef CC_PARALLEL_FOR
 #           define CC_PARALLEL_FOR    __pragma("omp parallel for")
 #       endif
+#       ifndef CC_PARALLEL
+#           define CC_PARALLEL        __pragma("omp parallel")
+#       endif
+#       ifndef CC_PARALLEL_THREADS
+#           define CC_PARALLEL_THREADS(n) CC__PRAGMA(omp parallel num_threads(n))
+#       endif
+#       ifndef CC_FOR
+#           define CC_FOR             __pragma("omp for nowait")
+#       endif
+#       ifndef CC_SINGLE
+#           define CC_SINGLE          __pragma("omp single")
+#       endif
+#       ifndef CC_SINGLE_COPY
+#           define CC_SINGLE_COPY(x)  CC__PRAGMA(omp single copyprivate(x))
+#       endif
 #       ifndef CC_BARRIER
 #           define CC_BARRIER         __pragma("omp barrier")
 #       endif
 #   else
+#       define CC__PRAGMA(x) _Pragma(#x)
 #       ifndef CC_ATOMIC
 #           define CC_ATOMIC          _Pragma("omp atomic" )
 #       endif
 #       ifndef CC_PARALLEL_FOR
 #           define CC_PARALLEL_FOR    _Pragma("omp parallel for")
 #       endif
+#       ifndef CC_PARALLEL
+#           define CC_PARALLEL        _Pragma("omp parallel")
+#       endif
+#       ifndef CC_PARALLEL_THREADS
+#           define CC_PARALLEL_THREADS(n) CC__PRAGMA(omp parallel num_threads(n))
+#       endif
+#       ifndef CC_FOR
+#           define CC_FOR             _Pragma("omp for nowait")
+#       endif
+#       ifndef CC_SINGLE
+#           define CC_SINGLE          _Pragma("omp single")
+#       endif
+#       ifndef CC_SINGLE_COPY
+#           define CC_SINGLE_COPY(x)  CC__PRAGMA(omp single copyprivate(x))
+#       endif
 #       ifndef CC_BARRIER
 #           define CC_BARRIER         _Pragma("omp barrier")
 #       endif
 #   endif
 #endif
 
+// the vector kernels gather doubles through 32-bit indices
+#ifndef CC_DISABLE_SIMD
+#   if !defined(CC_SINGLE_PRECISION) && !defined(CC_INDEX64) \
+    && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+#       define CC__SIMD_X86
+#       include <stddef.h>
+#       include <immintrin.h>
+#   endif
+#endif
+
+// the built-in thread pool backend runs on C11 threads
+#ifndef CC_DISABLE_THREAD_POOL
+#   if defined(__has_include) && !defined(__STDC_NO_THREADS__) && !defined(__cplusplus)
+#       if __has_include(<threads.h>)
+#           define CC__THREAD_POOL
+#           include <threads.h>
+#           include <stdatomic.h>
+#       endif
+#   endif
+#endif
+
+// the "Scatter" routines accumulate with the compiler's atomics without OpenMP
+#if defined(_OPENMP) || defined(__GNUC__) || defined(__clang__)
+#   define CC__ATOMICS
+#endif
+
+// ccm_LoadMapped and ccs_Load map the files in memory on POSIX systems
+#if defined(__unix__) || defined(__APPLE__)
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   define CC__MAPPED_FILES
+#endif
+
+// the chunks of ccm_LoadTopology are read with pread where it is declared
+#if defined(CC__MAPPED_FILES) && (defined(__APPLE__) || defined(_DEFAULT_SOURCE)      \
+    || defined(_XOPEN_SOURCE) || (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L))
+#   define CC__PREAD
+#endif
+
+// the level buffers ask for huge pages and report their NUMA placement on Linux
+#ifdef __linux__
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#   if defined(_DEFAULT_SOURCE) && defined(MADV_HUGEPAGE)
+#       define CC__HUGE_PAGES
+#   endif
+#   if defined(_DEFAULT_SOURCE) && defined(SYS_move_pages)
+#       define CC__PAGE_NODES
+#   endif
+#endif
+
+// the kernel autotuner queries the thread count and times the kernels
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
+#include <time.h>
+
 
 /*******************************************************************************
  * Utility functions
  *
  */
-static int32_t cc__Max(int32_t a, int32_t b)
+static cc_Index cc__Min(cc_Index a, cc_Index b)
+{
+    return a < b ? a : b;
+}
+
+static int64_t cc__Min64(int64_t a, int64_t b)
+{
+    return a < b ? a : b;
+}
+
+static cc_Index cc__Max(cc_Index a, cc_Index b)
 {
     return a > b ? a : b;
 }
 
-static double cc__Minf(double x, double y)
+static cc_Index cc__Abs(cc_Index a)
+{
+    return a < 0 ? -a : a;
+}
+
+static int32_t cc__Popcount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+    return (int32_t)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+static cc_Real cc__Minf(cc_Real x, cc_Real y)
 {
     return x < y ? x : y;
 }
 
-static double cc__Maxf(double x, double y)
+static cc_Real cc__Maxf(cc_Real x, cc_Real y)
 {
     return x > y ? x : y;
 }
 
-static double cc__Satf(double x)
+static cc_Real cc__Satf(cc_Real x)
 {
     return cc__Maxf(0.0f, cc__Minf(x, 1.0f));
 }
 
-static double cc__Signf(double x)
+static cc_Real cc__Signf(cc_Real x)
 {
     if (x < 0.0f) {
         return -1.0f;
@@ -344,43 +751,43 @@ static double cc__Signf(double x)
 }
 
 static void
-cc__Lerpfv(int32_t n, double *out, const double *x, const double *y, double u)
+cc__Lerpfv(cc_Index n, cc_Real *out, const cc_Real *x, const cc_Real *y, cc_Real u)
 {
     for (int32_t i = 0; i < n; ++i) {
         out[i] = x[i] + u * (y[i] - x[i]);
     }
 }
 
-static void cc__Lerp2f(double *out, const double *x, const double *y, double u)
+static void cc__Lerp2f(cc_Real *out, const cc_Real *x, const cc_Real *y, cc_Real u)
 {
     cc__Lerpfv(2, out, x, y, u);
 }
 
-static void cc__Lerp3f(double *out, const double *x, const double *y, double u)
+static void cc__Lerp3f(cc_Real *out, const cc_Real *x, const cc_Real *y, cc_Real u)
 {
     cc__Lerpfv(3, out, x, y, u);
 }
 
-static void cc__Mulfv(int32_t n, double *out, const double *x, double y)
+static void cc__Mulfv(cc_Index n, cc_Real *out, const cc_Real *x, cc_Real y)
 {
     for (int32_t i = 0; i < n; ++i) {
         out[i] = x[i] * y;
     }
 }
 
-static void cc__Mul3f(double *out, const double *x, double y)
+static void cc__Mul3f(cc_Real *out, const cc_Real *x, cc_Real y)
 {
     cc__Mulfv(3, out, x, y);
 }
 
-static void cc__Addfv(int32_t n, double *out, const double *x, const double *y)
+static void cc__Addfv(cc_Index n, cc_Real *out, const cc_Real *x, const cc_Real *y)
 {
     for (int32_t i = 0; i < n; ++i) {
         out[i] = x[i] + y[i];
     }
 }
 
-static void cc__Add3f(double *out, const double *x, const double *y)
+static void cc__Add3f(cc_Real *out, const cc_Real *x, const cc_Real *y)
 {
     cc__Addfv(3, out, x, y);
 }
@@ -407,7 +814,347 @@ static int32_t cc__EncodeUv(const cc_VertexUv uv)
     const uint32_t v = uv.array[1] * 65535.0f;
     const uint32_t tmp = ((u & 0xFFFFu) | ((v & 0xFFFFu) << 16));
 
-    return (int32_t)tmp;
+    return (cc_Index)tmp;
+}
+
+
+/*******************************************************************************
+ * ParallelBackend -- Runs the loops of the refinement on a thread pool
+ *
+ * A backend splits a range of elements into chunks of (at most) "grain"
+ * elements and calls the callback once per chunk, possibly concurrently.
+ * The OpenMP backend is the default: it lets the refinement drivers keep
+ * their threads in a single parallel region (see RefineVertexPoints), and
+ * runs serially when OpenMP is disabled. Applications that own a thread pool
+ * can install a backend of their own and compile the library without OpenMP
+ * so that no second pool gets spawned.
+ *
+ * The built-in thread pool lets its threads grab chunks from a shared atomic
+ * counter, which balances the load of a flat loop as well as stealing from
+ * per-thread queues would. A callback that calls cc_ParallelFor again runs
+ * the nested loop serially.
+ *
+ * The backend runs the halfedge, crease, uv and classification loops, the
+ * "Gather" and "Scatter" kernels, the scatter plans, the construction and
+ * evaluation of stencil tables, and the loaders and codecs of ccm files. The
+ * "Scatter" kernels and the scatter plans accumulate with atomics that do not
+ * depend on OpenMP (see AtomicAdd).
+ *
+ */
+#ifndef CC_PARALLEL_GRAIN
+#   define CC_PARALLEL_GRAIN 1024
+#endif
+
+static void
+cc__ParallelFor_Serial(
+    cc_Index begin,
+    cc_Index end,
+    cc_Index grain,
+    cc_ParallelForCallback callback,
+    void *userData,
+    void *backendData
+) {
+    (void)grain;
+    (void)backendData;
+
+    if (begin < end) {
+        (*callback)(begin, end, userData);
+    }
+}
+
+static void
+cc__ParallelFor_OpenMP(
+    cc_Index begin,
+    cc_Index end,
+    cc_Index grain,
+    cc_ParallelForCallback callback,
+    void *userData,
+    void *backendData
+) {
+    const cc_Index chunkCount = begin < end ? (end - begin + grain - 1) / grain : 0;
+
+    (void)backendData;
+
+CC_PARALLEL_FOR
+    for (cc_Index chunkID = 0; chunkID < chunkCount; ++chunkID) {
+        const cc_Index chunkBegin = begin + chunkID * grain;
+        const cc_Index chunkEnd = chunkBegin + cc__Min(grain, end - chunkBegin);
+
+        (*callback)(chunkBegin, chunkEnd, userData);
+    }
+CC_BARRIER
+}
+
+static const cc_ParallelBackend cc__SerialBackend = {&cc__ParallelFor_Serial, NULL};
+static const cc_ParallelBackend cc__OpenMPBackend = {&cc__ParallelFor_OpenMP, NULL};
+static const cc_ParallelBackend *cc__ParallelBackend = &cc__OpenMPBackend;
+
+CCDEF const cc_ParallelBackend *cc_SerialBackend(void)
+{
+    return &cc__SerialBackend;
+}
+
+CCDEF const cc_ParallelBackend *cc_OpenMPBackend(void)
+{
+    return &cc__OpenMPBackend;
+}
+
+CCDEF void cc_SetParallelBackend(const cc_ParallelBackend *backend)
+{
+    cc__ParallelBackend = backend != NULL ? backend : &cc__OpenMPBackend;
+}
+
+CCDEF const cc_ParallelBackend *cc_GetParallelBackend(void)
+{
+    return cc__ParallelBackend;
+}
+
+static bool cc__IsOpenMPBackend(void)
+{
+    return cc__ParallelBackend == &cc__OpenMPBackend;
+}
+
+CCDEF void
+cc_ParallelFor(
+    cc_Index begin,
+    cc_Index end,
+    cc_Index grain,
+    cc_ParallelForCallback callback,
+    void *userData
+) {
+    CC_ASSERT(grain > 0);
+    (*cc__ParallelBackend->parallelFor)(begin,
+                                        end,
+                                        grain,
+                                        callback,
+                                        userData,
+                                        cc__ParallelBackend->backendData);
+}
+
+#ifdef CC__THREAD_POOL
+typedef struct {
+    cc_ParallelBackend backend;     // first member, so that the pool can be
+                                    // retrieved from the backend
+    int32_t threadCount;            // including the submitting thread
+    thrd_t *threads;
+    mtx_t submitMutex;              // serializes concurrent submissions
+    mtx_t mutex;                    // guards the fields below
+    cnd_t jobReady, jobDone;
+    uint64_t jobID;
+    int32_t busyThreadCount;
+    bool isStopping;
+    cc_ParallelForCallback callback;
+    void *userData;
+    cc_Index begin, end, grain, chunkCount;
+    atomic_llong nextChunkID;
+} cc__ThreadPool;
+
+static _Thread_local bool cc__IsInParallelFor = false;
+
+static void cc__ThreadPool_RunChunks(cc__ThreadPool *pool)
+{
+    const bool wasInParallelFor = cc__IsInParallelFor;
+
+    cc__IsInParallelFor = true;
+
+    for (;;) {
+        const cc_Index chunkID = (cc_Index)atomic_fetch_add(&pool->nextChunkID, 1);
+        cc_Index chunkBegin, chunkEnd;
+
+        if (chunkID >= pool->chunkCount) {
+            break;
+        }
+
+        chunkBegin = pool->begin + chunkID * pool->grain;
+        chunkEnd = chunkBegin + cc__Min(pool->grain, pool->end - chunkBegin);
+        (*pool->callback)(chunkBegin, chunkEnd, pool->userData);
+    }
+
+    cc__IsInParallelFor = wasInParallelFor;
+}
+
+static int cc__ThreadPool_Worker(void *arg)
+{
+    cc__ThreadPool *pool = (cc__ThreadPool *)arg;
+    uint64_t jobID = 0;
+
+    mtx_lock(&pool->mutex);
+
+    for (;;) {
+        while (!pool->isStopping && pool->jobID == jobID) {
+            cnd_wait(&pool->jobReady, &pool->mutex);
+        }
+
+        if (pool->isStopping) {
+            break;
+        }
+
+        jobID = pool->jobID;
+        mtx_unlock(&pool->mutex);
+        cc__ThreadPool_RunChunks(pool);
+        mtx_lock(&pool->mutex);
+
+        if (--pool->busyThreadCount == 0) {
+            cnd_signal(&pool->jobDone);
+        }
+    }
+
+    mtx_unlock(&pool->mutex);
+
+    return 0;
+}
+
+static void
+cc__ParallelFor_ThreadPool(
+    cc_Index begin,
+    cc_Index end,
+    cc_Index grain,
+    cc_ParallelForCallback callback,
+    void *userData,
+    void *backendData
+) {
+    cc__ThreadPool *pool = (cc__ThreadPool *)backendData;
+
+    if (end - begin <= grain || pool->threadCount == 1 || cc__IsInParallelFor) {
+        cc__ParallelFor_Serial(begin, end, grain, callback, userData, NULL);
+
+        return;
+    }
+
+    mtx_lock(&pool->submitMutex);
+    mtx_lock(&pool->mutex);
+    pool->callback = callback;
+    pool->userData = userData;
+    pool->begin = begin;
+    pool->end = end;
+    pool->grain = grain;
+    pool->chunkCount = (end - begin + grain - 1) / grain;
+    atomic_store(&pool->nextChunkID, 0);
+    pool->busyThreadCount = pool->threadCount - 1;
+    ++pool->jobID;
+    cnd_broadcast(&pool->jobReady);
+    mtx_unlock(&pool->mutex);
+
+    cc__ThreadPool_RunChunks(pool);
+
+    mtx_lock(&pool->mutex);
+    while (pool->busyThreadCount > 0) {
+        cnd_wait(&pool->jobDone, &pool->mutex);
+    }
+    mtx_unlock(&pool->mutex);
+    mtx_unlock(&pool->submitMutex);
+}
+
+CCDEF cc_ParallelBackend *cc_CreateThreadPoolBackend(int32_t threadCount)
+{
+    cc__ThreadPool *pool = (cc__ThreadPool *)CC_MALLOC(sizeof(*pool));
+
+    CC_ASSERT(threadCount > 0);
+    pool->backend.parallelFor = &cc__ParallelFor_ThreadPool;
+    pool->backend.backendData = pool;
+    pool->threadCount = threadCount;
+    pool->threads = (thrd_t *)CC_MALLOC(sizeof(thrd_t) * threadCount);
+    pool->jobID = 0;
+    pool->busyThreadCount = 0;
+    pool->isStopping = false;
+    atomic_init(&pool->nextChunkID, 0);
+    mtx_init(&pool->submitMutex, mtx_plain);
+    mtx_init(&pool->mutex, mtx_plain);
+    cnd_init(&pool->jobReady);
+    cnd_init(&pool->jobDone);
+
+    for (int32_t threadID = 1; threadID < threadCount; ++threadID) {
+        if (thrd_create(&pool->threads[threadID], &cc__ThreadPool_Worker, pool)
+            != thrd_success) {
+            CC_LOG("cc: failed to start thread %i of the pool", threadID);
+            pool->threadCount = threadID;
+            break;
+        }
+    }
+
+    return &pool->backend;
+}
+
+CCDEF void cc_ReleaseThreadPoolBackend(cc_ParallelBackend *backend)
+{
+    cc__ThreadPool *pool = (cc__ThreadPool *)backend->backendData;
+
+    CC_ASSERT(cc__ParallelBackend != backend);
+    mtx_lock(&pool->mutex);
+    pool->isStopping = true;
+    cnd_broadcast(&pool->jobReady);
+    mtx_unlock(&pool->mutex);
+
+    for (int32_t threadID = 1; threadID < pool->threadCount; ++threadID) {
+        thrd_join(pool->threads[threadID], NULL);
+    }
+
+    cnd_destroy(&pool->jobDone);
+    cnd_destroy(&pool->jobReady);
+    mtx_destroy(&pool->mutex);
+    mtx_destroy(&pool->submitMutex);
+    CC_FREE(pool->threads);
+    CC_FREE(pool);
+}
+#else
+CCDEF cc_ParallelBackend *cc_CreateThreadPoolBackend(int32_t threadCount)
+{
+    (void)threadCount;
+    CC_LOG("cc: the thread pool backend requires C11 threads");
+
+    return NULL;
+}
+
+CCDEF void cc_ReleaseThreadPoolBackend(cc_ParallelBackend *backend)
+{
+    (void)backend;
+}
+#endif // CC__THREAD_POOL
+
+
+/*******************************************************************************
+ * AtomicAdd -- Atomically adds a value to a real or an integer
+ *
+ * With OpenMP, the additions go through CC_ATOMIC, which also holds among the
+ * threads of the other backends. Without OpenMP, they rely on the atomic
+ * builtins of GCC and Clang, and the reals are added with a compare-and-swap
+ * loop. Other compilers get plain additions (see ParallelScatter).
+ *
+ */
+static void cc__AtomicAddReal(cc_Real *x, cc_Real y)
+{
+#if defined(_OPENMP) || !defined(CC__ATOMICS)
+CC_ATOMIC
+    *x+= y;
+#else
+    cc_Real expected, desired;
+
+    __atomic_load(x, &expected, __ATOMIC_RELAXED);
+    do {
+        desired = expected + y;
+    } while (!__atomic_compare_exchange(x, &expected, &desired, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+#endif
+}
+
+static void cc__AtomicAddIndex(cc_Index *x, cc_Index y)
+{
+#if defined(_OPENMP) || !defined(CC__ATOMICS)
+CC_ATOMIC
+    *x+= y;
+#else
+    __atomic_fetch_add(x, y, __ATOMIC_RELAXED);
+#endif
+}
+
+static void cc__AtomicAddInt64(int64_t *x, int64_t y)
+{
+#if defined(_OPENMP) || !defined(CC__ATOMICS)
+CC_ATOMIC
+    *x+= y;
+#else
+    __atomic_fetch_add(x, y, __ATOMIC_RELAXED);
+#endif
 }
 
 
@@ -415,7 +1162,7 @@ static int32_t cc__EncodeUv(const cc_VertexUv uv)
  * FaceCount -- Returns the number of faces
  *
  */
-CCDEF int32_t ccm_FaceCount(const cc_Mesh *mesh)
+CCDEF cc_Index ccm_FaceCount(const cc_Mesh *mesh)
 {
     return mesh->faceCount;
 }
@@ -425,7 +1172,7 @@ CCDEF int32_t ccm_FaceCount(const cc_Mesh *mesh)
  * EdgeCount -- Returns the number of edges
  *
  */
-CCDEF int32_t ccm_EdgeCount(const cc_Mesh *mesh)
+CCDEF cc_Index ccm_EdgeCount(const cc_Mesh *mesh)
 {
     return mesh->edgeCount;
 }
@@ -435,7 +1182,7 @@ CCDEF int32_t ccm_EdgeCount(const cc_Mesh *mesh)
  * CreaseCount -- Returns the number of creases
  *
  */
-CCDEF int32_t ccm_CreaseCount(const cc_Mesh *mesh)
+CCDEF cc_Index ccm_CreaseCount(const cc_Mesh *mesh)
 {
     return ccm_EdgeCount(mesh);
 }
@@ -445,7 +1192,7 @@ CCDEF int32_t ccm_CreaseCount(const cc_Mesh *mesh)
  * HalfedgeCount -- Returns the number of halfedges
  *
  */
-CCDEF int32_t ccm_HalfedgeCount(const cc_Mesh *mesh)
+CCDEF cc_Index ccm_HalfedgeCount(const cc_Mesh *mesh)
 {
     return mesh->halfedgeCount;
 }
@@ -455,7 +1202,7 @@ CCDEF int32_t ccm_HalfedgeCount(const cc_Mesh *mesh)
  * VertexCount -- Returns the number of vertices
  *
  */
-CCDEF int32_t ccm_VertexCount(const cc_Mesh *mesh)
+CCDEF cc_Index ccm_VertexCount(const cc_Mesh *mesh)
 {
     return mesh->vertexCount;
 }
@@ -465,7 +1212,7 @@ CCDEF int32_t ccm_VertexCount(const cc_Mesh *mesh)
  * UvCount -- Returns the number of uvs
  *
  */
-CCDEF int32_t ccm_UvCount(const cc_Mesh *mesh)
+CCDEF cc_Index ccm_UvCount(const cc_Mesh *mesh)
 {
     return mesh->uvCount;
 }
@@ -481,15 +1228,15 @@ CCDEF int32_t ccm_UvCount(const cc_Mesh *mesh)
  * where H0 denotes the number of half-edges of the control cage.
  *
  */
-CCDEF int32_t ccm_FaceCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth)
+CCDEF cc_Index ccm_FaceCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth)
 {
     CC_ASSERT(depth > 0);
-    const int32_t H0 = ccm_HalfedgeCount(cage);
+    const cc_Index H0 = ccm_HalfedgeCount(cage);
 
     return (H0 << ((depth - 1) << 1));
 }
 
-CCDEF int32_t ccm_FaceCountAtDepth(const cc_Mesh *cage, int32_t depth)
+CCDEF cc_Index ccm_FaceCountAtDepth(const cc_Mesh *cage, int32_t depth)
 {
     if (depth == 0) {
         return ccm_FaceCount(cage);
@@ -510,17 +1257,17 @@ CCDEF int32_t ccm_FaceCountAtDepth(const cc_Mesh *cage, int32_t depth)
  * of the control cage.
  *
  */
-CCDEF int32_t ccm_EdgeCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth)
+CCDEF cc_Index ccm_EdgeCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth)
 {
     CC_ASSERT(depth > 0);
-    const int32_t E0 = ccm_EdgeCount(cage);
-    const int32_t H0 = ccm_HalfedgeCount(cage);
-    const int32_t tmp = ~(0xFFFFFFFF << depth); // (2^d - 1)
+    const cc_Index E0 = ccm_EdgeCount(cage);
+    const cc_Index H0 = ccm_HalfedgeCount(cage);
+    const cc_Index tmp = ((cc_Index)1 << depth) - 1; // (2^d - 1)
 
     return ((E0 << 1) + (tmp * H0)) << (depth - 1);
 }
 
-CCDEF int32_t ccm_EdgeCountAtDepth(const cc_Mesh *cage, int32_t depth)
+CCDEF cc_Index ccm_EdgeCountAtDepth(const cc_Mesh *cage, int32_t depth)
 {
     if (depth == 0) {
         return ccm_EdgeCount(cage);
@@ -539,9 +1286,9 @@ CCDEF int32_t ccm_EdgeCountAtDepth(const cc_Mesh *cage, int32_t depth)
  * where H0 denotes the number of half-edges of the control cage.
  *
  */
-CCDEF int32_t ccm_HalfedgeCountAtDepth(const cc_Mesh *cage, int32_t depth)
+CCDEF cc_Index ccm_HalfedgeCountAtDepth(const cc_Mesh *cage, int32_t depth)
 {
-    const int32_t H0 = ccm_HalfedgeCount(cage);
+    const cc_Index H0 = ccm_HalfedgeCount(cage);
 
     return H0 << (depth << 1);
 }
@@ -556,9 +1303,9 @@ CCDEF int32_t ccm_HalfedgeCountAtDepth(const cc_Mesh *cage, int32_t depth)
  * where C0 denotes the number of creases of the control cage.
  *
  */
-CCDEF int32_t ccm_CreaseCountAtDepth(const cc_Mesh *cage, int32_t depth)
+CCDEF cc_Index ccm_CreaseCountAtDepth(const cc_Mesh *cage, int32_t depth)
 {
-    const int32_t C0 = ccm_CreaseCount(cage);
+    const cc_Index C0 = ccm_CreaseCount(cage);
 
     return C0 << depth;
 }
@@ -579,22 +1326,22 @@ CCDEF int32_t ccm_CreaseCountAtDepth(const cc_Mesh *cage, int32_t depth)
  * the first subdivision step by hand and then apply the formula.
  *
  */
-CCDEF int32_t ccm_VertexCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth)
+CCDEF cc_Index ccm_VertexCountAtDepth_Fast(const cc_Mesh *cage, int32_t depth)
 {
     CC_ASSERT(depth > 0);
-    const int32_t V0 = ccm_VertexCount(cage);
-    const int32_t F0 = ccm_FaceCount(cage);
-    const int32_t E0 = ccm_EdgeCount(cage);
-    const int32_t H0 = ccm_HalfedgeCount(cage);
-    const int32_t F1 = H0;
-    const int32_t E1 = 2 * E0 + H0;
-    const int32_t V1 = V0 + E0 + F0;
-    const int32_t tmp =  ~(0xFFFFFFFF << (depth - 1)); // 2^{d-1} - 1
+    const cc_Index V0 = ccm_VertexCount(cage);
+    const cc_Index F0 = ccm_FaceCount(cage);
+    const cc_Index E0 = ccm_EdgeCount(cage);
+    const cc_Index H0 = ccm_HalfedgeCount(cage);
+    const cc_Index F1 = H0;
+    const cc_Index E1 = 2 * E0 + H0;
+    const cc_Index V1 = V0 + E0 + F0;
+    const cc_Index tmp = ((cc_Index)1 << (depth - 1)) - 1; // 2^{d-1} - 1
 
     return V1 + tmp * (E1 + tmp * F1);
 }
 
-CCDEF int32_t ccm_VertexCountAtDepth(const cc_Mesh *cage, int32_t depth)
+CCDEF cc_Index ccm_VertexCountAtDepth(const cc_Mesh *cage, int32_t depth)
 {
     if (depth == 0) {
         return ccm_VertexCount(cage);
@@ -608,101 +1355,101 @@ CCDEF int32_t ccm_VertexCountAtDepth(const cc_Mesh *cage, int32_t depth)
  * Halfedge data accessors
  *
  */
-static cc_Halfedge *ccm__Halfedge(const cc_Mesh *mesh, int32_t halfedgeID)
+static cc_Halfedge *ccm__Halfedge(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return &mesh->halfedges[halfedgeID];
 }
 
-CCDEF int32_t ccm_HalfedgeTwinID(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_Index ccm_HalfedgeTwinID(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return ccm__Halfedge(mesh, halfedgeID)->twinID;
 }
 
-CCDEF int32_t ccm_HalfedgeNextID(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_Index ccm_HalfedgeNextID(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return ccm__Halfedge(mesh, halfedgeID)->nextID;
 }
 
-CCDEF int32_t ccm_HalfedgePrevID(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_Index ccm_HalfedgePrevID(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return ccm__Halfedge(mesh, halfedgeID)->prevID;
 }
 
-CCDEF int32_t ccm_HalfedgeVertexID(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_Index ccm_HalfedgeVertexID(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return ccm__Halfedge(mesh, halfedgeID)->vertexID;
 }
 
-CCDEF int32_t ccm_HalfedgeUvID(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_Index ccm_HalfedgeUvID(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return ccm__Halfedge(mesh, halfedgeID)->uvID;
 }
 
-CCDEF int32_t ccm_HalfedgeEdgeID(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_Index ccm_HalfedgeEdgeID(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return ccm__Halfedge(mesh, halfedgeID)->edgeID;
 }
 
-CCDEF int32_t ccm_HalfedgeFaceID(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_Index ccm_HalfedgeFaceID(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return ccm__Halfedge(mesh, halfedgeID)->faceID;
 }
 
-CCDEF double ccm_HalfedgeSharpness(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_Real ccm_HalfedgeSharpness(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return ccm_CreaseSharpness(mesh, ccm_HalfedgeEdgeID(mesh, halfedgeID));
 }
 
-CCDEF cc_VertexPoint ccm_HalfedgeVertexPoint(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_VertexPoint ccm_HalfedgeVertexPoint(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return ccm_VertexPoint(mesh, ccm_HalfedgeVertexID(mesh, halfedgeID));
 }
 
-CCDEF cc_VertexUv ccm_HalfedgeVertexUv(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_VertexUv ccm_HalfedgeVertexUv(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
     return ccm_Uv(mesh, ccm_HalfedgeUvID(mesh, halfedgeID));
 }
 
-static cc_Crease *ccm__Crease(const cc_Mesh *mesh, int32_t edgeID)
+static cc_Crease *ccm__Crease(const cc_Mesh *mesh, cc_Index edgeID)
 {
     return &mesh->creases[edgeID];
 }
 
-CCDEF int32_t ccm_CreaseNextID(const cc_Mesh *mesh, int32_t edgeID)
+CCDEF cc_Index ccm_CreaseNextID(const cc_Mesh *mesh, cc_Index edgeID)
 {
     return ccm__Crease(mesh, edgeID)->nextID;
 }
 
-CCDEF int32_t ccm_CreasePrevID(const cc_Mesh *mesh, int32_t edgeID)
+CCDEF cc_Index ccm_CreasePrevID(const cc_Mesh *mesh, cc_Index edgeID)
 {
     return ccm__Crease(mesh, edgeID)->prevID;
 }
 
-CCDEF double ccm_CreaseSharpness(const cc_Mesh *mesh, int32_t edgeID)
+CCDEF cc_Real ccm_CreaseSharpness(const cc_Mesh *mesh, cc_Index edgeID)
 {
     return ccm__Crease(mesh, edgeID)->sharpness;
 }
 
-CCDEF int32_t ccm_HalfedgeFaceID_Quad(int32_t halfedgeID)
+CCDEF cc_Index ccm_HalfedgeFaceID_Quad(cc_Index halfedgeID)
 {
     return halfedgeID >> 2;
 }
 
-static int32_t
-ccm__ScrollFaceHalfedgeID_Quad(int32_t halfedgeID, int32_t direction)
+static cc_Index
+ccm__ScrollFaceHalfedgeID_Quad(cc_Index halfedgeID, int32_t direction)
 {
-    const int32_t base = 3;
-    const int32_t localID = (halfedgeID & base) + direction;
+    const cc_Index base = 3;
+    const cc_Index localID = (halfedgeID & base) + direction;
 
     return (halfedgeID & ~base) | (localID & base);
 }
 
-CCDEF int32_t ccm_HalfedgeNextID_Quad(int32_t halfedgeID)
+CCDEF cc_Index ccm_HalfedgeNextID_Quad(cc_Index halfedgeID)
 {
     return ccm__ScrollFaceHalfedgeID_Quad(halfedgeID, +1);
 }
 
-CCDEF int32_t ccm_HalfedgePrevID_Quad(int32_t halfedgeID)
+CCDEF cc_Index ccm_HalfedgePrevID_Quad(cc_Index halfedgeID)
 {
     return ccm__ScrollFaceHalfedgeID_Quad(halfedgeID, -1);
 }
@@ -711,11 +1458,11 @@ CCDEF int32_t ccm_HalfedgePrevID_Quad(int32_t halfedgeID)
  * Vertex data accessors
  *
  */
-CCDEF cc_VertexPoint ccm_VertexPoint(const cc_Mesh *mesh, int32_t vertexID)
+CCDEF cc_VertexPoint ccm_VertexPoint(const cc_Mesh *mesh, cc_Index vertexID)
 {
     return mesh->vertexPoints[vertexID];
 }
-CCDEF cc_VertexUv ccm_Uv(const cc_Mesh *mesh, int32_t uvID)
+CCDEF cc_VertexUv ccm_Uv(const cc_Mesh *mesh, cc_Index uvID)
 {
     return mesh->uvs[uvID];
 }
@@ -725,7 +1472,7 @@ CCDEF cc_VertexUv ccm_Uv(const cc_Mesh *mesh, int32_t uvID)
  * VertexToHalfedgeID -- Returns a halfedge ID that carries a given vertex
  *
  */
-CCDEF int32_t ccm_VertexToHalfedgeID(const cc_Mesh *mesh, int32_t vertexID)
+CCDEF cc_Index ccm_VertexToHalfedgeID(const cc_Mesh *mesh, cc_Index vertexID)
 {
     return mesh->vertexToHalfedgeIDs[vertexID];
 }
@@ -735,7 +1482,7 @@ CCDEF int32_t ccm_VertexToHalfedgeID(const cc_Mesh *mesh, int32_t vertexID)
  * EdgeToHalfedgeID -- Returns a halfedge associated with a given edge
  *
  */
-CCDEF int32_t ccm_EdgeToHalfedgeID(const cc_Mesh *mesh, int32_t edgeID)
+CCDEF cc_Index ccm_EdgeToHalfedgeID(const cc_Mesh *mesh, cc_Index edgeID)
 {
     return mesh->edgeToHalfedgeIDs[edgeID];
 }
@@ -745,12 +1492,12 @@ CCDEF int32_t ccm_EdgeToHalfedgeID(const cc_Mesh *mesh, int32_t edgeID)
  * FaceToHalfedgeID -- Returns a halfedge associated with a given face
  *
  */
-CCDEF int32_t ccm_FaceToHalfedgeID(const cc_Mesh *mesh, int32_t faceID)
+CCDEF cc_Index ccm_FaceToHalfedgeID(const cc_Mesh *mesh, cc_Index faceID)
 {
     return mesh->faceToHalfedgeIDs[faceID];
 }
 
-CCDEF int32_t ccm_FaceToHalfedgeID_Quad(int32_t faceID)
+CCDEF cc_Index ccm_FaceToHalfedgeID_Quad(cc_Index faceID)
 {
     return faceID << 2;
 }
@@ -760,37 +1507,103 @@ CCDEF int32_t ccm_FaceToHalfedgeID_Quad(int32_t faceID)
  * Vertex Halfedge Iteration
  *
  */
-CCDEF int32_t ccm_NextVertexHalfedgeID(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_Index ccm_NextVertexHalfedgeID(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
-    const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
+    const cc_Index twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
 
     return twinID >= 0 ? ccm_HalfedgeNextID(mesh, twinID) : -1;
 }
 
-CCDEF int32_t ccm_PrevVertexHalfedgeID(const cc_Mesh *mesh, int32_t halfedgeID)
+CCDEF cc_Index ccm_PrevVertexHalfedgeID(const cc_Mesh *mesh, cc_Index halfedgeID)
 {
-    const int32_t prevID = ccm_HalfedgePrevID(mesh, halfedgeID);
+    const cc_Index prevID = ccm_HalfedgePrevID(mesh, halfedgeID);
 
     return ccm_HalfedgeTwinID(mesh, prevID);
 }
 
 
+/*******************************************************************************
+ * TopologyFingerprint -- Hashes the data that the subdivision topology uses
+ *
+ * The fingerprint covers the element counts, the halfedges, the creases, and
+ * the uvs of the mesh (i.e., everything but the vertex points). It is an
+ * FNV-1a hash over 32-bit words, so it is cheap enough to be recomputed every
+ * frame and never returns 0.
+ *
+ */
+static uint64_t cc__HashWords(uint64_t hash, const void *data, size_t byteCount)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    for (size_t i = 0; i + sizeof(uint32_t) <= byteCount; i+= sizeof(uint32_t)) {
+        uint32_t word;
+
+        CC_MEMCPY(&word, &bytes[i], sizeof(word));
+        hash = (hash ^ word) * 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+// the padding of cc_Crease (if any) is skipped so that it does not leak
+static uint64_t cc__HashCreases(uint64_t hash, const cc_Crease *creases, cc_Index count)
+{
+    if (sizeof(cc_Crease) != 2 * sizeof(cc_Index) + sizeof(cc_Real)) {
+        for (cc_Index i = 0; i < count; ++i) {
+            const cc_Index ids[2] = {creases[i].nextID, creases[i].prevID};
+
+            hash = cc__HashWords(hash, ids, sizeof(ids));
+            hash = cc__HashWords(hash, &creases[i].sharpness, sizeof(cc_Real));
+        }
+
+        return hash;
+    }
+
+    return cc__HashWords(hash, creases, sizeof(cc_Crease) * count);
+}
+
+CCDEF uint64_t ccm_TopologyFingerprint(const cc_Mesh *mesh)
+{
+    const cc_Index counts[5] = {
+        ccm_VertexCount(mesh),
+        ccm_UvCount(mesh),
+        ccm_HalfedgeCount(mesh),
+        ccm_EdgeCount(mesh),
+        ccm_FaceCount(mesh)
+    };
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    hash = cc__HashWords(hash, counts, sizeof(counts));
+    hash = cc__HashWords(hash,
+                         mesh->halfedges,
+                         sizeof(cc_Halfedge) * ccm_HalfedgeCount(mesh));
+    hash = cc__HashCreases(hash, mesh->creases, ccm_CreaseCount(mesh));
+#ifndef CC_DISABLE_UV
+    hash = cc__HashWords(hash,
+                         mesh->uvs,
+                         sizeof(cc_VertexUv) * ccm_UvCount(mesh));
+#endif
+
+    return hash != 0 ? hash : 1;
+}
+
+
 /*******************************************************************************
  * Create -- Allocates memory for a mesh of given vertex and halfedge count
  *
  */
 CCDEF cc_Mesh *
 ccm_Create(
-    int32_t vertexCount,
-    int32_t uvCount,
-    int32_t halfedgeCount,
-    int32_t edgeCount,
-    int32_t faceCount
-) {
-    const int32_t halfedgeByteCount = halfedgeCount * sizeof(cc_Halfedge);
-    const int32_t vertexByteCount = vertexCount * sizeof(cc_VertexPoint);
-    const int32_t uvByteCount = uvCount * sizeof(cc_VertexUv);
-    const int32_t creaseByteCount = edgeCount * sizeof(cc_Crease);
+    cc_Index vertexCount,
+    cc_Index uvCount,
+    cc_Index halfedgeCount,
+    cc_Index edgeCount,
+    cc_Index faceCount
+) {
+    const size_t halfedgeByteCount = halfedgeCount * sizeof(cc_Halfedge);
+    const size_t vertexByteCount = vertexCount * sizeof(cc_VertexPoint);
+    const size_t uvByteCount = uvCount * sizeof(cc_VertexUv);
+    const size_t creaseByteCount = edgeCount * sizeof(cc_Crease);
     cc_Mesh *mesh = (cc_Mesh *)CC_MALLOC(sizeof(*mesh));
 
     mesh->vertexCount = vertexCount;
@@ -798,13 +1611,15 @@ ccm_Create(
     mesh->halfedgeCount = halfedgeCount;
     mesh->edgeCount = edgeCount;
     mesh->faceCount = faceCount;
-    mesh->vertexToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * vertexCount);
-    mesh->edgeToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * edgeCount);
-    mesh->faceToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * faceCount);
+    mesh->vertexToHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * vertexCount);
+    mesh->edgeToHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * edgeCount);
+    mesh->faceToHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * faceCount);
     mesh->halfedges = (cc_Halfedge *)CC_MALLOC(halfedgeByteCount);
     mesh->creases = (cc_Crease *)CC_MALLOC(creaseByteCount);
     mesh->vertexPoints = (cc_VertexPoint *)CC_MALLOC(vertexByteCount);
     mesh->uvs = (cc_VertexUv *)CC_MALLOC(uvByteCount);
+    mesh->mappedData = NULL;
+    mesh->mappedByteCount = 0;
 
     return mesh;
 }
@@ -813,17 +1628,37 @@ ccm_Create(
 /*******************************************************************************
  * Release -- Releases memory used for a given mesh
  *
+ * The arrays of a mesh loaded with ccm_LoadMapped either point into the
+ * file mapping, which is unmapped as a whole, or were allocated for a
+ * conversion, and are freed.
+ *
  */
-CCDEF void ccm_Release(cc_Mesh *mesh)
+static void ccm__ReleaseArray(const cc_Mesh *mesh, void *array)
 {
-    CC_FREE(mesh->vertexToHalfedgeIDs);
-    CC_FREE(mesh->faceToHalfedgeIDs);
-    CC_FREE(mesh->edgeToHalfedgeIDs);
-    CC_FREE(mesh->halfedges);
-    CC_FREE(mesh->creases);
-    CC_FREE(mesh->vertexPoints);
-    CC_FREE(mesh->uvs);
-    CC_FREE(mesh);
+    const char *mappedData = (const char *)mesh->mappedData;
+    const char *data = (const char *)array;
+
+    if (mappedData == NULL
+        || data < mappedData || data >= mappedData + mesh->mappedByteCount) {
+        CC_FREE(array);
+    }
+}
+
+CCDEF void ccm_Release(cc_Mesh *mesh)
+{
+    ccm__ReleaseArray(mesh, mesh->vertexToHalfedgeIDs);
+    ccm__ReleaseArray(mesh, mesh->faceToHalfedgeIDs);
+    ccm__ReleaseArray(mesh, mesh->edgeToHalfedgeIDs);
+    ccm__ReleaseArray(mesh, mesh->halfedges);
+    ccm__ReleaseArray(mesh, mesh->creases);
+    ccm__ReleaseArray(mesh, mesh->vertexPoints);
+    ccm__ReleaseArray(mesh, mesh->uvs);
+#ifdef CC__MAPPED_FILES
+    if (mesh->mappedData != NULL) {
+        munmap(mesh->mappedData, mesh->mappedByteCount);
+    }
+#endif
+    CC_FREE(mesh);
 }
 
 
@@ -831,12 +1666,12 @@ CCDEF void ccm_Release(cc_Mesh *mesh)
  * FaceCountAtDepth -- Returns the accumulated number of faces up to a given subdivision depth
  *
  */
-CCDEF int32_t ccs_CumulativeFaceCountAtDepth(const cc_Mesh *cage, int32_t depth)
+CCDEF cc_Index ccs_CumulativeFaceCountAtDepth(const cc_Mesh *cage, int32_t depth)
 {
     return ccs_CumulativeHalfedgeCountAtDepth(cage, depth) >> 2;
 }
 
-CCDEF int32_t ccs_CumulativeFaceCount(const cc_Subd *subd)
+CCDEF cc_Index ccs_CumulativeFaceCount(const cc_Subd *subd)
 {
     return ccs_CumulativeFaceCountAtDepth(subd->cage, ccs_MaxDepth(subd));
 }
@@ -846,20 +1681,20 @@ CCDEF int32_t ccs_CumulativeFaceCount(const cc_Subd *subd)
  * EdgeCountAtDepth -- Returns the accumulated number of edges up to a given subdivision depth
  *
  */
-CCDEF int32_t ccs_CumulativeEdgeCountAtDepth(const cc_Mesh *cage, int32_t depth)
+CCDEF cc_Index ccs_CumulativeEdgeCountAtDepth(const cc_Mesh *cage, int32_t depth)
 {
     CC_ASSERT(depth >= 0);
-    const int32_t H0 = ccm_HalfedgeCount(cage);
-    const int32_t E0 = ccm_EdgeCount(cage);
-    const int32_t H1 = H0 << 2;
-    const int32_t E1 = (E0 << 1) + H0;
+    const cc_Index H0 = ccm_HalfedgeCount(cage);
+    const cc_Index E0 = ccm_EdgeCount(cage);
+    const cc_Index H1 = H0 << 2;
+    const cc_Index E1 = (E0 << 1) + H0;
     const int32_t D = depth;
-    const int32_t A = ~(0xFFFFFFFF << D); //  2^{d} - 1
+    const cc_Index A = ((cc_Index)1 << D) - 1; //  2^{d} - 1
 
     return (A * (6 * E1 + A * H1 - H1)) / 6;
 }
 
-CCDEF int32_t ccs_CumulativeEdgeCount(const cc_Subd *subd)
+CCDEF cc_Index ccs_CumulativeEdgeCount(const cc_Subd *subd)
 {
     return ccs_CumulativeEdgeCountAtDepth(subd->cage, ccs_MaxDepth(subd));
 }
@@ -876,19 +1711,19 @@ CCDEF int32_t ccs_CumulativeEdgeCount(const cc_Subd *subd)
  * halfedges in the control mesh.
  *
  */
-CCDEF int32_t
+CCDEF cc_Index
 ccs_CumulativeHalfedgeCountAtDepth(const cc_Mesh *cage, int32_t maxDepth)
 {
     CC_ASSERT(maxDepth >= 0);
     const int32_t D = maxDepth;
-    const int32_t H0 = ccm_HalfedgeCount(cage);
-    const int32_t H1 = H0 << 2;
-    const int32_t tmp = ~(0xFFFFFFFF << (D << 1)); // (4^D - 1)
+    const cc_Index H0 = ccm_HalfedgeCount(cage);
+    const cc_Index H1 = H0 << 2;
+    const cc_Index tmp = ((cc_Index)1 << (D << 1)) - 1; // (4^D - 1)
 
     return (H1 * tmp) / 3;
 }
 
-CCDEF int32_t ccs_CumulativeHalfedgeCount(const cc_Subd *subd)
+CCDEF cc_Index ccs_CumulativeHalfedgeCount(const cc_Subd *subd)
 {
     return ccs_CumulativeHalfedgeCountAtDepth(subd->cage, ccs_MaxDepth(subd));
 }
@@ -905,19 +1740,19 @@ CCDEF int32_t ccs_CumulativeHalfedgeCount(const cc_Subd *subd)
  * creases in the control mesh.
  *
  */
-CCDEF int32_t
+CCDEF cc_Index
 ccs_CumulativeCreaseCountAtDepth(const cc_Mesh *cage, int32_t maxDepth)
 {
     CC_ASSERT(maxDepth >= 0);
     const int32_t D = maxDepth;
-    const int32_t C0 = ccm_CreaseCount(cage);
-    const int32_t C1 = C0 << 1;
-    const int32_t tmp = ~(0xFFFFFFFF << D); // (2^D - 1)
+    const cc_Index C0 = ccm_CreaseCount(cage);
+    const cc_Index C1 = C0 << 1;
+    const cc_Index tmp = ((cc_Index)1 << D) - 1; // (2^D - 1)
 
     return (C1 * tmp);
 }
 
-CCDEF int32_t ccs_CumulativeCreaseCount(const cc_Subd *subd)
+CCDEF cc_Index ccs_CumulativeCreaseCount(const cc_Subd *subd)
 {
     return ccs_CumulativeCreaseCountAtDepth(subd->cage, ccs_MaxDepth(subd));
 }
@@ -931,25 +1766,25 @@ CCDEF int32_t ccs_CumulativeCreaseCount(const cc_Subd *subd)
  *  Vd+1 = Fd + Ed + Vd
  *
  */
-CCDEF int32_t
+CCDEF cc_Index
 ccs_CumulativeVertexCountAtDepth(const cc_Mesh *cage, int32_t depth)
 {
     CC_ASSERT(depth >= 0);
-    const int32_t V0 = ccm_VertexCount(cage);
-    const int32_t F0 = ccm_FaceCount(cage);
-    const int32_t E0 = ccm_EdgeCount(cage);
-    const int32_t H0 = ccm_HalfedgeCount(cage);
-    const int32_t F1 = H0;
-    const int32_t E1 = 2 * E0 + H0;
-    const int32_t V1 = V0 + E0 + F0;
+    const cc_Index V0 = ccm_VertexCount(cage);
+    const cc_Index F0 = ccm_FaceCount(cage);
+    const cc_Index E0 = ccm_EdgeCount(cage);
+    const cc_Index H0 = ccm_HalfedgeCount(cage);
+    const cc_Index F1 = H0;
+    const cc_Index E1 = 2 * E0 + H0;
+    const cc_Index V1 = V0 + E0 + F0;
     const int32_t D = depth;
-    const int32_t A =  ~(0xFFFFFFFF << (D     ));     //  2^{d} - 1
-    const int32_t B =  ~(0xFFFFFFFF << (D << 1)) / 3; // (4^{d} - 1) / 3
+    const cc_Index A = ((cc_Index)1 << (D     )) - 1;      //  2^{d} - 1
+    const cc_Index B = (((cc_Index)1 << (D << 1)) - 1) / 3; // (4^{d} - 1) / 3
 
     return A * (E1 - (F1 << 1)) + B * F1 + D * (F1 - E1 + V1);
 }
 
-CCDEF int32_t ccs_CumulativeVertexCount(const cc_Subd *subd)
+CCDEF cc_Index ccs_CumulativeVertexCount(const cc_Subd *subd)
 {
     return ccs_CumulativeVertexCountAtDepth(subd->cage, ccs_MaxDepth(subd));
 }
@@ -965,39 +1800,558 @@ CCDEF int32_t ccs_MaxDepth(const cc_Subd *subd)
 }
 
 
+/*******************************************************************************
+ * Level storage -- Locates the data of each depth within the subd buffers
+ *
+ * By default, the subd stores every depth one after the other. With the
+ * CC_SUBD_FINAL_LEVEL_ONLY flag, it only stores two levels: the final depth
+ * lives at the start of each buffer and the depths of different parity share
+ * the space that follows. Refining depth d+1 from depth d thus never
+ * overwrites its input, and only the final (and previous) depth remains
+ * accessible once the refinement completes.
+ *
+ */
+static bool ccs__IsFinalLevelOnly(const cc_Subd *subd)
+{
+    return (subd->flags & CC_SUBD_FINAL_LEVEL_ONLY) != 0;
+}
+
+static cc_Index
+ccs__LevelStride(
+    const cc_Subd *subd,
+    int32_t depth,
+    cc_Index (*levelCount)(const cc_Mesh *, int32_t),
+    cc_Index (*cumulativeCount)(const cc_Mesh *, int32_t)
+) {
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+
+    if (ccs__IsFinalLevelOnly(subd)) {
+        return ((maxDepth - depth) & 1) ? (*levelCount)(subd->cage, maxDepth) : 0;
+    } else {
+        return (*cumulativeCount)(subd->cage, depth - 1);
+    }
+}
+
+static cc_Index
+ccs__LevelStorageCount(
+    const cc_Mesh *cage,
+    int32_t maxDepth,
+    uint32_t flags,
+    cc_Index (*levelCount)(const cc_Mesh *, int32_t),
+    cc_Index (*cumulativeCount)(const cc_Mesh *, int32_t)
+) {
+    if (flags & CC_SUBD_FINAL_LEVEL_ONLY) {
+        const cc_Index prevCount = maxDepth > 1 ? (*levelCount)(cage, maxDepth - 1) : 0;
+
+        return (*levelCount)(cage, maxDepth) + prevCount;
+    } else {
+        return (*cumulativeCount)(cage, maxDepth);
+    }
+}
+
+static cc_Index ccs__HalfedgeStride(const cc_Subd *subd, int32_t depth)
+{
+    return ccs__LevelStride(subd,
+                            depth,
+                            &ccm_HalfedgeCountAtDepth,
+                            &ccs_CumulativeHalfedgeCountAtDepth);
+}
+
+static cc_Index ccs__CreaseStride(const cc_Subd *subd, int32_t depth)
+{
+    const cc_Index stride = ccs__LevelStride(subd,
+                                             depth,
+                                             &ccm_CreaseCountAtDepth,
+                                             &ccs_CumulativeCreaseCountAtDepth);
+
+    // sparse creases: same layout, scaled down to the stored cage edges
+    if (subd->creaseBits != NULL) {
+        return stride / ccm_CreaseCount(subd->cage) * subd->creaseEdgeCount;
+    }
+
+    return stride;
+}
+
+static cc_Index ccs__VertexStride(const cc_Subd *subd, int32_t depth)
+{
+    return ccs__LevelStride(subd,
+                            depth,
+                            &ccm_VertexCountAtDepth,
+                            &ccs_CumulativeVertexCountAtDepth);
+}
+
+static cc_Index ccs__EdgeStride(const cc_Subd *subd, int32_t depth)
+{
+    return ccs__LevelStride(subd,
+                            depth,
+                            &ccm_EdgeCountAtDepth,
+                            &ccs_CumulativeEdgeCountAtDepth);
+}
+
+
+/*******************************************************************************
+ * BoundaryHalfedges -- Counts and offsets of the per-depth boundary lists
+ *
+ * Each boundary halfedge splits into two boundary halfedges, so depth d
+ * holds 2^d times as many as the cage, and the lists of depths [0, d)
+ * precede that of depth d.
+ *
+ */
+static cc_Index ccs__CageBoundaryHalfedgeCount(const cc_Mesh *cage)
+{
+    const cc_Index halfedgeCount = ccm_HalfedgeCount(cage);
+    cc_Index boundaryHalfedgeCount = 0;
+
+    for (cc_Index halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        if (ccm_HalfedgeTwinID(cage, halfedgeID) < 0) {
+            ++boundaryHalfedgeCount;
+        }
+    }
+
+    return boundaryHalfedgeCount;
+}
+
+static cc_Index
+ccs__BoundaryHalfedgeStride(cc_Index cageBoundaryHalfedgeCount, int32_t depth)
+{
+    return cageBoundaryHalfedgeCount * (((cc_Index)1 << depth) - 1);
+}
+
+
+/*******************************************************************************
+ * LevelBuffers -- Allocates the halfedge, crease, and vertex point buffers
+ *
+ * With CC_SUBD_FIRST_TOUCH, the level buffers start on a CC_PAGE_ALIGNMENT
+ * boundary, which defaults to the size of a huge page, and ask the kernel to
+ * back them with huge pages where it can (Linux). The block returned by
+ * CC_MALLOC is recorded right before the aligned buffer. The buffers are
+ * then first-touched by the threads of the refinement (see FirstTouch).
+ *
+ */
+#ifndef CC_PAGE_ALIGNMENT
+#   define CC_PAGE_ALIGNMENT ((size_t)2 << 20)
+#endif
+
+static void ccs__FirstTouch(cc_Subd *subd);
+static void ccs__FirstTouchCreases(cc_Subd *subd);
+
+static void *ccs__AllocateLevelBuffer(const cc_Subd *subd, size_t byteCount)
+{
+    if (subd->flags & CC_SUBD_FIRST_TOUCH) {
+        const size_t alignment = CC_PAGE_ALIGNMENT;
+        char *block = (char *)CC_MALLOC(byteCount + alignment + sizeof(void *));
+        const uintptr_t address = (uintptr_t)(block + sizeof(void *));
+        char *buffer = block + sizeof(void *) + (alignment - address % alignment) % alignment;
+
+        ((void **)buffer)[-1] = block;
+#ifdef CC__HUGE_PAGES
+        if (byteCount >= alignment) {
+            madvise(buffer, byteCount, MADV_HUGEPAGE);
+        }
+#endif
+
+        return buffer;
+    }
+
+    return CC_MALLOC(byteCount);
+}
+
+static bool ccs__IsMapped(const cc_Subd *subd, const void *array)
+{
+    const char *mappedData = (const char *)subd->mappedData;
+    const char *data = (const char *)array;
+
+    return mappedData != NULL
+        && data >= mappedData && data < mappedData + subd->mappedByteCount;
+}
+
+static void ccs__ReleaseLevelBuffer(const cc_Subd *subd, void *buffer)
+{
+    if (ccs__IsMapped(subd, buffer)) {
+        return;
+    } else if (subd->flags & CC_SUBD_FIRST_TOUCH) {
+        CC_FREE(((void **)buffer)[-1]);
+    } else {
+        CC_FREE(buffer);
+    }
+}
+
+
+/*******************************************************************************
+ * SparseCreases -- Index of the cage edges whose creases are stored
+ *
+ * With CC_SUBD_SPARSE_CREASES, only the cage edges that are sharp or chained
+ * to another edge are stored, along with the edges they chain to. The
+ * 2^d edges that descend from such an edge at depth d are stored
+ * contiguously, in the order of their cage edge, so that edge x of depth d
+ * is found at (rank(x >> d) << d) + (x mod 2^d), where the rank is given
+ * by a bitset over the cage edges. The creases of the remaining edges are
+ * never sharp and chain to their siblings, so they are not stored.
+ *
+ */
+static cc_Index ccs__CreaseWordCount(const cc_Mesh *cage)
+{
+    return (ccm_CreaseCount(cage) + 63) / 64;
+}
+
+static void ccs__BuildCreaseIndex(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const cc_Index edgeCount = ccm_CreaseCount(cage);
+    const cc_Index wordCount = ccs__CreaseWordCount(cage);
+    uint64_t *bits = subd->creaseBits;
+    cc_Index creaseEdgeCount = 0;
+
+    CC_MEMSET(bits, 0, sizeof(uint64_t) * wordCount);
+
+    for (cc_Index edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const cc_Index nextID = ccm_CreaseNextID(cage, edgeID);
+        const cc_Index prevID = ccm_CreasePrevID(cage, edgeID);
+
+        if (ccm_CreaseSharpness(cage, edgeID) > 0.0f
+            || nextID != edgeID || prevID != edgeID) {
+            bits[edgeID >> 6]|= (uint64_t)1 << (edgeID & 63);
+            bits[nextID >> 6]|= (uint64_t)1 << (nextID & 63);
+            bits[prevID >> 6]|= (uint64_t)1 << (prevID & 63);
+        }
+    }
+
+    for (cc_Index wordID = 0; wordID < wordCount; ++wordID) {
+        subd->creaseRanks[wordID] = creaseEdgeCount;
+        creaseEdgeCount+= cc__Popcount64(bits[wordID]);
+    }
+
+    for (cc_Index edgeID = 0, creaseID = 0; edgeID < edgeCount; ++edgeID) {
+        if (bits[edgeID >> 6] & ((uint64_t)1 << (edgeID & 63))) {
+            subd->creaseEdgeIDs[creaseID++] = edgeID;
+        }
+    }
+
+    subd->creaseEdgeCount = creaseEdgeCount;
+}
+
+static cc_Index ccs__CreaseStorageCount(const cc_Subd *subd)
+{
+    const cc_Index creaseCount = ccs__LevelStorageCount(subd->cage,
+                                                       subd->maxDepth,
+                                                       subd->flags,
+                                                       &ccm_CreaseCountAtDepth,
+                                                       &ccs_CumulativeCreaseCountAtDepth);
+
+    if (subd->creaseBits != NULL) {
+        return creaseCount / ccm_CreaseCount(subd->cage) * subd->creaseEdgeCount;
+    }
+
+    return creaseCount;
+}
+
+static cc_Index
+ccs__FindCreaseID(
+    const uint64_t *creaseBits,
+    const cc_Index *creaseRanks,
+    cc_Index edgeID,
+    int32_t depth
+) {
+    const cc_Index cageEdgeID = edgeID >> depth;
+    const cc_Index wordID = cageEdgeID >> 6;
+    const uint64_t word = creaseBits[wordID];
+    const uint64_t bit = (uint64_t)1 << (cageEdgeID & 63);
+
+    if (word & bit) {
+        const cc_Index rank = creaseRanks[wordID] + cc__Popcount64(word & (bit - 1));
+
+        return (rank << depth) + (edgeID & (((cc_Index)1 << depth) - 1));
+    }
+
+    return -1;
+}
+
+static const cc_Crease *
+ccs__FindCrease(
+    const cc_Crease *creases,
+    const uint64_t *creaseBits,
+    const cc_Index *creaseRanks,
+    cc_Index edgeID,
+    int32_t depth
+) {
+    const cc_Index creaseID = ccs__FindCreaseID(creaseBits, creaseRanks, edgeID, depth);
+
+    return creaseID >= 0 ? &creases[creaseID] : NULL;
+}
+
+static cc_Index ccs__SmoothCreaseNextID(cc_Index edgeID, int32_t depth)
+{
+    const cc_Index mask = ((cc_Index)1 << depth) - 1;
+
+    return (edgeID & mask) == mask ? edgeID : edgeID + 1;
+}
+
+static cc_Index ccs__SmoothCreasePrevID(cc_Index edgeID, int32_t depth)
+{
+    const cc_Index mask = ((cc_Index)1 << depth) - 1;
+
+    return (edgeID & mask) == 0 ? edgeID : edgeID - 1;
+}
+
+static cc_Index ccs__CreaseEdgeID(const cc_Subd *subd, cc_Index creaseID, int32_t depth)
+{
+    if (subd->creaseBits != NULL) {
+        const cc_Index mask = ((cc_Index)1 << depth) - 1;
+
+        return (subd->creaseEdgeIDs[creaseID >> depth] << depth) + (creaseID & mask);
+    }
+
+    return creaseID;
+}
+
+static cc_Index ccs__CreaseID(const cc_Subd *subd, cc_Index edgeID, int32_t depth)
+{
+    if (edgeID >= ccm_CreaseCountAtDepth(subd->cage, depth)) {
+        return -1;
+    } else if (subd->creaseBits != NULL) {
+        return ccs__FindCreaseID(subd->creaseBits, subd->creaseRanks, edgeID, depth);
+    }
+
+    return edgeID;
+}
+
+static cc_Index ccs__CreaseCountAtDepth(const cc_Subd *subd, int32_t depth)
+{
+    if (subd->creaseBits != NULL) {
+        return subd->creaseEdgeCount << depth;
+    }
+
+    return ccm_CreaseCountAtDepth(subd->cage, depth);
+}
+
+static void ccs__UpdateCreaseIndex(cc_Subd *subd)
+{
+    const cc_Index creaseEdgeCount = subd->creaseEdgeCount;
+
+    ccs__BuildCreaseIndex(subd);
+
+    // the cage creases were edited since the last refinement
+    if (subd->creaseEdgeCount != creaseEdgeCount) {
+        ccs__ReleaseLevelBuffer(subd, subd->creases);
+        subd->creases = (cc_Crease *)ccs__AllocateLevelBuffer(subd,
+                                                              sizeof(cc_Crease)
+                                                              * ccs__CreaseStorageCount(subd));
+
+        if (subd->flags & CC_SUBD_FIRST_TOUCH) {
+            ccs__FirstTouchCreases(subd);
+        }
+    }
+}
+
+
+/*******************************************************************************
+ * RecordCageCounts -- Records the cage counts the buffers of a subd rely on
+ *
+ */
+static void ccs__RecordCageCounts(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+
+    subd->cageVertexCount = ccm_VertexCount(cage);
+    subd->cageHalfedgeCount = ccm_HalfedgeCount(cage);
+    subd->cageEdgeCount = ccm_EdgeCount(cage);
+    subd->cageFaceCount = ccm_FaceCount(cage);
+    subd->cageCreaseCount = ccm_CreaseCount(cage);
+}
+
+
+/*******************************************************************************
+ * IsIndexable -- Checks that the counts of a subd are representable by cc_Index
+ *
+ * The check is done in floating point on the terms of the cumulative count
+ * formulas, including their intermediate products, so that it cannot
+ * overflow itself.
+ *
+ */
+static bool ccs__IsIndexable(const cc_Mesh *cage, int32_t maxDepth)
+{
+    const double H0 = ccm_HalfedgeCount(cage);
+    const double E1 = 2.0 * ccm_EdgeCount(cage) + H0;
+    const double V1 = (double)ccm_VertexCount(cage) + ccm_EdgeCount(cage) + ccm_FaceCount(cage);
+    double A = 1.0, B = 1.0; // 2^D and 4^D
+    double edgeCount, halfedgeCount, vertexCount;
+
+    for (int32_t depth = 0; depth < maxDepth; ++depth) {
+        A*= 2.0;
+        B*= 4.0;
+    }
+
+    halfedgeCount = 4.0 * H0 * B;
+    edgeCount = A * (6.0 * E1 + A * 4.0 * H0);
+    vertexCount = A * (E1 + 2.0 * H0) + B * H0 + maxDepth * (H0 + E1 + V1);
+
+    return halfedgeCount < (double)CC_INDEX_MAX
+        && edgeCount < (double)CC_INDEX_MAX
+        && vertexCount < (double)CC_INDEX_MAX;
+}
+
+
 /*******************************************************************************
  * Create -- Create a subd
  *
  */
-CCDEF cc_Subd *ccs_Create(const cc_Mesh *cage, int32_t maxDepth)
+CCDEF cc_Subd *
+ccs_CreateWithFlags(const cc_Mesh *cage, int32_t maxDepth, uint32_t flags)
 {
-    const int32_t halfedgeCount = ccs_CumulativeHalfedgeCountAtDepth(cage, maxDepth);
-    const int32_t creaseCount = ccs_CumulativeCreaseCountAtDepth(cage, maxDepth);
-    const int32_t vertexCount = ccs_CumulativeVertexCountAtDepth(cage, maxDepth);
+    if (!ccs__IsIndexable(cage, maxDepth)) {
+        CC_LOG("cc: subd too large for cc_Index (see CC_INDEX64)");
+
+        return NULL;
+    }
+
+    const cc_Index halfedgeCount = ccs__LevelStorageCount(cage,
+                                                         maxDepth,
+                                                         flags,
+                                                         &ccm_HalfedgeCountAtDepth,
+                                                         &ccs_CumulativeHalfedgeCountAtDepth);
+    const cc_Index vertexCount = ccs__LevelStorageCount(cage,
+                                                       maxDepth,
+                                                       flags,
+                                                       &ccm_VertexCountAtDepth,
+                                                       &ccs_CumulativeVertexCountAtDepth);
     const size_t halfedgeByteCount = halfedgeCount * sizeof(cc_Halfedge_SemiRegular);
-    const size_t creaseByteCount = creaseCount * sizeof(cc_Crease);
     const size_t vertexPointByteCount = vertexCount * sizeof(cc_VertexPoint);
+    const size_t boundaryHalfedgeByteCount =
+        ccs__BoundaryHalfedgeStride(ccs__CageBoundaryHalfedgeCount(cage), maxDepth + 1)
+        * sizeof(cc_Index);
+    const size_t sharpnessByteCount = (maxDepth + 1) * sizeof(cc_Real);
     cc_Subd *subd = (cc_Subd *)CC_MALLOC(sizeof(*subd));
 
     subd->maxDepth = maxDepth;
-    subd->halfedges = (cc_Halfedge_SemiRegular *)CC_MALLOC(halfedgeByteCount);
-    subd->creases = (cc_Crease *)CC_MALLOC(creaseByteCount);
-    subd->vertexPoints = (cc_VertexPoint *)CC_MALLOC(vertexPointByteCount);
+    subd->flags = flags;
+    subd->halfedges =
+        (cc_Halfedge_SemiRegular *)ccs__AllocateLevelBuffer(subd, halfedgeByteCount);
+    subd->vertexPoints = (cc_VertexPoint *)ccs__AllocateLevelBuffer(subd, vertexPointByteCount);
+    subd->vertexToHalfedgeIDs = NULL;
+    subd->edgeToHalfedgeIDs = NULL;
+    subd->cageRingOffsets = NULL;
+    subd->cageRingHalfedgeIDs = NULL;
+    subd->vertexValences = NULL;
+    subd->vertexClassIDs = NULL;
+    subd->regularVertexCounts = NULL;
+    subd->boundaryHalfedgeCount = ccs__CageBoundaryHalfedgeCount(cage);
+    subd->boundaryHalfedgeIDs = (cc_Index *)CC_MALLOC(boundaryHalfedgeByteCount);
+    subd->maxCreaseSharpness = (cc_Real *)CC_MALLOC(sharpnessByteCount);
+    subd->minBoundarySharpness = (cc_Real *)CC_MALLOC(sharpnessByteCount);
+    subd->creaseBits = NULL;
+    subd->creaseRanks = NULL;
+    subd->creaseEdgeIDs = NULL;
+    subd->creaseEdgeCount = 0;
     subd->cage = cage;
+    subd->topologyFingerprint = 0;
+    ccs__RecordCageCounts(subd);
+    subd->parallelGrain = CC_PARALLEL_GRAIN;
+    subd->mappedData = NULL;
+    subd->mappedByteCount = 0;
+
+    if ((flags & CC_SUBD_SPARSE_CREASES) && ccm_CreaseCount(cage) > 0) {
+        const cc_Index wordCount = ccs__CreaseWordCount(cage);
+
+        subd->creaseBits = (uint64_t *)CC_MALLOC(sizeof(uint64_t) * wordCount);
+        subd->creaseRanks = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * wordCount);
+        subd->creaseEdgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * ccm_CreaseCount(cage));
+        ccs__BuildCreaseIndex(subd);
+    }
+
+    subd->creases = (cc_Crease *)ccs__AllocateLevelBuffer(subd,
+                                                          sizeof(cc_Crease)
+                                                          * ccs__CreaseStorageCount(subd));
+
+    // creased kernels until the crease refinement says otherwise
+    for (int32_t depth = 0; depth <= maxDepth; ++depth) {
+        subd->maxCreaseSharpness[depth] = 1.0f;
+        subd->minBoundarySharpness[depth] = 0.0f;
+    }
+
+    if (flags & CC_SUBD_HALFEDGE_MAPPINGS) {
+        const cc_Index edgeCount = ccs__LevelStorageCount(cage,
+                                                          maxDepth,
+                                                          flags,
+                                                          &ccm_EdgeCountAtDepth,
+                                                          &ccs_CumulativeEdgeCountAtDepth);
+
+        subd->vertexToHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * vertexCount);
+        subd->edgeToHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * edgeCount);
+    }
+
+    if (flags & CC_SUBD_VERTEX_RINGS) {
+        const cc_Index cageVertexCount = ccm_VertexCount(cage);
+        const cc_Index cageHalfedgeCount = ccm_HalfedgeCount(cage);
+
+        subd->cageRingOffsets = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * (cageVertexCount + 1));
+        subd->cageRingHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * cageHalfedgeCount);
+        subd->vertexValences = (int32_t *)CC_MALLOC(sizeof(int32_t) * vertexCount);
+    }
+
+    if (flags & CC_SUBD_VERTEX_CLASSES) {
+        subd->vertexClassIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * vertexCount);
+        subd->regularVertexCounts = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * (maxDepth + 1));
+        CC_MEMSET(subd->regularVertexCounts, 0, sizeof(cc_Index) * (maxDepth + 1));
+    }
+
+    if (flags & CC_SUBD_FIRST_TOUCH) {
+        ccs__FirstTouch(subd);
+    }
 
     return subd;
 }
 
+CCDEF cc_Subd *ccs_Create(const cc_Mesh *cage, int32_t maxDepth)
+{
+    return ccs_CreateWithFlags(cage, maxDepth, CC_SUBD_DEFAULT);
+}
+
 
 /*******************************************************************************
  * Release -- Releases memory used for a given subd
  *
+ * The arrays of a subd loaded with ccs_Load may point into the file mapping,
+ * which is unmapped as a whole.
+ *
  */
+static void ccs__ReleaseArray(const cc_Subd *subd, void *array)
+{
+    if (!ccs__IsMapped(subd, array)) {
+        CC_FREE(array);
+    }
+}
+
 CCDEF void ccs_Release(cc_Subd *subd)
 {
-    CC_FREE(subd->halfedges);
-    CC_FREE(subd->creases);
-    CC_FREE(subd->vertexPoints);
+    ccs__ReleaseLevelBuffer(subd, subd->halfedges);
+    ccs__ReleaseLevelBuffer(subd, subd->creases);
+    ccs__ReleaseLevelBuffer(subd, subd->vertexPoints);
+    ccs__ReleaseArray(subd, subd->boundaryHalfedgeIDs);
+    ccs__ReleaseArray(subd, subd->maxCreaseSharpness);
+    ccs__ReleaseArray(subd, subd->minBoundarySharpness);
+    if (subd->vertexToHalfedgeIDs != NULL) {
+        ccs__ReleaseArray(subd, subd->vertexToHalfedgeIDs);
+        ccs__ReleaseArray(subd, subd->edgeToHalfedgeIDs);
+    }
+    if (subd->vertexValences != NULL) {
+        ccs__ReleaseArray(subd, subd->cageRingOffsets);
+        ccs__ReleaseArray(subd, subd->cageRingHalfedgeIDs);
+        ccs__ReleaseArray(subd, subd->vertexValences);
+    }
+    if (subd->vertexClassIDs != NULL) {
+        ccs__ReleaseArray(subd, subd->vertexClassIDs);
+        ccs__ReleaseArray(subd, subd->regularVertexCounts);
+    }
+    if (subd->creaseBits != NULL) {
+        CC_FREE(subd->creaseBits);
+        CC_FREE(subd->creaseRanks);
+        CC_FREE(subd->creaseEdgeIDs);
+    }
+#ifdef CC__MAPPED_FILES
+    if (subd->mappedData != NULL) {
+        munmap(subd->mappedData, subd->mappedByteCount);
+    }
+#endif
     CC_FREE(subd);
 }
 
@@ -1012,25 +2366,34 @@ CCDEF void ccs_Release(cc_Subd *subd)
  *
  */
 static const cc_Crease *
-ccs__Crease(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+ccs__Crease(const cc_Subd *subd, cc_Index edgeID, int32_t depth)
 {
     CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
-    const int32_t stride = ccs_CumulativeCreaseCountAtDepth(subd->cage,
-                                                            depth - 1);
+    const cc_Index stride = ccs__CreaseStride(subd, depth);
+
+    if (subd->creaseBits != NULL) {
+        return ccs__FindCrease(&subd->creases[stride],
+                               subd->creaseBits,
+                               subd->creaseRanks,
+                               edgeID,
+                               depth);
+    }
 
     return &subd->creases[stride + edgeID];
 }
 
-CCDEF double
-ccs_CreaseSharpness_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+CCDEF cc_Real
+ccs_CreaseSharpness_Fast(const cc_Subd *subd, cc_Index edgeID, int32_t depth)
 {
-    return ccs__Crease(subd, edgeID, depth)->sharpness;
+    const cc_Crease *crease = ccs__Crease(subd, edgeID, depth);
+
+    return crease != NULL ? crease->sharpness : 0.0f;
 }
 
-CCDEF double
-ccs_CreaseSharpness(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+CCDEF cc_Real
+ccs_CreaseSharpness(const cc_Subd *subd, cc_Index edgeID, int32_t depth)
 {
-    const int32_t creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
+    const cc_Index creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
 
     if (edgeID < creaseCount) {
         return ccs_CreaseSharpness_Fast(subd, edgeID, depth);
@@ -1039,16 +2402,18 @@ ccs_CreaseSharpness(const cc_Subd *subd, int32_t edgeID, int32_t depth)
     }
 }
 
-CCDEF int32_t
-ccs_CreaseNextID_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+CCDEF cc_Index
+ccs_CreaseNextID_Fast(const cc_Subd *subd, cc_Index edgeID, int32_t depth)
 {
-    return ccs__Crease(subd, edgeID, depth)->nextID;
+    const cc_Crease *crease = ccs__Crease(subd, edgeID, depth);
+
+    return crease != NULL ? crease->nextID : ccs__SmoothCreaseNextID(edgeID, depth);
 }
 
-CCDEF int32_t
-ccs_CreaseNextID(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+CCDEF cc_Index
+ccs_CreaseNextID(const cc_Subd *subd, cc_Index edgeID, int32_t depth)
 {
-    const int32_t creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
+    const cc_Index creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
 
     if (edgeID < creaseCount) {
         return ccs_CreaseNextID_Fast(subd, edgeID, depth);
@@ -1057,16 +2422,18 @@ ccs_CreaseNextID(const cc_Subd *subd, int32_t edgeID, int32_t depth)
     }
 }
 
-CCDEF int32_t
-ccs_CreasePrevID_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+CCDEF cc_Index
+ccs_CreasePrevID_Fast(const cc_Subd *subd, cc_Index edgeID, int32_t depth)
 {
-    return ccs__Crease(subd, edgeID, depth)->prevID;
+    const cc_Crease *crease = ccs__Crease(subd, edgeID, depth);
+
+    return crease != NULL ? crease->prevID : ccs__SmoothCreasePrevID(edgeID, depth);
 }
 
-CCDEF int32_t
-ccs_CreasePrevID(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+CCDEF cc_Index
+ccs_CreasePrevID(const cc_Subd *subd, cc_Index edgeID, int32_t depth)
 {
-    const int32_t creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
+    const cc_Index creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
 
     if (edgeID < creaseCount) {
         return ccs_CreasePrevID_Fast(subd, edgeID, depth);
@@ -1081,29 +2448,28 @@ ccs_CreasePrevID(const cc_Subd *subd, int32_t edgeID, int32_t depth)
  *
  */
 static const cc_Halfedge_SemiRegular *
-ccs__Halfedge(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+ccs__Halfedge(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
     CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
-    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(subd->cage,
-                                                              depth - 1);
+    const cc_Index stride = ccs__HalfedgeStride(subd, depth);
 
     return &subd->halfedges[stride + halfedgeID];
 }
 
-CCDEF int32_t
-ccs_HalfedgeVertexID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+CCDEF cc_Index
+ccs_HalfedgeVertexID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
     return ccs__Halfedge(subd, halfedgeID, depth)->vertexID;
 }
 
-CCDEF int32_t
-ccs_HalfedgeTwinID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+CCDEF cc_Index
+ccs_HalfedgeTwinID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
     return ccs__Halfedge(subd, halfedgeID, depth)->twinID;
 }
 
-CCDEF int32_t
-ccs_HalfedgeNextID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+CCDEF cc_Index
+ccs_HalfedgeNextID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
     (void)subd;
     (void)depth;
@@ -1111,8 +2477,8 @@ ccs_HalfedgeNextID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
     return ccm_HalfedgeNextID_Quad(halfedgeID);
 }
 
-CCDEF int32_t
-ccs_HalfedgePrevID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+CCDEF cc_Index
+ccs_HalfedgePrevID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
     (void)subd;
     (void)depth;
@@ -1120,8 +2486,8 @@ ccs_HalfedgePrevID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
     return ccm_HalfedgePrevID_Quad(halfedgeID);
 }
 
-CCDEF int32_t
-ccs_HalfedgeFaceID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+CCDEF cc_Index
+ccs_HalfedgeFaceID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
     (void)subd;
     (void)depth;
@@ -1129,37 +2495,37 @@ ccs_HalfedgeFaceID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
     return ccm_HalfedgeFaceID_Quad(halfedgeID);
 }
 
-CCDEF int32_t
-ccs_HalfedgeEdgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+CCDEF cc_Index
+ccs_HalfedgeEdgeID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
     return ccs__Halfedge(subd, halfedgeID, depth)->edgeID;
 }
 
-CCDEF double
-ccs_HalfedgeSharpness(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+CCDEF cc_Real
+ccs_HalfedgeSharpness(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
-    const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+    const cc_Index edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
 
     return ccs_CreaseSharpness(subd, edgeID, depth);
 }
 
 CCDEF cc_VertexPoint
-ccs_HalfedgeVertexPoint(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+ccs_HalfedgeVertexPoint(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
-    const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
+    const cc_Index vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
 
     return ccs_VertexPoint(subd, vertexID, depth);
 }
 
 #ifndef CC_DISABLE_UV
 static uint32_t
-ccs__HalfedgeVertexUvID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+ccs__HalfedgeVertexUvID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
     return ccs__Halfedge(subd, halfedgeID, depth)->uvID;
 }
 
 CCDEF cc_VertexUv
-ccs_HalfedgeVertexUv(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+ccs_HalfedgeVertexUv(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
     return cc__DecodeUv(ccs__HalfedgeVertexUvID(subd, halfedgeID, depth));
 }
@@ -1171,10 +2537,10 @@ ccs_HalfedgeVertexUv(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
  *
  */
 CCDEF cc_VertexPoint
-ccs_VertexPoint(const cc_Subd *subd, int32_t vertexID, int32_t depth)
+ccs_VertexPoint(const cc_Subd *subd, cc_Index vertexID, int32_t depth)
 {
     CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(subd->cage, depth - 1);
+    const cc_Index stride = ccs__VertexStride(subd, depth);
 
     return subd->vertexPoints[stride + vertexID];
 }
@@ -1184,18 +2550,18 @@ ccs_VertexPoint(const cc_Subd *subd, int32_t vertexID, int32_t depth)
  * Vertex halfedge iteration
  *
  */
-CCDEF int32_t
-ccs_PrevVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+CCDEF cc_Index
+ccs_PrevVertexHalfedgeID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
-    const int32_t prevID = ccs_HalfedgePrevID(subd, halfedgeID, depth);
+    const cc_Index prevID = ccs_HalfedgePrevID(subd, halfedgeID, depth);
 
     return ccs_HalfedgeTwinID(subd, prevID, depth);
 }
 
-CCDEF int32_t
-ccs_NextVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+CCDEF cc_Index
+ccs_NextVertexHalfedgeID(const cc_Subd *subd, cc_Index halfedgeID, int32_t depth)
 {
-    const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+    const cc_Index twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
 
     return ccs_HalfedgeNextID(subd, twinID, depth);
 }
@@ -1205,8 +2571,8 @@ ccs_NextVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
  * Face to Halfedge Mapping
  *
  */
-CCDEF int32_t
-ccs_FaceToHalfedgeID(const cc_Subd *subd, int32_t faceID, int32_t depth)
+CCDEF cc_Index
+ccs_FaceToHalfedgeID(const cc_Subd *subd, cc_Index faceID, int32_t depth)
 {
     (void)subd;
     (void)depth;
@@ -1222,74 +2588,74 @@ ccs_FaceToHalfedgeID(const cc_Subd *subd, int32_t faceID, int32_t depth)
  * the edge. This routine has O(depth) complexity.
  *
  */
-static int32_t ccs__EdgeToHalfedgeID_First(const cc_Mesh *cage, int32_t edgeID)
+static cc_Index ccs__EdgeToHalfedgeID_First(const cc_Mesh *cage, cc_Index edgeID)
 {
-    const int32_t edgeCount = ccm_EdgeCount(cage);
+    const cc_Index edgeCount = ccm_EdgeCount(cage);
 
     if /* [2E, 2E + H) */ (edgeID >= 2 * edgeCount) {
-        const int32_t halfedgeID = edgeID - 2 * edgeCount;
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        const cc_Index halfedgeID = edgeID - 2 * edgeCount;
+        const cc_Index nextID = ccm_HalfedgeNextID(cage, halfedgeID);
 
         return cc__Max(4 * halfedgeID + 1, 4 * nextID + 2);
 
     } else if /* */ ((edgeID & 1) == 1) {
-        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID >> 1);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        const cc_Index halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID >> 1);
+        const cc_Index nextID = ccm_HalfedgeNextID(cage, halfedgeID);
 
         return 4 * nextID + 3;
 
     } else /* */ {
-        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID >> 1);
+        const cc_Index halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID >> 1);
 
         return 4 * halfedgeID + 0;
     }
 }
 
-CCDEF int32_t
-ccs_EdgeToHalfedgeID(
-    const cc_Subd *subd,
-    int32_t edgeID,
+static cc_Index
+ccs__EdgeToHalfedgeID(
+    const cc_Mesh *cage,
+    cc_Index edgeID,
     int32_t depth
 ) {
 #if 0 // recursive version
     if (depth > 1) {
-        int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(subd->cage, depth - 1);
+        cc_Index edgeCount = ccm_EdgeCountAtDepth_Fast(cage, depth - 1);
 
         if /* [2E, 2E + H) */ (edgeID >= 2 * edgeCount) {
-            int32_t halfedgeID = edgeID - 2 * edgeCount;
-            int32_t nextID = ccm_NextFaceHalfedgeID_Quad(halfedgeID);
+            cc_Index halfedgeID = edgeID - 2 * edgeCount;
+            cc_Index nextID = ccm_NextFaceHalfedgeID_Quad(halfedgeID);
 
             return cc__Max(4 * halfedgeID + 1, 4 * nextID + 2);
 
         } else if /* [E, 2E) */ (edgeID >= edgeCount) {
-            int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd,
-                                                      edgeID >> 1,
-                                                      depth - 1);
-            int32_t nextID = ccm_NextFaceHalfedgeID_Quad(halfedgeID);
+            cc_Index halfedgeID = ccs__EdgeToHalfedgeID(cage,
+                                                       edgeID >> 1,
+                                                       depth - 1);
+            cc_Index nextID = ccm_NextFaceHalfedgeID_Quad(halfedgeID);
 
             return 4 * nextID + 3;
 
         } else /* [0, E) */ {
-            int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID >> 1, depth - 1);
+            cc_Index halfedgeID = ccs__EdgeToHalfedgeID(cage, edgeID >> 1, depth - 1);
 
             return 4 * halfedgeID + 0;
         }
     } else {
-        return ccs__EdgeToHalfedgeID_First(subd->cage, edgeID);
+        return ccs__EdgeToHalfedgeID_First(cage, edgeID);
     }
 #else // non-recursive version
     uint32_t heap = 1u;
-    int32_t edgeHalfedgeID = 0;
+    cc_Index edgeHalfedgeID = 0;
     int32_t heapDepth = depth;
 
     // build heap
     for (; heapDepth > 1; --heapDepth) {
-        const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(subd->cage,
+        const cc_Index edgeCount = ccm_EdgeCountAtDepth_Fast(cage,
                                                             heapDepth - 1);
 
         if /* [2E, 2E + H) */ (edgeID >= 2 * edgeCount) {
-            const int32_t halfedgeID = edgeID - 2 * edgeCount;
-            const int32_t nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+            const cc_Index halfedgeID = edgeID - 2 * edgeCount;
+            const cc_Index nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
 
             edgeHalfedgeID = cc__Max(4 * halfedgeID + 1, 4 * nextID + 2);
             break;
@@ -1301,13 +2667,13 @@ ccs_EdgeToHalfedgeID(
 
     // initialize root cfg
     if (heapDepth == 1) {
-        edgeHalfedgeID = ccs__EdgeToHalfedgeID_First(subd->cage, edgeID);
+        edgeHalfedgeID = ccs__EdgeToHalfedgeID_First(cage, edgeID);
     }
 
     // read heap
     while (heap > 1u) {
         if ((heap & 1u) == 1u) {
-            const int32_t nextID = ccm_HalfedgeNextID_Quad(edgeHalfedgeID);
+            const cc_Index nextID = ccm_HalfedgeNextID_Quad(edgeHalfedgeID);
 
             edgeHalfedgeID = 4 * nextID + 3;
         } else {
@@ -1321,6 +2687,12 @@ ccs_EdgeToHalfedgeID(
 #endif
 }
 
+CCDEF cc_Index
+ccs_EdgeToHalfedgeID(const cc_Subd *subd, cc_Index edgeID, int32_t depth)
+{
+    return ccs__EdgeToHalfedgeID(subd->cage, edgeID, depth);
+}
+
 
 /*******************************************************************************
  * Vertex to Halfedge Mapping
@@ -1329,19 +2701,19 @@ ccs_EdgeToHalfedgeID(
  * given vertex. This routine has O(depth) complexity.
  *
  */
-static int32_t
-ccs__VertexToHalfedgeID_First(const cc_Mesh *cage, int32_t vertexID)
+static cc_Index
+ccs__VertexToHalfedgeID_First(const cc_Mesh *cage, cc_Index vertexID)
 {
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index faceCount = ccm_FaceCount(cage);
 
     if /* [V + F, V + F + E) */ (vertexID >= vertexCount + faceCount) {
-        const int32_t edgeID = vertexID - vertexCount - faceCount;
+        const cc_Index edgeID = vertexID - vertexCount - faceCount;
 
         return 4 * ccm_EdgeToHalfedgeID(cage, edgeID) + 1;
 
     } else if /* [V, V + F) */ (vertexID >= vertexCount) {
-        const int32_t faceID = vertexID - vertexCount;
+        const cc_Index faceID = vertexID - vertexCount;
 
         return 4 * ccm_FaceToHalfedgeID(cage, faceID) + 2;
 
@@ -1351,51 +2723,49 @@ ccs__VertexToHalfedgeID_First(const cc_Mesh *cage, int32_t vertexID)
     }
 }
 
-CCDEF int32_t
-ccs_VertexPointToHalfedgeID(const cc_Subd *subd, int32_t vertexID, int32_t depth)
+static cc_Index
+ccs__VertexPointToHalfedgeID(const cc_Mesh *cage, cc_Index vertexID, int32_t depth)
 {
 #if 0 // recursive version
     if (depth > 1) {
-        const cc_Mesh *cage = subd->cage;
-        const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth - 1);
-        const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth - 1);
+        const cc_Index vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth - 1);
+        const cc_Index faceCount = ccm_FaceCountAtDepth_Fast(cage, depth - 1);
 
         if /* [V + F, V + F + E) */ (vertexID >= vertexCount + faceCount) {
-            const int32_t edgeID = vertexID - vertexCount - faceCount;
+            const cc_Index edgeID = vertexID - vertexCount - faceCount;
 
-            return 4 * ccs_EdgeToHalfedgeID(subd, edgeID, depth - 1) + 1;
+            return 4 * ccs__EdgeToHalfedgeID(cage, edgeID, depth - 1) + 1;
 
         } else if /* [V, V + F) */ (vertexID >= vertexCount) {
-            const int32_t faceID = vertexID - vertexCount;
+            const cc_Index faceID = vertexID - vertexCount;
 
             return 4 * ccm_FaceToHalfedgeID_Quad(faceID) + 2;
 
         } else /* [0, V) */ {
 
-            return 4 * ccs_VertexPointToHalfedgeID(subd, vertexID, depth - 1) + 0;
+            return 4 * ccs__VertexPointToHalfedgeID(cage, vertexID, depth - 1) + 0;
         }
     } else {
 
-        return ccs__VertexToHalfedgeID_First(subd->cage, vertexID);
+        return ccs__VertexToHalfedgeID_First(cage, vertexID);
     }
 #else // non-recursive version
-    const cc_Mesh *cage = subd->cage;
     int32_t heapDepth = depth;
-    int32_t stride = 0;
-    int32_t halfedgeID;
+    cc_Index stride = 0;
+    cc_Index halfedgeID = -1;
 
     // build heap
     for (; heapDepth > 1; --heapDepth) {
-        const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, heapDepth - 1);
-        const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, heapDepth - 1);
+        const cc_Index vertexCount = ccm_VertexCountAtDepth_Fast(cage, heapDepth - 1);
+        const cc_Index faceCount = ccm_FaceCountAtDepth_Fast(cage, heapDepth - 1);
 
         if /* [V + F, V + F + E) */ (vertexID >= vertexCount + faceCount) {
-            const int32_t edgeID = vertexID - faceCount - vertexCount;
+            const cc_Index edgeID = vertexID - faceCount - vertexCount;
 
-            halfedgeID = 4 * ccs_EdgeToHalfedgeID(subd, edgeID, heapDepth - 1) + 1;
+            halfedgeID = 4 * ccs__EdgeToHalfedgeID(cage, edgeID, heapDepth - 1) + 1;
             break;
         } else if /* [V, V + F) */ (vertexID >= vertexCount) {
-            const int32_t faceID = vertexID - vertexCount;
+            const cc_Index faceID = vertexID - vertexCount;
 
             halfedgeID = 4 * ccm_FaceToHalfedgeID_Quad(faceID) + 2;
             break;
@@ -1406,611 +2776,650 @@ ccs_VertexPointToHalfedgeID(const cc_Subd *subd, int32_t vertexID, int32_t depth
 
     // initialize root cfg
     if (heapDepth == 1) {
-        halfedgeID = ccs__VertexToHalfedgeID_First(subd->cage, vertexID);
+        halfedgeID = ccs__VertexToHalfedgeID_First(cage, vertexID);
     }
 
     return halfedgeID << stride;
 #endif
 }
 
+CCDEF cc_Index
+ccs_VertexPointToHalfedgeID(const cc_Subd *subd, cc_Index vertexID, int32_t depth)
+{
+    return ccs__VertexPointToHalfedgeID(subd->cage, vertexID, depth);
+}
+
 
 /*******************************************************************************
- * CageFacePoints -- Applies Catmull Clark's face rule on the cage mesh
- *
- * The "Gather" routine iterates over each face of the mesh and compute the
- * resulting face vertex.
+ * Level -- Creates a view over the data of a given subd depth
  *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the face vertex.
+ * The view stores the base pointers and element counts of the requested
+ * depth so that the ccl_* accessors can skip the cumulative count
+ * computations performed by their ccs_* counterparts. The view remains
+ * valid as long as the subd is alive.
  *
  */
-static void ccs__CageFacePoints_Gather(cc_Subd *subd)
+CCDEF cc_SubdLevel ccs_Level(const cc_Subd *subd, int32_t depth)
 {
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    const cc_Index halfedgeStride = ccs__HalfedgeStride(subd, depth);
+    const cc_Index creaseStride = ccs__CreaseStride(subd, depth);
+    const cc_Index vertexStride = ccs__VertexStride(subd, depth);
+    cc_SubdLevel level;
+
+    level.cage = cage;
+    level.vertexPoints = &subd->vertexPoints[vertexStride];
+    level.halfedges = &subd->halfedges[halfedgeStride];
+    level.creases = &subd->creases[creaseStride];
+    level.vertexToHalfedgeIDs = NULL;
+    level.edgeToHalfedgeIDs = NULL;
+    level.vertexValences = NULL;
+    level.vertexClassIDs = NULL;
+    level.regularVertexCount = 0;
+    level.boundaryHalfedgeIDs = &subd->boundaryHalfedgeIDs[
+        ccs__BoundaryHalfedgeStride(subd->boundaryHalfedgeCount, depth)
+    ];
+    level.boundaryHalfedgeCount = subd->boundaryHalfedgeCount << depth;
+    level.creaseBits = subd->creaseBits;
+    level.creaseRanks = subd->creaseRanks;
+    level.depth = depth;
+    level.vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    level.halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+    level.edgeCount = ccm_EdgeCountAtDepth_Fast(cage, depth);
+    level.faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    level.creaseCount = ccm_CreaseCountAtDepth(cage, depth);
+
+    if (subd->vertexToHalfedgeIDs != NULL) {
+        level.vertexToHalfedgeIDs = &subd->vertexToHalfedgeIDs[vertexStride];
+        level.edgeToHalfedgeIDs = &subd->edgeToHalfedgeIDs[ccs__EdgeStride(subd, depth)];
+    }
 
-CC_PARALLEL_FOR
-    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
-        const int32_t halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
-        cc_VertexPoint newFacePoint = ccm_HalfedgeVertexPoint(cage, halfedgeID);
-        double faceVertexCount = 1.0f;
+    if (subd->vertexValences != NULL) {
+        level.vertexValences = &subd->vertexValences[vertexStride];
+    }
 
-        for (int32_t halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
-                     halfedgeIt != halfedgeID;
-                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
-            const cc_VertexPoint vertexPoint = ccm_HalfedgeVertexPoint(cage, halfedgeIt);
+    if (subd->vertexClassIDs != NULL) {
+        level.vertexClassIDs = &subd->vertexClassIDs[vertexStride];
+        level.regularVertexCount = subd->regularVertexCounts[depth];
+    }
 
-            cc__Add3f(newFacePoint.array, newFacePoint.array, vertexPoint.array);
-            ++faceVertexCount;
-        }
+    return level;
+}
 
-        cc__Mul3f(newFacePoint.array, newFacePoint.array, 1.0f / faceVertexCount);
 
-        newFacePoints[faceID] = newFacePoint;
-    }
-CC_BARRIER
+/*******************************************************************************
+ * Level queries
+ *
+ */
+CCDEF int32_t ccl_Depth(const cc_SubdLevel *level)
+{
+    return level->depth;
 }
 
-static void ccs__CageFacePoints_Scatter(cc_Subd *subd)
+CCDEF cc_Index ccl_VertexCount(const cc_SubdLevel *level)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    return level->vertexCount;
+}
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const cc_VertexPoint vertexPoint = ccm_HalfedgeVertexPoint(cage, halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        double faceVertexCount = 1.0f;
-        double *newFacePoint = newFacePoints[faceID].array;
+CCDEF cc_Index ccl_HalfedgeCount(const cc_SubdLevel *level)
+{
+    return level->halfedgeCount;
+}
 
-        for (int32_t halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
-                     halfedgeIt != halfedgeID;
-                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
-            ++faceVertexCount;
-        }
+CCDEF cc_Index ccl_EdgeCount(const cc_SubdLevel *level)
+{
+    return level->edgeCount;
+}
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newFacePoint[i]+= vertexPoint.array[i] / (double)faceVertexCount;
-        }
-    }
-CC_BARRIER
+CCDEF cc_Index ccl_FaceCount(const cc_SubdLevel *level)
+{
+    return level->faceCount;
+}
+
+CCDEF cc_Index ccl_CreaseCount(const cc_SubdLevel *level)
+{
+    return level->creaseCount;
 }
 
 
 /*******************************************************************************
- * CageEdgePoints -- Applies Catmull Clark's edge rule on the cage mesh
- *
- * The "Gather" routine iterates over each edge of the mesh and computes the
- * resulting edge vertex.
- *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the edge vertex.
+ * Level crease data accessors
  *
  */
-static void ccs__CageEdgePoints_Gather(cc_Subd *subd)
+static const cc_Crease *ccl__Crease(const cc_SubdLevel *level, cc_Index edgeID)
+{
+    if (level->creaseBits != NULL) {
+        return ccs__FindCrease(level->creases,
+                               level->creaseBits,
+                               level->creaseRanks,
+                               edgeID,
+                               level->depth);
+    }
+
+    return &level->creases[edgeID];
+}
+
+CCDEF cc_Real ccl_CreaseSharpness_Fast(const cc_SubdLevel *level, cc_Index edgeID)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t edgeCount = ccm_EdgeCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    const cc_Crease *crease = ccl__Crease(level, edgeID);
 
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
-        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const double edgeWeight = twinID < 0 ? 0.0f : 1.0f;
-        const cc_VertexPoint oldEdgePoints[2] = {
-            ccm_HalfedgeVertexPoint(cage, halfedgeID),
-            ccm_HalfedgeVertexPoint(cage,     nextID)
-        };
-        const cc_VertexPoint newFacePointPair[2] = {
-            newFacePoints[ccm_HalfedgeFaceID(cage, halfedgeID)],
-            newFacePoints[ccm_HalfedgeFaceID(cage, cc__Max(0, twinID))]
-        };
-        double *newEdgePoint = newEdgePoints[edgeID].array;
-        cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
-        double tmp1[3], tmp2[3];
+    return crease != NULL ? crease->sharpness : 0.0f;
+}
 
-        cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
-        cc__Add3f(tmp2, newFacePointPair[0].array, newFacePointPair[1].array);
-        cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
-        cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
-        cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
-        cc__Lerp3f(newEdgePoint,
-                   sharpEdgePoint.array,
-                   smoothEdgePoint.array,
-                   edgeWeight);
+CCDEF cc_Real ccl_CreaseSharpness(const cc_SubdLevel *level, cc_Index edgeID)
+{
+    if (edgeID < ccl_CreaseCount(level)) {
+        return ccl_CreaseSharpness_Fast(level, edgeID);
+    } else {
+        return 0.0f;
     }
-CC_BARRIER
 }
 
-static void ccs__CageEdgePoints_Scatter(cc_Subd *subd)
+CCDEF cc_Index ccl_CreaseNextID_Fast(const cc_SubdLevel *level, cc_Index edgeID)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    const cc_Crease *crease = ccl__Crease(level, edgeID);
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        double tmp1[3], tmp2[3], tmp3[3], tmp4[3], atomicWeight[3];
-        double weight = twinID >= 0 ? 0.5f : 1.0f;
+    return crease != NULL ? crease->nextID : ccs__SmoothCreaseNextID(edgeID, level->depth);
+}
 
-        cc__Mul3f(tmp1, newFacePoint.array, 0.5f);
-        cc__Mul3f(tmp2, ccm_HalfedgeVertexPoint(cage, halfedgeID).array, weight);
-        cc__Mul3f(tmp3, ccm_HalfedgeVertexPoint(cage,     nextID).array, weight);
-        cc__Lerp3f(tmp4, tmp2, tmp3, 0.5f);
-        cc__Lerp3f(atomicWeight, tmp1, tmp4, weight);
+CCDEF cc_Index ccl_CreaseNextID(const cc_SubdLevel *level, cc_Index edgeID)
+{
+    if (edgeID < ccl_CreaseCount(level)) {
+        return ccl_CreaseNextID_Fast(level, edgeID);
+    } else {
+        return edgeID;
+    }
+}
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
-        }
+CCDEF cc_Index ccl_CreasePrevID_Fast(const cc_SubdLevel *level, cc_Index edgeID)
+{
+    const cc_Crease *crease = ccl__Crease(level, edgeID);
+
+    return crease != NULL ? crease->prevID : ccs__SmoothCreasePrevID(edgeID, level->depth);
+}
+
+CCDEF cc_Index ccl_CreasePrevID(const cc_SubdLevel *level, cc_Index edgeID)
+{
+    if (edgeID < ccl_CreaseCount(level)) {
+        return ccl_CreasePrevID_Fast(level, edgeID);
+    } else {
+        return edgeID;
     }
-CC_BARRIER
 }
 
 
 /*******************************************************************************
- * CreasedCageEdgePoints -- Applies DeRole et al.'s edge rule on the cage mesh
- *
- * The "Gather" routine iterates over each edge of the mesh and computes the
- * resulting edge vertex.
- *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the edge vertex.
+ * Level halfedge data accessors
  *
  */
-static void ccs__CreasedCageEdgePoints_Gather(cc_Subd *subd)
+static const cc_Halfedge_SemiRegular *
+ccl__Halfedge(const cc_SubdLevel *level, cc_Index halfedgeID)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t edgeCount = ccm_EdgeCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    return &level->halfedges[halfedgeID];
+}
 
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
-        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const double sharp = ccm_CreaseSharpness(cage, edgeID);
-        const double edgeWeight = cc__Satf(sharp);
-        const cc_VertexPoint oldEdgePoints[2] = {
-            ccm_HalfedgeVertexPoint(cage, halfedgeID),
-            ccm_HalfedgeVertexPoint(cage,     nextID)
-        };
-        const cc_VertexPoint newAdjacentFacePoints[2] = {
-            newFacePoints[ccm_HalfedgeFaceID(cage, halfedgeID)],
-            newFacePoints[ccm_HalfedgeFaceID(cage, cc__Max(0, twinID))]
-        };
-        cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
-        double tmp1[3], tmp2[3];
+CCDEF cc_Index ccl_HalfedgeTwinID(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    return ccl__Halfedge(level, halfedgeID)->twinID;
+}
 
-        cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
-        cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
-        cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
-        cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
-        cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
-        cc__Lerp3f(newEdgePoints[edgeID].array,
-                   smoothEdgePoint.array,
-                   sharpEdgePoint.array,
-                   edgeWeight);
-    }
-CC_BARRIER
+CCDEF cc_Index ccl_HalfedgeNextID(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    (void)level;
+
+    return ccm_HalfedgeNextID_Quad(halfedgeID);
 }
 
-static void ccs__CreasedCageEdgePoints_Scatter(cc_Subd *subd)
+CCDEF cc_Index ccl_HalfedgePrevID(const cc_SubdLevel *level, cc_Index halfedgeID)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    (void)level;
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const double sharp = ccm_CreaseSharpness(cage, edgeID);
-        const double edgeWeight = cc__Satf(sharp);
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldEdgePoints[2] = {
-            ccm_HalfedgeVertexPoint(cage, halfedgeID),
-            ccm_HalfedgeVertexPoint(cage,     nextID)
-        };
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint sharpPoint = {0.0f, 0.0f, 0.0f};
-        double tmp[3], atomicWeight[3];
+    return ccm_HalfedgePrevID_Quad(halfedgeID);
+}
 
-        // sharp point
-        cc__Lerp3f(tmp, oldEdgePoints[0].array, oldEdgePoints[1].array, 0.5f);
-        cc__Mul3f(sharpPoint.array, tmp, twinID < 0 ? 1.0f : 0.5f);
+CCDEF cc_Index ccl_HalfedgeFaceID(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    (void)level;
 
-        // smooth point
-        cc__Lerp3f(tmp, oldEdgePoints[0].array, newFacePoint.array, 0.5f);
-        cc__Mul3f(smoothPoint.array, tmp, 0.5f);
+    return ccm_HalfedgeFaceID_Quad(halfedgeID);
+}
 
-        // atomic weight
-        cc__Lerp3f(atomicWeight,
-                   smoothPoint.array,
-                   sharpPoint.array,
-                   edgeWeight);
+CCDEF cc_Index ccl_HalfedgeEdgeID(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    return ccl__Halfedge(level, halfedgeID)->edgeID;
+}
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
-        }
-    }
-CC_BARRIER
+CCDEF cc_Index ccl_HalfedgeVertexID(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    return ccl__Halfedge(level, halfedgeID)->vertexID;
+}
+
+CCDEF cc_Real ccl_HalfedgeSharpness(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    return ccl_CreaseSharpness(level, ccl_HalfedgeEdgeID(level, halfedgeID));
+}
+
+CCDEF cc_VertexPoint
+ccl_HalfedgeVertexPoint(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    return ccl_VertexPoint(level, ccl_HalfedgeVertexID(level, halfedgeID));
+}
+
+#ifndef CC_DISABLE_UV
+static cc_Index
+ccl__HalfedgeVertexUvID(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    return ccl__Halfedge(level, halfedgeID)->uvID;
+}
+
+CCDEF cc_VertexUv
+ccl_HalfedgeVertexUv(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    return cc__DecodeUv(ccl__HalfedgeVertexUvID(level, halfedgeID));
 }
+#endif
 
 
 /*******************************************************************************
- * CageVertexPoints -- Applies Catmull Clark's vertex rule on the cage mesh
- *
- * The "Gather" routine iterates over each vertex of the mesh and computes the
- * resulting smooth vertex.
- *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the smooth vertex.
+ * Level vertex data accessors
  *
  */
-static void ccs__CageVertexPoints_Gather(cc_Subd *subd)
+CCDEF cc_VertexPoint ccl_VertexPoint(const cc_SubdLevel *level, cc_Index vertexID)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+    return level->vertexPoints[vertexID];
+}
 
-CC_PARALLEL_FOR
-    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
-        const int32_t halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldVertexPoint = ccm_VertexPoint(cage, vertexID);
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        double valence = 1.0f;
-        int32_t iterator;
-        double tmp1[3], tmp2[3];
 
-        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
-        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+/*******************************************************************************
+ * Level vertex halfedge iteration
+ *
+ */
+CCDEF cc_Index
+ccl_PrevVertexHalfedgeID(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    const cc_Index prevID = ccl_HalfedgePrevID(level, halfedgeID);
 
-        for (iterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
-             iterator >= 0 && iterator != halfedgeID;
-             iterator = ccm_PrevVertexHalfedgeID(cage, iterator)) {
-            const int32_t edgeID = ccm_HalfedgeEdgeID(cage, iterator);
-            const int32_t faceID = ccm_HalfedgeFaceID(cage, iterator);
-            const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-            const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+    return ccl_HalfedgeTwinID(level, prevID);
+}
 
-            cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
-            cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
-            ++valence;
-        }
+CCDEF cc_Index
+ccl_NextVertexHalfedgeID(const cc_SubdLevel *level, cc_Index halfedgeID)
+{
+    const cc_Index twinID = ccl_HalfedgeTwinID(level, halfedgeID);
 
-        cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
-        cc__Mul3f(tmp2, oldVertexPoint.array, 1.0f - 3.0f / valence);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
-        cc__Lerp3f(newVertexPoints[vertexID].array,
-                   oldVertexPoint.array,
-                   smoothPoint.array,
-                   iterator != halfedgeID ? 0.0f : 1.0f);
-    }
-CC_BARRIER
+    return ccl_HalfedgeNextID(level, twinID);
 }
 
-static void ccs__CageVertexPoints_Scatter(cc_Subd *subd)
+
+/*******************************************************************************
+ * Level (vertex, edge, face) to halfedge mappings
+ *
+ * These are O(1) table lookups if the subd stores the mappings (see
+ * CC_SUBD_HALFEDGE_MAPPINGS), and O(depth) otherwise.
+ *
+ */
+CCDEF cc_Index ccl_FaceToHalfedgeID(const cc_SubdLevel *level, cc_Index faceID)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+    (void)level;
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const cc_VertexPoint oldVertexPoint = ccm_VertexPoint(cage, vertexID);
-        int32_t valence = 1;
-        int32_t forwardIterator, backwardIterator;
+    return ccm_FaceToHalfedgeID_Quad(faceID);
+}
 
-        for (forwardIterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
-             forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccm_PrevVertexHalfedgeID(cage, forwardIterator)) {
-            ++valence;
-        }
+CCDEF cc_Index ccl_EdgeToHalfedgeID(const cc_SubdLevel *level, cc_Index edgeID)
+{
+    if (level->edgeToHalfedgeIDs != NULL) {
+        return level->edgeToHalfedgeIDs[edgeID];
+    }
 
-        for (backwardIterator = ccm_NextVertexHalfedgeID(cage, halfedgeID);
-             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
-             backwardIterator = ccm_NextVertexHalfedgeID(cage, backwardIterator)) {
-            ++valence;
-        }
+    return ccs__EdgeToHalfedgeID(level->cage, edgeID, level->depth);
+}
 
-        for (int32_t i = 0; i < 3; ++i) {
-            const double w = 1.0f / (double)valence;
-            const double v = oldVertexPoint.array[i];
-            const double f = newFacePoints[faceID].array[i];
-            const double e = newEdgePoints[edgeID].array[i];
-            const double s = forwardIterator < 0 ? 0.0f : 1.0f;
-CC_ATOMIC
-            newVertexPoints[vertexID].array[i]+=
-                w * (v + w * s * (4.0f * e - f - 3.0f * v));
-        }
+CCDEF cc_Index ccl_VertexToHalfedgeID(const cc_SubdLevel *level, cc_Index vertexID)
+{
+    if (level->vertexToHalfedgeIDs != NULL) {
+        return level->vertexToHalfedgeIDs[vertexID];
     }
-CC_BARRIER
+
+    return ccs__VertexPointToHalfedgeID(level->cage, vertexID, level->depth);
 }
 
 
 /*******************************************************************************
- * CreasedCageVertexPoints -- Applies DeRose et al.'s vertex rule on cage mesh
- *
- * The "Gather" routine iterates over each vertex of the mesh and computes the
- * resulting smooth vertex.
+ * ParallelRange -- Runs a level routine over the elements of a level
  *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the smooth vertex.
+ * The level routines ("Gather", "Scatter", and the segmented reductions)
+ * process a range of elements, so that they run on any backend (see
+ * ParallelBackend). With the OpenMP backend, the chunks are shared among the
+ * threads of the driver's parallel region, and the threads synchronize before
+ * the next routine. With any other backend, the driver runs on the calling
+ * thread, and each routine submits its chunks to the backend, which returns
+ * once all of them are done.
  *
  */
-static void ccs__CreasedCageVertexPoints_Gather(cc_Subd *subd)
+typedef struct ccs__RangeTask ccs__RangeTask;
+typedef void (*ccs__RangeRoutine)(const ccs__RangeTask *task, cc_Index begin, cc_Index end);
+
+struct ccs__RangeTask {
+    ccs__RangeRoutine routine;
+    cc_Subd *subd;
+    int32_t depth;
+    bool isCreased;
+    cc_Index *scratch;
+};
+
+static void ccs__RunRangeTask(cc_Index begin, cc_Index end, void *userData)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+    const ccs__RangeTask *task = (const ccs__RangeTask *)userData;
 
-CC_PARALLEL_FOR
-    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
-        const int32_t halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
-        const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
-        const int32_t prevFaceID = ccm_HalfedgeFaceID(cage, prevID);
-        const double thisS = ccm_HalfedgeSharpness(cage, halfedgeID);
-        const double prevS = ccm_HalfedgeSharpness(cage,     prevID);
-        const double creaseWeight = cc__Signf(thisS);
-        const double prevCreaseWeight = cc__Signf(prevS);
-        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
-        const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
-        const cc_VertexPoint oldPoint = ccm_VertexPoint(cage, vertexID);
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
-        double avgS = prevS;
-        double creaseCount = prevCreaseWeight;
-        double valence = 1.0f;
-        int32_t forwardIterator;
-        double tmp1[3], tmp2[3];
+    (*task->routine)(task, begin, end);
+}
 
-        // smooth contrib
-        cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
-        cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+static void
+ccs__ParallelRange(const ccs__RangeTask *task, cc_Index count, cc_Index grain)
+{
+    if (cc__IsOpenMPBackend()) {
+        const cc_Index chunkCount = (count + grain - 1) / grain;
 
-        // crease contrib
-        cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
-        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+CC_FOR
+        for (cc_Index chunkID = 0; chunkID < chunkCount; ++chunkID) {
+            const cc_Index begin = chunkID * grain;
 
-        for (forwardIterator = ccm_HalfedgeTwinID(cage, prevID);
-             forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccm_HalfedgeTwinID(cage, forwardIterator)) {
-            const int32_t prevID = ccm_HalfedgePrevID(cage, forwardIterator);
-            const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
-            const int32_t prevFaceID = ccm_HalfedgeFaceID(cage, prevID);
-            const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
-            const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
-            const double prevS = ccm_HalfedgeSharpness(cage, prevID);
-            const double prevCreaseWeight = cc__Signf(prevS);
+            (*task->routine)(task, begin, cc__Min(begin + grain, count));
+        }
+CC_BARRIER
+    } else {
+        cc_ParallelFor(0, count, grain, &ccs__RunRangeTask, (void *)task);
+    }
+}
 
-            // smooth contrib
-            cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
-            cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
-            ++valence;
+/*
+ * The topology routines run outside of the drivers' regions, so they submit
+ * their chunks to the backend directly (with the OpenMP backend, each loop
+ * opens a parallel region of its own).
+ */
+static void
+ccs__ParallelLoop(const ccs__RangeTask *task, cc_Index count, cc_Index grain)
+{
+    cc_ParallelFor(0, count, grain, &ccs__RunRangeTask, (void *)task);
+}
 
-            // crease contrib
-            cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-            avgS+= prevS;
-            creaseCount+= prevCreaseWeight;
 
-            // next vertex halfedge
-            forwardIterator = prevID;
-        }
+/*******************************************************************************
+ * FirstTouch -- Places the pages of the level buffers near their threads
+ *
+ * On NUMA machines, a page lands on the node of the thread that first writes
+ * to it. With CC_SUBD_FIRST_TOUCH, the subd zeroes its level buffers as soon
+ * as they are allocated, sharing the elements of each depth among the threads
+ * the way the refinement does (see ParallelRange): the children halfedges and
+ * creases by parent, and the face, edge, and vertex points by the element
+ * they refine. Each thread thus mostly writes to pages of its own node. In
+ * final-level-only mode, the depths share their storage, so the touch goes
+ * from the deepest level up so that the largest levels set the placement.
+ * Note that the cage is left as is: it lives wherever its loader put it.
+ *
+ */
+static void
+ccs__FirstTouch_Halfedges(const ccs__RangeTask *task, cc_Index begin, cc_Index end)
+{
+    cc_Halfedge_SemiRegular *halfedges = ccs_Level(task->subd, task->depth + 1).halfedges;
 
-        // boundary corrections
-        if (forwardIterator < 0) {
-            cc__Mul3f(tmp1, newEdgePoint.array    , creaseWeight);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-            creaseCount+= creaseWeight;
-            ++valence;
-        }
+    CC_MEMSET(&halfedges[4 * begin], 0, sizeof(*halfedges) * 4 * (end - begin));
+}
 
-        // smooth point
-        cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
-        cc__Mul3f(tmp2, oldPoint.array, 1.0f - 3.0f / valence);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+static void
+ccs__FirstTouch_Creases(const ccs__RangeTask *task, cc_Index begin, cc_Index end)
+{
+    cc_Crease *creases = ccs_Level(task->subd, task->depth + 1).creases;
 
-        // crease point
-        cc__Mul3f(tmp1, creasePoint.array, 0.25f);
-        cc__Mul3f(tmp2, oldPoint.array, 0.5f);
-        cc__Add3f(creasePoint.array, tmp1, tmp2);
+    CC_MEMSET(&creases[2 * begin], 0, sizeof(*creases) * 2 * (end - begin));
+}
 
-        // proper vertex rule selection
-        if (creaseCount <= 1.0f) {
-            newVertexPoints[vertexID] = smoothPoint;
-        } else if (creaseCount >= 3.0f || valence == 2.0f) {
-            newVertexPoints[vertexID] = oldPoint;
-        } else {
-            cc__Lerp3f(newVertexPoints[vertexID].array,
-                       oldPoint.array,
-                       creasePoint.array,
-                       cc__Satf(avgS * 0.5f));
-        }
-    }
-CC_BARRIER
+static void
+ccs__FirstTouch_Points(
+    const ccs__RangeTask *task,
+    cc_Index offset,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_VertexPoint *vertexPoints = ccs_Level(task->subd, task->depth + 1).vertexPoints;
+
+    CC_MEMSET(&vertexPoints[offset + begin], 0, sizeof(*vertexPoints) * (end - begin));
+}
+
+static void
+ccs__FirstTouch_FacePoints(const ccs__RangeTask *task, cc_Index begin, cc_Index end)
+{
+    const cc_Mesh *cage = task->subd->cage;
+
+    ccs__FirstTouch_Points(task, ccm_VertexCountAtDepth(cage, task->depth), begin, end);
+}
+
+static void
+ccs__FirstTouch_EdgePoints(const ccs__RangeTask *task, cc_Index begin, cc_Index end)
+{
+    const cc_Mesh *cage = task->subd->cage;
+    const cc_Index offset = ccm_VertexCountAtDepth(cage, task->depth)
+                          + ccm_FaceCountAtDepth(cage, task->depth);
+
+    ccs__FirstTouch_Points(task, offset, begin, end);
 }
 
+static void
+ccs__FirstTouch_VertexPoints(const ccs__RangeTask *task, cc_Index begin, cc_Index end)
+{
+    ccs__FirstTouch_Points(task, 0, begin, end);
+}
 
-static void ccs__CreasedCageVertexPoints_Scatter(cc_Subd *subd)
+static void ccs__FirstTouchDepth(cc_Subd *subd, int32_t depth)
 {
     const cc_Mesh *cage = subd->cage;
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    const cc_VertexPoint *oldVertexPoints = cage->vertexPoints;
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+    const cc_Index grain = subd->parallelGrain;
+    ccs__RangeTask task = {&ccs__FirstTouch_Halfedges, subd, depth, false, NULL};
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
-        const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
-        const double thisS = ccm_HalfedgeSharpness(cage, halfedgeID);
-        const double prevS = ccm_HalfedgeSharpness(cage,     prevID);
-        const double creaseWeight = cc__Signf(thisS);
-        const double prevCreaseWeight = cc__Signf(prevS);
-        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
-        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldPoint = oldVertexPoints[vertexID];
-        cc_VertexPoint cornerPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint atomicWeight = {0.0f, 0.0f, 0.0f};
-        double avgS = prevS;
-        double creaseCount = prevCreaseWeight;
-        double valence = 1.0f;
-        int32_t forwardIterator, backwardIterator;
-        double tmp1[3], tmp2[3];
+    ccs__ParallelRange(&task, ccm_HalfedgeCountAtDepth(cage, depth), grain);
+    task.routine = &ccs__FirstTouch_Creases;
+    ccs__ParallelRange(&task, ccs__CreaseCountAtDepth(subd, depth), grain);
+    task.routine = &ccs__FirstTouch_FacePoints;
+    ccs__ParallelRange(&task, ccm_FaceCountAtDepth(cage, depth), grain);
+    task.routine = &ccs__FirstTouch_EdgePoints;
+    ccs__ParallelRange(&task, ccm_EdgeCountAtDepth(cage, depth), grain);
+    task.routine = &ccs__FirstTouch_VertexPoints;
+    ccs__ParallelRange(&task, ccm_VertexCountAtDepth(cage, depth), grain);
+}
 
-        for (forwardIterator = ccm_HalfedgeTwinID(cage, prevID);
-             forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccm_HalfedgeTwinID(cage, forwardIterator)) {
-            const int32_t prevID = ccm_HalfedgePrevID(cage, forwardIterator);
-            const double prevS = ccm_HalfedgeSharpness(cage, prevID);
-            const double prevCreaseWeight = cc__Signf(prevS);
+static void ccs__FirstTouchCreaseDepth(cc_Subd *subd, int32_t depth)
+{
+    const ccs__RangeTask task = {&ccs__FirstTouch_Creases, subd, depth, false, NULL};
 
-            // valence computation
-            ++valence;
+    ccs__ParallelRange(&task, ccs__CreaseCountAtDepth(subd, depth), subd->parallelGrain);
+}
 
-            // crease computation
-            avgS+= prevS;
-            creaseCount+= prevCreaseWeight;
+static void
+ccs__FirstTouchDepths(cc_Subd *subd, void (*touchDepth)(cc_Subd *, int32_t))
+{
+    const int32_t maxDepth = ccs_MaxDepth(subd);
 
-            // next vertex halfedge
-            forwardIterator = prevID;
+    if (cc__IsOpenMPBackend()) {
+CC_PARALLEL
+        for (int32_t depth = maxDepth - 1; depth >= 0; --depth) {
+            (*touchDepth)(subd, depth);
+        }
+    } else {
+        for (int32_t depth = maxDepth - 1; depth >= 0; --depth) {
+            (*touchDepth)(subd, depth);
         }
+    }
+}
 
-        for (backwardIterator = ccm_HalfedgeTwinID(cage, halfedgeID);
-             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
-             backwardIterator = ccm_HalfedgeTwinID(cage, backwardIterator)) {
-            const int32_t nextID = ccm_HalfedgeNextID(cage, backwardIterator);
-            const double nextS = ccm_HalfedgeSharpness(cage, nextID);
-            const double nextCreaseWeight = cc__Signf(nextS);
+static void ccs__FirstTouch(cc_Subd *subd)
+{
+    ccs__FirstTouchDepths(subd, &ccs__FirstTouchDepth);
+}
 
-            // valence computation
-            ++valence;
+static void ccs__FirstTouchCreases(cc_Subd *subd)
+{
+    ccs__FirstTouchDepths(subd, &ccs__FirstTouchCreaseDepth);
+}
 
-            // crease computation
-            avgS+= nextS;
-            creaseCount+= nextCreaseWeight;
 
-            // next vertex halfedge
-            backwardIterator = nextID;
+/*******************************************************************************
+ * PagePlacement -- Counts the pages of the level buffers on each NUMA node
+ *
+ * The pages of the halfedge, crease, and vertex point buffers are looked up
+ * with the move_pages system call (Linux), which reports the node of each
+ * page without moving it. Pages that were never touched, or that live on a
+ * node beyond "nodeCount", are not counted. Returns the total number of
+ * pages, or -1 if the platform cannot tell.
+ *
+ */
+#ifdef CC__PAGE_NODES
+static void
+ccs__CountPageNodes(
+    const void *buffer,
+    size_t byteCount,
+    int64_t *pageCounts,
+    int32_t nodeCount,
+    int64_t *pageCount
+) {
+    enum {BATCH_SIZE = 256};
+    const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    const uintptr_t end = (uintptr_t)buffer + byteCount;
+    uintptr_t page = (uintptr_t)buffer - (uintptr_t)buffer % pageSize;
+
+    while (page < end) {
+        void *pages[BATCH_SIZE];
+        int status[BATCH_SIZE];
+        int32_t batchCount = 0;
+
+        for (; batchCount < BATCH_SIZE && page < end; ++batchCount, page+= pageSize) {
+            pages[batchCount] = (void *)page;
         }
 
-        // corner point
-        cc__Mul3f(cornerPoint.array, oldPoint.array, 1.0f / valence);
+        if (syscall(SYS_move_pages, 0, (unsigned long)batchCount, pages, NULL, status, 0) != 0) {
+            for (int32_t pageID = 0; pageID < batchCount; ++pageID) {
+                status[pageID] = -1;
+            }
+        }
 
-        // crease computation: V / 4
-        cc__Mul3f(tmp1, oldPoint.array, 0.25f * creaseWeight);
-        cc__Mul3f(tmp2, newEdgePoint.array, 0.25f * creaseWeight);
-        cc__Add3f(creasePoint.array, tmp1, tmp2);
+        for (int32_t pageID = 0; pageID < batchCount; ++pageID) {
+            if (status[pageID] >= 0 && status[pageID] < nodeCount) {
+                ++pageCounts[status[pageID]];
+            }
+        }
 
-        // smooth computation: (4E - F + (n - 3) V) / N
-        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
-        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
-        cc__Mul3f(tmp1, oldPoint.array, valence - 3.0f);
-        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-        cc__Mul3f(smoothPoint.array,
-                  smoothPoint.array,
-                  1.0f / (valence * valence));
+        (*pageCount)+= batchCount;
+    }
+}
+#endif
 
-        // boundary corrections
-        if (forwardIterator < 0) {
-            creaseCount+= creaseWeight;
-            ++valence;
+CCDEF int64_t
+ccs_PagePlacement(const cc_Subd *subd, int64_t *pageCounts, int32_t nodeCount)
+{
+#ifdef CC__PAGE_NODES
+    const cc_Index halfedgeCount = ccs__LevelStorageCount(subd->cage,
+                                                         subd->maxDepth,
+                                                         subd->flags,
+                                                         &ccm_HalfedgeCountAtDepth,
+                                                         &ccs_CumulativeHalfedgeCountAtDepth);
+    const cc_Index vertexCount = ccs__LevelStorageCount(subd->cage,
+                                                       subd->maxDepth,
+                                                       subd->flags,
+                                                       &ccm_VertexCountAtDepth,
+                                                       &ccs_CumulativeVertexCountAtDepth);
+    const cc_Index creaseCount = ccs__CreaseStorageCount(subd);
+    int64_t pageCount = 0;
+
+    for (int32_t nodeID = 0; nodeID < nodeCount; ++nodeID) {
+        pageCounts[nodeID] = 0;
+    }
 
-            cc__Mul3f(tmp1, oldPoint.array, 0.25f * prevCreaseWeight);
-            cc__Mul3f(tmp2, newPrevEdgePoint.array, 0.25f * prevCreaseWeight);
-            cc__Add3f(tmp1, tmp1, tmp2);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-        }
+    ccs__CountPageNodes(subd->halfedges,
+                        sizeof(cc_Halfedge_SemiRegular) * halfedgeCount,
+                        pageCounts,
+                        nodeCount,
+                        &pageCount);
+    ccs__CountPageNodes(subd->creases,
+                        sizeof(cc_Crease) * creaseCount,
+                        pageCounts,
+                        nodeCount,
+                        &pageCount);
+    ccs__CountPageNodes(subd->vertexPoints,
+                        sizeof(cc_VertexPoint) * vertexCount,
+                        pageCounts,
+                        nodeCount,
+                        &pageCount);
+
+    return pageCount;
+#else
+    (void)subd;
+    (void)pageCounts;
+    (void)nodeCount;
 
-        // atomicWeight (TODO: make branchless ?)
-        if (creaseCount <= 1.0f) {
-            atomicWeight = smoothPoint;
-        } else if (creaseCount >= 3.0f || valence == 2.0f) {
-            atomicWeight = cornerPoint;
-        } else {
-            cc__Lerp3f(atomicWeight.array,
-                       cornerPoint.array,
-                       creasePoint.array,
-                       cc__Satf(avgS * 0.5f));
+    return -1;
+#endif
+}
+
+/*******************************************************************************
+ * ParallelScatter -- Runs a "Scatter" routine over the halfedges of a level
+ *
+ * The "Scatter" routines are range routines as well (see ParallelRange); their
+ * task also carries the optional contribution buffer. Their additions are
+ * atomic on any backend (see AtomicAdd), unless the compiler provides no
+ * atomics: the routines that add to the points then run on the calling thread.
+ *
+ */
+typedef struct {
+    ccs__RangeTask task;    // first member, so that the routine can cast it back
+    cc_VertexPoint *contributions;
+} ccs__ScatterTask;
+
+static void
+ccs__ParallelScatter(const ccs__ScatterTask *task, cc_Index count, cc_Index grain)
+{
+#ifndef CC__ATOMICS
+    if (task->contributions == NULL) {
+        (*task->task.routine)(&task->task, 0, count);
+
+        return;
+    }
+#endif
+
+    ccs__ParallelRange(&task->task, count, grain);
+}
+
+
+/*******************************************************************************
+ * ScatterWeight -- Accumulates the contribution of a halfedge to a point
+ *
+ * By default, the contribution is atomically added to the point. If a
+ * contribution buffer is provided, the contribution is instead stored at the
+ * location of the halfedge, to be summed in a deterministic order later on
+ * (see the "SegmentedScatter" routines).
+ *
+ */
+static void
+ccs__ScatterWeight(
+    cc_VertexPoint *points,
+    cc_Index pointID,
+    cc_VertexPoint *contributions,
+    cc_Index halfedgeID,
+    const cc_Real *weight
+) {
+    if (contributions != NULL) {
+        for (int32_t i = 0; i < 3; ++i) {
+            contributions[halfedgeID].array[i] = weight[i];
         }
+    } else {
         for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newVertexPoints[vertexID].array[i]+= atomicWeight.array[i];
+            cc__AtomicAddReal(&points[pointID].array[i], weight[i]);
         }
     }
-CC_BARRIER
 }
 
 
 /*******************************************************************************
- * FacePoints -- Applies Catmull Clark's face rule on the subd
+ * CageFacePoints -- Applies Catmull Clark's face rule on the cage mesh
  *
  * The "Gather" routine iterates over each face of the mesh and compute the
  * resulting face vertex.
@@ -2019,98 +3428,134 @@ CC_BARRIER
  * adds its contribution to the computation of the face vertex.
  *
  */
-static void ccs__FacePoints_Gather(cc_Subd *subd, int32_t depth)
-{
+static void
+ccs__CageFacePoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
 
-CC_PARALLEL_FOR
-    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
-        const int32_t halfedgeID = ccs_FaceToHalfedgeID(subd, faceID, depth);
-        cc_VertexPoint newFacePoint = ccs_HalfedgeVertexPoint(subd, halfedgeID, depth);
+    for (cc_Index faceID = begin; faceID < end; ++faceID) {
+        const cc_Index halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
+        cc_VertexPoint newFacePoint = ccm_HalfedgeVertexPoint(cage, halfedgeID);
+        cc_Real faceVertexCount = 1.0f;
 
-        for (int32_t halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeID, depth);
+        for (cc_Index halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
                      halfedgeIt != halfedgeID;
-                     halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeIt, depth)) {
-            const cc_VertexPoint vertexPoint = ccs_HalfedgeVertexPoint(subd, halfedgeIt, depth);
+                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
+            const cc_VertexPoint vertexPoint = ccm_HalfedgeVertexPoint(cage, halfedgeIt);
 
             cc__Add3f(newFacePoint.array, newFacePoint.array, vertexPoint.array);
+            ++faceVertexCount;
         }
 
-        cc__Mul3f(newFacePoint.array, newFacePoint.array, 0.25f);
+        cc__Mul3f(newFacePoint.array, newFacePoint.array, 1.0f / faceVertexCount);
 
         newFacePoints[faceID] = newFacePoint;
     }
-CC_BARRIER
 }
 
-static void ccs__FacePoints_Scatter(cc_Subd *subd, int32_t depth)
+static void ccs__CageFacePoints_Gather(cc_Subd *subd)
 {
+    const ccs__RangeTask task = {&ccs__CageFacePoints_GatherRange, subd, 0, false, NULL};
+
+    ccs__ParallelRange(&task, ccm_FaceCount(subd->cage), subd->parallelGrain);
+}
+
+static void
+ccs__CageFacePoints_ScatterRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    cc_VertexPoint *contributions = ((const ccs__ScatterTask *)task)->contributions;
     const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const cc_VertexPoint vertexPoint = ccs_HalfedgeVertexPoint(subd, halfedgeID, depth);
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        double *newFacePoint = newFacePoints[faceID].array;
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_VertexPoint vertexPoint = ccm_HalfedgeVertexPoint(cage, halfedgeID);
+        const cc_Index faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        cc_Real faceVertexCount = 1.0f;
+        cc_Real atomicWeight[3];
+
+        for (cc_Index halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
+                     halfedgeIt != halfedgeID;
+                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
+            ++faceVertexCount;
+        }
 
         for (int32_t i = 0; i < 3; ++i) {
-    CC_ATOMIC
-            newFacePoint[i]+= vertexPoint.array[i] / (double)4.0f;
+            atomicWeight[i] = vertexPoint.array[i] / (cc_Real)faceVertexCount;
         }
+
+        ccs__ScatterWeight(newFacePoints, faceID, contributions, halfedgeID, atomicWeight);
     }
-CC_BARRIER
+}
+
+static void
+ccs__CageFacePoints_Scatter(cc_Subd *subd, cc_VertexPoint *contributions)
+{
+    const ccs__ScatterTask task = {
+        {&ccs__CageFacePoints_ScatterRange, subd, 0, false, NULL},
+        contributions
+    };
+
+    ccs__ParallelScatter(&task, ccm_HalfedgeCount(subd->cage), subd->parallelGrain);
 }
 
 
 /*******************************************************************************
- * EdgePoints -- Applies Catmull Clark's edge rule on the subd
+ * CageEdgePoints -- Applies Catmull Clark's edge rule on the cage mesh
  *
- * The "Gather" routine iterates over each edge of the mesh and compute the
+ * The "Gather" routine iterates over each edge of the mesh and computes the
  * resulting edge vertex.
  *
  * The "Scatter" routine iterates over each halfedge of the mesh and atomically
  * adds its contribution to the computation of the edge vertex.
  *
  */
-static void ccs__EdgePoints_Gather(cc_Subd *subd, int32_t depth)
-{
+static void
+ccs__CageEdgePoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
-
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID, depth);
-        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-        const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
-        const double edgeWeight = twinID < 0 ? 0.0f : 1.0f;
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+
+    for (cc_Index edgeID = begin; edgeID < end; ++edgeID) {
+        const cc_Index halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
+        const cc_Index twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+        const cc_Index nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        const cc_Real edgeWeight = twinID < 0 ? 0.0f : 1.0f;
         const cc_VertexPoint oldEdgePoints[2] = {
-            ccs_HalfedgeVertexPoint(subd, halfedgeID, depth),
-            ccs_HalfedgeVertexPoint(subd,     nextID, depth)
-        };
-        const cc_VertexPoint newAdjacentFacePoints[2] = {
-            newFacePoints[ccs_HalfedgeFaceID(subd,         halfedgeID, depth)],
-            newFacePoints[ccs_HalfedgeFaceID(subd, cc__Max(0, twinID), depth)]
+            ccm_HalfedgeVertexPoint(cage, halfedgeID),
+            ccm_HalfedgeVertexPoint(cage,     nextID)
+        };
+        const cc_VertexPoint newFacePointPair[2] = {
+            newFacePoints[ccm_HalfedgeFaceID(cage, halfedgeID)],
+            newFacePoints[ccm_HalfedgeFaceID(cage, cc__Max(0, twinID))]
         };
-        double *newEdgePoint = newEdgePoints[edgeID].array;
+        cc_Real *newEdgePoint = newEdgePoints[edgeID].array;
         cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
         cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
-        double tmp1[3], tmp2[3];
+        cc_Real tmp1[3], tmp2[3];
 
         cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
-        cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
+        cc__Add3f(tmp2, newFacePointPair[0].array, newFacePointPair[1].array);
         cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
         cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
         cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
@@ -2119,81 +3564,102 @@ CC_PARALLEL_FOR
                    smoothEdgePoint.array,
                    edgeWeight);
     }
-CC_BARRIER
 }
 
-static void ccs__EdgePoints_Scatter(cc_Subd *subd, int32_t depth)
+static void ccs__CageEdgePoints_Gather(cc_Subd *subd)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+    const ccs__RangeTask task = {&ccs__CageEdgePoints_GatherRange, subd, 0, false, NULL};
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-        const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
+    ccs__ParallelRange(&task, ccm_EdgeCount(subd->cage), subd->parallelGrain);
+}
+
+static void
+ccs__CageEdgePoints_ScatterRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    cc_VertexPoint *contributions = ((const ccs__ScatterTask *)task)->contributions;
+    const cc_Mesh *cage = subd->cage;
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const cc_Index twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+        const cc_Index nextID = ccm_HalfedgeNextID(cage, halfedgeID);
         const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        double tmp1[3], tmp2[3], tmp3[3], tmp4[3], atomicWeight[3];
-        double weight = twinID >= 0 ? 0.5f : 1.0f;
+        cc_Real tmp1[3], tmp2[3], tmp3[3], tmp4[3], atomicWeight[3];
+        cc_Real weight = twinID >= 0 ? 0.5f : 1.0f;
 
         cc__Mul3f(tmp1, newFacePoint.array, 0.5f);
-        cc__Mul3f(tmp2, ccs_HalfedgeVertexPoint(subd, halfedgeID, depth).array, weight);
-        cc__Mul3f(tmp3, ccs_HalfedgeVertexPoint(subd,     nextID, depth).array, weight);
+        cc__Mul3f(tmp2, ccm_HalfedgeVertexPoint(cage, halfedgeID).array, weight);
+        cc__Mul3f(tmp3, ccm_HalfedgeVertexPoint(cage,     nextID).array, weight);
         cc__Lerp3f(tmp4, tmp2, tmp3, 0.5f);
         cc__Lerp3f(atomicWeight, tmp1, tmp4, weight);
 
-        for (int32_t i = 0; i < 3; ++i) {
-    CC_ATOMIC
-            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
-        }
+        ccs__ScatterWeight(newEdgePoints, edgeID, contributions, halfedgeID, atomicWeight);
     }
-CC_BARRIER
 }
 
+static void
+ccs__CageEdgePoints_Scatter(cc_Subd *subd, cc_VertexPoint *contributions)
+{
+    const ccs__ScatterTask task = {
+        {&ccs__CageEdgePoints_ScatterRange, subd, 0, false, NULL},
+        contributions
+    };
+
+    ccs__ParallelScatter(&task, ccm_HalfedgeCount(subd->cage), subd->parallelGrain);
+}
+
+
 /*******************************************************************************
- * CreasedEdgePoints -- Applies DeRose et al's edge rule on the subd
+ * CreasedCageEdgePoints -- Applies DeRole et al.'s edge rule on the cage mesh
  *
- * The "Gather" routine iterates over each edge of the mesh and compute the
+ * The "Gather" routine iterates over each edge of the mesh and computes the
  * resulting edge vertex.
  *
  * The "Scatter" routine iterates over each halfedge of the mesh and atomically
  * adds its contribution to the computation of the edge vertex.
  *
  */
-static void ccs__CreasedEdgePoints_Gather(cc_Subd *subd, int32_t depth)
-{
+static void
+ccs__CreasedCageEdgePoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride +vertexCount + faceCount];
-
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID, depth);
-        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-        const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
-        const double sharp = ccs_CreaseSharpness(subd, edgeID, depth);
-        const double edgeWeight = cc__Satf(sharp);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+
+    for (cc_Index edgeID = begin; edgeID < end; ++edgeID) {
+        const cc_Index halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
+        const cc_Index twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+        const cc_Index nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        const cc_Real sharp = ccm_CreaseSharpness(cage, edgeID);
+        const cc_Real edgeWeight = cc__Satf(sharp);
         const cc_VertexPoint oldEdgePoints[2] = {
-            ccs_HalfedgeVertexPoint(subd, halfedgeID, depth),
-            ccs_HalfedgeVertexPoint(subd,     nextID, depth)
+            ccm_HalfedgeVertexPoint(cage, halfedgeID),
+            ccm_HalfedgeVertexPoint(cage,     nextID)
         };
         const cc_VertexPoint newAdjacentFacePoints[2] = {
-            newFacePoints[ccs_HalfedgeFaceID(subd,         halfedgeID, depth)],
-            newFacePoints[ccs_HalfedgeFaceID(subd, cc__Max(0, twinID), depth)]
+            newFacePoints[ccm_HalfedgeFaceID(cage, halfedgeID)],
+            newFacePoints[ccm_HalfedgeFaceID(cage, cc__Max(0, twinID))]
         };
         cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
         cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
-        double tmp1[3], tmp2[3];
+        cc_Real tmp1[3], tmp2[3];
 
         cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
         cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
@@ -2205,36 +3671,45 @@ CC_PARALLEL_FOR
                    sharpEdgePoint.array,
                    edgeWeight);
     }
-CC_BARRIER
 }
 
-
-static void ccs__CreasedEdgePoints_Scatter(cc_Subd *subd, int32_t depth)
+static void ccs__CreasedCageEdgePoints_Gather(cc_Subd *subd)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+    const ccs__RangeTask task = {&ccs__CreasedCageEdgePoints_GatherRange, subd, 0, false, NULL};
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
-        const double sharp = ccs_CreaseSharpness(subd, edgeID, depth);
-        const double edgeWeight = cc__Satf(sharp);
+    ccs__ParallelRange(&task, ccm_EdgeCount(subd->cage), subd->parallelGrain);
+}
+
+static void
+ccs__CreasedCageEdgePoints_ScatterRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    cc_VertexPoint *contributions = ((const ccs__ScatterTask *)task)->contributions;
+    const cc_Mesh *cage = subd->cage;
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const cc_Index twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+        const cc_Index nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        const cc_Real sharp = ccm_CreaseSharpness(cage, edgeID);
+        const cc_Real edgeWeight = cc__Satf(sharp);
         const cc_VertexPoint newFacePoint = newFacePoints[faceID];
         const cc_VertexPoint oldEdgePoints[2] = {
-            ccs_HalfedgeVertexPoint(subd, halfedgeID, depth),
-            ccs_HalfedgeVertexPoint(subd,     nextID, depth)
+            ccm_HalfedgeVertexPoint(cage, halfedgeID),
+            ccm_HalfedgeVertexPoint(cage,     nextID)
         };
         cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
         cc_VertexPoint sharpPoint = {0.0f, 0.0f, 0.0f};
-        double tmp[3], atomicWeight[3];
+        cc_Real tmp[3], atomicWeight[3];
 
         // sharp point
         cc__Lerp3f(tmp, oldEdgePoints[0].array, oldEdgePoints[1].array, 0.5f);
@@ -2250,17 +3725,24 @@ CC_PARALLEL_FOR
                    sharpPoint.array,
                    edgeWeight);
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
-        }
+        ccs__ScatterWeight(newEdgePoints, edgeID, contributions, halfedgeID, atomicWeight);
     }
-CC_BARRIER
+}
+
+static void
+ccs__CreasedCageEdgePoints_Scatter(cc_Subd *subd, cc_VertexPoint *contributions)
+{
+    const ccs__ScatterTask task = {
+        {&ccs__CreasedCageEdgePoints_ScatterRange, subd, 0, false, NULL},
+        contributions
+    };
+
+    ccs__ParallelScatter(&task, ccm_HalfedgeCount(subd->cage), subd->parallelGrain);
 }
 
 
 /*******************************************************************************
- * VertexPoints -- Applies Catmull Clark's vertex rule on the subd
+ * CageVertexPoints -- Applies Catmull Clark's vertex rule on the cage mesh
  *
  * The "Gather" routine iterates over each vertex of the mesh and computes the
  * resulting smooth vertex.
@@ -2269,38 +3751,42 @@ CC_BARRIER
  * adds its contribution to the computation of the smooth vertex.
  *
  */
-static void ccs__VertexPoints_Gather(cc_Subd *subd, int32_t depth)
-{
+static void
+ccs__CageVertexPoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
-
-CC_PARALLEL_FOR
-    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
-        const int32_t halfedgeID = ccs_VertexPointToHalfedgeID(subd, vertexID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        const cc_Index halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
+        const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const cc_Index faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
         const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
         const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldVertexPoint = ccs_VertexPoint(subd, vertexID, depth);
+        const cc_VertexPoint oldVertexPoint = ccm_VertexPoint(cage, vertexID);
         cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        double valence = 1.0f;
-        int32_t iterator;
-        double tmp1[3], tmp2[3];
+        cc_Real valence = 1.0f;
+        cc_Index iterator;
+        cc_Real tmp1[3], tmp2[3];
 
         cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
         cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
         cc__Add3f(smoothPoint.array, tmp1, tmp2);
 
-        for (iterator = ccs_PrevVertexHalfedgeID(subd, halfedgeID, depth);
+        for (iterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
              iterator >= 0 && iterator != halfedgeID;
-             iterator = ccs_PrevVertexHalfedgeID(subd, iterator, depth)) {
-            const int32_t edgeID = ccs_HalfedgeEdgeID(subd, iterator, depth);
-            const int32_t faceID = ccs_HalfedgeFaceID(subd, iterator, depth);
+             iterator = ccm_PrevVertexHalfedgeID(cage, iterator)) {
+            const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, iterator);
+            const cc_Index faceID = ccm_HalfedgeFaceID(cage, iterator);
             const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
             const cc_VertexPoint newFacePoint = newFacePoints[faceID];
 
@@ -2319,58 +3805,86 @@ CC_PARALLEL_FOR
                    smoothPoint.array,
                    iterator != halfedgeID ? 0.0f : 1.0f);
     }
-CC_BARRIER
 }
 
-static void ccs__VertexPoints_Scatter(cc_Subd *subd, int32_t depth)
+static void ccs__CageVertexPoints_Gather(cc_Subd *subd)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+    const ccs__RangeTask task = {&ccs__CageVertexPoints_GatherRange, subd, 0, false, NULL};
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        const cc_VertexPoint oldVertexPoint = ccs_VertexPoint(subd, vertexID, depth);
-        int32_t valence = 1;
-        int32_t forwardIterator, backwardIterator;
+    ccs__ParallelRange(&task, ccm_VertexCount(subd->cage), subd->parallelGrain);
+}
 
-        for (forwardIterator = ccs_PrevVertexHalfedgeID(subd, halfedgeID, depth);
-             forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccs_PrevVertexHalfedgeID(subd, forwardIterator, depth)) {
-            ++valence;
-        }
+static void
+ccs__CageVertexPoints_ScatterRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    cc_VertexPoint *contributions = ((const ccs__ScatterTask *)task)->contributions;
+    const cc_Mesh *cage = subd->cage;
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const int32_t *valences = nextLevel.vertexValences;
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
+        const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const cc_Index faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        const cc_VertexPoint oldVertexPoint = ccm_VertexPoint(cage, vertexID);
+        cc_Index valence = 1;
+        cc_Index forwardIterator, backwardIterator;
+        cc_Real atomicWeight[3];
 
-        for (backwardIterator = ccs_NextVertexHalfedgeID(subd, halfedgeID, depth);
-             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
-             backwardIterator = ccs_NextVertexHalfedgeID(subd, backwardIterator, depth)) {
-            ++valence;
+        if (valences != NULL) {
+            valence = cc__Abs(valences[vertexID]);
+            forwardIterator = valences[vertexID] < 0 ? -1 : halfedgeID;
+        } else {
+            for (forwardIterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
+                 forwardIterator >= 0 && forwardIterator != halfedgeID;
+                 forwardIterator = ccm_PrevVertexHalfedgeID(cage, forwardIterator)) {
+                ++valence;
+            }
+
+            for (backwardIterator = ccm_NextVertexHalfedgeID(cage, halfedgeID);
+                 forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+                 backwardIterator = ccm_NextVertexHalfedgeID(cage, backwardIterator)) {
+                ++valence;
+            }
         }
 
         for (int32_t i = 0; i < 3; ++i) {
-            const double w = 1.0f / (double)valence;
-            const double v = oldVertexPoint.array[i];
-            const double f = newFacePoints[faceID].array[i];
-            const double e = newEdgePoints[edgeID].array[i];
-            const double s = forwardIterator < 0 ? 0.0f : 1.0f;
-CC_ATOMIC
-            newVertexPoints[vertexID].array[i]+=
-                w * (v + w * s * (4.0f * e - f - 3.0f * v));
+            const cc_Real w = 1.0f / (cc_Real)valence;
+            const cc_Real v = oldVertexPoint.array[i];
+            const cc_Real f = newFacePoints[faceID].array[i];
+            const cc_Real e = newEdgePoints[edgeID].array[i];
+            const cc_Real s = forwardIterator < 0 ? 0.0f : 1.0f;
+
+            atomicWeight[i] = w * (v + w * s * (4.0f * e - f - 3.0f * v));
         }
+
+        ccs__ScatterWeight(newVertexPoints, vertexID, contributions, halfedgeID, atomicWeight);
     }
-CC_BARRIER
+}
+
+static void
+ccs__CageVertexPoints_Scatter(cc_Subd *subd, cc_VertexPoint *contributions)
+{
+    const ccs__ScatterTask task = {
+        {&ccs__CageVertexPoints_ScatterRange, subd, 0, false, NULL},
+        contributions
+    };
+
+    ccs__ParallelScatter(&task, ccm_HalfedgeCount(subd->cage), subd->parallelGrain);
 }
 
 
 /*******************************************************************************
- * CreasedVertexPoints -- Applies DeRose et al.'s vertex rule on the subd
+ * CreasedCageVertexPoints -- Applies DeRose et al.'s vertex rule on cage mesh
  *
  * The "Gather" routine iterates over each vertex of the mesh and computes the
  * resulting smooth vertex.
@@ -2379,38 +3893,42 @@ CC_BARRIER
  * adds its contribution to the computation of the smooth vertex.
  *
  */
-static void ccs__CreasedVertexPoints_Gather(cc_Subd *subd, int32_t depth)
-{
+static void
+ccs__CreasedCageVertexPoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
-
-CC_PARALLEL_FOR
-    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
-        const int32_t halfedgeID = ccs_VertexPointToHalfedgeID(subd, vertexID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t prevID = ccs_HalfedgePrevID(subd, halfedgeID, depth);
-        const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
-        const int32_t prevFaceID = ccs_HalfedgeFaceID(subd, prevID, depth);
-        const double thisS = ccs_HalfedgeSharpness(subd, halfedgeID, depth);
-        const double prevS = ccs_HalfedgeSharpness(subd,     prevID, depth);
-        const double creaseWeight = cc__Signf(thisS);
-        const double prevCreaseWeight = cc__Signf(prevS);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        const cc_Index halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
+        const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const cc_Index prevID = ccm_HalfedgePrevID(cage, halfedgeID);
+        const cc_Index prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
+        const cc_Index prevFaceID = ccm_HalfedgeFaceID(cage, prevID);
+        const cc_Real thisS = ccm_HalfedgeSharpness(cage, halfedgeID);
+        const cc_Real prevS = ccm_HalfedgeSharpness(cage,     prevID);
+        const cc_Real creaseWeight = cc__Signf(thisS);
+        const cc_Real prevCreaseWeight = cc__Signf(prevS);
         const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
         const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
         const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
-        const cc_VertexPoint oldPoint = ccs_VertexPoint(subd, vertexID, depth);
+        const cc_VertexPoint oldPoint = ccm_VertexPoint(cage, vertexID);
         cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
         cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
-        double avgS = prevS;
-        double creaseCount = prevCreaseWeight;
-        double valence = 1.0f;
-        int32_t forwardIterator, backwardIterator;
-        double tmp1[3], tmp2[3];
+        cc_Real avgS = prevS;
+        cc_Real creaseCount = prevCreaseWeight;
+        cc_Real valence = 1.0f;
+        cc_Index forwardIterator;
+        cc_Real tmp1[3], tmp2[3];
 
         // smooth contrib
         cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
@@ -2421,16 +3939,16 @@ CC_PARALLEL_FOR
         cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
         cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
 
-        for (forwardIterator = ccs_HalfedgeTwinID(subd, prevID, depth);
+        for (forwardIterator = ccm_HalfedgeTwinID(cage, prevID);
              forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccs_HalfedgeTwinID(subd, forwardIterator, depth)) {
-            const int32_t prevID = ccs_HalfedgePrevID(subd, forwardIterator, depth);
-            const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
-            const int32_t prevFaceID = ccs_HalfedgeFaceID(subd, prevID, depth);
+             forwardIterator = ccm_HalfedgeTwinID(cage, forwardIterator)) {
+            const cc_Index prevID = ccm_HalfedgePrevID(cage, forwardIterator);
+            const cc_Index prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
+            const cc_Index prevFaceID = ccm_HalfedgeFaceID(cage, prevID);
             const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
             const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
-            const double prevS = ccs_HalfedgeSharpness(subd, prevID, depth);
-            const double prevCreaseWeight = cc__Signf(prevS);
+            const cc_Real prevS = ccm_HalfedgeSharpness(cage, prevID);
+            const cc_Real prevCreaseWeight = cc__Signf(prevS);
 
             // smooth contrib
             cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
@@ -2449,34 +3967,6 @@ CC_PARALLEL_FOR
             forwardIterator = prevID;
         }
 
-        for (backwardIterator = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
-             backwardIterator = ccs_HalfedgeTwinID(subd, backwardIterator, depth)) {
-            const int32_t nextID = ccs_HalfedgeNextID(subd, backwardIterator, depth);
-            const int32_t nextEdgeID = ccs_HalfedgeEdgeID(subd, nextID, depth);
-            const int32_t nextFaceID = ccs_HalfedgeFaceID(subd, nextID, depth);
-            const cc_VertexPoint newNextEdgePoint = newEdgePoints[nextEdgeID];
-            const cc_VertexPoint newNextFacePoint = newFacePoints[nextFaceID];
-            const double nextS = ccs_HalfedgeSharpness(subd, nextID, depth);
-            const double nextCreaseWeight = cc__Signf(nextS);
-
-            // smooth contrib
-            cc__Mul3f(tmp1, newNextFacePoint.array, -1.0f);
-            cc__Mul3f(tmp2, newNextEdgePoint.array, +4.0f);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
-            ++valence;
-
-            // crease contrib
-            cc__Mul3f(tmp1, newNextEdgePoint.array, nextCreaseWeight);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-            avgS+= nextS;
-            creaseCount+= nextCreaseWeight;
-
-            // next vertex halfedge
-            backwardIterator = nextID;
-        }
-
         // boundary corrections
         if (forwardIterator < 0) {
             cc__Mul3f(tmp1, newEdgePoint.array    , creaseWeight);
@@ -2491,11 +3981,11 @@ CC_PARALLEL_FOR
         cc__Add3f(smoothPoint.array, tmp1, tmp2);
 
         // crease point
-        cc__Mul3f(tmp1, creasePoint.array, 0.5f / creaseCount);
+        cc__Mul3f(tmp1, creasePoint.array, 0.25f);
         cc__Mul3f(tmp2, oldPoint.array, 0.5f);
         cc__Add3f(creasePoint.array, tmp1, tmp2);
 
-        // proper vertex rule selection (TODO: make branchless)
+        // proper vertex rule selection
         if (creaseCount <= 1.0f) {
             newVertexPoints[vertexID] = smoothPoint;
         } else if (creaseCount >= 3.0f || valence == 2.0f) {
@@ -2507,52 +3997,63 @@ CC_PARALLEL_FOR
                        cc__Satf(avgS * 0.5f));
         }
     }
-CC_BARRIER
 }
 
-
-static void ccs__CreasedVertexPoints_Scatter(cc_Subd *subd, int32_t depth)
+static void ccs__CreasedCageVertexPoints_Gather(cc_Subd *subd)
 {
+    const ccs__RangeTask task = {&ccs__CreasedCageVertexPoints_GatherRange, subd, 0, false, NULL};
+
+    ccs__ParallelRange(&task, ccm_VertexCount(subd->cage), subd->parallelGrain);
+}
+
+
+static void
+ccs__CreasedCageVertexPoints_ScatterRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    cc_VertexPoint *contributions = ((const ccs__ScatterTask *)task)->contributions;
     const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        const int32_t prevID = ccs_HalfedgePrevID(subd, halfedgeID, depth);
-        const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
-        const double thisS = ccs_HalfedgeSharpness(subd, halfedgeID, depth);
-        const double prevS = ccs_HalfedgeSharpness(subd,     prevID, depth);
-        const double creaseWeight = cc__Signf(thisS);
-        const double prevCreaseWeight = cc__Signf(prevS);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_VertexPoint *oldVertexPoints = cage->vertexPoints;
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
+        const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const cc_Index faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        const cc_Index prevID = ccm_HalfedgePrevID(cage, halfedgeID);
+        const cc_Index prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
+        const cc_Real thisS = ccm_HalfedgeSharpness(cage, halfedgeID);
+        const cc_Real prevS = ccm_HalfedgeSharpness(cage,     prevID);
+        const cc_Real creaseWeight = cc__Signf(thisS);
+        const cc_Real prevCreaseWeight = cc__Signf(prevS);
         const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
         const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
         const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldPoint = ccs_VertexPoint(subd, vertexID, depth);
+        const cc_VertexPoint oldPoint = oldVertexPoints[vertexID];
         cc_VertexPoint cornerPoint = {0.0f, 0.0f, 0.0f};
         cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
         cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
         cc_VertexPoint atomicWeight = {0.0f, 0.0f, 0.0f};
-        double avgS = prevS;
-        double creaseCount = prevCreaseWeight;
-        double valence = 1.0f;
-        int32_t forwardIterator, backwardIterator;
-        double tmp1[3], tmp2[3];
+        cc_Real avgS = prevS;
+        cc_Real creaseCount = prevCreaseWeight;
+        cc_Real valence = 1.0f;
+        cc_Index forwardIterator, backwardIterator;
+        cc_Real tmp1[3], tmp2[3];
 
-        for (forwardIterator = ccs_HalfedgeTwinID(subd, prevID, depth);
+        for (forwardIterator = ccm_HalfedgeTwinID(cage, prevID);
              forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccs_HalfedgeTwinID(subd, forwardIterator, depth)) {
-            
-            const int32_t prevID = ccs_HalfedgePrevID(subd, forwardIterator, depth);
-            const double prevS = ccs_HalfedgeSharpness(subd, prevID, depth);
-            const double prevCreaseWeight = cc__Signf(prevS);
+             forwardIterator = ccm_HalfedgeTwinID(cage, forwardIterator)) {
+            const cc_Index prevID = ccm_HalfedgePrevID(cage, forwardIterator);
+            const cc_Real prevS = ccm_HalfedgeSharpness(cage, prevID);
+            const cc_Real prevCreaseWeight = cc__Signf(prevS);
 
             // valence computation
             ++valence;
@@ -2561,765 +4062,9660 @@ CC_PARALLEL_FOR
             avgS+= prevS;
             creaseCount+= prevCreaseWeight;
 
-            // next vertex halfedge
-            forwardIterator = prevID;
-        }
+            // next vertex halfedge
+            forwardIterator = prevID;
+        }
+
+        for (backwardIterator = ccm_HalfedgeTwinID(cage, halfedgeID);
+             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+             backwardIterator = ccm_HalfedgeTwinID(cage, backwardIterator)) {
+            const cc_Index nextID = ccm_HalfedgeNextID(cage, backwardIterator);
+            const cc_Real nextS = ccm_HalfedgeSharpness(cage, nextID);
+            const cc_Real nextCreaseWeight = cc__Signf(nextS);
+
+            // valence computation
+            ++valence;
+
+            // crease computation
+            avgS+= nextS;
+            creaseCount+= nextCreaseWeight;
+
+            // next vertex halfedge
+            backwardIterator = nextID;
+        }
+
+        // corner point
+        cc__Mul3f(cornerPoint.array, oldPoint.array, 1.0f / valence);
+
+        // crease computation: V / 4
+        cc__Mul3f(tmp1, oldPoint.array, 0.25f * creaseWeight);
+        cc__Mul3f(tmp2, newEdgePoint.array, 0.25f * creaseWeight);
+        cc__Add3f(creasePoint.array, tmp1, tmp2);
+
+        // smooth computation: (4E - F + (n - 3) V) / N
+        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+        cc__Mul3f(tmp1, oldPoint.array, valence - 3.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Mul3f(smoothPoint.array,
+                  smoothPoint.array,
+                  1.0f / (valence * valence));
+
+        // boundary corrections
+        if (forwardIterator < 0) {
+            creaseCount+= creaseWeight;
+            ++valence;
+
+            cc__Mul3f(tmp1, oldPoint.array, 0.25f * prevCreaseWeight);
+            cc__Mul3f(tmp2, newPrevEdgePoint.array, 0.25f * prevCreaseWeight);
+            cc__Add3f(tmp1, tmp1, tmp2);
+            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        }
+
+        // atomicWeight (TODO: make branchless ?)
+        if (creaseCount <= 1.0f) {
+            atomicWeight = smoothPoint;
+        } else if (creaseCount >= 3.0f || valence == 2.0f) {
+            atomicWeight = cornerPoint;
+        } else {
+            cc__Lerp3f(atomicWeight.array,
+                       cornerPoint.array,
+                       creasePoint.array,
+                       cc__Satf(avgS * 0.5f));
+        }
+        ccs__ScatterWeight(newVertexPoints,
+                           vertexID,
+                           contributions,
+                           halfedgeID,
+                           atomicWeight.array);
+    }
+}
+
+static void
+ccs__CreasedCageVertexPoints_Scatter(cc_Subd *subd, cc_VertexPoint *contributions)
+{
+    const ccs__ScatterTask task = {
+        {&ccs__CreasedCageVertexPoints_ScatterRange, subd, 0, false, NULL},
+        contributions
+    };
+
+    ccs__ParallelScatter(&task, ccm_HalfedgeCount(subd->cage), subd->parallelGrain);
+}
+
+
+/*******************************************************************************
+ * CageVertexPoints_Rings -- Vertex rules on the cage mesh using the one-rings
+ *
+ * Same as the "Gather" routines above, except that the halfedges around each
+ * vertex are read contiguously from the cage one-rings of the subd.
+ *
+ */
+static void
+ccs__CageVertexPoints_GatherRingsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const cc_Mesh *cage = subd->cage;
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_Index *ringOffsets = subd->cageRingOffsets;
+    const cc_Index *ringHalfedgeIDs = subd->cageRingHalfedgeIDs;
+    const int32_t *valences = nextLevel.vertexValences;
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        const cc_Index ringBegin = ringOffsets[vertexID];
+        const cc_Index ringEnd = ringOffsets[vertexID + 1];
+        const cc_VertexPoint oldVertexPoint = ccm_VertexPoint(cage, vertexID);
+        const cc_Real valence = (cc_Real)(ringEnd - ringBegin);
+        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+        cc_Real tmp1[3], tmp2[3];
+
+        for (cc_Index ringID = ringBegin; ringID < ringEnd; ++ringID) {
+            const cc_Index halfedgeID = ringHalfedgeIDs[ringID];
+            const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+            const cc_Index faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+            const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+            const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+
+            cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+            cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+            if (ringID == ringBegin) {
+                cc__Add3f(smoothPoint.array, tmp1, tmp2);
+            } else {
+                cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+                cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+            }
+        }
+
+        cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
+        cc__Mul3f(tmp2, oldVertexPoint.array, 1.0f - 3.0f / valence);
+        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+        cc__Lerp3f(newVertexPoints[vertexID].array,
+                   oldVertexPoint.array,
+                   smoothPoint.array,
+                   valences[vertexID] < 0 ? 0.0f : 1.0f);
+    }
+}
+
+static void ccs__CageVertexPoints_GatherRings(cc_Subd *subd)
+{
+    const ccs__RangeTask task = {&ccs__CageVertexPoints_GatherRingsRange, subd, 0, false, NULL};
+
+    ccs__ParallelRange(&task, ccm_VertexCount(subd->cage), subd->parallelGrain);
+}
+
+static void
+ccs__CreasedCageVertexPoints_GatherRingsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const cc_Mesh *cage = subd->cage;
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_Index *ringOffsets = subd->cageRingOffsets;
+    const cc_Index *ringHalfedgeIDs = subd->cageRingHalfedgeIDs;
+    const int32_t *valences = nextLevel.vertexValences;
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        const cc_Index ringBegin = ringOffsets[vertexID];
+        const cc_Index ringEnd = ringOffsets[vertexID + 1];
+        const cc_VertexPoint oldPoint = ccm_VertexPoint(cage, vertexID);
+        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
+        cc_Real avgS = 0.0f;
+        cc_Real creaseCount = 0.0f;
+        cc_Real valence = (cc_Real)(ringEnd - ringBegin);
+        cc_Real tmp1[3], tmp2[3];
+
+        for (cc_Index ringID = ringBegin; ringID < ringEnd; ++ringID) {
+            const cc_Index prevID = ccm_HalfedgePrevID(cage, ringHalfedgeIDs[ringID]);
+            const cc_Index prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
+            const cc_Index prevFaceID = ccm_HalfedgeFaceID(cage, prevID);
+            const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
+            const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
+            const cc_Real prevS = ccm_HalfedgeSharpness(cage, prevID);
+            const cc_Real prevCreaseWeight = cc__Signf(prevS);
+
+            // smooth contrib
+            cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
+            cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
+            if (ringID == ringBegin) {
+                cc__Add3f(smoothPoint.array, tmp1, tmp2);
+            } else {
+                cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+                cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+            }
+
+            // crease contrib
+            cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
+            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+            avgS+= prevS;
+            creaseCount+= prevCreaseWeight;
+        }
+
+        // boundary corrections
+        if (valences[vertexID] < 0) {
+            const cc_Index halfedgeID = ringHalfedgeIDs[ringBegin];
+            const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+            const cc_Real creaseWeight =
+                cc__Signf(ccm_HalfedgeSharpness(cage, halfedgeID));
+
+            cc__Mul3f(tmp1, newEdgePoints[edgeID].array, creaseWeight);
+            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+            creaseCount+= creaseWeight;
+            ++valence;
+        }
+
+        // smooth point
+        cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
+        cc__Mul3f(tmp2, oldPoint.array, 1.0f - 3.0f / valence);
+        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+        // crease point
+        cc__Mul3f(tmp1, creasePoint.array, 0.25f);
+        cc__Mul3f(tmp2, oldPoint.array, 0.5f);
+        cc__Add3f(creasePoint.array, tmp1, tmp2);
+
+        // proper vertex rule selection
+        if (creaseCount <= 1.0f) {
+            newVertexPoints[vertexID] = smoothPoint;
+        } else if (creaseCount >= 3.0f || valence == 2.0f) {
+            newVertexPoints[vertexID] = oldPoint;
+        } else {
+            cc__Lerp3f(newVertexPoints[vertexID].array,
+                       oldPoint.array,
+                       creasePoint.array,
+                       cc__Satf(avgS * 0.5f));
+        }
+    }
+}
+
+static void ccs__CreasedCageVertexPoints_GatherRings(cc_Subd *subd)
+{
+    const ccs__RangeTask task = {&ccs__CreasedCageVertexPoints_GatherRingsRange, subd, 0, false, NULL};
+
+    ccs__ParallelRange(&task, ccm_VertexCount(subd->cage), subd->parallelGrain);
+}
+
+
+#ifdef CC__SIMD_X86
+/*******************************************************************************
+ * SimdWidth -- Returns the number of lanes supported by the vector kernels
+ *
+ * The vector kernels process consecutive vertices/edges/faces in groups of
+ * 4 (AVX2) or 8 (AVX-512) lanes and gather the AoS vertex points on the fly.
+ * Each lane performs the same sequence of operations as the scalar kernels,
+ * so both paths produce the same results. The CPU is queried once at runtime.
+ *
+ */
+static int32_t cc__SimdWidth(void)
+{
+    static int32_t width = 0;
+
+    if (width == 0) {
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f")) {
+            width = 8;
+        } else if (__builtin_cpu_supports("avx2")) {
+            width = 4;
+        } else {
+            width = 1;
+        }
+    }
+
+    return width;
+}
+
+// the gathers use 32-bit offsets so make sure the level data is addressable
+static bool ccs__IsSimdCompatible(const cc_SubdLevel *level)
+{
+    const int64_t halfedgeStride = sizeof(cc_Halfedge_SemiRegular) / sizeof(int32_t);
+    const int64_t halfedgeCount = ccl_HalfedgeCount(level);
+    const int64_t nextVertexCount = (int64_t)ccl_VertexCount(level)
+                                  + (int64_t)ccl_FaceCount(level)
+                                  + (int64_t)ccl_EdgeCount(level);
+
+    return halfedgeCount * halfedgeStride <= INT32_MAX
+        && nextVertexCount * 3 <= INT32_MAX;
+}
+
+
+/*******************************************************************************
+ * AVX2 gather / store routines
+ *
+ */
+__attribute__((target("avx2"))) static __m128i
+ccl__HalfedgeField_Avx2(
+    const cc_SubdLevel *level,
+    __m128i halfedgeIDs,
+    size_t fieldOffset
+) {
+    const int32_t stride = sizeof(cc_Halfedge_SemiRegular) / sizeof(int32_t);
+    const int32_t *base = (const int32_t *)((const char *)level->halfedges + fieldOffset);
+    const __m128i offsets = _mm_mullo_epi32(halfedgeIDs, _mm_set1_epi32(stride));
+
+    return _mm_i32gather_epi32(base, offsets, 4);
+}
+
+__attribute__((target("avx2"))) static __m128i
+ccl__HalfedgeTwinID_Avx2(const cc_SubdLevel *level, __m128i halfedgeIDs)
+{
+    return ccl__HalfedgeField_Avx2(level,
+                                   halfedgeIDs,
+                                   offsetof(cc_Halfedge_SemiRegular, twinID));
+}
+
+__attribute__((target("avx2"))) static __m128i
+ccl__HalfedgeEdgeID_Avx2(const cc_SubdLevel *level, __m128i halfedgeIDs)
+{
+    return ccl__HalfedgeField_Avx2(level,
+                                   halfedgeIDs,
+                                   offsetof(cc_Halfedge_SemiRegular, edgeID));
+}
+
+__attribute__((target("avx2"))) static __m128i
+ccl__HalfedgeVertexID_Avx2(const cc_SubdLevel *level, __m128i halfedgeIDs)
+{
+    return ccl__HalfedgeField_Avx2(level,
+                                   halfedgeIDs,
+                                   offsetof(cc_Halfedge_SemiRegular, vertexID));
+}
+
+__attribute__((target("avx2"))) static __m128i
+cc__ScrollFaceHalfedgeID_Quad_Avx2(__m128i halfedgeIDs, int32_t direction)
+{
+    const __m128i base = _mm_set1_epi32(3);
+    const __m128i localIDs = _mm_add_epi32(_mm_and_si128(halfedgeIDs, base),
+                                           _mm_set1_epi32(direction));
+
+    return _mm_or_si128(_mm_andnot_si128(base, halfedgeIDs),
+                        _mm_and_si128(localIDs, base));
+}
+
+__attribute__((target("avx2"))) static void
+cc__LoadPoints_Avx2(const cc_VertexPoint *points, __m128i pointIDs, __m256d *out)
+{
+    const double *base = points->array;
+    const __m128i offsets = _mm_mullo_epi32(pointIDs, _mm_set1_epi32(3));
+
+    out[0] = _mm256_i32gather_pd(base + 0, offsets, 8);
+    out[1] = _mm256_i32gather_pd(base + 1, offsets, 8);
+    out[2] = _mm256_i32gather_pd(base + 2, offsets, 8);
+}
+
+__attribute__((target("avx2"))) static void
+cc__StorePoints_Avx2(cc_VertexPoint *points, const __m256d *in)
+{
+    double tmp[3][4];
+
+    for (int32_t i = 0; i < 3; ++i) {
+        _mm256_storeu_pd(tmp[i], in[i]);
+    }
+
+    for (int32_t laneID = 0; laneID < 4; ++laneID) {
+        for (int32_t i = 0; i < 3; ++i) {
+            points[laneID].array[i] = tmp[i][laneID];
+        }
+    }
+}
+
+// converts a 32-bit lane mask into a 64-bit lane mask
+__attribute__((target("avx2"))) static __m256d cc__WideMask_Avx2(__m128i mask)
+{
+    return _mm256_castsi256_pd(_mm256_cvtepi32_epi64(mask));
+}
+
+
+/*******************************************************************************
+ * AVX2 kernels
+ *
+ * Each routine processes the largest multiple of 4 elements of the range
+ * [begin, end), where begin is a multiple of 4, and returns the end of the
+ * elements it processed.
+ *
+ */
+__attribute__((target("avx2"))) static int32_t
+ccs__FacePoints_Gather_Avx2(
+    const cc_SubdLevel *level,
+    cc_VertexPoint *newFacePoints,
+    cc_Index begin,
+    cc_Index end
+) {
+    const int32_t blockEnd = end / 4;
+
+    for (int32_t blockID = begin / 4; blockID < blockEnd; ++blockID) {
+        const __m128i faceIDs = _mm_add_epi32(_mm_set1_epi32(4 * blockID),
+                                              _mm_setr_epi32(0, 1, 2, 3));
+        const __m128i halfedgeIDs = _mm_slli_epi32(faceIDs, 2);
+        __m256d newFacePoint[3], vertexPoint[3];
+
+        cc__LoadPoints_Avx2(level->vertexPoints,
+                            ccl__HalfedgeVertexID_Avx2(level, halfedgeIDs),
+                            newFacePoint);
+
+        for (int32_t halfedgeIt = 1; halfedgeIt < 4; ++halfedgeIt) {
+            const __m128i halfedgeItIDs =
+                    _mm_add_epi32(halfedgeIDs, _mm_set1_epi32(halfedgeIt));
+
+            cc__LoadPoints_Avx2(level->vertexPoints,
+                                ccl__HalfedgeVertexID_Avx2(level, halfedgeItIDs),
+                                vertexPoint);
+
+            for (int32_t i = 0; i < 3; ++i) {
+                newFacePoint[i] = _mm256_add_pd(newFacePoint[i], vertexPoint[i]);
+            }
+        }
+
+        for (int32_t i = 0; i < 3; ++i) {
+            newFacePoint[i] = _mm256_mul_pd(newFacePoint[i], _mm256_set1_pd(0.25));
+        }
+
+        cc__StorePoints_Avx2(&newFacePoints[4 * blockID], newFacePoint);
+    }
+
+    return 4 * blockEnd;
+}
+
+__attribute__((target("avx2"))) static int32_t
+ccs__EdgePoints_Gather_Avx2(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    cc_VertexPoint *newEdgePoints,
+    cc_Index begin,
+    cc_Index end
+) {
+    const int32_t blockEnd = end / 4;
+
+    for (int32_t blockID = begin / 4; blockID < blockEnd; ++blockID) {
+        int32_t edgeHalfedgeIDs[4];
+
+        for (int32_t laneID = 0; laneID < 4; ++laneID) {
+            edgeHalfedgeIDs[laneID] =
+                    ccl_EdgeToHalfedgeID(level, 4 * blockID + laneID);
+        }
+
+        const __m128i halfedgeIDs = _mm_loadu_si128((const __m128i *)edgeHalfedgeIDs);
+        const __m128i twinIDs = ccl__HalfedgeTwinID_Avx2(level, halfedgeIDs);
+        const __m128i nextIDs = cc__ScrollFaceHalfedgeID_Quad_Avx2(halfedgeIDs, +1);
+        const __m128i isSmooth = _mm_cmpgt_epi32(twinIDs, _mm_set1_epi32(-1));
+        const __m256d edgeWeight = _mm256_and_pd(cc__WideMask_Avx2(isSmooth),
+                                                 _mm256_set1_pd(1.0));
+        __m256d oldEdgePoints[2][3], newAdjacentFacePoints[2][3];
+        __m256d newEdgePoint[3];
+
+        cc__LoadPoints_Avx2(level->vertexPoints,
+                            ccl__HalfedgeVertexID_Avx2(level, halfedgeIDs),
+                            oldEdgePoints[0]);
+        cc__LoadPoints_Avx2(level->vertexPoints,
+                            ccl__HalfedgeVertexID_Avx2(level, nextIDs),
+                            oldEdgePoints[1]);
+        cc__LoadPoints_Avx2(newFacePoints,
+                            _mm_srai_epi32(halfedgeIDs, 2),
+                            newAdjacentFacePoints[0]);
+        cc__LoadPoints_Avx2(newFacePoints,
+                            _mm_srai_epi32(_mm_max_epi32(twinIDs, _mm_setzero_si128()), 2),
+                            newAdjacentFacePoints[1]);
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const __m256d tmp1 = _mm256_add_pd(oldEdgePoints[0][i],
+                                               oldEdgePoints[1][i]);
+            const __m256d tmp2 = _mm256_add_pd(newAdjacentFacePoints[0][i],
+                                               newAdjacentFacePoints[1][i]);
+            const __m256d sharpEdgePoint = _mm256_mul_pd(tmp1, _mm256_set1_pd(0.5));
+            const __m256d smoothEdgePoint = _mm256_mul_pd(_mm256_add_pd(tmp1, tmp2),
+                                                          _mm256_set1_pd(0.25));
+            const __m256d delta = _mm256_sub_pd(smoothEdgePoint, sharpEdgePoint);
+
+            newEdgePoint[i] = _mm256_add_pd(sharpEdgePoint,
+                                            _mm256_mul_pd(edgeWeight, delta));
+        }
+
+        cc__StorePoints_Avx2(&newEdgePoints[4 * blockID], newEdgePoint);
+    }
+
+    return 4 * blockEnd;
+}
+
+__attribute__((target("avx2"))) static int32_t
+ccs__VertexPoints_Gather_Avx2(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    cc_VertexPoint *newVertexPoints,
+    cc_Index begin,
+    cc_Index end
+) {
+    const int32_t blockEnd = end / 4;
+
+    for (int32_t blockID = begin / 4; blockID < blockEnd; ++blockID) {
+        const __m128i vertexIDs = _mm_add_epi32(_mm_set1_epi32(4 * blockID),
+                                                _mm_setr_epi32(0, 1, 2, 3));
+        const __m256d one = _mm256_set1_pd(1.0);
+        int32_t vertexHalfedgeIDs[4];
+        __m256d newEdgePoint[3], newFacePoint[3], oldVertexPoint[3];
+        __m256d smoothPoint[3], newVertexPoint[3];
+        __m256d valence = one;
+
+        for (int32_t laneID = 0; laneID < 4; ++laneID) {
+            vertexHalfedgeIDs[laneID] =
+                    ccl_VertexToHalfedgeID(level, 4 * blockID + laneID);
+        }
+
+        const __m128i halfedgeIDs = _mm_loadu_si128((const __m128i *)vertexHalfedgeIDs);
+
+        cc__LoadPoints_Avx2(newEdgePoints,
+                            ccl__HalfedgeEdgeID_Avx2(level, halfedgeIDs),
+                            newEdgePoint);
+        cc__LoadPoints_Avx2(newFacePoints,
+                            _mm_srai_epi32(halfedgeIDs, 2),
+                            newFacePoint);
+        cc__LoadPoints_Avx2(level->vertexPoints, vertexIDs, oldVertexPoint);
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const __m256d tmp1 = _mm256_mul_pd(newFacePoint[i], _mm256_set1_pd(-1.0));
+            const __m256d tmp2 = _mm256_mul_pd(newEdgePoint[i], _mm256_set1_pd(+4.0));
+
+            smoothPoint[i] = _mm256_add_pd(tmp1, tmp2);
+        }
+
+        // each lane walks its own one-ring; finished lanes are masked out
+        __m128i iterators = ccl__HalfedgeTwinID_Avx2(
+            level, cc__ScrollFaceHalfedgeID_Quad_Avx2(halfedgeIDs, -1)
+        );
+        __m128i isActive = _mm_andnot_si128(
+            _mm_cmpeq_epi32(iterators, halfedgeIDs),
+            _mm_cmpgt_epi32(iterators, _mm_set1_epi32(-1))
+        );
+
+        while (_mm_movemask_epi8(isActive) != 0) {
+            const __m128i safeIterators = _mm_max_epi32(iterators,
+                                                        _mm_setzero_si128());
+            const __m256d mask = cc__WideMask_Avx2(isActive);
+            const __m128i nextIterators = ccl__HalfedgeTwinID_Avx2(
+                level, cc__ScrollFaceHalfedgeID_Quad_Avx2(safeIterators, -1)
+            );
+
+            cc__LoadPoints_Avx2(newEdgePoints,
+                                ccl__HalfedgeEdgeID_Avx2(level, safeIterators),
+                                newEdgePoint);
+            cc__LoadPoints_Avx2(newFacePoints,
+                                _mm_srai_epi32(safeIterators, 2),
+                                newFacePoint);
+
+            for (int32_t i = 0; i < 3; ++i) {
+                const __m256d tmp1 = _mm256_mul_pd(newFacePoint[i], _mm256_set1_pd(-1.0));
+                const __m256d tmp2 = _mm256_mul_pd(newEdgePoint[i], _mm256_set1_pd(+4.0));
+                const __m256d tmp = _mm256_add_pd(_mm256_add_pd(smoothPoint[i], tmp1),
+                                                  tmp2);
+
+                smoothPoint[i] = _mm256_blendv_pd(smoothPoint[i], tmp, mask);
+            }
+            valence = _mm256_blendv_pd(valence, _mm256_add_pd(valence, one), mask);
+
+            iterators = _mm_blendv_epi8(iterators, nextIterators, isActive);
+            isActive = _mm_and_si128(isActive, _mm_andnot_si128(
+                _mm_cmpeq_epi32(iterators, halfedgeIDs),
+                _mm_cmpgt_epi32(iterators, _mm_set1_epi32(-1))
+            ));
+        }
+
+        const __m256d vertexWeight = _mm256_and_pd(
+            cc__WideMask_Avx2(_mm_cmpeq_epi32(iterators, halfedgeIDs)),
+            one
+        );
+        const __m256d smoothWeight = _mm256_div_pd(one, _mm256_mul_pd(valence, valence));
+        const __m256d oldWeight = _mm256_sub_pd(one, _mm256_div_pd(_mm256_set1_pd(3.0),
+                                                                   valence));
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const __m256d tmp1 = _mm256_mul_pd(smoothPoint[i], smoothWeight);
+            const __m256d tmp2 = _mm256_mul_pd(oldVertexPoint[i], oldWeight);
+            const __m256d delta = _mm256_sub_pd(_mm256_add_pd(tmp1, tmp2),
+                                                oldVertexPoint[i]);
+
+            newVertexPoint[i] = _mm256_add_pd(oldVertexPoint[i],
+                                              _mm256_mul_pd(vertexWeight, delta));
+        }
+
+        cc__StorePoints_Avx2(&newVertexPoints[4 * blockID], newVertexPoint);
+    }
+
+    return 4 * blockEnd;
+}
+
+
+/*******************************************************************************
+ * AVX-512 gather / store routines
+ *
+ */
+__attribute__((target("avx512f"))) static __m256i
+ccl__HalfedgeField_Avx512(
+    const cc_SubdLevel *level,
+    __m256i halfedgeIDs,
+    size_t fieldOffset
+) {
+    const int32_t stride = sizeof(cc_Halfedge_SemiRegular) / sizeof(int32_t);
+    const int32_t *base = (const int32_t *)((const char *)level->halfedges + fieldOffset);
+    const __m256i offsets = _mm256_mullo_epi32(halfedgeIDs, _mm256_set1_epi32(stride));
+
+    return _mm256_i32gather_epi32(base, offsets, 4);
+}
+
+__attribute__((target("avx512f"))) static __m256i
+ccl__HalfedgeTwinID_Avx512(const cc_SubdLevel *level, __m256i halfedgeIDs)
+{
+    return ccl__HalfedgeField_Avx512(level,
+                                     halfedgeIDs,
+                                     offsetof(cc_Halfedge_SemiRegular, twinID));
+}
+
+__attribute__((target("avx512f"))) static __m256i
+ccl__HalfedgeEdgeID_Avx512(const cc_SubdLevel *level, __m256i halfedgeIDs)
+{
+    return ccl__HalfedgeField_Avx512(level,
+                                     halfedgeIDs,
+                                     offsetof(cc_Halfedge_SemiRegular, edgeID));
+}
+
+__attribute__((target("avx512f"))) static __m256i
+ccl__HalfedgeVertexID_Avx512(const cc_SubdLevel *level, __m256i halfedgeIDs)
+{
+    return ccl__HalfedgeField_Avx512(level,
+                                     halfedgeIDs,
+                                     offsetof(cc_Halfedge_SemiRegular, vertexID));
+}
+
+__attribute__((target("avx512f"))) static __m256i
+cc__ScrollFaceHalfedgeID_Quad_Avx512(__m256i halfedgeIDs, int32_t direction)
+{
+    const __m256i base = _mm256_set1_epi32(3);
+    const __m256i localIDs = _mm256_add_epi32(_mm256_and_si256(halfedgeIDs, base),
+                                              _mm256_set1_epi32(direction));
+
+    return _mm256_or_si256(_mm256_andnot_si256(base, halfedgeIDs),
+                           _mm256_and_si256(localIDs, base));
+}
+
+__attribute__((target("avx512f"))) static void
+cc__LoadPoints_Avx512(const cc_VertexPoint *points, __m256i pointIDs, __m512d *out)
+{
+    const double *base = points->array;
+    const __m256i offsets = _mm256_mullo_epi32(pointIDs, _mm256_set1_epi32(3));
+
+    out[0] = _mm512_i32gather_pd(offsets, base + 0, 8);
+    out[1] = _mm512_i32gather_pd(offsets, base + 1, 8);
+    out[2] = _mm512_i32gather_pd(offsets, base + 2, 8);
+}
+
+__attribute__((target("avx512f"))) static void
+cc__StorePoints_Avx512(cc_VertexPoint *points, const __m512d *in)
+{
+    double tmp[3][8];
+
+    for (int32_t i = 0; i < 3; ++i) {
+        _mm512_storeu_pd(tmp[i], in[i]);
+    }
+
+    for (int32_t laneID = 0; laneID < 8; ++laneID) {
+        for (int32_t i = 0; i < 3; ++i) {
+            points[laneID].array[i] = tmp[i][laneID];
+        }
+    }
+}
+
+// converts a 32-bit lane mask into an AVX-512 mask register
+__attribute__((target("avx512f"))) static __mmask8 cc__Mask_Avx512(__m256i mask)
+{
+    return (__mmask8)_mm256_movemask_ps(_mm256_castsi256_ps(mask));
+}
+
+
+/*******************************************************************************
+ * AVX-512 kernels
+ *
+ * Each routine processes the largest multiple of 8 elements of the range
+ * [begin, end), where begin is a multiple of 8, and returns the end of the
+ * elements it processed.
+ *
+ */
+__attribute__((target("avx512f"))) static int32_t
+ccs__FacePoints_Gather_Avx512(
+    const cc_SubdLevel *level,
+    cc_VertexPoint *newFacePoints,
+    cc_Index begin,
+    cc_Index end
+) {
+    const int32_t blockEnd = end / 8;
+
+    for (int32_t blockID = begin / 8; blockID < blockEnd; ++blockID) {
+        const __m256i faceIDs = _mm256_add_epi32(_mm256_set1_epi32(8 * blockID),
+                                                 _mm256_setr_epi32(0, 1, 2, 3,
+                                                                   4, 5, 6, 7));
+        const __m256i halfedgeIDs = _mm256_slli_epi32(faceIDs, 2);
+        __m512d newFacePoint[3], vertexPoint[3];
+
+        cc__LoadPoints_Avx512(level->vertexPoints,
+                              ccl__HalfedgeVertexID_Avx512(level, halfedgeIDs),
+                              newFacePoint);
+
+        for (int32_t halfedgeIt = 1; halfedgeIt < 4; ++halfedgeIt) {
+            const __m256i halfedgeItIDs =
+                    _mm256_add_epi32(halfedgeIDs, _mm256_set1_epi32(halfedgeIt));
+
+            cc__LoadPoints_Avx512(level->vertexPoints,
+                                  ccl__HalfedgeVertexID_Avx512(level, halfedgeItIDs),
+                                  vertexPoint);
+
+            for (int32_t i = 0; i < 3; ++i) {
+                newFacePoint[i] = _mm512_add_pd(newFacePoint[i], vertexPoint[i]);
+            }
+        }
+
+        for (int32_t i = 0; i < 3; ++i) {
+            newFacePoint[i] = _mm512_mul_pd(newFacePoint[i], _mm512_set1_pd(0.25));
+        }
+
+        cc__StorePoints_Avx512(&newFacePoints[8 * blockID], newFacePoint);
+    }
+
+    return 8 * blockEnd;
+}
+
+__attribute__((target("avx512f"))) static int32_t
+ccs__EdgePoints_Gather_Avx512(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    cc_VertexPoint *newEdgePoints,
+    cc_Index begin,
+    cc_Index end
+) {
+    const int32_t blockEnd = end / 8;
+
+    for (int32_t blockID = begin / 8; blockID < blockEnd; ++blockID) {
+        int32_t edgeHalfedgeIDs[8];
+
+        for (int32_t laneID = 0; laneID < 8; ++laneID) {
+            edgeHalfedgeIDs[laneID] =
+                    ccl_EdgeToHalfedgeID(level, 8 * blockID + laneID);
+        }
+
+        const __m256i halfedgeIDs = _mm256_loadu_si256((const __m256i *)edgeHalfedgeIDs);
+        const __m256i twinIDs = ccl__HalfedgeTwinID_Avx512(level, halfedgeIDs);
+        const __m256i nextIDs = cc__ScrollFaceHalfedgeID_Quad_Avx512(halfedgeIDs, +1);
+        const __mmask8 isSmooth = cc__Mask_Avx512(
+            _mm256_cmpgt_epi32(twinIDs, _mm256_set1_epi32(-1))
+        );
+        const __m512d edgeWeight = _mm512_mask_blend_pd(isSmooth,
+                                                        _mm512_setzero_pd(),
+                                                        _mm512_set1_pd(1.0));
+        __m512d oldEdgePoints[2][3], newAdjacentFacePoints[2][3];
+        __m512d newEdgePoint[3];
+
+        cc__LoadPoints_Avx512(level->vertexPoints,
+                              ccl__HalfedgeVertexID_Avx512(level, halfedgeIDs),
+                              oldEdgePoints[0]);
+        cc__LoadPoints_Avx512(level->vertexPoints,
+                              ccl__HalfedgeVertexID_Avx512(level, nextIDs),
+                              oldEdgePoints[1]);
+        cc__LoadPoints_Avx512(newFacePoints,
+                              _mm256_srai_epi32(halfedgeIDs, 2),
+                              newAdjacentFacePoints[0]);
+        cc__LoadPoints_Avx512(newFacePoints,
+                              _mm256_srai_epi32(_mm256_max_epi32(twinIDs,
+                                                                 _mm256_setzero_si256()),
+                                                2),
+                              newAdjacentFacePoints[1]);
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const __m512d tmp1 = _mm512_add_pd(oldEdgePoints[0][i],
+                                               oldEdgePoints[1][i]);
+            const __m512d tmp2 = _mm512_add_pd(newAdjacentFacePoints[0][i],
+                                               newAdjacentFacePoints[1][i]);
+            const __m512d sharpEdgePoint = _mm512_mul_pd(tmp1, _mm512_set1_pd(0.5));
+            const __m512d smoothEdgePoint = _mm512_mul_pd(_mm512_add_pd(tmp1, tmp2),
+                                                          _mm512_set1_pd(0.25));
+            const __m512d delta = _mm512_sub_pd(smoothEdgePoint, sharpEdgePoint);
+
+            newEdgePoint[i] = _mm512_add_pd(sharpEdgePoint,
+                                            _mm512_mul_pd(edgeWeight, delta));
+        }
+
+        cc__StorePoints_Avx512(&newEdgePoints[8 * blockID], newEdgePoint);
+    }
+
+    return 8 * blockEnd;
+}
+
+__attribute__((target("avx512f"))) static int32_t
+ccs__VertexPoints_Gather_Avx512(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    cc_VertexPoint *newVertexPoints,
+    cc_Index begin,
+    cc_Index end
+) {
+    const int32_t blockEnd = end / 8;
+
+    for (int32_t blockID = begin / 8; blockID < blockEnd; ++blockID) {
+        const __m256i vertexIDs = _mm256_add_epi32(_mm256_set1_epi32(8 * blockID),
+                                                   _mm256_setr_epi32(0, 1, 2, 3,
+                                                                     4, 5, 6, 7));
+        const __m512d one = _mm512_set1_pd(1.0);
+        int32_t vertexHalfedgeIDs[8];
+        __m512d newEdgePoint[3], newFacePoint[3], oldVertexPoint[3];
+        __m512d smoothPoint[3], newVertexPoint[3];
+        __m512d valence = one;
+
+        for (int32_t laneID = 0; laneID < 8; ++laneID) {
+            vertexHalfedgeIDs[laneID] =
+                    ccl_VertexToHalfedgeID(level, 8 * blockID + laneID);
+        }
+
+        const __m256i halfedgeIDs = _mm256_loadu_si256((const __m256i *)vertexHalfedgeIDs);
+
+        cc__LoadPoints_Avx512(newEdgePoints,
+                              ccl__HalfedgeEdgeID_Avx512(level, halfedgeIDs),
+                              newEdgePoint);
+        cc__LoadPoints_Avx512(newFacePoints,
+                              _mm256_srai_epi32(halfedgeIDs, 2),
+                              newFacePoint);
+        cc__LoadPoints_Avx512(level->vertexPoints, vertexIDs, oldVertexPoint);
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const __m512d tmp1 = _mm512_mul_pd(newFacePoint[i], _mm512_set1_pd(-1.0));
+            const __m512d tmp2 = _mm512_mul_pd(newEdgePoint[i], _mm512_set1_pd(+4.0));
+
+            smoothPoint[i] = _mm512_add_pd(tmp1, tmp2);
+        }
+
+        // each lane walks its own one-ring; finished lanes are masked out
+        __m256i iterators = ccl__HalfedgeTwinID_Avx512(
+            level, cc__ScrollFaceHalfedgeID_Quad_Avx512(halfedgeIDs, -1)
+        );
+        __m256i isActive = _mm256_andnot_si256(
+            _mm256_cmpeq_epi32(iterators, halfedgeIDs),
+            _mm256_cmpgt_epi32(iterators, _mm256_set1_epi32(-1))
+        );
+
+        while (_mm256_movemask_epi8(isActive) != 0) {
+            const __m256i safeIterators = _mm256_max_epi32(iterators,
+                                                           _mm256_setzero_si256());
+            const __mmask8 mask = cc__Mask_Avx512(isActive);
+            const __m256i nextIterators = ccl__HalfedgeTwinID_Avx512(
+                level, cc__ScrollFaceHalfedgeID_Quad_Avx512(safeIterators, -1)
+            );
+
+            cc__LoadPoints_Avx512(newEdgePoints,
+                                  ccl__HalfedgeEdgeID_Avx512(level, safeIterators),
+                                  newEdgePoint);
+            cc__LoadPoints_Avx512(newFacePoints,
+                                  _mm256_srai_epi32(safeIterators, 2),
+                                  newFacePoint);
+
+            for (int32_t i = 0; i < 3; ++i) {
+                const __m512d tmp1 = _mm512_mul_pd(newFacePoint[i], _mm512_set1_pd(-1.0));
+                const __m512d tmp2 = _mm512_mul_pd(newEdgePoint[i], _mm512_set1_pd(+4.0));
+                const __m512d tmp = _mm512_add_pd(_mm512_add_pd(smoothPoint[i], tmp1),
+                                                  tmp2);
+
+                smoothPoint[i] = _mm512_mask_blend_pd(mask, smoothPoint[i], tmp);
+            }
+            valence = _mm512_mask_blend_pd(mask, valence, _mm512_add_pd(valence, one));
+
+            iterators = _mm256_blendv_epi8(iterators, nextIterators, isActive);
+            isActive = _mm256_and_si256(isActive, _mm256_andnot_si256(
+                _mm256_cmpeq_epi32(iterators, halfedgeIDs),
+                _mm256_cmpgt_epi32(iterators, _mm256_set1_epi32(-1))
+            ));
+        }
+
+        const __m512d vertexWeight = _mm512_mask_blend_pd(
+            cc__Mask_Avx512(_mm256_cmpeq_epi32(iterators, halfedgeIDs)),
+            _mm512_setzero_pd(),
+            one
+        );
+        const __m512d smoothWeight = _mm512_div_pd(one, _mm512_mul_pd(valence, valence));
+        const __m512d oldWeight = _mm512_sub_pd(one, _mm512_div_pd(_mm512_set1_pd(3.0),
+                                                                   valence));
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const __m512d tmp1 = _mm512_mul_pd(smoothPoint[i], smoothWeight);
+            const __m512d tmp2 = _mm512_mul_pd(oldVertexPoint[i], oldWeight);
+            const __m512d delta = _mm512_sub_pd(_mm512_add_pd(tmp1, tmp2),
+                                                oldVertexPoint[i]);
+
+            newVertexPoint[i] = _mm512_add_pd(oldVertexPoint[i],
+                                              _mm512_mul_pd(vertexWeight, delta));
+        }
+
+        cc__StorePoints_Avx512(&newVertexPoints[8 * blockID], newVertexPoint);
+    }
+
+    return 8 * blockEnd;
+}
+
+
+/*******************************************************************************
+ * Vector kernel dispatch -- Returns the number of elements processed
+ *
+ */
+// vector kernels process aligned ranges only, which is what the backends
+// produce when they split the elements at multiples of the grain
+static bool ccs__IsSimdRange(const cc_SubdLevel *level, cc_Index begin)
+{
+    return ccs__IsSimdCompatible(level) && begin % cc__SimdWidth() == 0;
+}
+
+static int32_t
+ccs__FacePoints_Gather_Simd(
+    const cc_SubdLevel *level,
+    cc_VertexPoint *newFacePoints,
+    cc_Index begin,
+    cc_Index end
+) {
+    if (!ccs__IsSimdRange(level, begin)) {
+        return begin;
+    }
+
+    switch (cc__SimdWidth()) {
+    case 8: return ccs__FacePoints_Gather_Avx512(level, newFacePoints, begin, end);
+    case 4: return ccs__FacePoints_Gather_Avx2(level, newFacePoints, begin, end);
+    default: return begin;
+    }
+}
+
+static int32_t
+ccs__EdgePoints_Gather_Simd(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    cc_VertexPoint *newEdgePoints,
+    cc_Index begin,
+    cc_Index end
+) {
+    if (!ccs__IsSimdRange(level, begin)) {
+        return begin;
+    }
+
+    switch (cc__SimdWidth()) {
+    case 8:
+        return ccs__EdgePoints_Gather_Avx512(level, newFacePoints, newEdgePoints, begin, end);
+    case 4:
+        return ccs__EdgePoints_Gather_Avx2(level, newFacePoints, newEdgePoints, begin, end);
+    default:
+        return begin;
+    }
+}
+
+static int32_t
+ccs__VertexPoints_Gather_Simd(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    cc_VertexPoint *newVertexPoints,
+    cc_Index begin,
+    cc_Index end
+) {
+    if (!ccs__IsSimdRange(level, begin)) {
+        return begin;
+    }
+
+    switch (cc__SimdWidth()) {
+    case 8:
+        return ccs__VertexPoints_Gather_Avx512(level,
+                                               newFacePoints,
+                                               newEdgePoints,
+                                               newVertexPoints,
+                                               begin,
+                                               end);
+    case 4:
+        return ccs__VertexPoints_Gather_Avx2(level,
+                                             newFacePoints,
+                                             newEdgePoints,
+                                             newVertexPoints,
+                                             begin,
+                                             end);
+    default:
+        return begin;
+    }
+}
+#endif // CC__SIMD_X86
+
+
+/*******************************************************************************
+ * FacePoints -- Applies Catmull Clark's face rule on the subd
+ *
+ * The "Gather" routine iterates over each face of the mesh and compute the
+ * resulting face vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the face vertex.
+ *
+ */
+static cc_VertexPoint ccs__FacePoint(const cc_SubdLevel *level, cc_Index faceID)
+{
+    const cc_Index halfedgeID = ccl_FaceToHalfedgeID(level, faceID);
+    cc_VertexPoint newFacePoint = ccl_HalfedgeVertexPoint(level, halfedgeID);
+
+    for (cc_Index halfedgeIt = ccl_HalfedgeNextID(level, halfedgeID);
+                 halfedgeIt != halfedgeID;
+                 halfedgeIt = ccl_HalfedgeNextID(level, halfedgeIt)) {
+        const cc_VertexPoint vertexPoint = ccl_HalfedgeVertexPoint(level, halfedgeIt);
+
+        cc__Add3f(newFacePoint.array, newFacePoint.array, vertexPoint.array);
+    }
+
+    cc__Mul3f(newFacePoint.array, newFacePoint.array, 0.25f);
+
+    return newFacePoint;
+}
+
+static void
+ccs__FacePoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+
+#ifdef CC__SIMD_X86
+    const cc_Index faceBegin = ccs__FacePoints_Gather_Simd(&level, newFacePoints, begin, end);
+#else
+    const cc_Index faceBegin = begin;
+#endif
+
+    for (cc_Index faceID = faceBegin; faceID < end; ++faceID) {
+        newFacePoints[faceID] = ccs__FacePoint(&level, faceID);
+    }
+}
+
+static void ccs__FacePoints_Gather(cc_Subd *subd, int32_t depth)
+{
+    const ccs__RangeTask task = {&ccs__FacePoints_GatherRange, subd, depth, false, NULL};
+
+    ccs__ParallelRange(&task,
+                       ccm_FaceCountAtDepth(subd->cage, depth),
+                       subd->parallelGrain);
+}
+
+static void
+ccs__FacePoints_ScatterRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    cc_VertexPoint *contributions = ((const ccs__ScatterTask *)task)->contributions;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_VertexPoint vertexPoint = ccl_HalfedgeVertexPoint(&level, halfedgeID);
+        const cc_Index faceID = ccl_HalfedgeFaceID(&level, halfedgeID);
+        cc_Real atomicWeight[3];
+
+        for (int32_t i = 0; i < 3; ++i) {
+            atomicWeight[i] = vertexPoint.array[i] / (cc_Real)4.0f;
+        }
+
+        ccs__ScatterWeight(newFacePoints, faceID, contributions, halfedgeID, atomicWeight);
+    }
+}
+
+static void
+ccs__FacePoints_Scatter(
+    cc_Subd *subd,
+    int32_t depth,
+    cc_VertexPoint *contributions
+) {
+    const ccs__ScatterTask task = {
+        {&ccs__FacePoints_ScatterRange, subd, depth, false, NULL},
+        contributions
+    };
+
+    ccs__ParallelScatter(&task,
+                        ccm_HalfedgeCountAtDepth(subd->cage, depth),
+                        subd->parallelGrain);
+}
+
+
+/*******************************************************************************
+ * EdgePoints -- Applies Catmull Clark's edge rule on the subd
+ *
+ * The "Gather" routine iterates over each edge of the mesh and compute the
+ * resulting edge vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the edge vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__EdgePoint(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    cc_Index halfedgeID
+) {
+    const cc_Index twinID = ccl_HalfedgeTwinID(level, halfedgeID);
+    const cc_Index nextID = ccl_HalfedgeNextID(level, halfedgeID);
+    const cc_Real edgeWeight = twinID < 0 ? 0.0f : 1.0f;
+    const cc_VertexPoint oldEdgePoints[2] = {
+        ccl_HalfedgeVertexPoint(level, halfedgeID),
+        ccl_HalfedgeVertexPoint(level,     nextID)
+    };
+    const cc_VertexPoint newAdjacentFacePoints[2] = {
+        newFacePoints[ccl_HalfedgeFaceID(level,         halfedgeID)],
+        newFacePoints[ccl_HalfedgeFaceID(level, cc__Max(0, twinID))]
+    };
+    cc_VertexPoint newEdgePoint;
+    cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
+    cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
+    cc_Real tmp1[3], tmp2[3];
+
+    cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
+    cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
+    cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
+    cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
+    cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
+    cc__Lerp3f(newEdgePoint.array,
+               sharpEdgePoint.array,
+               smoothEdgePoint.array,
+               edgeWeight);
+
+    return newEdgePoint;
+}
+
+static void
+ccs__EdgePoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+
+#ifdef CC__SIMD_X86
+    const cc_Index edgeBegin = ccs__EdgePoints_Gather_Simd(&level,
+                                                          newFacePoints,
+                                                          newEdgePoints,
+                                                          begin,
+                                                          end);
+#else
+    const cc_Index edgeBegin = begin;
+#endif
+
+    for (cc_Index edgeID = edgeBegin; edgeID < end; ++edgeID) {
+        const cc_Index halfedgeID = ccl_EdgeToHalfedgeID(&level, edgeID);
+
+        newEdgePoints[edgeID] = ccs__EdgePoint(&level, newFacePoints, halfedgeID);
+    }
+}
+
+static void ccs__EdgePoints_Gather(cc_Subd *subd, int32_t depth)
+{
+    const ccs__RangeTask task = {&ccs__EdgePoints_GatherRange, subd, depth, false, NULL};
+
+    ccs__ParallelRange(&task,
+                       ccm_EdgeCountAtDepth(subd->cage, depth),
+                       subd->parallelGrain);
+}
+
+static void
+ccs__EdgePoints_ScatterRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    cc_VertexPoint *contributions = ((const ccs__ScatterTask *)task)->contributions;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index faceID = ccl_HalfedgeFaceID(&level, halfedgeID);
+        const cc_Index edgeID = ccl_HalfedgeEdgeID(&level, halfedgeID);
+        const cc_Index twinID = ccl_HalfedgeTwinID(&level, halfedgeID);
+        const cc_Index nextID = ccl_HalfedgeNextID(&level, halfedgeID);
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+        cc_Real tmp1[3], tmp2[3], tmp3[3], tmp4[3], atomicWeight[3];
+        cc_Real weight = twinID >= 0 ? 0.5f : 1.0f;
+
+        cc__Mul3f(tmp1, newFacePoint.array, 0.5f);
+        cc__Mul3f(tmp2, ccl_HalfedgeVertexPoint(&level, halfedgeID).array, weight);
+        cc__Mul3f(tmp3, ccl_HalfedgeVertexPoint(&level,     nextID).array, weight);
+        cc__Lerp3f(tmp4, tmp2, tmp3, 0.5f);
+        cc__Lerp3f(atomicWeight, tmp1, tmp4, weight);
+
+        ccs__ScatterWeight(newEdgePoints, edgeID, contributions, halfedgeID, atomicWeight);
+    }
+}
+
+static void
+ccs__EdgePoints_Scatter(
+    cc_Subd *subd,
+    int32_t depth,
+    cc_VertexPoint *contributions
+) {
+    const ccs__ScatterTask task = {
+        {&ccs__EdgePoints_ScatterRange, subd, depth, false, NULL},
+        contributions
+    };
+
+    ccs__ParallelScatter(&task,
+                        ccm_HalfedgeCountAtDepth(subd->cage, depth),
+                        subd->parallelGrain);
+}
+
+/*******************************************************************************
+ * CreasedEdgePoints -- Applies DeRose et al's edge rule on the subd
+ *
+ * The "Gather" routine iterates over each edge of the mesh and compute the
+ * resulting edge vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the edge vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__CreasedEdgePoint(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    cc_Index halfedgeID
+) {
+    const cc_Index edgeID = ccl_HalfedgeEdgeID(level, halfedgeID);
+    const cc_Index twinID = ccl_HalfedgeTwinID(level, halfedgeID);
+    const cc_Index nextID = ccl_HalfedgeNextID(level, halfedgeID);
+    const cc_Real sharp = ccl_CreaseSharpness(level, edgeID);
+    const cc_Real edgeWeight = cc__Satf(sharp);
+    const cc_VertexPoint oldEdgePoints[2] = {
+        ccl_HalfedgeVertexPoint(level, halfedgeID),
+        ccl_HalfedgeVertexPoint(level,     nextID)
+    };
+    const cc_VertexPoint newAdjacentFacePoints[2] = {
+        newFacePoints[ccl_HalfedgeFaceID(level,         halfedgeID)],
+        newFacePoints[ccl_HalfedgeFaceID(level, cc__Max(0, twinID))]
+    };
+    cc_VertexPoint newEdgePoint;
+    cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
+    cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
+    cc_Real tmp1[3], tmp2[3];
+
+    cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
+    cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
+    cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
+    cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
+    cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
+    cc__Lerp3f(newEdgePoint.array,
+               smoothEdgePoint.array,
+               sharpEdgePoint.array,
+               edgeWeight);
+
+    return newEdgePoint;
+}
+
+static void
+ccs__CreasedEdgePoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+
+    for (cc_Index edgeID = begin; edgeID < end; ++edgeID) {
+        const cc_Index halfedgeID = ccl_EdgeToHalfedgeID(&level, edgeID);
+
+        newEdgePoints[edgeID] = ccs__CreasedEdgePoint(&level, newFacePoints, halfedgeID);
+    }
+}
+
+static void ccs__CreasedEdgePoints_Gather(cc_Subd *subd, int32_t depth)
+{
+    const ccs__RangeTask task = {&ccs__CreasedEdgePoints_GatherRange, subd, depth, false, NULL};
+
+    ccs__ParallelRange(&task,
+                       ccm_EdgeCountAtDepth(subd->cage, depth),
+                       subd->parallelGrain);
+}
+
+
+static void
+ccs__CreasedEdgePoints_ScatterRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    cc_VertexPoint *contributions = ((const ccs__ScatterTask *)task)->contributions;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index twinID = ccl_HalfedgeTwinID(&level, halfedgeID);
+        const cc_Index edgeID = ccl_HalfedgeEdgeID(&level, halfedgeID);
+        const cc_Index faceID = ccl_HalfedgeFaceID(&level, halfedgeID);
+        const cc_Index nextID = ccl_HalfedgeNextID(&level, halfedgeID);
+        const cc_Real sharp = ccl_CreaseSharpness(&level, edgeID);
+        const cc_Real edgeWeight = cc__Satf(sharp);
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+        const cc_VertexPoint oldEdgePoints[2] = {
+            ccl_HalfedgeVertexPoint(&level, halfedgeID),
+            ccl_HalfedgeVertexPoint(&level,     nextID)
+        };
+        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint sharpPoint = {0.0f, 0.0f, 0.0f};
+        cc_Real tmp[3], atomicWeight[3];
+
+        // sharp point
+        cc__Lerp3f(tmp, oldEdgePoints[0].array, oldEdgePoints[1].array, 0.5f);
+        cc__Mul3f(sharpPoint.array, tmp, twinID < 0 ? 1.0f : 0.5f);
+
+        // smooth point
+        cc__Lerp3f(tmp, oldEdgePoints[0].array, newFacePoint.array, 0.5f);
+        cc__Mul3f(smoothPoint.array, tmp, 0.5f);
+
+        // atomic weight
+        cc__Lerp3f(atomicWeight,
+                   smoothPoint.array,
+                   sharpPoint.array,
+                   edgeWeight);
+
+        ccs__ScatterWeight(newEdgePoints, edgeID, contributions, halfedgeID, atomicWeight);
+    }
+}
+
+static void
+ccs__CreasedEdgePoints_Scatter(
+    cc_Subd *subd,
+    int32_t depth,
+    cc_VertexPoint *contributions
+) {
+    const ccs__ScatterTask task = {
+        {&ccs__CreasedEdgePoints_ScatterRange, subd, depth, false, NULL},
+        contributions
+    };
+
+    ccs__ParallelScatter(&task,
+                        ccm_HalfedgeCountAtDepth(subd->cage, depth),
+                        subd->parallelGrain);
+}
+
+
+/*******************************************************************************
+ * VertexPoints -- Applies Catmull Clark's vertex rule on the subd
+ *
+ * The "Gather" routine iterates over each vertex of the mesh and computes the
+ * resulting smooth vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the smooth vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__VertexPoint(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    cc_Index vertexID
+) {
+    const cc_Index halfedgeID = ccl_VertexToHalfedgeID(level, vertexID);
+    const cc_Index edgeID = ccl_HalfedgeEdgeID(level, halfedgeID);
+    const cc_Index faceID = ccl_HalfedgeFaceID(level, halfedgeID);
+    const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+    const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+    const cc_VertexPoint oldVertexPoint = ccl_VertexPoint(level, vertexID);
+    cc_VertexPoint newVertexPoint;
+    cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+    cc_Real valence = 1.0f;
+    cc_Index iterator;
+    cc_Real tmp1[3], tmp2[3];
+
+    cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+    cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+    for (iterator = ccl_PrevVertexHalfedgeID(level, halfedgeID);
+         iterator >= 0 && iterator != halfedgeID;
+         iterator = ccl_PrevVertexHalfedgeID(level, iterator)) {
+        const cc_Index edgeID = ccl_HalfedgeEdgeID(level, iterator);
+        const cc_Index faceID = ccl_HalfedgeFaceID(level, iterator);
+        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+
+        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+        ++valence;
+    }
+
+    cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
+    cc__Mul3f(tmp2, oldVertexPoint.array, 1.0f - 3.0f / valence);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+    cc__Lerp3f(newVertexPoint.array,
+               oldVertexPoint.array,
+               smoothPoint.array,
+               iterator != halfedgeID ? 0.0f : 1.0f);
+
+    return newVertexPoint;
+}
+
+static void
+ccs__VertexPoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+#ifdef CC__SIMD_X86
+    const cc_Index vertexBegin = ccs__VertexPoints_Gather_Simd(&level,
+                                                              newFacePoints,
+                                                              newEdgePoints,
+                                                              newVertexPoints,
+                                                              begin,
+                                                              end);
+#else
+    const cc_Index vertexBegin = begin;
+#endif
+
+    for (cc_Index vertexID = vertexBegin; vertexID < end; ++vertexID) {
+        newVertexPoints[vertexID] =
+            ccs__VertexPoint(&level, newFacePoints, newEdgePoints, vertexID);
+    }
+}
+
+static void ccs__VertexPoints_Gather(cc_Subd *subd, int32_t depth)
+{
+    const ccs__RangeTask task = {&ccs__VertexPoints_GatherRange, subd, depth, false, NULL};
+
+    ccs__ParallelRange(&task,
+                       ccm_VertexCountAtDepth(subd->cage, depth),
+                       subd->parallelGrain);
+}
+
+static void
+ccs__VertexPoints_ScatterRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    cc_VertexPoint *contributions = ((const ccs__ScatterTask *)task)->contributions;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const int32_t *valences = level.vertexValences;
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index vertexID = ccl_HalfedgeVertexID(&level, halfedgeID);
+        const cc_Index edgeID = ccl_HalfedgeEdgeID(&level, halfedgeID);
+        const cc_Index faceID = ccl_HalfedgeFaceID(&level, halfedgeID);
+        const cc_VertexPoint oldVertexPoint = ccl_VertexPoint(&level, vertexID);
+        cc_Index valence = 1;
+        cc_Index forwardIterator, backwardIterator;
+        cc_Real atomicWeight[3];
+
+        if (valences != NULL) {
+            valence = cc__Abs(valences[vertexID]);
+            forwardIterator = valences[vertexID] < 0 ? -1 : halfedgeID;
+        } else {
+            for (forwardIterator = ccl_PrevVertexHalfedgeID(&level, halfedgeID);
+                 forwardIterator >= 0 && forwardIterator != halfedgeID;
+                 forwardIterator = ccl_PrevVertexHalfedgeID(&level, forwardIterator)) {
+                ++valence;
+            }
+
+            for (backwardIterator = ccl_NextVertexHalfedgeID(&level, halfedgeID);
+                 forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+                 backwardIterator = ccl_NextVertexHalfedgeID(&level, backwardIterator)) {
+                ++valence;
+            }
+        }
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const cc_Real w = 1.0f / (cc_Real)valence;
+            const cc_Real v = oldVertexPoint.array[i];
+            const cc_Real f = newFacePoints[faceID].array[i];
+            const cc_Real e = newEdgePoints[edgeID].array[i];
+            const cc_Real s = forwardIterator < 0 ? 0.0f : 1.0f;
+
+            atomicWeight[i] = w * (v + w * s * (4.0f * e - f - 3.0f * v));
+        }
+
+        ccs__ScatterWeight(newVertexPoints, vertexID, contributions, halfedgeID, atomicWeight);
+    }
+}
+
+static void
+ccs__VertexPoints_Scatter(
+    cc_Subd *subd,
+    int32_t depth,
+    cc_VertexPoint *contributions
+) {
+    const ccs__ScatterTask task = {
+        {&ccs__VertexPoints_ScatterRange, subd, depth, false, NULL},
+        contributions
+    };
+
+    ccs__ParallelScatter(&task,
+                        ccm_HalfedgeCountAtDepth(subd->cage, depth),
+                        subd->parallelGrain);
+}
+
+
+/*******************************************************************************
+ * CreasedVertexPoints -- Applies DeRose et al.'s vertex rule on the subd
+ *
+ * The "Gather" routine iterates over each vertex of the mesh and computes the
+ * resulting smooth vertex. If the subd stores the vertex classes, regular
+ * vertices (interior, valence 4, no creases) bypass the crease logic.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the smooth vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__CreasedVertexPoint(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    cc_Index vertexID
+)
+{
+    const cc_Index halfedgeID = ccl_VertexToHalfedgeID(level, vertexID);
+    const cc_Index edgeID = ccl_HalfedgeEdgeID(level, halfedgeID);
+    const cc_Index prevID = ccl_HalfedgePrevID(level, halfedgeID);
+    const cc_Index prevEdgeID = ccl_HalfedgeEdgeID(level, prevID);
+    const cc_Index prevFaceID = ccl_HalfedgeFaceID(level, prevID);
+    const cc_Real thisS = ccl_HalfedgeSharpness(level, halfedgeID);
+    const cc_Real prevS = ccl_HalfedgeSharpness(level,     prevID);
+    const cc_Real creaseWeight = cc__Signf(thisS);
+    const cc_Real prevCreaseWeight = cc__Signf(prevS);
+    const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+    const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
+    const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
+    const cc_VertexPoint oldPoint = ccl_VertexPoint(level, vertexID);
+    cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+    cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
+    cc_Real avgS = prevS;
+    cc_Real creaseCount = prevCreaseWeight;
+    cc_Real valence = 1.0f;
+    cc_Index forwardIterator, backwardIterator;
+    cc_Real tmp1[3], tmp2[3];
+
+    // smooth contrib
+    cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
+    cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+    // crease contrib
+    cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
+    cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+
+    for (forwardIterator = ccl_HalfedgeTwinID(level, prevID);
+         forwardIterator >= 0 && forwardIterator != halfedgeID;
+         forwardIterator = ccl_HalfedgeTwinID(level, forwardIterator)) {
+        const cc_Index prevID = ccl_HalfedgePrevID(level, forwardIterator);
+        const cc_Index prevEdgeID = ccl_HalfedgeEdgeID(level, prevID);
+        const cc_Index prevFaceID = ccl_HalfedgeFaceID(level, prevID);
+        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
+        const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
+        const cc_Real prevS = ccl_HalfedgeSharpness(level, prevID);
+        const cc_Real prevCreaseWeight = cc__Signf(prevS);
+
+        // smooth contrib
+        cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+        ++valence;
+
+        // crease contrib
+        cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
+        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        avgS+= prevS;
+        creaseCount+= prevCreaseWeight;
+
+        // next vertex halfedge
+        forwardIterator = prevID;
+    }
+
+    for (backwardIterator = ccl_HalfedgeTwinID(level, halfedgeID);
+         forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+         backwardIterator = ccl_HalfedgeTwinID(level, backwardIterator)) {
+        const cc_Index nextID = ccl_HalfedgeNextID(level, backwardIterator);
+        const cc_Index nextEdgeID = ccl_HalfedgeEdgeID(level, nextID);
+        const cc_Index nextFaceID = ccl_HalfedgeFaceID(level, nextID);
+        const cc_VertexPoint newNextEdgePoint = newEdgePoints[nextEdgeID];
+        const cc_VertexPoint newNextFacePoint = newFacePoints[nextFaceID];
+        const cc_Real nextS = ccl_HalfedgeSharpness(level, nextID);
+        const cc_Real nextCreaseWeight = cc__Signf(nextS);
+
+        // smooth contrib
+        cc__Mul3f(tmp1, newNextFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newNextEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+        ++valence;
+
+        // crease contrib
+        cc__Mul3f(tmp1, newNextEdgePoint.array, nextCreaseWeight);
+        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        avgS+= nextS;
+        creaseCount+= nextCreaseWeight;
+
+        // next vertex halfedge
+        backwardIterator = nextID;
+    }
+
+    // boundary corrections
+    if (forwardIterator < 0) {
+        cc__Mul3f(tmp1, newEdgePoint.array    , creaseWeight);
+        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        creaseCount+= creaseWeight;
+        ++valence;
+    }
+
+    // smooth point
+    cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
+    cc__Mul3f(tmp2, oldPoint.array, 1.0f - 3.0f / valence);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+    // crease point
+    cc__Mul3f(tmp1, creasePoint.array, 0.5f / creaseCount);
+    cc__Mul3f(tmp2, oldPoint.array, 0.5f);
+    cc__Add3f(creasePoint.array, tmp1, tmp2);
+
+    // proper vertex rule selection (TODO: make branchless)
+    if (creaseCount <= 1.0f) {
+        return smoothPoint;
+    } else if (creaseCount >= 3.0f || valence == 2.0f) {
+        return oldPoint;
+    } else {
+        cc_VertexPoint newVertexPoint;
+
+        cc__Lerp3f(newVertexPoint.array,
+                   oldPoint.array,
+                   creasePoint.array,
+                   cc__Satf(avgS * 0.5f));
+
+        return newVertexPoint;
+    }
+}
+
+static cc_VertexPoint
+ccs__RegularVertexPoint(
+    const cc_SubdLevel *level,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    cc_Index vertexID
+)
+{
+    const cc_Index halfedgeID = ccl_VertexToHalfedgeID(level, vertexID);
+    const cc_VertexPoint oldPoint = ccl_VertexPoint(level, vertexID);
+    const cc_Real valence = 4.0f;
+    cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+    cc_Index prevIDs[4];
+    cc_Real tmp1[3], tmp2[3];
+
+    prevIDs[0] = ccl_HalfedgePrevID(level, halfedgeID);
+    prevIDs[1] = ccl_HalfedgePrevID(level, ccl_HalfedgeTwinID(level, prevIDs[0]));
+    prevIDs[2] = ccl_HalfedgePrevID(level, ccl_HalfedgeTwinID(level, prevIDs[1]));
+    prevIDs[3] = ccl_HalfedgePrevID(level, ccl_HalfedgeTwinID(level, prevIDs[2]));
+
+    cc__Mul3f(tmp1, newFacePoints[ccl_HalfedgeFaceID(level, prevIDs[0])].array, -1.0f);
+    cc__Mul3f(tmp2, newEdgePoints[ccl_HalfedgeEdgeID(level, prevIDs[0])].array, +4.0f);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+    for (int32_t i = 1; i < 4; ++i) {
+        cc__Mul3f(tmp1, newFacePoints[ccl_HalfedgeFaceID(level, prevIDs[i])].array, -1.0f);
+        cc__Mul3f(tmp2, newEdgePoints[ccl_HalfedgeEdgeID(level, prevIDs[i])].array, +4.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+    }
+
+    cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
+    cc__Mul3f(tmp2, oldPoint.array, 1.0f - 3.0f / valence);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+    return smoothPoint;
+}
+
+static void
+ccs__CreasedVertexPoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+    if (level.vertexClassIDs != NULL) {
+        const cc_Index *vertexIDs = level.vertexClassIDs;
+        const cc_Index regularVertexCount = level.regularVertexCount;
+
+        for (cc_Index classID = begin; classID < cc__Min(end, regularVertexCount); ++classID) {
+            const cc_Index vertexID = vertexIDs[classID];
+
+            newVertexPoints[vertexID] =
+                ccs__RegularVertexPoint(&level, newFacePoints, newEdgePoints, vertexID);
+        }
+
+        for (cc_Index classID = cc__Max(begin, regularVertexCount); classID < end; ++classID) {
+            const cc_Index vertexID = vertexIDs[classID];
+
+            newVertexPoints[vertexID] =
+                ccs__CreasedVertexPoint(&level, newFacePoints, newEdgePoints, vertexID);
+        }
+
+        return;
+    }
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        newVertexPoints[vertexID] =
+            ccs__CreasedVertexPoint(&level, newFacePoints, newEdgePoints, vertexID);
+    }
+}
+
+static void ccs__CreasedVertexPoints_Gather(cc_Subd *subd, int32_t depth)
+{
+    const ccs__RangeTask task = {&ccs__CreasedVertexPoints_GatherRange, subd, depth, false, NULL};
+
+    ccs__ParallelRange(&task,
+                       ccm_VertexCountAtDepth(subd->cage, depth),
+                       subd->parallelGrain);
+}
+
+
+static void
+ccs__CreasedVertexPoints_ScatterRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    cc_VertexPoint *contributions = ((const ccs__ScatterTask *)task)->contributions;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index vertexID = ccl_HalfedgeVertexID(&level, halfedgeID);
+        const cc_Index edgeID = ccl_HalfedgeEdgeID(&level, halfedgeID);
+        const cc_Index faceID = ccl_HalfedgeFaceID(&level, halfedgeID);
+        const cc_Index prevID = ccl_HalfedgePrevID(&level, halfedgeID);
+        const cc_Index prevEdgeID = ccl_HalfedgeEdgeID(&level, prevID);
+        const cc_Real thisS = ccl_HalfedgeSharpness(&level, halfedgeID);
+        const cc_Real prevS = ccl_HalfedgeSharpness(&level,     prevID);
+        const cc_Real creaseWeight = cc__Signf(thisS);
+        const cc_Real prevCreaseWeight = cc__Signf(prevS);
+        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
+        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+        const cc_VertexPoint oldPoint = ccl_VertexPoint(&level, vertexID);
+        cc_VertexPoint cornerPoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint atomicWeight = {0.0f, 0.0f, 0.0f};
+        cc_Real avgS = prevS;
+        cc_Real creaseCount = prevCreaseWeight;
+        cc_Real valence = 1.0f;
+        cc_Index forwardIterator, backwardIterator;
+        cc_Real tmp1[3], tmp2[3];
+
+        for (forwardIterator = ccl_HalfedgeTwinID(&level, prevID);
+             forwardIterator >= 0 && forwardIterator != halfedgeID;
+             forwardIterator = ccl_HalfedgeTwinID(&level, forwardIterator)) {
+            
+            const cc_Index prevID = ccl_HalfedgePrevID(&level, forwardIterator);
+            const cc_Real prevS = ccl_HalfedgeSharpness(&level, prevID);
+            const cc_Real prevCreaseWeight = cc__Signf(prevS);
+
+            // valence computation
+            ++valence;
+
+            // crease computation
+            avgS+= prevS;
+            creaseCount+= prevCreaseWeight;
+
+            // next vertex halfedge
+            forwardIterator = prevID;
+        }
+
+        for (backwardIterator = ccl_HalfedgeTwinID(&level, halfedgeID);
+             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+             backwardIterator = ccl_HalfedgeTwinID(&level, backwardIterator)) {
+            const cc_Index nextID = ccl_HalfedgeNextID(&level, backwardIterator);
+            const cc_Real nextS = ccl_HalfedgeSharpness(&level, nextID);
+            const cc_Real nextCreaseWeight = cc__Signf(nextS);
+
+            // valence computation
+            ++valence;
+
+            // crease computation
+            avgS+= nextS;
+            creaseCount+= nextCreaseWeight;
+
+            // next vertex halfedge
+            backwardIterator = nextID;
+        }
+
+        // corner point
+        cc__Mul3f(cornerPoint.array, oldPoint.array, 1.0f / valence);
+
+        // crease computation: V / 4
+        cc__Mul3f(tmp1, oldPoint.array, 0.25f * creaseWeight);
+        cc__Mul3f(tmp2, newEdgePoint.array, 0.25f * creaseWeight);
+        cc__Add3f(creasePoint.array, tmp1, tmp2);
+
+        // smooth computation: (4E - F + (n - 3) V) / N
+        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+        cc__Mul3f(tmp1, oldPoint.array, valence - 3.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Mul3f(smoothPoint.array,
+                  smoothPoint.array,
+                  1.0f / (valence * valence));
+
+        // boundary corrections
+        if (forwardIterator < 0) {
+            creaseCount+= creaseWeight;
+            ++valence;
+
+            cc__Mul3f(tmp1, oldPoint.array, 0.25f * prevCreaseWeight);
+            cc__Mul3f(tmp2, newPrevEdgePoint.array, 0.25f * prevCreaseWeight);
+            cc__Add3f(tmp1, tmp1, tmp2);
+            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        }
+
+        // atomicWeight (TODO: make branchless ?)
+        if (creaseCount <= 1.0f) {
+            atomicWeight = smoothPoint;
+        } else if (creaseCount >= 3.0f || valence == 2.0f) {
+            atomicWeight = cornerPoint;
+        } else {
+            cc__Lerp3f(atomicWeight.array,
+                       cornerPoint.array,
+                       creasePoint.array,
+                       cc__Satf(avgS * 0.5f));
+        }
+
+        ccs__ScatterWeight(newVertexPoints,
+                           vertexID,
+                           contributions,
+                           halfedgeID,
+                           atomicWeight.array);
+    }
+}
+
+static void
+ccs__CreasedVertexPoints_Scatter(
+    cc_Subd *subd,
+    int32_t depth,
+    cc_VertexPoint *contributions
+) {
+    const ccs__ScatterTask task = {
+        {&ccs__CreasedVertexPoints_ScatterRange, subd, depth, false, NULL},
+        contributions
+    };
+
+    ccs__ParallelScatter(&task,
+                        ccm_HalfedgeCountAtDepth(subd->cage, depth),
+                        subd->parallelGrain);
+}
+
+
+/*******************************************************************************
+ * BoundaryPoints -- Applies DeRose et al.'s rules on the boundary of the subd
+ *
+ * Once the interior creases have vanished, the crease-free kernels refine the
+ * subd and these routines overwrite the edge and vertex points that lie on the
+ * (sharp) boundary. They iterate over the boundary halfedges of the level and
+ * apply the same rules as the "Gather" routines of the creased kernels.
+ *
+ */
+static void
+ccs__BoundaryEdgePoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+
+    for (cc_Index boundaryID = begin; boundaryID < end; ++boundaryID) {
+        const cc_Index halfedgeID = level.boundaryHalfedgeIDs[boundaryID];
+        const cc_Index edgeID = ccl_HalfedgeEdgeID(&level, halfedgeID);
+        const cc_Index nextID = ccl_HalfedgeNextID(&level, halfedgeID);
+        const cc_Real sharp = ccl_CreaseSharpness(&level, edgeID);
+        const cc_Real edgeWeight = cc__Satf(sharp);
+        const cc_VertexPoint oldEdgePoints[2] = {
+            ccl_HalfedgeVertexPoint(&level, halfedgeID),
+            ccl_HalfedgeVertexPoint(&level,     nextID)
+        };
+        const cc_VertexPoint newAdjacentFacePoints[2] = {
+            newFacePoints[ccl_HalfedgeFaceID(&level, halfedgeID)],
+            newFacePoints[ccl_HalfedgeFaceID(&level,          0)]
+        };
+        cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
+        cc_Real tmp1[3], tmp2[3];
+
+        cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
+        cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
+        cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
+        cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
+        cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
+        cc__Lerp3f(newEdgePoints[edgeID].array,
+                   smoothEdgePoint.array,
+                   sharpEdgePoint.array,
+                   edgeWeight);
+    }
+}
+
+static void ccs__BoundaryEdgePoints_Gather(cc_Subd *subd, int32_t depth)
+{
+    const ccs__RangeTask task = {&ccs__BoundaryEdgePoints_GatherRange, subd, depth, false, NULL};
+
+    ccs__ParallelRange(&task,
+                       ccs_Level(subd, depth).boundaryHalfedgeCount,
+                       subd->parallelGrain);
+}
+
+static void
+ccs__BoundaryVertexPoints_GatherRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+
+    for (cc_Index boundaryID = begin; boundaryID < end; ++boundaryID) {
+        const cc_Index halfedgeID = level.boundaryHalfedgeIDs[boundaryID];
+        const cc_Index vertexID = ccl_HalfedgeVertexID(&level, halfedgeID);
+
+        newVertexPoints[vertexID] =
+            ccs__CreasedVertexPoint(&level, newFacePoints, newEdgePoints, vertexID);
+    }
+}
+
+static void ccs__BoundaryVertexPoints_Gather(cc_Subd *subd, int32_t depth)
+{
+    const ccs__RangeTask task = {&ccs__BoundaryVertexPoints_GatherRange, subd, depth, false, NULL};
+
+    ccs__ParallelRange(&task,
+                       ccs_Level(subd, depth).boundaryHalfedgeCount,
+                       subd->parallelGrain);
+}
+
+
+/*******************************************************************************
+ * SharedScratch -- Scratch memory for the threads of a refinement region
+ *
+ * The level routines run inside the parallel region of the refinement driver
+ * (see RefineVertexPoints), so their scratch memory is allocated by a single
+ * thread and its address broadcast to the others. The memory is released once
+ * all threads are done with it.
+ *
+ */
+static void *ccs__SharedMalloc(size_t size)
+{
+    void *ptr;
+
+CC_SINGLE_COPY(ptr)
+    ptr = CC_MALLOC(size);
+
+    return ptr;
+}
+
+static void ccs__SharedFree(void *ptr)
+{
+CC_BARRIER
+CC_SINGLE
+    CC_FREE(ptr);
+}
+
+
+/*******************************************************************************
+ * TiledPoints -- Refines the face, edge and vertex points of a level in tiles
+ *
+ * At depth d > 0, the children of face f are faces 4f to 4f+3, so each aligned
+ * block of 4^k faces (k < d) is a 2^k x 2^k patch that descends from a single
+ * face of depth d-k. Each tile computes the face points of such a patch, then
+ * the edge and vertex points whose inputs lie in the patch, while these inputs
+ * are still in cache. Edges and vertices that depend on a neighbouring tile,
+ * as well as those on the boundary of the subd, lie on the patch perimeter, so
+ * at most 4 * 2^k of each are deferred to a second, much smaller pass. Both
+ * passes apply the same per-element rules as the untiled routines, so the
+ * results are identical.
+ * The tiles are 4^CC_TILE_DEPTH faces wide.
+ *
+ */
+#ifndef CC_TILE_DEPTH
+#   define CC_TILE_DEPTH 5
+#endif
+
+static int32_t ccs__TileDepth(int32_t depth)
+{
+    return cc__Min(CC_TILE_DEPTH, depth - 1);
+}
+
+// the streaming vector kernels outperform the scalar tiles on smooth levels
+static bool ccs__IsTileable(const cc_Subd *subd, int32_t depth, bool isCreased)
+{
+    cc_SubdLevel level;
+
+    if (ccs__TileDepth(depth) < 2) {
+        return false;
+    }
+
+    level = ccs_Level(subd, depth);
+
+    if (isCreased) {
+        return level.vertexClassIDs == NULL;
+    }
+
+#ifdef CC__SIMD_X86
+    return cc__SimdWidth() == 1 || !ccs__IsSimdCompatible(&level);
+#else
+    return true;
+#endif
+}
+
+static bool ccs__IsFaceInTile(cc_Index faceID, cc_Index faceBegin, cc_Index faceEnd)
+{
+    return faceID >= faceBegin && faceID < faceEnd;
+}
+
+/*
+ * A vertex is refined by a single one of its outgoing halfedges. Halfedge
+ * 4h+i stems from halfedge h of the previous depth: it leaves the old vertex
+ * of h for i = 0, the edge point of h for i = 1, and the face point of h for
+ * i = 2. Face points are thus refined by their halfedge of the first child
+ * face, and edge points by the child of the larger of the previous halfedge
+ * and its twin. Old vertices are refined by their smallest outgoing halfedge,
+ * which requires a walk around their one-ring.
+ */
+static bool
+ccs__IsTileVertexOwner(
+    const cc_SubdLevel *level,
+    cc_Index halfedgeID,
+    cc_Index faceBegin,
+    cc_Index faceEnd,
+    bool *isInTile
+) {
+    const cc_Index parentID = halfedgeID >> 2;
+    cc_Index iterator;
+
+    *isInTile = true;
+
+    if ((halfedgeID & 3) == 3) {
+        return false;
+    } else if ((halfedgeID & 3) == 2) {
+        return (parentID & 3) == 0;
+    } else if ((halfedgeID & 3) == 1) {
+        const cc_Index twinID = ccl_HalfedgeTwinID(level, halfedgeID - 1);
+        cc_Index parentTwinID;
+
+        if (twinID < 0) {
+            *isInTile = false;
+
+            return true;
+        }
+
+        parentTwinID = ccm_HalfedgePrevID_Quad(twinID >> 2);
+        *isInTile = ccs__IsFaceInTile(parentTwinID, faceBegin, faceEnd);
+
+        return parentID > parentTwinID;
+    }
+
+    for (iterator = ccl_PrevVertexHalfedgeID(level, halfedgeID);
+         iterator >= 0 && iterator != halfedgeID;
+         iterator = ccl_PrevVertexHalfedgeID(level, iterator)) {
+        if (iterator < halfedgeID) {
+            return false;
+        }
+
+        *isInTile&= ccs__IsFaceInTile(iterator >> 2, faceBegin, faceEnd);
+    }
+
+    // open ring: walk the other way, up to the boundary
+    if (iterator < 0) {
+        *isInTile = false;
+
+        for (iterator = halfedgeID; ccl_HalfedgeTwinID(level, iterator) >= 0;) {
+            iterator = ccl_NextVertexHalfedgeID(level, iterator);
+
+            if (iterator < halfedgeID) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+typedef struct {
+    cc_SubdLevel level;
+    cc_VertexPoint *newFacePoints;
+    cc_VertexPoint *newEdgePoints;
+    cc_VertexPoint *newVertexPoints;
+    cc_Index tileFaceCount;
+    cc_Index tileDeferredCount;
+    cc_Index *deferredEdgeIDs;
+    cc_Index *deferredVertexIDs;
+    cc_Index *deferredEdgeCounts;
+    cc_Index *deferredVertexCounts;
+} ccs__Tiles;
+
+static cc_Index ccs__TileCount(cc_Subd *subd, int32_t depth)
+{
+    return ccm_FaceCountAtDepth(subd->cage, depth) >> (2 * ccs__TileDepth(depth));
+}
+
+static ccs__Tiles ccs__LoadTiles(const ccs__RangeTask *task)
+{
+    const int32_t depth = task->depth;
+    const cc_SubdLevel nextLevel = ccs_Level(task->subd, depth + 1);
+    const int32_t tileDepth = ccs__TileDepth(depth);
+    const cc_Index tileCount = ccs__TileCount(task->subd, depth);
+    ccs__Tiles tiles;
+
+    tiles.level = ccs_Level(task->subd, depth);
+    tiles.newFacePoints = &nextLevel.vertexPoints[ccl_VertexCount(&tiles.level)];
+    tiles.newEdgePoints = &tiles.newFacePoints[ccl_FaceCount(&tiles.level)];
+    tiles.newVertexPoints = nextLevel.vertexPoints;
+    tiles.tileFaceCount = (cc_Index)1 << (2 * tileDepth);
+    tiles.tileDeferredCount = (cc_Index)4 << tileDepth;
+    tiles.deferredEdgeIDs = task->scratch;
+    tiles.deferredVertexIDs = &tiles.deferredEdgeIDs[tileCount * tiles.tileDeferredCount];
+    tiles.deferredEdgeCounts = &tiles.deferredVertexIDs[tileCount * tiles.tileDeferredCount];
+    tiles.deferredVertexCounts = &tiles.deferredEdgeCounts[tileCount];
+
+    return tiles;
+}
+
+static void
+ccs__TiledPoints_GatherTiles(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const ccs__Tiles tiles = ccs__LoadTiles(task);
+    const cc_SubdLevel level = tiles.level;
+    const cc_Index tileFaceCount = tiles.tileFaceCount;
+    const cc_Index tileDeferredCount = tiles.tileDeferredCount;
+    const bool isCreased = task->isCreased;
+    cc_VertexPoint *newFacePoints = tiles.newFacePoints;
+    cc_VertexPoint *newEdgePoints = tiles.newEdgePoints;
+    cc_VertexPoint *newVertexPoints = tiles.newVertexPoints;
+    cc_Index *deferredEdgeIDs = tiles.deferredEdgeIDs;
+    cc_Index *deferredVertexIDs = tiles.deferredVertexIDs;
+    cc_Index *deferredEdgeCounts = tiles.deferredEdgeCounts;
+    cc_Index *deferredVertexCounts = tiles.deferredVertexCounts;
+
+    for (cc_Index tileID = begin; tileID < end; ++tileID) {
+        const cc_Index faceBegin = tileID * tileFaceCount;
+        const cc_Index faceEnd = faceBegin + tileFaceCount;
+        cc_Index *tileEdgeIDs = &deferredEdgeIDs[tileID * tileDeferredCount];
+        cc_Index *tileVertexIDs = &deferredVertexIDs[tileID * tileDeferredCount];
+        cc_Index tileEdgeCount = 0;
+        cc_Index tileVertexCount = 0;
+
+        for (cc_Index faceID = faceBegin; faceID < faceEnd; ++faceID) {
+            newFacePoints[faceID] = ccs__FacePoint(&level, faceID);
+        }
+
+        for (cc_Index halfedgeID = 4 * faceBegin; halfedgeID < 4 * faceEnd; ++halfedgeID) {
+            const cc_Index twinID = ccl_HalfedgeTwinID(&level, halfedgeID);
+
+            // boundary edges read the point of face 0, which may not be ready
+            if (halfedgeID < twinID) {
+                continue;
+            } else if (twinID < 0 || !ccs__IsFaceInTile(twinID >> 2, faceBegin, faceEnd)) {
+                CC_ASSERT(tileEdgeCount < tileDeferredCount);
+                tileEdgeIDs[tileEdgeCount++] = halfedgeID;
+            } else {
+                const cc_Index edgeID = ccl_HalfedgeEdgeID(&level, halfedgeID);
+
+                newEdgePoints[edgeID] = isCreased
+                    ? ccs__CreasedEdgePoint(&level, newFacePoints, halfedgeID)
+                    : ccs__EdgePoint(&level, newFacePoints, halfedgeID);
+            }
+        }
+
+        for (cc_Index halfedgeID = 4 * faceBegin; halfedgeID < 4 * faceEnd; ++halfedgeID) {
+            const cc_Index vertexID = ccl_HalfedgeVertexID(&level, halfedgeID);
+            bool isInTile;
+
+            if (!ccs__IsTileVertexOwner(&level, halfedgeID, faceBegin, faceEnd, &isInTile)) {
+                continue;
+            } else if (!isInTile) {
+                CC_ASSERT(tileVertexCount < tileDeferredCount);
+                tileVertexIDs[tileVertexCount++] = vertexID;
+            } else {
+                newVertexPoints[vertexID] = isCreased
+                    ? ccs__CreasedVertexPoint(&level, newFacePoints, newEdgePoints, vertexID)
+                    : ccs__VertexPoint(&level, newFacePoints, newEdgePoints, vertexID);
+            }
+        }
+
+        deferredEdgeCounts[tileID] = tileEdgeCount;
+        deferredVertexCounts[tileID] = tileVertexCount;
+    }
+}
+
+static void
+ccs__TiledPoints_GatherEdges(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const ccs__Tiles tiles = ccs__LoadTiles(task);
+    const cc_SubdLevel level = tiles.level;
+    const cc_Index tileDeferredCount = tiles.tileDeferredCount;
+    const bool isCreased = task->isCreased;
+    const cc_VertexPoint *newFacePoints = tiles.newFacePoints;
+    cc_VertexPoint *newEdgePoints = tiles.newEdgePoints;
+    const cc_Index *deferredEdgeIDs = tiles.deferredEdgeIDs;
+    const cc_Index *deferredEdgeCounts = tiles.deferredEdgeCounts;
+
+    for (cc_Index tileID = begin; tileID < end; ++tileID) {
+        const cc_Index *tileEdgeIDs = &deferredEdgeIDs[tileID * tileDeferredCount];
+
+        for (cc_Index i = 0; i < deferredEdgeCounts[tileID]; ++i) {
+            const cc_Index halfedgeID = tileEdgeIDs[i];
+            const cc_Index edgeID = ccl_HalfedgeEdgeID(&level, halfedgeID);
+
+            newEdgePoints[edgeID] = isCreased
+                ? ccs__CreasedEdgePoint(&level, newFacePoints, halfedgeID)
+                : ccs__EdgePoint(&level, newFacePoints, halfedgeID);
+        }
+    }
+}
+
+static void
+ccs__TiledPoints_GatherVertices(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const ccs__Tiles tiles = ccs__LoadTiles(task);
+    const cc_SubdLevel level = tiles.level;
+    const cc_Index tileDeferredCount = tiles.tileDeferredCount;
+    const bool isCreased = task->isCreased;
+    const cc_VertexPoint *newFacePoints = tiles.newFacePoints;
+    const cc_VertexPoint *newEdgePoints = tiles.newEdgePoints;
+    cc_VertexPoint *newVertexPoints = tiles.newVertexPoints;
+    const cc_Index *deferredVertexIDs = tiles.deferredVertexIDs;
+    const cc_Index *deferredVertexCounts = tiles.deferredVertexCounts;
+
+    for (cc_Index tileID = begin; tileID < end; ++tileID) {
+        const cc_Index *tileVertexIDs = &deferredVertexIDs[tileID * tileDeferredCount];
+
+        for (cc_Index i = 0; i < deferredVertexCounts[tileID]; ++i) {
+            const cc_Index vertexID = tileVertexIDs[i];
+
+            newVertexPoints[vertexID] = isCreased
+                ? ccs__CreasedVertexPoint(&level, newFacePoints, newEdgePoints, vertexID)
+                : ccs__VertexPoint(&level, newFacePoints, newEdgePoints, vertexID);
+        }
+    }
+}
+
+static void ccs__TiledPoints_Gather(cc_Subd *subd, int32_t depth, bool isCreased)
+{
+    const cc_Index tileCount = ccs__TileCount(subd, depth);
+    const cc_Index tileDeferredCount = (cc_Index)4 << ccs__TileDepth(depth);
+    const cc_Index deferredCount = tileCount * tileDeferredCount;
+    cc_Index *scratch = (cc_Index *)ccs__SharedMalloc(
+        sizeof(cc_Index) * (2 * deferredCount + 2 * tileCount));
+    ccs__RangeTask task = {&ccs__TiledPoints_GatherTiles, subd, depth, isCreased, scratch};
+
+    CC_ASSERT(tileCount << (2 * ccs__TileDepth(depth))
+              == ccm_FaceCountAtDepth(subd->cage, depth));
+
+    ccs__ParallelRange(&task, tileCount, 1);
+    task.routine = &ccs__TiledPoints_GatherEdges;
+    ccs__ParallelRange(&task, tileCount, 1);
+    task.routine = &ccs__TiledPoints_GatherVertices;
+    ccs__ParallelRange(&task, tileCount, 1);
+
+    ccs__SharedFree(scratch);
+}
+
+
+/*******************************************************************************
+ * RefineVertexPoints -- Computes the result of Catmull Clark subdivision.
+ *
+ * The vertex points are refined one depth after the other. In final-level-only
+ * mode (see CC_SUBD_FINAL_LEVEL_ONLY), the intermediate topology is not kept
+ * in memory, so the topology of each depth is refined right before its
+ * vertex points.
+ *
+ * With the OpenMP backend (see ParallelBackend), all depths are refined
+ * within a single parallel region: the level routines share their loops among
+ * its threads and synchronize with a barrier after each loop. Depths with
+ * fewer than CC_PARALLEL_CUTOFF halfedges are too small to amortize the
+ * synchronization, so they are refined serially beforehand. In
+ * final-level-only mode, the topology routines open regions of their own, so
+ * each depth gets its own region. With any other backend, the depths are
+ * refined on the calling thread and the level routines submit their loops to
+ * the backend.
+ *
+ */
+#ifndef CC_PARALLEL_CUTOFF
+#   define CC_PARALLEL_CUTOFF 4096
+#endif
+
+typedef void (*ccs__LevelRefiner)(cc_Subd *subd, int32_t depth);
+
+static void ccs__RefineTopologyAtDepth(cc_Subd *subd, int32_t depth);
+
+static bool ccs__IsRegionDepth(const cc_Subd *subd, int32_t depth)
+{
+    return cc__IsOpenMPBackend()
+        && ccm_HalfedgeCountAtDepth(subd->cage, depth) >= CC_PARALLEL_CUTOFF;
+}
+
+static void ccs__RefineVertexPoints(cc_Subd *subd, ccs__LevelRefiner refiner)
+{
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+    int32_t depth = 0;
+
+#ifdef CC__SIMD_X86
+    // query the CPU before the threads race to do it
+    cc__SimdWidth();
+#endif
+
+    if (ccs__IsFinalLevelOnly(subd)) {
+        for (; depth < maxDepth; ++depth) {
+            ccs__RefineTopologyAtDepth(subd, depth);
+
+            if (ccs__IsRegionDepth(subd, depth)) {
+CC_PARALLEL
+                (*refiner)(subd, depth);
+            } else {
+                (*refiner)(subd, depth);
+            }
+        }
+
+        return;
+    }
+
+    for (; depth < maxDepth && !ccs__IsRegionDepth(subd, depth); ++depth) {
+        (*refiner)(subd, depth);
+    }
+
+    if (depth < maxDepth) {
+CC_PARALLEL
+        for (int32_t depthIt = depth; depthIt < maxDepth; ++depthIt) {
+            (*refiner)(subd, depthIt);
+        }
+    }
+}
+
+static void
+ccs__ClearVertexPointsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_VertexPoint zero = {0.0f, 0.0f, 0.0f};
+    cc_VertexPoint *vertexPoints = ccs_Level(task->subd, task->depth).vertexPoints;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        vertexPoints[vertexID] = zero;
+    }
+}
+
+static void ccs__ClearVertexPoints(cc_Subd *subd, int32_t depth)
+{
+    const ccs__RangeTask task = {&ccs__ClearVertexPointsRange, subd, depth, false, NULL};
+
+    ccs__ParallelRange(&task,
+                       ccm_VertexCountAtDepth(subd->cage, depth),
+                       subd->parallelGrain);
+}
+
+/*******************************************************************************
+ * RefineLevelVertexPoints -- Refines the vertex points of one depth
+ *
+ * Sharpness decays at each depth, so past some depth only the boundary of the
+ * subd remains creased. From there on, as long as the boundary is sharp, the
+ * creased routines dispatch to the crease-free kernels and then fix up the
+ * boundary points.
+ *
+ */
+static bool ccs__IsCreaseFree(const cc_Subd *subd, int32_t depth)
+{
+    return depth > 0
+        && subd->maxCreaseSharpness[depth] == 0.0f
+        && subd->minBoundarySharpness[depth] >= 1.0f;
+}
+
+static void ccs__RefineLevelVertexPoints_Scatter(cc_Subd *subd, int32_t depth)
+{
+    ccs__ClearVertexPoints(subd, depth + 1);
+
+    if (depth == 0) {
+        ccs__CageFacePoints_Scatter(subd, NULL);
+        ccs__CreasedCageEdgePoints_Scatter(subd, NULL);
+        ccs__CreasedCageVertexPoints_Scatter(subd, NULL);
+    } else if (ccs__IsCreaseFree(subd, depth)) {
+        ccs__FacePoints_Scatter(subd, depth, NULL);
+        ccs__EdgePoints_Scatter(subd, depth, NULL);
+        ccs__BoundaryEdgePoints_Gather(subd, depth);
+        ccs__VertexPoints_Scatter(subd, depth, NULL);
+        ccs__BoundaryVertexPoints_Gather(subd, depth);
+    } else {
+        ccs__FacePoints_Scatter(subd, depth, NULL);
+        ccs__CreasedEdgePoints_Scatter(subd, depth, NULL);
+        ccs__CreasedVertexPoints_Scatter(subd, depth, NULL);
+    }
+}
+
+static void
+ccs__RefineLevelVertexPoints_NoCreases_Scatter(cc_Subd *subd, int32_t depth)
+{
+    ccs__ClearVertexPoints(subd, depth + 1);
+
+    if (depth == 0) {
+        ccs__CageFacePoints_Scatter(subd, NULL);
+        ccs__CageEdgePoints_Scatter(subd, NULL);
+        ccs__CageVertexPoints_Scatter(subd, NULL);
+    } else {
+        ccs__FacePoints_Scatter(subd, depth, NULL);
+        ccs__EdgePoints_Scatter(subd, depth, NULL);
+        ccs__VertexPoints_Scatter(subd, depth, NULL);
+    }
+}
+
+static void ccs__RefineLevelVertexPoints_Gather(cc_Subd *subd, int32_t depth)
+{
+    if (depth == 0) {
+        ccs__CageFacePoints_Gather(subd);
+        ccs__CreasedCageEdgePoints_Gather(subd);
+        if (subd->cageRingOffsets != NULL) {
+            ccs__CreasedCageVertexPoints_GatherRings(subd);
+        } else {
+            ccs__CreasedCageVertexPoints_Gather(subd);
+        }
+    } else if (ccs__IsCreaseFree(subd, depth) && ccs__IsTileable(subd, depth, false)) {
+        ccs__TiledPoints_Gather(subd, depth, false);
+        ccs__BoundaryEdgePoints_Gather(subd, depth);
+        ccs__BoundaryVertexPoints_Gather(subd, depth);
+    } else if (ccs__IsCreaseFree(subd, depth)) {
+        ccs__FacePoints_Gather(subd, depth);
+        ccs__EdgePoints_Gather(subd, depth);
+        ccs__BoundaryEdgePoints_Gather(subd, depth);
+        ccs__VertexPoints_Gather(subd, depth);
+        ccs__BoundaryVertexPoints_Gather(subd, depth);
+    } else if (ccs__IsTileable(subd, depth, true)) {
+        ccs__TiledPoints_Gather(subd, depth, true);
+    } else {
+        ccs__FacePoints_Gather(subd, depth);
+        ccs__CreasedEdgePoints_Gather(subd, depth);
+        ccs__CreasedVertexPoints_Gather(subd, depth);
+    }
+}
+
+static void
+ccs__RefineLevelVertexPoints_NoCreases_Gather(cc_Subd *subd, int32_t depth)
+{
+    if (depth == 0) {
+        ccs__CageFacePoints_Gather(subd);
+        ccs__CageEdgePoints_Gather(subd);
+        if (subd->cageRingOffsets != NULL) {
+            ccs__CageVertexPoints_GatherRings(subd);
+        } else {
+            ccs__CageVertexPoints_Gather(subd);
+        }
+    } else if (ccs__IsTileable(subd, depth, false)) {
+        ccs__TiledPoints_Gather(subd, depth, false);
+    } else {
+        ccs__FacePoints_Gather(subd, depth);
+        ccs__EdgePoints_Gather(subd, depth);
+        ccs__VertexPoints_Gather(subd, depth);
+    }
+}
+
+CCDEF void ccs_RefineVertexPoints_Scatter(cc_Subd *subd)
+{
+    ccs__RefineVertexPoints(subd, &ccs__RefineLevelVertexPoints_Scatter);
+}
+
+CCDEF void ccs_RefineVertexPoints_NoCreases_Scatter(cc_Subd *subd)
+{
+    ccs__RefineVertexPoints(subd, &ccs__RefineLevelVertexPoints_NoCreases_Scatter);
+}
+
+CCDEF void ccs_RefineVertexPoints_Gather(cc_Subd *subd)
+{
+    ccs__RefineVertexPoints(subd, &ccs__RefineLevelVertexPoints_Gather);
+}
+
+CCDEF void ccs_RefineVertexPoints_NoCreases_Gather(cc_Subd *subd)
+{
+    ccs__RefineVertexPoints(subd, &ccs__RefineLevelVertexPoints_NoCreases_Gather);
+}
+
+
+/*******************************************************************************
+ * ScatterPlan -- Halfedge to point segmentation for deterministic scatter
+ *
+ * The plan stores, for each depth, the halfedges that contribute to each
+ * vertex point sorted by increasing halfedge ID (the faces of the cage are
+ * stored the same way). The "SegmentedScatter" routines first compute the
+ * contribution of each halfedge without any atomics, and then sum them per
+ * point following the order of the plan. The result is thus independent of
+ * the number of threads, and matches the serial "Scatter" routines. Face
+ * points at depth > 0 and edge points do not need any segmentation since
+ * their halfedges are known in closed form.
+ *
+ */
+static cc_Index ccs__ScatterPlanVertexOffsetStride(const cc_Mesh *cage, int32_t depth)
+{
+    cc_Index stride = 0;
+
+    for (int32_t i = 0; i < depth; ++i) {
+        stride+= ccm_VertexCountAtDepth(cage, i) + 1;
+    }
+
+    return stride;
+}
+
+static cc_Index ccs__ScatterPlanHalfedgeStride(const cc_Mesh *cage, int32_t depth)
+{
+    cc_Index stride = 0;
+
+    for (int32_t i = 0; i < depth; ++i) {
+        stride+= ccm_HalfedgeCountAtDepth(cage, i);
+    }
+
+    return stride;
+}
+
+static cc_Index
+ccs__ScatterPlanHalfedgeVertexID(
+    const cc_Mesh *cage,
+    const cc_SubdLevel *level,
+    cc_Index halfedgeID
+) {
+    if (level == NULL) {
+        return ccm_HalfedgeVertexID(cage, halfedgeID);
+    } else {
+        return ccl_HalfedgeVertexID(level, halfedgeID);
+    }
+}
+
+typedef struct {
+    const cc_Mesh *cage;
+    const cc_SubdLevel *level;
+    cc_Index *offsets;
+} ccs__VertexSegmentTask;
+
+static void ccs__CountVertexSegments(cc_Index begin, cc_Index end, void *userData)
+{
+    const ccs__VertexSegmentTask *task = (const ccs__VertexSegmentTask *)userData;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index vertexID = ccs__ScatterPlanHalfedgeVertexID(task->cage,
+                                                                  task->level,
+                                                                  halfedgeID);
+
+        cc__AtomicAddIndex(&task->offsets[vertexID + 1], 1);
+    }
+}
+
+// counting sort of the halfedges of a given depth w.r.t. their vertex
+static void
+ccs__BuildScatterPlanVertexSegments(
+    const cc_Subd *subd,
+    int32_t depth,
+    cc_Index *offsets,
+    cc_Index *halfedgeIDs
+) {
+    const cc_Mesh *cage = subd->cage;
+    const cc_Index vertexCount = ccm_VertexCountAtDepth(cage, depth);
+    const cc_Index halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+    cc_SubdLevel levelData;
+    const cc_SubdLevel *level = NULL;
+    ccs__VertexSegmentTask task;
+
+    if (depth > 0) {
+        levelData = ccs_Level(subd, depth);
+        level = &levelData;
+    }
+
+    task.cage = cage;
+    task.level = level;
+    task.offsets = offsets;
+
+    CC_MEMSET(offsets, 0, sizeof(cc_Index) * (vertexCount + 1));
+
+#ifdef CC__ATOMICS
+    cc_ParallelFor(0, halfedgeCount, subd->parallelGrain, &ccs__CountVertexSegments, &task);
+#else
+    ccs__CountVertexSegments(0, halfedgeCount, &task);
+#endif
+
+    for (cc_Index vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        offsets[vertexID + 1]+= offsets[vertexID];
+    }
+
+    for (cc_Index halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const cc_Index vertexID = ccs__ScatterPlanHalfedgeVertexID(cage,
+                                                                  level,
+                                                                  halfedgeID);
+
+        halfedgeIDs[offsets[vertexID]++] = halfedgeID;
+    }
+
+    // the fill pass shifted the offsets by one segment
+    for (cc_Index vertexID = vertexCount; vertexID > 0; --vertexID) {
+        offsets[vertexID] = offsets[vertexID - 1];
+    }
+    offsets[0] = 0;
+}
+
+// counting sort of the halfedges of the cage w.r.t. their face
+static void
+ccs__BuildScatterPlanCageFaceSegments(
+    const cc_Mesh *cage,
+    cc_Index *offsets,
+    cc_Index *halfedgeIDs
+) {
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_Index halfedgeCount = ccm_HalfedgeCount(cage);
+
+    CC_MEMSET(offsets, 0, sizeof(cc_Index) * (faceCount + 1));
+
+    for (cc_Index halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        offsets[ccm_HalfedgeFaceID(cage, halfedgeID) + 1]+= 1;
+    }
+
+    for (cc_Index faceID = 0; faceID < faceCount; ++faceID) {
+        offsets[faceID + 1]+= offsets[faceID];
+    }
+
+    for (cc_Index halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        halfedgeIDs[offsets[ccm_HalfedgeFaceID(cage, halfedgeID)]++] = halfedgeID;
+    }
+
+    for (cc_Index faceID = faceCount; faceID > 0; --faceID) {
+        offsets[faceID] = offsets[faceID - 1];
+    }
+    offsets[0] = 0;
+}
+
+CCDEF cc_ScatterPlan *ccs_CreateScatterPlan(const cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_Index halfedgeCount = ccm_HalfedgeCount(cage);
+    const cc_Index vertexOffsetCount = ccs__ScatterPlanVertexOffsetStride(cage, maxDepth);
+    const cc_Index vertexHalfedgeCount = ccs__ScatterPlanHalfedgeStride(cage, maxDepth);
+    const cc_Index contributionCount = ccm_HalfedgeCountAtDepth(cage, maxDepth - 1);
+    cc_ScatterPlan *plan = (cc_ScatterPlan *)CC_MALLOC(sizeof(*plan));
+
+    CC_ASSERT(!ccs__IsFinalLevelOnly(subd));
+    plan->maxDepth = maxDepth;
+    plan->cageFaceOffsets = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * (faceCount + 1));
+    plan->cageFaceHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * halfedgeCount);
+    plan->vertexOffsets = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * vertexOffsetCount);
+    plan->vertexHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * vertexHalfedgeCount);
+    plan->contributions = (cc_VertexPoint *)CC_MALLOC(sizeof(cc_VertexPoint)
+                                                      * contributionCount);
+
+    ccs__BuildScatterPlanCageFaceSegments(cage,
+                                          plan->cageFaceOffsets,
+                                          plan->cageFaceHalfedgeIDs);
+
+    for (int32_t depth = 0; depth < maxDepth; ++depth) {
+        const cc_Index offsetStride = ccs__ScatterPlanVertexOffsetStride(cage, depth);
+        const cc_Index halfedgeStride = ccs__ScatterPlanHalfedgeStride(cage, depth);
+
+        ccs__BuildScatterPlanVertexSegments(subd,
+                                            depth,
+                                            &plan->vertexOffsets[offsetStride],
+                                            &plan->vertexHalfedgeIDs[halfedgeStride]);
+    }
+
+    return plan;
+}
+
+CCDEF void ccs_ReleaseScatterPlan(cc_ScatterPlan *plan)
+{
+    CC_FREE(plan->cageFaceOffsets);
+    CC_FREE(plan->cageFaceHalfedgeIDs);
+    CC_FREE(plan->vertexOffsets);
+    CC_FREE(plan->vertexHalfedgeIDs);
+    CC_FREE(plan->contributions);
+    CC_FREE(plan);
+}
+
+
+/*******************************************************************************
+ * Segmented reductions -- Sums the halfedge contributions of each point
+ *
+ * The contributions are summed in increasing halfedge order starting from
+ * zero, which is exactly what a serial execution of the "Scatter" routines
+ * computes.
+ *
+ */
+typedef struct {
+    ccs__RangeTask task;    // first member, so that the routine can cast it back
+    const cc_Index *offsets;
+    const cc_Index *halfedgeIDs;
+    const cc_VertexPoint *contributions;
+    cc_VertexPoint *points;
+} ccs__ReduceTask;
+
+static void
+ccs__SegmentedReduceRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const ccs__ReduceTask *reduceTask = (const ccs__ReduceTask *)task;
+    const cc_Index *offsets = reduceTask->offsets;
+    const cc_Index *halfedgeIDs = reduceTask->halfedgeIDs;
+    const cc_VertexPoint *contributions = reduceTask->contributions;
+
+    for (cc_Index pointID = begin; pointID < end; ++pointID) {
+        cc_VertexPoint point = {0.0f, 0.0f, 0.0f};
+
+        for (cc_Index i = offsets[pointID]; i < offsets[pointID + 1]; ++i) {
+            const cc_VertexPoint contribution = contributions[halfedgeIDs[i]];
+
+            cc__Add3f(point.array, point.array, contribution.array);
+        }
+
+        reduceTask->points[pointID] = point;
+    }
+}
+
+static void
+ccs__SegmentedReduce(
+    cc_Subd *subd,
+    const cc_Index *offsets,
+    const cc_Index *halfedgeIDs,
+    cc_Index pointCount,
+    const cc_VertexPoint *contributions,
+    cc_VertexPoint *points
+) {
+    const ccs__ReduceTask task = {
+        {&ccs__SegmentedReduceRange, subd, 0, false, NULL},
+        offsets,
+        halfedgeIDs,
+        contributions,
+        points
+    };
+
+    ccs__ParallelRange(&task.task, pointCount, subd->parallelGrain);
+}
+
+static void
+ccs__QuadReduceRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const ccs__ReduceTask *reduceTask = (const ccs__ReduceTask *)task;
+    const cc_VertexPoint *contributions = reduceTask->contributions;
+
+    for (cc_Index faceID = begin; faceID < end; ++faceID) {
+        const cc_Index halfedgeID = ccm_FaceToHalfedgeID_Quad(faceID);
+        cc_VertexPoint newFacePoint = {0.0f, 0.0f, 0.0f};
+
+        for (int32_t i = 0; i < 4; ++i) {
+            const cc_VertexPoint contribution = contributions[halfedgeID + i];
+
+            cc__Add3f(newFacePoint.array, newFacePoint.array, contribution.array);
+        }
+
+        reduceTask->points[faceID] = newFacePoint;
+    }
+}
+
+static void
+ccs__QuadReduce(
+    cc_Subd *subd,
+    cc_Index faceCount,
+    const cc_VertexPoint *contributions,
+    cc_VertexPoint *newFacePoints
+) {
+    const ccs__ReduceTask task = {
+        {&ccs__QuadReduceRange, subd, 0, false, NULL},
+        NULL,
+        NULL,
+        contributions,
+        newFacePoints
+    };
+
+    ccs__ParallelRange(&task.task, faceCount, subd->parallelGrain);
+}
+
+static void
+ccs__EdgeReduce(
+    cc_Index edgeHalfedgeID,
+    cc_Index edgeTwinID,
+    const cc_VertexPoint *contributions,
+    cc_VertexPoint *newEdgePoint
+) {
+    const cc_Index halfedgeIDs[2] = {
+        edgeTwinID < 0 ? edgeHalfedgeID : cc__Min(edgeHalfedgeID, edgeTwinID),
+        edgeTwinID < 0 ? -1 : cc__Max(edgeHalfedgeID, edgeTwinID)
+    };
+    cc_VertexPoint point = {0.0f, 0.0f, 0.0f};
+
+    for (cc_Index i = 0; i < 2 && halfedgeIDs[i] >= 0; ++i) {
+        const cc_VertexPoint contribution = contributions[halfedgeIDs[i]];
+
+        cc__Add3f(point.array, point.array, contribution.array);
+    }
+
+    *newEdgePoint = point;
+}
+
+static void
+ccs__CageEdgeReduceRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const ccs__ReduceTask *reduceTask = (const ccs__ReduceTask *)task;
+    const cc_Mesh *cage = task->subd->cage;
+
+    for (cc_Index edgeID = begin; edgeID < end; ++edgeID) {
+        const cc_Index halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
+        const cc_Index twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+
+        ccs__EdgeReduce(halfedgeID,
+                        twinID,
+                        reduceTask->contributions,
+                        &reduceTask->points[edgeID]);
+    }
+}
+
+static void
+ccs__CageEdgeReduce(
+    cc_Subd *subd,
+    const cc_VertexPoint *contributions,
+    cc_VertexPoint *newEdgePoints
+) {
+    const ccs__ReduceTask task = {
+        {&ccs__CageEdgeReduceRange, subd, 0, false, NULL},
+        NULL,
+        NULL,
+        contributions,
+        newEdgePoints
+    };
+
+    ccs__ParallelRange(&task.task, ccm_EdgeCount(subd->cage), subd->parallelGrain);
+}
+
+static void
+ccs__LevelEdgeReduceRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const ccs__ReduceTask *reduceTask = (const ccs__ReduceTask *)task;
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+
+    for (cc_Index edgeID = begin; edgeID < end; ++edgeID) {
+        const cc_Index halfedgeID = ccl_EdgeToHalfedgeID(&level, edgeID);
+        const cc_Index twinID = ccl_HalfedgeTwinID(&level, halfedgeID);
+
+        ccs__EdgeReduce(halfedgeID,
+                        twinID,
+                        reduceTask->contributions,
+                        &reduceTask->points[edgeID]);
+    }
+}
+
+static void
+ccs__LevelEdgeReduce(
+    cc_Subd *subd,
+    int32_t depth,
+    const cc_VertexPoint *contributions,
+    cc_VertexPoint *newEdgePoints
+) {
+    const ccs__ReduceTask task = {
+        {&ccs__LevelEdgeReduceRange, subd, depth, false, NULL},
+        NULL,
+        NULL,
+        contributions,
+        newEdgePoints
+    };
+
+    ccs__ParallelRange(&task.task,
+                       ccm_EdgeCountAtDepth(subd->cage, depth),
+                       subd->parallelGrain);
+}
+
+
+/*******************************************************************************
+ * RefineVertexPoints_SegmentedScatter -- Atomic-free, deterministic scatter
+ *
+ */
+static void
+ccs__RefineCageVertexPoints_SegmentedScatter(
+    cc_Subd *subd,
+    cc_ScatterPlan *plan,
+    bool creases
+) {
+    const cc_Mesh *cage = subd->cage;
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+    cc_VertexPoint *contributions = plan->contributions;
+
+    ccs__CageFacePoints_Scatter(subd, contributions);
+    ccs__SegmentedReduce(subd,
+                         plan->cageFaceOffsets,
+                         plan->cageFaceHalfedgeIDs,
+                         faceCount,
+                         contributions,
+                         newFacePoints);
+
+    if (creases) {
+        ccs__CreasedCageEdgePoints_Scatter(subd, contributions);
+    } else {
+        ccs__CageEdgePoints_Scatter(subd, contributions);
+    }
+    ccs__CageEdgeReduce(subd, contributions, newEdgePoints);
+
+    if (creases) {
+        ccs__CreasedCageVertexPoints_Scatter(subd, contributions);
+    } else {
+        ccs__CageVertexPoints_Scatter(subd, contributions);
+    }
+    ccs__SegmentedReduce(subd,
+                         plan->vertexOffsets,
+                         plan->vertexHalfedgeIDs,
+                         vertexCount,
+                         contributions,
+                         newVertexPoints);
+}
+
+static void
+ccs__RefineVertexPoints_SegmentedScatter(
+    cc_Subd *subd,
+    int32_t depth,
+    cc_ScatterPlan *plan,
+    bool creases
+) {
+    const cc_Mesh *cage = subd->cage;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    const cc_Index offsetStride = ccs__ScatterPlanVertexOffsetStride(cage, depth);
+    const cc_Index halfedgeStride = ccs__ScatterPlanHalfedgeStride(cage, depth);
+    cc_VertexPoint *newFacePoints = &nextLevel.vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &nextLevel.vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = nextLevel.vertexPoints;
+    cc_VertexPoint *contributions = plan->contributions;
+
+    ccs__FacePoints_Scatter(subd, depth, contributions);
+    ccs__QuadReduce(subd, faceCount, contributions, newFacePoints);
+
+    if (creases) {
+        ccs__CreasedEdgePoints_Scatter(subd, depth, contributions);
+    } else {
+        ccs__EdgePoints_Scatter(subd, depth, contributions);
+    }
+    ccs__LevelEdgeReduce(subd, depth, contributions, newEdgePoints);
+
+    if (creases) {
+        ccs__CreasedVertexPoints_Scatter(subd, depth, contributions);
+    } else {
+        ccs__VertexPoints_Scatter(subd, depth, contributions);
+    }
+    ccs__SegmentedReduce(subd,
+                         &plan->vertexOffsets[offsetStride],
+                         &plan->vertexHalfedgeIDs[halfedgeStride],
+                         vertexCount,
+                         contributions,
+                         newVertexPoints);
+}
+
+static void
+ccs__RefineDepthVertexPoints_SegmentedScatter(
+    cc_Subd *subd,
+    int32_t depth,
+    cc_ScatterPlan *plan,
+    bool creases
+) {
+    if (depth == 0) {
+        ccs__RefineCageVertexPoints_SegmentedScatter(subd, plan, creases);
+    } else {
+        ccs__RefineVertexPoints_SegmentedScatter(subd, depth, plan, creases);
+    }
+}
+
+static void
+ccs__RefineAllVertexPoints_SegmentedScatter(
+    cc_Subd *subd,
+    cc_ScatterPlan *plan,
+    bool creases
+) {
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+    int32_t depth = 0;
+
+    CC_ASSERT(plan->maxDepth == maxDepth);
+    CC_ASSERT(!ccs__IsFinalLevelOnly(subd));
+
+    for (; depth < maxDepth && !ccs__IsRegionDepth(subd, depth); ++depth) {
+        ccs__RefineDepthVertexPoints_SegmentedScatter(subd, depth, plan, creases);
+    }
+
+    if (depth < maxDepth) {
+CC_PARALLEL
+        for (int32_t depthIt = depth; depthIt < maxDepth; ++depthIt) {
+            ccs__RefineDepthVertexPoints_SegmentedScatter(subd, depthIt, plan, creases);
+        }
+    }
+}
+
+CCDEF void
+ccs_RefineVertexPoints_SegmentedScatter(cc_Subd *subd, cc_ScatterPlan *plan)
+{
+    ccs__RefineAllVertexPoints_SegmentedScatter(subd, plan, true);
+}
+
+CCDEF void
+ccs_RefineVertexPoints_NoCreases_SegmentedScatter(cc_Subd *subd, cc_ScatterPlan *plan)
+{
+    ccs__RefineAllVertexPoints_SegmentedScatter(subd, plan, false);
+}
+
+
+/*******************************************************************************
+ * Stencil tables -- Refined vertex points as weighted sums of cage points
+ *
+ * With a fixed topology, every refined vertex point is a linear combination
+ * of the cage vertex points. The weights depend only on the halfedges and
+ * creases, so they can be computed once and re-evaluated for every new pose
+ * of the cage as a sparse matrix-vector product.
+ *
+ * The tables are built level by level: the stencils of the face, edge, and
+ * vertex points of depth d+1 are obtained by applying the creased refinement
+ * rules of the "Gather" routines to the stencils of depth d. Each stencil is
+ * stored as a sorted list of (cage vertex ID, weight) pairs in CSR format.
+ *
+ */
+typedef struct {
+    const cc_Subd *subd;
+    int32_t depth;
+    const cc_StencilTable *vertexStencils;  // vertex points at depth
+    const cc_StencilTable *faceStencils;    // face points at depth + 1
+    const cc_StencilTable *edgeStencils;    // edge points at depth + 1
+} ccs__StencilContext;
+
+typedef struct {
+    cc_Index entryCount;
+    cc_Index *vertexIDs;     // NULL when only counting entries
+    cc_Real *weights;
+} ccs__StencilRow;
+
+typedef void (*ccs__StencilRule)(const ccs__StencilContext *context,
+                                 cc_Index pointID,
+                                 ccs__StencilRow *row);
+
+static cc_StencilTable *ccs__CreateStencils(cc_Index pointCount, cc_Index entryCount)
+{
+    cc_StencilTable *stencils = (cc_StencilTable *)CC_MALLOC(sizeof(*stencils));
+
+    stencils->minDepth = 0;
+    stencils->maxDepth = 0;
+    stencils->pointCount = pointCount;
+    stencils->offsets = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * (pointCount + 1));
+    stencils->vertexIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * cc__Max(1, entryCount));
+    stencils->weights = (cc_Real *)CC_MALLOC(sizeof(cc_Real) * cc__Max(1, entryCount));
+    stencils->offsets[0] = 0;
+
+    return stencils;
+}
+
+CCDEF void ccs_ReleaseStencilTable(cc_StencilTable *table)
+{
+    CC_FREE(table->offsets);
+    CC_FREE(table->vertexIDs);
+    CC_FREE(table->weights);
+    CC_FREE(table);
+}
+
+static void
+ccs__AddStencil(
+    ccs__StencilRow *row,
+    const cc_StencilTable *stencils,
+    cc_Index pointID,
+    cc_Real weight
+) {
+    const cc_Index begin = stencils->offsets[pointID];
+    const cc_Index end = stencils->offsets[pointID + 1];
+
+    if (row->vertexIDs != NULL) {
+        for (cc_Index entryID = begin; entryID < end; ++entryID) {
+            const cc_Index rowEntryID = row->entryCount + entryID - begin;
+
+            row->vertexIDs[rowEntryID] = stencils->vertexIDs[entryID];
+            row->weights[rowEntryID] = weight * stencils->weights[entryID];
+        }
+    }
+
+    row->entryCount+= end - begin;
+}
+
+
+/*******************************************************************************
+ * SortStencil -- Sorts the entries of a stencil by cage vertex ID
+ *
+ * The rules append sorted stencils one after another, so a natural merge sort
+ * only has to merge a handful of runs. The merge is stable, which keeps the
+ * summation order of duplicate entries deterministic.
+ *
+ */
+static void
+ccs__SortStencil(
+    cc_Index entryCount,
+    cc_Index *vertexIDs,
+    cc_Real *weights,
+    cc_Index *tmpVertexIDs,
+    cc_Real *tmpWeights
+) {
+    cc_Index *srcVertexIDs = vertexIDs, *dstVertexIDs = tmpVertexIDs;
+    cc_Real *srcWeights = weights, *dstWeights = tmpWeights;
+    bool isSorted = false;
+
+    while (!isSorted) {
+        cc_Index *swapVertexIDs = srcVertexIDs;
+        cc_Real *swapWeights = srcWeights;
+
+        isSorted = true;
+
+        for (cc_Index begin = 0; begin < entryCount;) {
+            cc_Index middle = begin + 1, end, i, j, k;
+
+            while (middle < entryCount && srcVertexIDs[middle - 1] <= srcVertexIDs[middle])
+                ++middle;
+
+            end = middle;
+
+            if (middle < entryCount) {
+                isSorted = false;
+
+                for (end = middle + 1;
+                     end < entryCount && srcVertexIDs[end - 1] <= srcVertexIDs[end];
+                     ++end);
+            }
+
+            for (i = begin, j = middle, k = begin; k < end; ++k) {
+                if (j >= end || (i < middle && srcVertexIDs[i] <= srcVertexIDs[j])) {
+                    dstVertexIDs[k] = srcVertexIDs[i];
+                    dstWeights[k] = srcWeights[i++];
+                } else {
+                    dstVertexIDs[k] = srcVertexIDs[j];
+                    dstWeights[k] = srcWeights[j++];
+                }
+            }
+
+            begin = end;
+        }
+
+        srcVertexIDs = dstVertexIDs;
+        srcWeights = dstWeights;
+        dstVertexIDs = swapVertexIDs;
+        dstWeights = swapWeights;
+    }
+
+    if (srcVertexIDs != vertexIDs) {
+        CC_MEMCPY(vertexIDs, srcVertexIDs, sizeof(cc_Index) * entryCount);
+        CC_MEMCPY(weights, srcWeights, sizeof(cc_Real) * entryCount);
+    }
+}
+
+
+/*******************************************************************************
+ * ComputeStencil -- Evaluates a rule and merges the resulting stencil
+ *
+ * Duplicate vertex IDs are summed and entries with zero weight are dropped.
+ * The routine returns the number of merged entries, and writes them to
+ * (vertexIDs, weights) unless these are NULL.
+ *
+ */
+#ifndef CC_STENCIL_STACK_SIZE
+#   define CC_STENCIL_STACK_SIZE 256
+#endif
+
+static cc_Index
+ccs__ComputeStencil(
+    const ccs__StencilContext *context,
+    ccs__StencilRule rule,
+    cc_Index pointID,
+    cc_Index *vertexIDs,
+    cc_Real *weights
+) {
+    cc_Index stackVertexIDs[2 * CC_STENCIL_STACK_SIZE];
+    cc_Real stackWeights[2 * CC_STENCIL_STACK_SIZE];
+    ccs__StencilRow row = {0, NULL, NULL};
+    cc_Index *rowVertexIDs = stackVertexIDs;
+    cc_Real *rowWeights = stackWeights;
+    cc_Index entryCount, mergedCount = 0;
+
+    // count entries
+    (*rule)(context, pointID, &row);
+    entryCount = row.entryCount;
+
+    if (entryCount > CC_STENCIL_STACK_SIZE) {
+        rowVertexIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * 2 * entryCount);
+        rowWeights = (cc_Real *)CC_MALLOC(sizeof(cc_Real) * 2 * entryCount);
+    }
+
+    // gather entries
+    row.entryCount = 0;
+    row.vertexIDs = rowVertexIDs;
+    row.weights = rowWeights;
+    (*rule)(context, pointID, &row);
+    ccs__SortStencil(entryCount,
+                     rowVertexIDs,
+                     rowWeights,
+                     &rowVertexIDs[entryCount],
+                     &rowWeights[entryCount]);
+
+    // merge entries
+    for (cc_Index entryID = 0; entryID < entryCount;) {
+        const cc_Index vertexID = rowVertexIDs[entryID];
+        cc_Real weight = 0.0f;
+
+        for (; entryID < entryCount && rowVertexIDs[entryID] == vertexID; ++entryID) {
+            weight+= rowWeights[entryID];
+        }
+
+        if (weight != 0.0f) {
+            if (vertexIDs != NULL) {
+                vertexIDs[mergedCount] = vertexID;
+                weights[mergedCount] = weight;
+            }
+
+            ++mergedCount;
+        }
+    }
+
+    if (entryCount > CC_STENCIL_STACK_SIZE) {
+        CC_FREE(rowVertexIDs);
+        CC_FREE(rowWeights);
+    }
+
+    return mergedCount;
+}
+
+typedef struct {
+    const ccs__StencilContext *context;
+    ccs__StencilRule rule;
+    cc_Index *counts;
+    cc_StencilTable *stencils;
+} ccs__StencilRowTask;
+
+static void ccs__CountStencilRows(cc_Index begin, cc_Index end, void *userData)
+{
+    const ccs__StencilRowTask *task = (const ccs__StencilRowTask *)userData;
+
+    for (cc_Index pointID = begin; pointID < end; ++pointID) {
+        task->counts[pointID + 1] =
+            ccs__ComputeStencil(task->context, task->rule, pointID, NULL, NULL);
+    }
+}
+
+static void ccs__FillStencilRows(cc_Index begin, cc_Index end, void *userData)
+{
+    const ccs__StencilRowTask *task = (const ccs__StencilRowTask *)userData;
+    cc_StencilTable *stencils = task->stencils;
+
+    for (cc_Index pointID = begin; pointID < end; ++pointID) {
+        const cc_Index offset = stencils->offsets[pointID];
+
+        ccs__ComputeStencil(task->context,
+                            task->rule,
+                            pointID,
+                            &stencils->vertexIDs[offset],
+                            &stencils->weights[offset]);
+    }
+}
+
+static cc_StencilTable *
+ccs__BuildStencils(
+    const ccs__StencilContext *context,
+    ccs__StencilRule rule,
+    cc_Index pointCount
+) {
+    cc_Index *counts = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * (pointCount + 1));
+    ccs__StencilRowTask task = {context, rule, counts, NULL};
+
+    counts[0] = 0;
+    cc_ParallelFor(0, pointCount, CC_PARALLEL_GRAIN, &ccs__CountStencilRows, &task);
+
+    for (cc_Index pointID = 0; pointID < pointCount; ++pointID) {
+        counts[pointID + 1]+= counts[pointID];
+    }
+
+    task.stencils = ccs__CreateStencils(pointCount, counts[pointCount]);
+    CC_MEMCPY(task.stencils->offsets, counts, sizeof(cc_Index) * (pointCount + 1));
+    CC_FREE(counts);
+    cc_ParallelFor(0, pointCount, CC_PARALLEL_GRAIN, &ccs__FillStencilRows, &task);
+
+    return task.stencils;
+}
+
+static cc_StencilTable *
+ccs__ConcatStencils(cc_StencilTable **stencils, cc_Index stencilCount)
+{
+    cc_StencilTable *table;
+    cc_Index pointCount = 0, entryCount = 0;
+
+    for (cc_Index i = 0; i < stencilCount; ++i) {
+        pointCount+= stencils[i]->pointCount;
+        entryCount+= stencils[i]->offsets[stencils[i]->pointCount];
+    }
+
+    table = ccs__CreateStencils(pointCount, entryCount);
+    pointCount = entryCount = 0;
+
+    for (cc_Index i = 0; i < stencilCount; ++i) {
+        const cc_Index stencilPointCount = stencils[i]->pointCount;
+        const cc_Index stencilEntryCount = stencils[i]->offsets[stencilPointCount];
+
+        for (cc_Index pointID = 0; pointID < stencilPointCount; ++pointID) {
+            table->offsets[pointCount + pointID + 1] =
+                entryCount + stencils[i]->offsets[pointID + 1];
+        }
+
+        CC_MEMCPY(&table->vertexIDs[entryCount],
+                  stencils[i]->vertexIDs,
+                  sizeof(cc_Index) * stencilEntryCount);
+        CC_MEMCPY(&table->weights[entryCount],
+                  stencils[i]->weights,
+                  sizeof(cc_Real) * stencilEntryCount);
+
+        pointCount+= stencilPointCount;
+        entryCount+= stencilEntryCount;
+    }
+
+    return table;
+}
+
+
+/*******************************************************************************
+ * Stencil rules -- Weights of DeRose et al.'s rules for each new point
+ *
+ * These mirror the "CreasedCage*Points_Gather" and "Creased*Points_Gather"
+ * routines, including their boundary handling: the cage vertex rule only
+ * walks forward around the vertex, while deeper levels also walk backward.
+ *
+ */
+static void
+ccs__CageFaceStencil(
+    const ccs__StencilContext *context,
+    cc_Index faceID,
+    ccs__StencilRow *row
+) {
+    const cc_Mesh *cage = context->subd->cage;
+    const cc_Index halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
+    cc_Real faceVertexCount = 1.0f;
+    cc_Index halfedgeIt;
+
+    for (halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
+         halfedgeIt != halfedgeID;
+         halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
+        ++faceVertexCount;
+    }
+
+    do {
+        const cc_Index vertexID = ccm_HalfedgeVertexID(cage, halfedgeIt);
+
+        ccs__AddStencil(row, context->vertexStencils, vertexID, 1.0f / faceVertexCount);
+        halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt);
+    } while (halfedgeIt != halfedgeID);
+}
+
+static void
+ccs__FaceStencil(
+    const ccs__StencilContext *context,
+    cc_Index faceID,
+    ccs__StencilRow *row
+) {
+    const cc_SubdLevel level = ccs_Level(context->subd, context->depth);
+    const cc_Index halfedgeID = ccl_FaceToHalfedgeID(&level, faceID);
+
+    for (int32_t halfedgeIt = 0; halfedgeIt < 4; ++halfedgeIt) {
+        const cc_Index vertexID = ccl_HalfedgeVertexID(&level, halfedgeID + halfedgeIt);
+
+        ccs__AddStencil(row, context->vertexStencils, vertexID, 0.25f);
+    }
+}
+
+static void
+ccs__AddEdgeStencil(
+    const ccs__StencilContext *context,
+    const cc_Index vertexIDs[2],
+    const cc_Index faceIDs[2],
+    cc_Real sharp,
+    ccs__StencilRow *row
+) {
+    const cc_Real edgeWeight = cc__Satf(sharp);
+    const cc_Real vertexWeight = 0.25f + 0.25f * edgeWeight;
+    const cc_Real faceWeight = 0.25f - 0.25f * edgeWeight;
+
+    ccs__AddStencil(row, context->vertexStencils, vertexIDs[0], vertexWeight);
+    ccs__AddStencil(row, context->vertexStencils, vertexIDs[1], vertexWeight);
+
+    if (faceWeight != 0.0f) {
+        ccs__AddStencil(row, context->faceStencils, faceIDs[0], faceWeight);
+        ccs__AddStencil(row, context->faceStencils, faceIDs[1], faceWeight);
+    }
+}
+
+static void
+ccs__CageEdgeStencil(
+    const ccs__StencilContext *context,
+    cc_Index edgeID,
+    ccs__StencilRow *row
+) {
+    const cc_Mesh *cage = context->subd->cage;
+    const cc_Index halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
+    const cc_Index twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+    const cc_Index nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+    const cc_Index vertexIDs[2] = {
+        ccm_HalfedgeVertexID(cage, halfedgeID),
+        ccm_HalfedgeVertexID(cage,     nextID)
+    };
+    const cc_Index faceIDs[2] = {
+        ccm_HalfedgeFaceID(cage, halfedgeID),
+        ccm_HalfedgeFaceID(cage, cc__Max(0, twinID))
+    };
+
+    ccs__AddEdgeStencil(context,
+                        vertexIDs,
+                        faceIDs,
+                        ccm_CreaseSharpness(cage, edgeID),
+                        row);
+}
+
+static void
+ccs__EdgeStencil(
+    const ccs__StencilContext *context,
+    cc_Index edgeID,
+    ccs__StencilRow *row
+) {
+    const cc_SubdLevel level = ccs_Level(context->subd, context->depth);
+    const cc_Index halfedgeID = ccl_EdgeToHalfedgeID(&level, edgeID);
+    const cc_Index twinID = ccl_HalfedgeTwinID(&level, halfedgeID);
+    const cc_Index nextID = ccl_HalfedgeNextID(&level, halfedgeID);
+    const cc_Index vertexIDs[2] = {
+        ccl_HalfedgeVertexID(&level, halfedgeID),
+        ccl_HalfedgeVertexID(&level,     nextID)
+    };
+    const cc_Index faceIDs[2] = {
+        ccl_HalfedgeFaceID(&level,         halfedgeID),
+        ccl_HalfedgeFaceID(&level, cc__Max(0, twinID))
+    };
+
+    ccs__AddEdgeStencil(context,
+                        vertexIDs,
+                        faceIDs,
+                        ccl_CreaseSharpness(&level, edgeID),
+                        row);
+}
+
+/*
+ * The vertex rule is evaluated in two passes: the first one walks around the
+ * vertex to select the rule (smooth, crease, or corner) and the second one
+ * emits the weights of the new face and edge points of the one-ring.
+ */
+typedef struct {
+    cc_Real valence;
+    cc_Real creaseCount;
+    cc_Real avgS;
+    cc_Real oldWeight;
+    cc_Real smoothFaceWeight;
+    cc_Real smoothEdgeWeight;
+    cc_Real creaseEdgeWeight;
+    bool isSmooth;
+} ccs__VertexStencilWeights;
+
+static void
+ccs__SelectVertexStencilRule(ccs__VertexStencilWeights *weights, cc_Real creaseScale)
+{
+    const cc_Real valence = weights->valence;
+    const cc_Real creaseCount = weights->creaseCount;
+
+    weights->isSmooth = false;
+    weights->smoothFaceWeight = 0.0f;
+    weights->smoothEdgeWeight = 0.0f;
+    weights->creaseEdgeWeight = 0.0f;
+
+    if (creaseCount <= 1.0f) {
+        const cc_Real ringWeight = 1.0f / (valence * valence);
+
+        weights->isSmooth = true;
+        weights->oldWeight = 1.0f - 3.0f / valence;
+        weights->smoothFaceWeight = -ringWeight;
+        weights->smoothEdgeWeight = 4.0f * ringWeight;
+    } else if (creaseCount >= 3.0f || valence == 2.0f) {
+        weights->oldWeight = 1.0f;
+    } else {
+        const cc_Real u = cc__Satf(weights->avgS * 0.5f);
+
+        weights->oldWeight = 1.0f - 0.5f * u;
+        weights->creaseEdgeWeight = u * creaseScale;
+    }
+}
+
+static void
+ccs__AddVertexStencilRing(
+    const ccs__StencilContext *context,
+    const ccs__VertexStencilWeights *weights,
+    cc_Index faceID,
+    cc_Index edgeID,
+    cc_Real creaseWeight,
+    ccs__StencilRow *row
+) {
+    if (weights->isSmooth) {
+        ccs__AddStencil(row, context->faceStencils, faceID, weights->smoothFaceWeight);
+        ccs__AddStencil(row, context->edgeStencils, edgeID, weights->smoothEdgeWeight);
+    } else if (weights->creaseEdgeWeight * creaseWeight != 0.0f) {
+        ccs__AddStencil(row,
+                        context->edgeStencils,
+                        edgeID,
+                        weights->creaseEdgeWeight * creaseWeight);
+    }
+}
+
+static void
+ccs__CageVertexStencil(
+    const ccs__StencilContext *context,
+    cc_Index vertexID,
+    ccs__StencilRow *row
+) {
+    const cc_Mesh *cage = context->subd->cage;
+    const cc_Index halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
+    const cc_Index prevID = ccm_HalfedgePrevID(cage, halfedgeID);
+    const cc_Real thisS = ccm_HalfedgeSharpness(cage, halfedgeID);
+    const cc_Real prevS = ccm_HalfedgeSharpness(cage,     prevID);
+    const cc_Real creaseWeight = cc__Signf(thisS);
+    ccs__VertexStencilWeights weights;
+    cc_Index forwardIterator;
+
+    // rule selection
+    weights.valence = 1.0f;
+    weights.avgS = prevS;
+    weights.creaseCount = cc__Signf(prevS);
+
+    for (forwardIterator = ccm_HalfedgeTwinID(cage, prevID);
+         forwardIterator >= 0 && forwardIterator != halfedgeID;
+         forwardIterator = ccm_HalfedgeTwinID(cage, forwardIterator)) {
+        const cc_Index prevID = ccm_HalfedgePrevID(cage, forwardIterator);
+        const cc_Real prevS = ccm_HalfedgeSharpness(cage, prevID);
+
+        ++weights.valence;
+        weights.avgS+= prevS;
+        weights.creaseCount+= cc__Signf(prevS);
+        forwardIterator = prevID;
+    }
+
+    if (forwardIterator < 0) {
+        weights.creaseCount+= creaseWeight;
+        ++weights.valence;
+    }
+
+    ccs__SelectVertexStencilRule(&weights, 0.25f);
+
+    // stencil
+    ccs__AddStencil(row, context->vertexStencils, vertexID, weights.oldWeight);
+    ccs__AddVertexStencilRing(context,
+                              &weights,
+                              ccm_HalfedgeFaceID(cage, prevID),
+                              ccm_HalfedgeEdgeID(cage, prevID),
+                              cc__Signf(prevS),
+                              row);
+
+    for (forwardIterator = ccm_HalfedgeTwinID(cage, prevID);
+         forwardIterator >= 0 && forwardIterator != halfedgeID;
+         forwardIterator = ccm_HalfedgeTwinID(cage, forwardIterator)) {
+        const cc_Index prevID = ccm_HalfedgePrevID(cage, forwardIterator);
+
+        ccs__AddVertexStencilRing(context,
+                                  &weights,
+                                  ccm_HalfedgeFaceID(cage, prevID),
+                                  ccm_HalfedgeEdgeID(cage, prevID),
+                                  cc__Signf(ccm_HalfedgeSharpness(cage, prevID)),
+                                  row);
+        forwardIterator = prevID;
+    }
+
+    if (forwardIterator < 0 && !weights.isSmooth) {
+        ccs__AddVertexStencilRing(context,
+                                  &weights,
+                                  ccm_HalfedgeFaceID(cage, halfedgeID),
+                                  ccm_HalfedgeEdgeID(cage, halfedgeID),
+                                  creaseWeight,
+                                  row);
+    }
+}
+
+static void
+ccs__VertexStencil(
+    const ccs__StencilContext *context,
+    cc_Index vertexID,
+    ccs__StencilRow *row
+) {
+    const cc_SubdLevel level = ccs_Level(context->subd, context->depth);
+    const cc_Index halfedgeID = ccl_VertexToHalfedgeID(&level, vertexID);
+    const cc_Index prevID = ccl_HalfedgePrevID(&level, halfedgeID);
+    const cc_Real thisS = ccl_HalfedgeSharpness(&level, halfedgeID);
+    const cc_Real prevS = ccl_HalfedgeSharpness(&level,     prevID);
+    const cc_Real creaseWeight = cc__Signf(thisS);
+    ccs__VertexStencilWeights weights;
+    cc_Index forwardIterator, backwardIterator;
+
+    // rule selection
+    weights.valence = 1.0f;
+    weights.avgS = prevS;
+    weights.creaseCount = cc__Signf(prevS);
+
+    for (forwardIterator = ccl_HalfedgeTwinID(&level, prevID);
+         forwardIterator >= 0 && forwardIterator != halfedgeID;
+         forwardIterator = ccl_HalfedgeTwinID(&level, forwardIterator)) {
+        const cc_Index prevID = ccl_HalfedgePrevID(&level, forwardIterator);
+        const cc_Real prevS = ccl_HalfedgeSharpness(&level, prevID);
+
+        ++weights.valence;
+        weights.avgS+= prevS;
+        weights.creaseCount+= cc__Signf(prevS);
+        forwardIterator = prevID;
+    }
+
+    for (backwardIterator = ccl_HalfedgeTwinID(&level, halfedgeID);
+         forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+         backwardIterator = ccl_HalfedgeTwinID(&level, backwardIterator)) {
+        const cc_Index nextID = ccl_HalfedgeNextID(&level, backwardIterator);
+        const cc_Real nextS = ccl_HalfedgeSharpness(&level, nextID);
+
+        ++weights.valence;
+        weights.avgS+= nextS;
+        weights.creaseCount+= cc__Signf(nextS);
+        backwardIterator = nextID;
+    }
+
+    if (forwardIterator < 0) {
+        weights.creaseCount+= creaseWeight;
+        ++weights.valence;
+    }
+
+    ccs__SelectVertexStencilRule(&weights, 0.5f / weights.creaseCount);
+
+    // stencil
+    ccs__AddStencil(row, context->vertexStencils, vertexID, weights.oldWeight);
+    ccs__AddVertexStencilRing(context,
+                              &weights,
+                              ccl_HalfedgeFaceID(&level, prevID),
+                              ccl_HalfedgeEdgeID(&level, prevID),
+                              cc__Signf(prevS),
+                              row);
+
+    for (forwardIterator = ccl_HalfedgeTwinID(&level, prevID);
+         forwardIterator >= 0 && forwardIterator != halfedgeID;
+         forwardIterator = ccl_HalfedgeTwinID(&level, forwardIterator)) {
+        const cc_Index prevID = ccl_HalfedgePrevID(&level, forwardIterator);
+
+        ccs__AddVertexStencilRing(context,
+                                  &weights,
+                                  ccl_HalfedgeFaceID(&level, prevID),
+                                  ccl_HalfedgeEdgeID(&level, prevID),
+                                  cc__Signf(ccl_HalfedgeSharpness(&level, prevID)),
+                                  row);
+        forwardIterator = prevID;
+    }
+
+    for (backwardIterator = ccl_HalfedgeTwinID(&level, halfedgeID);
+         forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+         backwardIterator = ccl_HalfedgeTwinID(&level, backwardIterator)) {
+        const cc_Index nextID = ccl_HalfedgeNextID(&level, backwardIterator);
+
+        ccs__AddVertexStencilRing(context,
+                                  &weights,
+                                  ccl_HalfedgeFaceID(&level, nextID),
+                                  ccl_HalfedgeEdgeID(&level, nextID),
+                                  cc__Signf(ccl_HalfedgeSharpness(&level, nextID)),
+                                  row);
+        backwardIterator = nextID;
+    }
+
+    if (forwardIterator < 0 && !weights.isSmooth) {
+        ccs__AddVertexStencilRing(context,
+                                  &weights,
+                                  ccl_HalfedgeFaceID(&level, halfedgeID),
+                                  ccl_HalfedgeEdgeID(&level, halfedgeID),
+                                  creaseWeight,
+                                  row);
+    }
+}
+
+
+/*******************************************************************************
+ * CreateStencilTable -- Computes the stencils of the subd vertex points
+ *
+ * The table holds one stencil per vertex point of depths [minDepth, maxDepth],
+ * laid out as in the subd vertex point buffer. Use minDepth = 1 to cover every
+ * level, and minDepth = ccs_MaxDepth(subd) for the final level only. The
+ * subd must store every level (i.e., no CC_SUBD_FINAL_LEVEL_ONLY flag), but
+ * the resulting table can be evaluated on any subd of the same cage.
+ *
+ */
+static void ccs__FillCageStencils(cc_Index begin, cc_Index end, void *userData)
+{
+    cc_StencilTable *stencils = (cc_StencilTable *)userData;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        stencils->offsets[vertexID + 1] = vertexID + 1;
+        stencils->vertexIDs[vertexID] = vertexID;
+        stencils->weights[vertexID] = 1.0f;
+    }
+}
+
+static cc_StencilTable *ccs__CreateCageStencils(const cc_Mesh *cage)
+{
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    cc_StencilTable *stencils = ccs__CreateStencils(vertexCount, vertexCount);
+
+    cc_ParallelFor(0, vertexCount, CC_PARALLEL_GRAIN, &ccs__FillCageStencils, stencils);
+
+    return stencils;
+}
+
+static cc_StencilTable *
+ccs__RefineStencils(
+    const cc_Subd *subd,
+    int32_t depth,
+    const cc_StencilTable *vertexStencils
+) {
+    const cc_Mesh *cage = subd->cage;
+    const cc_Index vertexCount = ccm_VertexCountAtDepth(cage, depth);
+    const cc_Index faceCount = ccm_FaceCountAtDepth(cage, depth);
+    const cc_Index edgeCount = ccm_EdgeCountAtDepth(cage, depth);
+    cc_StencilTable *stencils[3];
+    cc_StencilTable *newVertexStencils, *newFaceStencils, *newEdgeStencils;
+    cc_StencilTable *newStencils;
+    ccs__StencilContext context = {subd, depth, vertexStencils, NULL, NULL};
+
+    newFaceStencils = ccs__BuildStencils(&context,
+                                         depth == 0 ? &ccs__CageFaceStencil
+                                                    : &ccs__FaceStencil,
+                                         faceCount);
+    context.faceStencils = newFaceStencils;
+    newEdgeStencils = ccs__BuildStencils(&context,
+                                         depth == 0 ? &ccs__CageEdgeStencil
+                                                    : &ccs__EdgeStencil,
+                                         edgeCount);
+    context.edgeStencils = newEdgeStencils;
+    newVertexStencils = ccs__BuildStencils(&context,
+                                           depth == 0 ? &ccs__CageVertexStencil
+                                                      : &ccs__VertexStencil,
+                                           vertexCount);
+
+    stencils[0] = newVertexStencils;
+    stencils[1] = newFaceStencils;
+    stencils[2] = newEdgeStencils;
+    newStencils = ccs__ConcatStencils(stencils, 3);
+
+    ccs_ReleaseStencilTable(newVertexStencils);
+    ccs_ReleaseStencilTable(newFaceStencils);
+    ccs_ReleaseStencilTable(newEdgeStencils);
+
+    return newStencils;
+}
+
+CCDEF cc_StencilTable *
+ccs_CreateStencilTable(const cc_Subd *subd, int32_t minDepth)
+{
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+    cc_StencilTable **levelStencils;
+    cc_StencilTable *stencils = ccs__CreateCageStencils(subd->cage);
+    cc_StencilTable *table;
+
+    CC_ASSERT(minDepth > 0 && minDepth <= maxDepth);
+    CC_ASSERT(!ccs__IsFinalLevelOnly(subd));
+    levelStencils = (cc_StencilTable **)CC_MALLOC(sizeof(*levelStencils) * maxDepth);
+
+    for (int32_t depth = 0; depth < maxDepth; ++depth) {
+        cc_StencilTable *newStencils = ccs__RefineStencils(subd, depth, stencils);
+
+        // only keep the levels covered by the table
+        if (depth < minDepth) {
+            ccs_ReleaseStencilTable(stencils);
+        }
+
+        levelStencils[depth] = stencils = newStencils;
+    }
+
+    if (minDepth < maxDepth) {
+        table = ccs__ConcatStencils(&levelStencils[minDepth - 1],
+                                    maxDepth - minDepth + 1);
+
+        for (int32_t depth = minDepth - 1; depth < maxDepth; ++depth) {
+            ccs_ReleaseStencilTable(levelStencils[depth]);
+        }
+    } else {
+        table = stencils;
+    }
+
+    CC_FREE(levelStencils);
+    table->minDepth = minDepth;
+    table->maxDepth = maxDepth;
+
+    return table;
+}
+
+
+/*******************************************************************************
+ * EvaluateStencilTable -- Computes vertex points from the cage vertex points
+ *
+ * The "RefineVertexPoints_Stencil" routine writes the points to the levels of
+ * the subd covered by the table; the halfedges and creases of the subd are
+ * left untouched.
+ *
+ */
+typedef struct {
+    const cc_StencilTable *table;
+    const cc_Mesh *cage;
+    cc_VertexPoint *vertexPoints;
+} ccs__StencilTask;
+
+static void ccs__EvaluateStencils(cc_Index begin, cc_Index end, void *userData)
+{
+    const ccs__StencilTask *task = (const ccs__StencilTask *)userData;
+    const cc_StencilTable *table = task->table;
+
+    for (cc_Index pointID = begin; pointID < end; ++pointID) {
+        const cc_Index entryBegin = table->offsets[pointID];
+        const cc_Index entryEnd = table->offsets[pointID + 1];
+        cc_VertexPoint vertexPoint = {0.0f, 0.0f, 0.0f};
+
+        for (cc_Index entryID = entryBegin; entryID < entryEnd; ++entryID) {
+            const cc_Index vertexID = table->vertexIDs[entryID];
+            const cc_Real weight = table->weights[entryID];
+            cc_Real tmp[3];
+
+            cc__Mul3f(tmp, ccm_VertexPoint(task->cage, vertexID).array, weight);
+            cc__Add3f(vertexPoint.array, vertexPoint.array, tmp);
+        }
+
+        task->vertexPoints[pointID] = vertexPoint;
+    }
+}
+
+CCDEF void
+ccs_EvaluateStencilTable(
+    const cc_StencilTable *table,
+    const cc_Mesh *cage,
+    cc_VertexPoint *vertexPoints
+) {
+    ccs__StencilTask task = {table, cage, vertexPoints};
+
+    cc_ParallelFor(0, table->pointCount, CC_PARALLEL_GRAIN,
+                   &ccs__EvaluateStencils, &task);
+}
+
+CCDEF void
+ccs_RefineVertexPoints_Stencil(cc_Subd *subd, const cc_StencilTable *table)
+{
+    const cc_SubdLevel level = ccs_Level(subd, table->minDepth);
+
+    CC_ASSERT(table->maxDepth == ccs_MaxDepth(subd));
+    CC_ASSERT(!ccs__IsFinalLevelOnly(subd) || table->minDepth == table->maxDepth);
+    ccs_EvaluateStencilTable(table, subd->cage, level.vertexPoints);
+}
+
+
+/*******************************************************************************
+ * RefineHalfedgeMappings -- Computes the vertex and edge to halfedge tables
+ *
+ * The tables store, for each vertex and edge of the next depth, the halfedge
+ * returned by ccs_VertexPointToHalfedgeID and ccs_EdgeToHalfedgeID. Instead
+ * of walking O(depth) heaps, they unroll the same recurrences one depth at a
+ * time from the tables of the current depth.
+ *
+ */
+static void
+ccs__CageVertexMappingsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Mesh *cage = task->subd->cage;
+    cc_Index *vertexToHalfedgeIDs = ccs_Level(task->subd, 1).vertexToHalfedgeIDs;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        vertexToHalfedgeIDs[vertexID] =
+            ccs__VertexToHalfedgeID_First(cage, vertexID);
+    }
+}
+
+static void
+ccs__CageEdgeMappingsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Mesh *cage = task->subd->cage;
+    cc_Index *edgeToHalfedgeIDs = ccs_Level(task->subd, 1).edgeToHalfedgeIDs;
+
+    for (cc_Index edgeID = begin; edgeID < end; ++edgeID) {
+        edgeToHalfedgeIDs[edgeID] =
+            ccs__EdgeToHalfedgeID_First(cage, edgeID);
+    }
+}
+
+static void ccs__RefineCageHalfedgeMappings(cc_Subd *subd)
+{
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    const cc_Index grain = subd->parallelGrain;
+    ccs__RangeTask task = {&ccs__CageVertexMappingsRange, subd, 0, false, NULL};
+
+    ccs__ParallelLoop(&task, ccl_VertexCount(&nextLevel), grain);
+    task.routine = &ccs__CageEdgeMappingsRange;
+    ccs__ParallelLoop(&task, ccl_EdgeCount(&nextLevel), grain);
+}
+
+// vertex points: [V) old vertices, [V, V + F) faces, [V + F, V + F + E) edges
+static void
+ccs__VertexMappingsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+    cc_Index *vertexToHalfedgeIDs = ccs_Level(task->subd, task->depth + 1).vertexToHalfedgeIDs;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        vertexToHalfedgeIDs[vertexID] = 4 * level.vertexToHalfedgeIDs[vertexID] + 0;
+    }
+}
+
+static void
+ccs__FaceMappingsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    cc_Index *vertexToHalfedgeIDs = ccs_Level(task->subd, task->depth + 1).vertexToHalfedgeIDs;
+
+    for (cc_Index faceID = begin; faceID < end; ++faceID) {
+        vertexToHalfedgeIDs[vertexCount + faceID] =
+            4 * ccm_FaceToHalfedgeID_Quad(faceID) + 2;
+    }
+}
+
+static void
+ccs__EdgeMappingsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+    const cc_SubdLevel nextLevel = ccs_Level(task->subd, task->depth + 1);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    cc_Index *vertexToHalfedgeIDs = nextLevel.vertexToHalfedgeIDs;
+    cc_Index *edgeToHalfedgeIDs = nextLevel.edgeToHalfedgeIDs;
+
+    for (cc_Index edgeID = begin; edgeID < end; ++edgeID) {
+        const cc_Index halfedgeID = level.edgeToHalfedgeIDs[edgeID];
+        const cc_Index nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+
+        vertexToHalfedgeIDs[vertexCount + faceCount + edgeID] = 4 * halfedgeID + 1;
+
+        // edges: [2E) split edges
+        edgeToHalfedgeIDs[2 * edgeID + 0] = 4 * halfedgeID + 0;
+        edgeToHalfedgeIDs[2 * edgeID + 1] = 4 * nextID + 3;
+    }
+}
+
+// edges: [2E, 2E + H) inner edges
+static void
+ccs__InnerEdgeMappingsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Index edgeCount = ccm_EdgeCountAtDepth(task->subd->cage, task->depth);
+    cc_Index *edgeToHalfedgeIDs = ccs_Level(task->subd, task->depth + 1).edgeToHalfedgeIDs;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+
+        edgeToHalfedgeIDs[2 * edgeCount + halfedgeID] =
+            cc__Max(4 * halfedgeID + 1, 4 * nextID + 2);
+    }
+}
+
+static void ccs__RefineHalfedgeMappings(cc_Subd *subd, int32_t depth)
+{
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_Index grain = subd->parallelGrain;
+    ccs__RangeTask task = {&ccs__VertexMappingsRange, subd, depth, false, NULL};
+
+    ccs__ParallelLoop(&task, ccl_VertexCount(&level), grain);
+    task.routine = &ccs__FaceMappingsRange;
+    ccs__ParallelLoop(&task, ccl_FaceCount(&level), grain);
+    task.routine = &ccs__EdgeMappingsRange;
+    ccs__ParallelLoop(&task, ccl_EdgeCount(&level), grain);
+    task.routine = &ccs__InnerEdgeMappingsRange;
+    ccs__ParallelLoop(&task, ccl_HalfedgeCount(&level), grain);
+}
+
+
+/*******************************************************************************
+ * RefineVertexValences -- Computes the cage one-rings and the valence tables
+ *
+ * The one-rings of the cage are stored in CSR form: the halfedges leaving
+ * vertex v are [offsets[v], offsets[v + 1]), listed in ccm_PrevVertexHalfedgeID
+ * order and starting on the boundary, if any. The valences count the faces
+ * around each vertex and are negated on boundaries. Past the cage, they follow
+ * from the refinement rules: old vertices keep theirs, face points get the
+ * face size and edge points get 4, or -2 on boundary edges.
+ *
+ */
+static cc_Index ccs__CageVertexRingStartID(const cc_Mesh *cage, cc_Index vertexID)
+{
+    const cc_Index halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
+    cc_Index startID = halfedgeID;
+    cc_Index iterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
+
+    while (iterator >= 0 && iterator != halfedgeID) {
+        iterator = ccm_PrevVertexHalfedgeID(cage, iterator);
+    }
+
+    // boundary vertex: rewind to the halfedge that has no twin
+    if (iterator < 0) {
+        for (iterator = ccm_NextVertexHalfedgeID(cage, halfedgeID);
+             iterator >= 0;
+             iterator = ccm_NextVertexHalfedgeID(cage, iterator)) {
+            startID = iterator;
+        }
+    }
+
+    return startID;
+}
+
+static void
+ccs__CageRingSizesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Mesh *cage = task->subd->cage;
+    cc_Index *ringOffsets = task->subd->cageRingOffsets;
+    int32_t *valences = ccs_Level(task->subd, 1).vertexValences;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        const cc_Index halfedgeID = ccs__CageVertexRingStartID(cage, vertexID);
+        cc_Index iterator;
+        int32_t valence = 1;
+
+        for (iterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
+             iterator >= 0 && iterator != halfedgeID;
+             iterator = ccm_PrevVertexHalfedgeID(cage, iterator)) {
+            ++valence;
+        }
+
+        ringOffsets[vertexID + 1] = valence;
+        valences[vertexID] = iterator < 0 ? -valence : valence;
+    }
+}
+
+static void
+ccs__CageRingHalfedgesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Mesh *cage = task->subd->cage;
+    const cc_Index *ringOffsets = task->subd->cageRingOffsets;
+    cc_Index *ringHalfedgeIDs = task->subd->cageRingHalfedgeIDs;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        cc_Index iterator = ccs__CageVertexRingStartID(cage, vertexID);
+
+        for (cc_Index ringID = ringOffsets[vertexID];
+                      ringID < ringOffsets[vertexID + 1];
+                      ++ringID) {
+            ringHalfedgeIDs[ringID] = iterator;
+            iterator = ccm_PrevVertexHalfedgeID(cage, iterator);
+        }
+    }
+}
+
+static void
+ccs__CageFaceValencesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Mesh *cage = task->subd->cage;
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    int32_t *valences = ccs_Level(task->subd, 1).vertexValences;
+
+    for (cc_Index faceID = begin; faceID < end; ++faceID) {
+        const cc_Index halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
+        int32_t faceVertexCount = 1;
+
+        for (cc_Index halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
+                     halfedgeIt != halfedgeID;
+                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
+            ++faceVertexCount;
+        }
+
+        valences[vertexCount + faceID] = faceVertexCount;
+    }
+}
+
+static void
+ccs__CageEdgeValencesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Mesh *cage = task->subd->cage;
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    int32_t *valences = ccs_Level(task->subd, 1).vertexValences;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+        const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+
+        if (halfedgeID > twinID) {
+            valences[vertexCount + faceCount + edgeID] = twinID < 0 ? -2 : 4;
+        }
+    }
+}
+
+static void ccs__RefineCageVertexValences(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index grain = subd->parallelGrain;
+    cc_Index *ringOffsets = subd->cageRingOffsets;
+    ccs__RangeTask task = {&ccs__CageRingSizesRange, subd, 0, false, NULL};
+
+    ccs__ParallelLoop(&task, vertexCount, grain);
+
+    ringOffsets[0] = 0;
+    for (cc_Index vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        ringOffsets[vertexID + 1]+= ringOffsets[vertexID];
+    }
+
+    task.routine = &ccs__CageRingHalfedgesRange;
+    ccs__ParallelLoop(&task, vertexCount, grain);
+    task.routine = &ccs__CageFaceValencesRange;
+    ccs__ParallelLoop(&task, ccm_FaceCount(cage), grain);
+    task.routine = &ccs__CageEdgeValencesRange;
+    ccs__ParallelLoop(&task, ccm_HalfedgeCount(cage), grain);
+}
+
+static void
+ccs__VertexValencesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+    int32_t *valences = ccs_Level(task->subd, task->depth + 1).vertexValences;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        valences[vertexID] = level.vertexValences[vertexID];
+    }
+}
+
+static void
+ccs__FaceValencesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Index vertexCount = ccm_VertexCountAtDepth(task->subd->cage, task->depth);
+    int32_t *valences = ccs_Level(task->subd, task->depth + 1).vertexValences;
+
+    for (cc_Index faceID = begin; faceID < end; ++faceID) {
+        valences[vertexCount + faceID] = 4;
+    }
+}
+
+static void
+ccs__EdgeValencesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    const cc_Index faceCount = ccl_FaceCount(&level);
+    int32_t *valences = ccs_Level(task->subd, task->depth + 1).vertexValences;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        const cc_Index twinID = ccl_HalfedgeTwinID(&level, halfedgeID);
+        const cc_Index edgeID = ccl_HalfedgeEdgeID(&level, halfedgeID);
+
+        if (halfedgeID > twinID) {
+            valences[vertexCount + faceCount + edgeID] = twinID < 0 ? -2 : 4;
+        }
+    }
+}
+
+static void ccs__RefineVertexValences(cc_Subd *subd, int32_t depth)
+{
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_Index grain = subd->parallelGrain;
+    ccs__RangeTask task = {&ccs__VertexValencesRange, subd, depth, false, NULL};
+
+    ccs__ParallelLoop(&task, ccl_VertexCount(&level), grain);
+    task.routine = &ccs__FaceValencesRange;
+    ccs__ParallelLoop(&task, ccl_FaceCount(&level), grain);
+    task.routine = &ccs__EdgeValencesRange;
+    ccs__ParallelLoop(&task, ccl_HalfedgeCount(&level), grain);
+}
+
+
+/*******************************************************************************
+ * RefineBoundaryHalfedges -- Computes the boundary halfedges of the next depth
+ *
+ * A boundary halfedge h splits into the boundary halfedges 4h and
+ * 4 * next(h) + 3, which respectively start at the vertex and at the edge
+ * point of h.
+ *
+ */
+static void
+ccs__CageBoundaryHalfedgesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Mesh *cage = task->subd->cage;
+    const cc_Index *boundaryHalfedgeIDs = task->subd->boundaryHalfedgeIDs;
+    cc_Index *nextBoundaryHalfedgeIDs = ccs_Level(task->subd, 1).boundaryHalfedgeIDs;
+
+    for (cc_Index boundaryID = begin; boundaryID < end; ++boundaryID) {
+        const cc_Index halfedgeID = boundaryHalfedgeIDs[boundaryID];
+        const cc_Index nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+
+        nextBoundaryHalfedgeIDs[2 * boundaryID + 0] = 4 * halfedgeID + 0;
+        nextBoundaryHalfedgeIDs[2 * boundaryID + 1] = 4 * nextID + 3;
+    }
+}
+
+static void ccs__RefineCageBoundaryHalfedges(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const cc_Index halfedgeCount = ccm_HalfedgeCount(cage);
+    cc_Index *boundaryHalfedgeIDs = subd->boundaryHalfedgeIDs;
+    cc_Index boundaryID = 0;
+    ccs__RangeTask task = {&ccs__CageBoundaryHalfedgesRange, subd, 0, false, NULL};
+
+    for (cc_Index halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        if (ccm_HalfedgeTwinID(cage, halfedgeID) < 0) {
+            boundaryHalfedgeIDs[boundaryID++] = halfedgeID;
+        }
+    }
+
+    ccs__ParallelLoop(&task, subd->boundaryHalfedgeCount, subd->parallelGrain);
+}
+
+static void
+ccs__BoundaryHalfedgesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+    cc_Index *nextBoundaryHalfedgeIDs =
+        ccs_Level(task->subd, task->depth + 1).boundaryHalfedgeIDs;
+
+    for (cc_Index boundaryID = begin; boundaryID < end; ++boundaryID) {
+        const cc_Index halfedgeID = level.boundaryHalfedgeIDs[boundaryID];
+        const cc_Index nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+
+        nextBoundaryHalfedgeIDs[2 * boundaryID + 0] = 4 * halfedgeID + 0;
+        nextBoundaryHalfedgeIDs[2 * boundaryID + 1] = 4 * nextID + 3;
+    }
+}
+
+static void ccs__RefineBoundaryHalfedges(cc_Subd *subd, int32_t depth)
+{
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    ccs__RangeTask task = {&ccs__BoundaryHalfedgesRange, subd, depth, false, NULL};
+
+    ccs__ParallelLoop(&task, level.boundaryHalfedgeCount, subd->parallelGrain);
+}
+
+
+/*******************************************************************************
+ * RefineHalfedgeTables -- Refines the optional per-halfedge tables of a subd
+ *
+ * This routine is called once the halfedges of the next depth are refined.
+ *
+ */
+static void ccs__RefineHalfedgeTables(cc_Subd *subd, int32_t depth)
+{
+    if (depth == 0) {
+        if (subd->vertexToHalfedgeIDs != NULL) {
+            ccs__RefineCageHalfedgeMappings(subd);
+        }
+
+        if (subd->vertexValences != NULL) {
+            ccs__RefineCageVertexValences(subd);
+        }
+
+        ccs__RefineCageBoundaryHalfedges(subd);
+    } else {
+        if (subd->vertexToHalfedgeIDs != NULL) {
+            ccs__RefineHalfedgeMappings(subd, depth);
+        }
+
+        if (subd->vertexValences != NULL) {
+            ccs__RefineVertexValences(subd, depth);
+        }
+
+        ccs__RefineBoundaryHalfedges(subd, depth);
+    }
+}
+
+
+/*******************************************************************************
+ * RefineCageHalfedges -- Applies halfedge refinement rules on the cage mesh
+ *
+ * This routine computes the halfedges of the control cage after one subdivision
+ * step and stores them in the subd.
+ *
+ */
+static void
+ccs__RefineCageHalfedge(
+    const cc_Mesh *cage,
+    cc_Halfedge_SemiRegular *halfedgesOut,
+    cc_Index halfedgeID
+) {
+    const cc_Index vertexCount = ccm_VertexCount(cage);
+    const cc_Index edgeCount = ccm_EdgeCount(cage);
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_Index twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+    const cc_Index prevID = ccm_HalfedgePrevID(cage, halfedgeID);
+    const cc_Index nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+    const cc_Index faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+    const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+    const cc_Index prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
+    const cc_Index prevTwinID = ccm_HalfedgeTwinID(cage, prevID);
+    const cc_Index vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
+    const cc_Index twinNextID =
+        twinID >= 0 ? ccm_HalfedgeNextID(cage, twinID) : -1;
+    cc_Halfedge_SemiRegular *newHalfedges[4] = {
+        &halfedgesOut[(4 * halfedgeID + 0)],
+        &halfedgesOut[(4 * halfedgeID + 1)],
+        &halfedgesOut[(4 * halfedgeID + 2)],
+        &halfedgesOut[(4 * halfedgeID + 3)]
+    };
+
+    // twinIDs
+    newHalfedges[0]->twinID = 4 * twinNextID + 3;
+    newHalfedges[1]->twinID = 4 * nextID     + 2;
+    newHalfedges[2]->twinID = 4 * prevID     + 1;
+    newHalfedges[3]->twinID = 4 * prevTwinID + 0;
+
+    // edgeIDs
+    newHalfedges[0]->edgeID = 2 * edgeID + (halfedgeID > twinID ? 0 : 1);
+    newHalfedges[1]->edgeID = 2 * edgeCount + halfedgeID;
+    newHalfedges[2]->edgeID = 2 * edgeCount + prevID;
+    newHalfedges[3]->edgeID = 2 * prevEdgeID + (prevID > prevTwinID ? 1 : 0);
+
+    // vertexIDs
+    newHalfedges[0]->vertexID = vertexID;
+    newHalfedges[1]->vertexID = vertexCount + faceCount + edgeID;
+    newHalfedges[2]->vertexID = vertexCount + faceID;
+    newHalfedges[3]->vertexID = vertexCount + faceCount + prevEdgeID;
+}
+
+static void
+ccs__CageHalfedgesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Mesh *cage = task->subd->cage;
+    cc_Halfedge_SemiRegular *halfedgesOut = ccs_Level(task->subd, 1).halfedges;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        ccs__RefineCageHalfedge(cage, halfedgesOut, halfedgeID);
+    }
+}
+
+static void ccs__RefineCageHalfedges(cc_Subd *subd)
+{
+    ccs__RangeTask task = {&ccs__CageHalfedgesRange, subd, 0, false, NULL};
+
+    ccs__ParallelLoop(&task, ccm_HalfedgeCount(subd->cage), subd->parallelGrain);
+    ccs__RefineHalfedgeTables(subd, 0);
+}
+
+
+/*******************************************************************************
+ * RefineHalfedges -- Applies halfedge refinement on the subd
+ *
+ * This routine computes the halfedges of the next subd level.
+ *
+ */
+static void
+ccs__RefineHalfedge(
+    const cc_SubdLevel *level,
+    cc_Halfedge_SemiRegular *halfedgesOut,
+    cc_Index halfedgeID
+) {
+    const cc_Index vertexCount = ccl_VertexCount(level);
+    const cc_Index edgeCount = ccl_EdgeCount(level);
+    const cc_Index faceCount = ccl_FaceCount(level);
+    const cc_Index twinID = ccl_HalfedgeTwinID(level, halfedgeID);
+    const cc_Index prevID = ccm_HalfedgePrevID_Quad(halfedgeID);
+    const cc_Index nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+    const cc_Index faceID = ccm_HalfedgeFaceID_Quad(halfedgeID);
+    const cc_Index edgeID = ccl_HalfedgeEdgeID(level, halfedgeID);
+    const cc_Index vertexID = ccl_HalfedgeVertexID(level, halfedgeID);
+    const cc_Index prevEdgeID = ccl_HalfedgeEdgeID(level, prevID);
+    const cc_Index prevTwinID = ccl_HalfedgeTwinID(level, prevID);
+    const cc_Index twinNextID = ccm_HalfedgeNextID_Quad(twinID);
+    cc_Halfedge_SemiRegular *newHalfedges[4] = {
+        &halfedgesOut[(4 * halfedgeID + 0)],
+        &halfedgesOut[(4 * halfedgeID + 1)],
+        &halfedgesOut[(4 * halfedgeID + 2)],
+        &halfedgesOut[(4 * halfedgeID + 3)]
+    };
+
+    // twinIDs
+    newHalfedges[0]->twinID = 4 * twinNextID + 3;
+    newHalfedges[1]->twinID = 4 * nextID     + 2;
+    newHalfedges[2]->twinID = 4 * prevID     + 1;
+    newHalfedges[3]->twinID = 4 * prevTwinID + 0;
+
+    // edgeIDs
+    newHalfedges[0]->edgeID = 2 * edgeID + (halfedgeID > twinID ? 0 : 1);
+    newHalfedges[1]->edgeID = 2 * edgeCount + halfedgeID;
+    newHalfedges[2]->edgeID = 2 * edgeCount + prevID;
+    newHalfedges[3]->edgeID = 2 * prevEdgeID + (prevID > prevTwinID ? 1 : 0);
+
+    // vertexIDs
+    newHalfedges[0]->vertexID = vertexID;
+    newHalfedges[1]->vertexID = vertexCount + faceCount + edgeID;
+    newHalfedges[2]->vertexID = vertexCount + faceID;
+    newHalfedges[3]->vertexID = vertexCount + faceCount + prevEdgeID;
+}
+
+static void
+ccs__HalfedgesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+    cc_Halfedge_SemiRegular *halfedgesOut = ccs_Level(task->subd, task->depth + 1).halfedges;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        ccs__RefineHalfedge(&level, halfedgesOut, halfedgeID);
+    }
+}
+
+static void ccs__RefineHalfedges(cc_Subd *subd, int32_t depth)
+{
+    const cc_Index halfedgeCount = ccm_HalfedgeCountAtDepth(subd->cage, depth);
+    ccs__RangeTask task = {&ccs__HalfedgesRange, subd, depth, false, NULL};
+
+    ccs__ParallelLoop(&task, halfedgeCount, subd->parallelGrain);
+    ccs__RefineHalfedgeTables(subd, depth);
+}
+
+
+/*******************************************************************************
+ * RefineHalfedges
+ *
+ */
+CCDEF void ccs_RefineHalfedges(cc_Subd *subd)
+{
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+
+    ccs__RefineCageHalfedges(subd);
+
+    for (int32_t depth = 1; depth < maxDepth; ++depth) {
+        ccs__RefineHalfedges(subd, depth);
+    }
+}
+
+
+#ifndef CC_DISABLE_UV
+/*******************************************************************************
+ * RefineCageVertexUvs -- Refines UVs of the cage mesh
+ *
+ * This routine computes the UVs of the control cage after one subdivision
+ * step and stores them in the subd. Note that since UVs are not linked to
+ * the topology of the mesh, we store the results of the UV computation
+ * within the halfedge buffer.
+ *
+ */
+static void
+ccs__RefineCageVertexUv(
+    const cc_Mesh *cage,
+    cc_Halfedge_SemiRegular *halfedgesOut,
+    cc_Index halfedgeID
+) {
+    const cc_Index prevID = ccm_HalfedgePrevID(cage, halfedgeID);
+    const cc_Index nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+    const cc_VertexUv uv = ccm_HalfedgeVertexUv(cage, halfedgeID);
+    const cc_VertexUv nextUv = ccm_HalfedgeVertexUv(cage, nextID);
+    const cc_VertexUv prevUv = ccm_HalfedgeVertexUv(cage, prevID);
+    cc_VertexUv edgeUv, prevEdgeUv;
+    cc_VertexUv faceUv = uv;
+    cc_Index m = 1;
+    cc_Halfedge_SemiRegular *newHalfedges[4] = {
+        &halfedgesOut[(4 * halfedgeID + 0)],
+        &halfedgesOut[(4 * halfedgeID + 1)],
+        &halfedgesOut[(4 * halfedgeID + 2)],
+        &halfedgesOut[(4 * halfedgeID + 3)]
+    };
+
+    cc__Lerp2f(edgeUv.array    , uv.array, nextUv.array, 0.5f);
+    cc__Lerp2f(prevEdgeUv.array, uv.array, prevUv.array, 0.5f);
+
+    for (cc_Index halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
+                 halfedgeIt != halfedgeID;
+                 halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
+        const cc_VertexUv uv = ccm_HalfedgeVertexUv(cage, halfedgeIt);
+
+        faceUv.u+= uv.array[0];
+        faceUv.v+= uv.array[1];
+        ++m;
+    }
+    faceUv.u/= (cc_Real)m;
+    faceUv.v/= (cc_Real)m;
+
+    newHalfedges[0]->uvID = cc__EncodeUv(uv);
+    newHalfedges[1]->uvID = cc__EncodeUv(edgeUv);
+    newHalfedges[2]->uvID = cc__EncodeUv(faceUv);
+    newHalfedges[3]->uvID = cc__EncodeUv(prevEdgeUv);
+}
+
+static void
+ccs__CageVertexUvsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Mesh *cage = task->subd->cage;
+    cc_Halfedge_SemiRegular *halfedgesOut = ccs_Level(task->subd, 1).halfedges;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        ccs__RefineCageVertexUv(cage, halfedgesOut, halfedgeID);
+    }
+}
+
+static void ccs__RefineCageVertexUvs(cc_Subd *subd)
+{
+    ccs__RangeTask task = {&ccs__CageVertexUvsRange, subd, 0, false, NULL};
+
+    ccs__ParallelLoop(&task, ccm_HalfedgeCount(subd->cage), subd->parallelGrain);
+}
+
+
+/*******************************************************************************
+ * RefineVertexUvs -- Applies UV refinement on the subd
+ *
+ * This routine computes the UVs of the next subd level.
+ *
+ */
+static void
+ccs__RefineVertexUv(
+    const cc_SubdLevel *level,
+    cc_Halfedge_SemiRegular *halfedgesOut,
+    cc_Index halfedgeID
+) {
+    const cc_Index prevID = ccm_HalfedgePrevID_Quad(halfedgeID);
+    const cc_Index nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+    const cc_VertexUv uv = ccl_HalfedgeVertexUv(level, halfedgeID);
+    const cc_VertexUv nextUv = ccl_HalfedgeVertexUv(level, nextID);
+    const cc_VertexUv prevUv = ccl_HalfedgeVertexUv(level, prevID);
+    cc_VertexUv edgeUv, prevEdgeUv;
+    cc_VertexUv faceUv = uv;
+    cc_Halfedge_SemiRegular *newHalfedges[4] = {
+        &halfedgesOut[(4 * halfedgeID + 0)],
+        &halfedgesOut[(4 * halfedgeID + 1)],
+        &halfedgesOut[(4 * halfedgeID + 2)],
+        &halfedgesOut[(4 * halfedgeID + 3)]
+    };
+
+    cc__Lerp2f(edgeUv.array    , uv.array, nextUv.array, 0.5f);
+    cc__Lerp2f(prevEdgeUv.array, uv.array, prevUv.array, 0.5f);
+
+    for (cc_Index halfedgeIt = ccl_HalfedgeNextID(level, halfedgeID);
+                 halfedgeIt != halfedgeID;
+                 halfedgeIt = ccl_HalfedgeNextID(level, halfedgeIt)) {
+        const cc_VertexUv uv = ccl_HalfedgeVertexUv(level, halfedgeIt);
+
+        faceUv.u+= uv.array[0];
+        faceUv.v+= uv.array[1];
+    }
+    faceUv.u/= 4.0f;
+    faceUv.v/= 4.0f;
+
+    newHalfedges[0]->uvID = ccl__HalfedgeVertexUvID(level, halfedgeID);
+    newHalfedges[1]->uvID = cc__EncodeUv(edgeUv);
+    newHalfedges[2]->uvID = cc__EncodeUv(faceUv);
+    newHalfedges[3]->uvID = cc__EncodeUv(prevEdgeUv);
+}
+
+static void
+ccs__VertexUvsRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+    cc_Halfedge_SemiRegular *halfedgesOut = ccs_Level(task->subd, task->depth + 1).halfedges;
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        ccs__RefineVertexUv(&level, halfedgesOut, halfedgeID);
+    }
+}
+
+static void ccs__RefineVertexUvs(cc_Subd *subd, int32_t depth)
+{
+    const cc_Index halfedgeCount = ccm_HalfedgeCountAtDepth(subd->cage, depth);
+    ccs__RangeTask task = {&ccs__VertexUvsRange, subd, depth, false, NULL};
+
+    ccs__ParallelLoop(&task, halfedgeCount, subd->parallelGrain);
+}
+
+
+/*******************************************************************************
+ * RefineUvs
+ *
+ */
+CCDEF void ccs_RefineVertexUvs(cc_Subd *subd)
+{
+    if (ccm_UvCount(subd->cage) > 0) {
+        const int32_t maxDepth = ccs_MaxDepth(subd);
+
+        ccs__RefineCageVertexUvs(subd);
+
+        for (int32_t depth = 1; depth < maxDepth; ++depth) {
+            ccs__RefineVertexUvs(subd, depth);
+        }
+    }
+}
+#endif
+
+
+/*******************************************************************************
+ * CreaseSharpnessRange -- Computes the sharpness bounds of a subd level
+ *
+ * The largest sharpness is taken over the interior edges and the smallest
+ * one over the boundary edges. Once the former is zero and the latter is at
+ * least one, the interior is smooth and the boundary is sharp, so the level
+ * can be refined with the crease-free kernels plus boundary fix-ups (see
+ * RefineLevelVertexPoints). The reductions are done over a fixed number of
+ * chunks so that they do not depend on the number of threads. With sparse
+ * creases, only the stored creases and the boundary halfedges are visited.
+ *
+ */
+#ifndef CC_SHARPNESS_CHUNK_COUNT
+#   define CC_SHARPNESS_CHUNK_COUNT 256
+#endif
+
+typedef struct {
+    ccs__RangeTask task;    // first member, so that the routine can cast it back
+    const uint64_t *boundaryBits;
+    cc_Real *chunkMaxSharpness;
+    cc_Real *chunkMinSharpness;
+} ccs__SharpnessTask;
+
+static void
+ccs__SparseSharpnessChunks(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const ccs__SharpnessTask *sharpnessTask = (const ccs__SharpnessTask *)task;
+    const cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_Index creaseCount = ccs__CreaseCountAtDepth(subd, depth);
+    const cc_Index boundaryHalfedgeCount = level.boundaryHalfedgeCount;
+    const cc_Index creaseChunkSize =
+        (creaseCount + CC_SHARPNESS_CHUNK_COUNT - 1) / CC_SHARPNESS_CHUNK_COUNT;
+    const cc_Index boundaryChunkSize =
+        (boundaryHalfedgeCount + CC_SHARPNESS_CHUNK_COUNT - 1) / CC_SHARPNESS_CHUNK_COUNT;
+    const uint64_t *boundaryBits = sharpnessTask->boundaryBits;
+
+    for (cc_Index chunkID = begin; chunkID < end; ++chunkID) {
+        const cc_Index creaseBegin = cc__Min(chunkID * creaseChunkSize, creaseCount);
+        const cc_Index creaseEnd = cc__Min(creaseBegin + creaseChunkSize, creaseCount);
+        const cc_Index boundaryBegin =
+            cc__Min(chunkID * boundaryChunkSize, boundaryHalfedgeCount);
+        const cc_Index boundaryEnd =
+            cc__Min(boundaryBegin + boundaryChunkSize, boundaryHalfedgeCount);
+        cc_Real interiorSharpness = 0.0f;
+        cc_Real boundarySharpness = 1.0f;
+
+        for (cc_Index creaseID = creaseBegin; creaseID < creaseEnd; ++creaseID) {
+            const cc_Index cageEdgeID = ccs__CreaseEdgeID(subd, creaseID, depth) >> depth;
+
+            if (!(boundaryBits[cageEdgeID >> 6] & ((uint64_t)1 << (cageEdgeID & 63)))) {
+                interiorSharpness = cc__Maxf(interiorSharpness,
+                                             level.creases[creaseID].sharpness);
+            }
+        }
+
+        for (cc_Index i = boundaryBegin; i < boundaryEnd; ++i) {
+            const cc_Index halfedgeID = level.boundaryHalfedgeIDs[i];
+
+            boundarySharpness = cc__Minf(boundarySharpness,
+                                         ccl_HalfedgeSharpness(&level, halfedgeID));
+        }
+
+        sharpnessTask->chunkMaxSharpness[chunkID] = interiorSharpness;
+        sharpnessTask->chunkMinSharpness[chunkID] = boundarySharpness;
+    }
+}
+
+static void ccs__ComputeSparseCreaseSharpnessRange(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const cc_Index wordCount = ccs__CreaseWordCount(cage);
+    uint64_t *boundaryBits = (uint64_t *)CC_MALLOC(sizeof(uint64_t) * wordCount);
+    cc_Real chunkMaxSharpness[CC_SHARPNESS_CHUNK_COUNT];
+    cc_Real chunkMinSharpness[CC_SHARPNESS_CHUNK_COUNT];
+    cc_Real maxSharpness = 0.0f;
+    cc_Real minSharpness = 1.0f;
+    ccs__SharpnessTask task = {
+        {&ccs__SparseSharpnessChunks, subd, depth, false, NULL},
+        boundaryBits,
+        chunkMaxSharpness,
+        chunkMinSharpness
+    };
+
+    // descendants of a cage edge lie on it, so they share its boundary status
+    CC_MEMSET(boundaryBits, 0, sizeof(uint64_t) * wordCount);
+    for (cc_Index i = 0; i < subd->boundaryHalfedgeCount; ++i) {
+        const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, subd->boundaryHalfedgeIDs[i]);
+
+        boundaryBits[edgeID >> 6]|= (uint64_t)1 << (edgeID & 63);
+    }
+
+    ccs__ParallelLoop(&task.task, CC_SHARPNESS_CHUNK_COUNT, 1);
+
+    for (int32_t chunkID = 0; chunkID < CC_SHARPNESS_CHUNK_COUNT; ++chunkID) {
+        maxSharpness = cc__Maxf(maxSharpness, chunkMaxSharpness[chunkID]);
+        minSharpness = cc__Minf(minSharpness, chunkMinSharpness[chunkID]);
+    }
+
+    subd->maxCreaseSharpness[depth] = maxSharpness;
+    subd->minBoundarySharpness[depth] = minSharpness;
+    CC_FREE(boundaryBits);
+}
+
+static void
+ccs__SharpnessChunks(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const ccs__SharpnessTask *sharpnessTask = (const ccs__SharpnessTask *)task;
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+    const cc_Index halfedgeCount = ccl_HalfedgeCount(&level);
+    const cc_Index chunkSize =
+        (halfedgeCount + CC_SHARPNESS_CHUNK_COUNT - 1) / CC_SHARPNESS_CHUNK_COUNT;
+
+    for (cc_Index chunkID = begin; chunkID < end; ++chunkID) {
+        const cc_Index halfedgeBegin = cc__Min(chunkID * chunkSize, halfedgeCount);
+        const cc_Index halfedgeEnd = cc__Min(halfedgeBegin + chunkSize, halfedgeCount);
+        cc_Real interiorSharpness = 0.0f;
+        cc_Real boundarySharpness = 1.0f;
+
+        for (cc_Index halfedgeID = halfedgeBegin; halfedgeID < halfedgeEnd; ++halfedgeID) {
+            const cc_Real sharpness = ccl_HalfedgeSharpness(&level, halfedgeID);
+
+            if (ccl_HalfedgeTwinID(&level, halfedgeID) >= 0) {
+                interiorSharpness = cc__Maxf(interiorSharpness, sharpness);
+            } else {
+                boundarySharpness = cc__Minf(boundarySharpness, sharpness);
+            }
+        }
+
+        sharpnessTask->chunkMaxSharpness[chunkID] = interiorSharpness;
+        sharpnessTask->chunkMinSharpness[chunkID] = boundarySharpness;
+    }
+}
+
+static void ccs__ComputeCreaseSharpnessRange(cc_Subd *subd, int32_t depth)
+{
+    if (subd->creaseBits != NULL) {
+        ccs__ComputeSparseCreaseSharpnessRange(subd, depth);
+
+        return;
+    }
+
+    cc_Real chunkMaxSharpness[CC_SHARPNESS_CHUNK_COUNT];
+    cc_Real chunkMinSharpness[CC_SHARPNESS_CHUNK_COUNT];
+    cc_Real maxSharpness = 0.0f;
+    cc_Real minSharpness = 1.0f;
+    ccs__SharpnessTask task = {
+        {&ccs__SharpnessChunks, subd, depth, false, NULL},
+        NULL,
+        chunkMaxSharpness,
+        chunkMinSharpness
+    };
+
+    ccs__ParallelLoop(&task.task, CC_SHARPNESS_CHUNK_COUNT, 1);
+
+    for (int32_t chunkID = 0; chunkID < CC_SHARPNESS_CHUNK_COUNT; ++chunkID) {
+        maxSharpness = cc__Maxf(maxSharpness, chunkMaxSharpness[chunkID]);
+        minSharpness = cc__Minf(minSharpness, chunkMinSharpness[chunkID]);
+    }
+
+    subd->maxCreaseSharpness[depth] = maxSharpness;
+    subd->minBoundarySharpness[depth] = minSharpness;
+}
+
+
+/*******************************************************************************
+ * ClassifyVertices -- Splits the vertices of a subd level into two lists
+ *
+ * Regular vertices are interior, have valence 4, and none of their edges is
+ * creased; they are listed first, in increasing order, and followed by the
+ * remaining (irregular) vertices. Past the first level, nearly all vertices
+ * are regular, so the gather kernels can run a fixed stencil on them.
+ *
+ */
+static bool ccs__IsRegularVertex(const cc_SubdLevel *level, cc_Index vertexID)
+{
+    const cc_Index halfedgeID = ccl_VertexToHalfedgeID(level, vertexID);
+    cc_Index iterator = halfedgeID;
+
+    for (int32_t i = 0; i < 4; ++i) {
+        const cc_Index prevID = ccl_HalfedgePrevID(level, iterator);
+
+        if (ccl_HalfedgeSharpness(level, prevID) != 0.0f) {
+            return false;
+        }
+
+        iterator = ccl_HalfedgeTwinID(level, prevID);
+
+        if (iterator < 0) {
+            return false;
+        }
+    }
+
+    return iterator == halfedgeID;
+}
+
+typedef struct {
+    ccs__RangeTask task;    // first member, so that the routine can cast it back
+    uint8_t *isRegular;
+} ccs__ClassifyTask;
+
+static void
+ccs__ClassifyVerticesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_SubdLevel level = ccs_Level(task->subd, task->depth);
+    uint8_t *isRegular = ((const ccs__ClassifyTask *)task)->isRegular;
+
+    for (cc_Index vertexID = begin; vertexID < end; ++vertexID) {
+        isRegular[vertexID] = ccs__IsRegularVertex(&level, vertexID);
+    }
+}
+
+static void ccs__ClassifyVertices(cc_Subd *subd, int32_t depth)
+{
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_Index vertexCount = ccl_VertexCount(&level);
+    cc_Index *vertexIDs = level.vertexClassIDs;
+    uint8_t *isRegular = (uint8_t *)CC_MALLOC(sizeof(uint8_t) * vertexCount);
+    cc_Index regularVertexCount = 0;
+    cc_Index regularID = 0, irregularID;
+    ccs__ClassifyTask task = {
+        {&ccs__ClassifyVerticesRange, subd, depth, false, NULL},
+        isRegular
+    };
+
+    ccs__ParallelLoop(&task.task, vertexCount, subd->parallelGrain);
+
+    for (cc_Index vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        regularVertexCount+= isRegular[vertexID];
+    }
+
+    irregularID = regularVertexCount;
+    for (cc_Index vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        if (isRegular[vertexID]) {
+            vertexIDs[regularID++] = vertexID;
+        } else {
+            vertexIDs[irregularID++] = vertexID;
+        }
+    }
+
+    subd->regularVertexCounts[depth] = regularVertexCount;
+    CC_FREE(isRegular);
+}
+
+
+/*******************************************************************************
+ * ClassifyLevel -- Computes the kernel selection data of a subd level
+ *
+ * This routine is called once both the halfedges and the creases of the
+ * level are refined. The last level is never refined, so it is skipped.
+ *
+ */
+static void ccs__ClassifyLevel(cc_Subd *subd, int32_t depth)
+{
+    if (depth < ccs_MaxDepth(subd)) {
+        ccs__ComputeCreaseSharpnessRange(subd, depth);
+
+        if (subd->vertexClassIDs != NULL) {
+            ccs__ClassifyVertices(subd, depth);
+        }
+    }
+}
+
+
+/*******************************************************************************
+ * RefineCageCreases -- Applies crease subdivision on the cage mesh
+ *
+ * This routine computes the creases of the control cage after one subdivision
+ * step and stores them in the subd. With sparse creases, only the stored
+ * creases are refined, so the cost scales with the number of sharp edges.
+ *
+ */
+static void
+ccs__RefineCageCrease(
+    const cc_Mesh *cage,
+    cc_Crease *creasesOut,
+    cc_Index creaseID,
+    cc_Index edgeID
+) {
+    const cc_Index nextID = ccm_CreaseNextID(cage, edgeID);
+    const cc_Index prevID = ccm_CreasePrevID(cage, edgeID);
+    const bool t1 = ccm_CreasePrevID(cage, nextID) == edgeID && nextID != edgeID;
+    const bool t2 = ccm_CreaseNextID(cage, prevID) == edgeID && prevID != edgeID;
+    const cc_Real thisS = 3.0f * ccm_CreaseSharpness(cage, edgeID);
+    const cc_Real nextS = ccm_CreaseSharpness(cage, nextID);
+    const cc_Real prevS = ccm_CreaseSharpness(cage, prevID);
+    cc_Crease *newCreases[2] = {
+        &creasesOut[(2 * creaseID + 0)],
+        &creasesOut[(2 * creaseID + 1)]
+    };
+
+    // next rule
+    newCreases[0]->nextID = 2 * edgeID + 1;
+    newCreases[1]->nextID = 2 * nextID + (t1 ? 0 : 1);
+
+    // prev rule
+    newCreases[0]->prevID = 2 * prevID + (t2 ? 1 : 0);
+    newCreases[1]->prevID = 2 * edgeID + 0;
+
+    // sharpness rule
+    newCreases[0]->sharpness = cc__Maxf(0.0f, (prevS + thisS) / 4.0f - 1.0f);
+    newCreases[1]->sharpness = cc__Maxf(0.0f, (thisS + nextS) / 4.0f - 1.0f);
+}
+
+static void
+ccs__CageCreasesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Mesh *cage = task->subd->cage;
+    cc_Crease *creasesOut = ccs_Level(task->subd, 1).creases;
+
+    for (cc_Index creaseID = begin; creaseID < end; ++creaseID) {
+        const cc_Index edgeID = ccs__CreaseEdgeID(task->subd, creaseID, 0);
+
+        ccs__RefineCageCrease(cage, creasesOut, creaseID, edgeID);
+    }
+}
+
+static void ccs__RefineCageCreases(cc_Subd *subd)
+{
+    ccs__RangeTask task = {&ccs__CageCreasesRange, subd, 0, false, NULL};
+
+    if (subd->creaseBits != NULL) {
+        ccs__UpdateCreaseIndex(subd);
+    }
+
+    ccs__ParallelLoop(&task, ccs__CreaseCountAtDepth(subd, 0), subd->parallelGrain);
+    ccs__ClassifyLevel(subd, 1);
+}
+
+
+/*******************************************************************************
+ * RefineCreases -- Applies crease subdivision on the subd
+ *
+ * This routine computes the topology of the next subd level.
+ *
+ */
+static void
+ccs__RefineCrease(
+    const cc_SubdLevel *level,
+    cc_Crease *creasesOut,
+    cc_Index creaseID,
+    cc_Index edgeID
+) {
+    const cc_Index nextID = ccl_CreaseNextID_Fast(level, edgeID);
+    const cc_Index prevID = ccl_CreasePrevID_Fast(level, edgeID);
+    const bool t1 = ccl_CreasePrevID_Fast(level, nextID) == edgeID && nextID != edgeID;
+    const bool t2 = ccl_CreaseNextID_Fast(level, prevID) == edgeID && prevID != edgeID;
+    const cc_Real thisS = 3.0f * ccl_CreaseSharpness_Fast(level, edgeID);
+    const cc_Real nextS = ccl_CreaseSharpness_Fast(level, nextID);
+    const cc_Real prevS = ccl_CreaseSharpness_Fast(level, prevID);
+    cc_Crease *newCreases[2] = {
+        &creasesOut[(2 * creaseID + 0)],
+        &creasesOut[(2 * creaseID + 1)]
+    };
+
+    // next rule
+    newCreases[0]->nextID = 2 * edgeID + 1;
+    newCreases[1]->nextID = 2 * nextID + (t1 ? 0 : 1);
+
+    // prev rule
+    newCreases[0]->prevID = 2 * prevID + (t2 ? 1 : 0);
+    newCreases[1]->prevID = 2 * edgeID + 0;
+
+    // sharpness rule
+    newCreases[0]->sharpness = cc__Maxf(0.0f, (prevS + thisS) / 4.0f - 1.0f);
+    newCreases[1]->sharpness = cc__Maxf(0.0f, (thisS + nextS) / 4.0f - 1.0f);
+}
+
+static void
+ccs__CreasesRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const int32_t depth = task->depth;
+    const cc_SubdLevel level = ccs_Level(task->subd, depth);
+    cc_Crease *creasesOut = ccs_Level(task->subd, depth + 1).creases;
+
+    for (cc_Index creaseID = begin; creaseID < end; ++creaseID) {
+        const cc_Index edgeID = ccs__CreaseEdgeID(task->subd, creaseID, depth);
+
+        ccs__RefineCrease(&level, creasesOut, creaseID, edgeID);
+    }
+}
+
+static void ccs__RefineCreases(cc_Subd *subd, int32_t depth)
+{
+    const cc_Index creaseCount = ccs__CreaseCountAtDepth(subd, depth);
+    ccs__RangeTask task = {&ccs__CreasesRange, subd, depth, false, NULL};
+
+    ccs__ParallelLoop(&task, creaseCount, subd->parallelGrain);
+    ccs__ClassifyLevel(subd, depth + 1);
+}
+
+
+/*******************************************************************************
+ * RefineCreases
+ *
+ */
+CCDEF void ccs_RefineCreases(cc_Subd *subd)
+{
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+
+    ccs__RefineCageCreases(subd);
+
+    for (int32_t depth = 1; depth < maxDepth; ++depth) {
+        ccs__RefineCreases(subd, depth);
+    }
+}
+
+
+/*******************************************************************************
+ * RefineCageTopology -- Applies all topology refinement rules on the cage mesh
+ *
+ * This routine fuses the halfedge, uv, and crease refinement of the control
+ * cage into a single pass over its halfedges, so that each parent halfedge
+ * is read once. Each crease is refined by the halfedge of its edge that
+ * has the largest ID (see the edgeID rule of RefineHalfedges).
+ *
+ */
+static void
+ccs__CageTopologyRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Subd *subd = task->subd;
+    const cc_Mesh *cage = subd->cage;
+    const cc_SubdLevel nextLevel = ccs_Level(subd, 1);
+    cc_Halfedge_SemiRegular *halfedgesOut = nextLevel.halfedges;
+    cc_Crease *creasesOut = nextLevel.creases;
+#ifndef CC_DISABLE_UV
+    const bool hasUvs = ccm_UvCount(cage) > 0;
+#endif
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        ccs__RefineCageHalfedge(cage, halfedgesOut, halfedgeID);
+
+#ifndef CC_DISABLE_UV
+        if (hasUvs) {
+            ccs__RefineCageVertexUv(cage, halfedgesOut, halfedgeID);
+        }
+#endif
+
+        if (halfedgeID > ccm_HalfedgeTwinID(cage, halfedgeID)) {
+            const cc_Index edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+            const cc_Index creaseID = ccs__CreaseID(subd, edgeID, 0);
+
+            if (creaseID >= 0) {
+                ccs__RefineCageCrease(cage, creasesOut, creaseID, edgeID);
+            }
+        }
+    }
+}
+
+static void ccs__RefineCageTopology(cc_Subd *subd)
+{
+    ccs__RangeTask task = {&ccs__CageTopologyRange, subd, 0, false, NULL};
+
+    if (subd->creaseBits != NULL) {
+        ccs__UpdateCreaseIndex(subd);
+    }
+
+    ccs__ParallelLoop(&task, ccm_HalfedgeCount(subd->cage), subd->parallelGrain);
+    ccs__RefineHalfedgeTables(subd, 0);
+    ccs__ClassifyLevel(subd, 1);
+}
+
+
+/*******************************************************************************
+ * RefineLevelTopology -- Applies all topology refinement rules on the subd
+ *
+ * This routine computes the topology of the next subd level in a single
+ * pass over the halfedges of the current one (see RefineCageTopology).
+ *
+ */
+static void
+ccs__LevelTopologyRange(
+    const ccs__RangeTask *task,
+    cc_Index begin,
+    cc_Index end
+) {
+    const cc_Subd *subd = task->subd;
+    const int32_t depth = task->depth;
+    const cc_SubdLevel level = ccs_Level(subd, depth);
+    const cc_SubdLevel nextLevel = ccs_Level(subd, depth + 1);
+    cc_Halfedge_SemiRegular *halfedgesOut = nextLevel.halfedges;
+    cc_Crease *creasesOut = nextLevel.creases;
+#ifndef CC_DISABLE_UV
+    const bool hasUvs = ccm_UvCount(subd->cage) > 0;
+#endif
+
+    for (cc_Index halfedgeID = begin; halfedgeID < end; ++halfedgeID) {
+        ccs__RefineHalfedge(&level, halfedgesOut, halfedgeID);
+
+#ifndef CC_DISABLE_UV
+        if (hasUvs) {
+            ccs__RefineVertexUv(&level, halfedgesOut, halfedgeID);
+        }
+#endif
+
+        if (halfedgeID > ccl_HalfedgeTwinID(&level, halfedgeID)) {
+            const cc_Index edgeID = ccl_HalfedgeEdgeID(&level, halfedgeID);
+            const cc_Index creaseID = ccs__CreaseID(subd, edgeID, depth);
+
+            if (creaseID >= 0) {
+                ccs__RefineCrease(&level, creasesOut, creaseID, edgeID);
+            }
+        }
+    }
+}
+
+static void ccs__RefineLevelTopology(cc_Subd *subd, int32_t depth)
+{
+    const cc_Index halfedgeCount = ccm_HalfedgeCountAtDepth(subd->cage, depth);
+    ccs__RangeTask task = {&ccs__LevelTopologyRange, subd, depth, false, NULL};
+
+    ccs__ParallelLoop(&task, halfedgeCount, subd->parallelGrain);
+    ccs__RefineHalfedgeTables(subd, depth);
+    ccs__ClassifyLevel(subd, depth + 1);
+}
+
+
+/*******************************************************************************
+ * Refine -- Computes and stores the result of Catmull Clark subdivision.
+ *
+ * The subdivision is computed down to the maxDepth parameter.
+ *
+ */
+static void ccs__RefineTopologyAtDepth(cc_Subd *subd, int32_t depth)
+{
+    if (depth == 0) {
+        ccs__RefineCageTopology(subd);
+    } else {
+        ccs__RefineLevelTopology(subd, depth);
+    }
+}
+
+static void ccs__RefineTopology(cc_Subd *subd)
+{
+    // in final-level-only mode, the vertex point refinement also refines
+    // the topology of each depth (see ccs__RefineVertexPoints)
+    if (!ccs__IsFinalLevelOnly(subd)) {
+        const int32_t maxDepth = ccs_MaxDepth(subd);
+
+        for (int32_t depth = 0; depth < maxDepth; ++depth) {
+            ccs__RefineTopologyAtDepth(subd, depth);
+        }
+    }
+
+    subd->topologyFingerprint = ccm_TopologyFingerprint(subd->cage);
+    ccs__RecordCageCounts(subd);
+}
+
+CCDEF void ccs_Refine_Scatter(cc_Subd *subd)
+{
+    ccs__RefineTopology(subd);
+    ccs_RefineVertexPoints_Scatter(subd);
+}
+
+CCDEF void ccs_Refine_Gather(cc_Subd *subd)
+{
+    ccs__RefineTopology(subd);
+    ccs_RefineVertexPoints_Gather(subd);
+}
+
+CCDEF void ccs_Refine_NoCreases_Scatter(cc_Subd *subd)
+{
+    ccs__RefineTopology(subd);
+    ccs_RefineVertexPoints_NoCreases_Scatter(subd);
+}
+
+CCDEF void ccs_Refine_NoCreases_Gather(cc_Subd *subd)
+{
+    ccs__RefineTopology(subd);
+    ccs_RefineVertexPoints_NoCreases_Gather(subd);
+}
+
+
+/*******************************************************************************
+ * BuildTopology / UpdatePoints -- Two-phase Catmull Clark subdivision
+ *
+ * When only the vertex points of the cage change (e.g., animation), the
+ * halfedges, creases, and uvs of the subd remain valid. BuildTopology refines
+ * them once and records the fingerprint of the cage topology. UpdatePoints
+ * then only refines the vertex points. If the fingerprint of the cage no
+ * longer matches, it rebuilds the topology first and returns true. This only
+ * holds while the cage keeps the vertex, halfedge, edge, face, and crease
+ * counts the subd was built for, since its buffers are sized from them: if
+ * any of them changed, UpdatePoints refuses and returns false without
+ * touching the subd, and the caller must ccs_Release it and ccs_Create a new
+ * one.
+ * Note that subds created with CC_SUBD_FINAL_LEVEL_ONLY cannot keep the
+ * intermediate topology, so UpdatePoints refines it along with the points.
+ *
+ */
+CCDEF void ccs_BuildTopology(cc_Subd *subd)
+{
+    ccs__RefineTopology(subd);
+}
+
+CCDEF bool ccs_IsTopologyUpToDate(const cc_Subd *subd)
+{
+    return subd->topologyFingerprint == ccm_TopologyFingerprint(subd->cage);
+}
+
+static bool ccs__HasCageCounts(const cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+
+    return subd->cageVertexCount == ccm_VertexCount(cage)
+        && subd->cageHalfedgeCount == ccm_HalfedgeCount(cage)
+        && subd->cageEdgeCount == ccm_EdgeCount(cage)
+        && subd->cageFaceCount == ccm_FaceCount(cage)
+        && subd->cageCreaseCount == ccm_CreaseCount(cage);
+}
+
+CCDEF bool ccs_UpdatePoints(cc_Subd *subd)
+{
+    const bool isTopologyOutdated = !ccs_IsTopologyUpToDate(subd);
+
+    if (isTopologyOutdated) {
+        if (!ccs__HasCageCounts(subd)) {
+            CC_LOG("cc: cage counts changed, the subd must be created again");
+
+            return false;
+        }
+
+        ccs__RefineTopology(subd);
+    }
+
+    ccs_RefineVertexPoints_Gather(subd);
+
+    return isTopologyOutdated;
+}
+
+
+/*******************************************************************************
+ * Tuning -- Picks the fastest vertex point kernel of each depth at runtime
+ *
+ * Whether "Gather" or "Scatter" wins, which grain balances the loops, and how
+ * many threads a depth can keep busy depend on the mesh, the depth, and the
+ * machine, so the tuned refinement measures them. A plan lists candidate
+ * kernel choices: the "Gather" routines at a few grains around
+ * CC_PARALLEL_GRAIN, and the "Scatter" routines, each with the OpenMP thread
+ * count halved from the maximum down to one. Each tuning refinement times one
+ * candidate on every depth, so that each depth keeps its own best time per
+ * candidate; the candidates take turns until each of them ran "sampleCount"
+ * times. The plan then locks in the fastest candidate of each depth, and the
+ * next refinements use it without timing anything. Since "Scatter" sums the
+ * contributions atomically, the tuning refinements may differ from one
+ * another in the last bits.
+ *
+ * Each depth runs in its own parallel region so that it gets its own thread
+ * count; a thread count of one (or of zero with a backend other than OpenMP)
+ * runs the depth on the calling thread. The time of a depth excludes its
+ * topology refinement in final-level-only mode. Locked plans are saved as the
+ * choice of each depth, so that the next runs can skip the tuning; a thread
+ * count of zero under OpenMP gives the depth the default number of threads.
+ *
+ */
+static double cc__Time(void)
+{
+    struct timespec time;
+
+    timespec_get(&time, TIME_UTC);
+
+    return (double)time.tv_sec + 1e-9 * (double)time.tv_nsec;
+}
+
+static int32_t ccs__MaxTuningThreadCount(void)
+{
+    if (!cc__IsOpenMPBackend()) {
+        return 0;
+    }
+
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+static int32_t ccs__TuningCandidates(cc_KernelChoice *candidates)
+{
+    const int32_t grains[3] = {
+        (int32_t)cc__Max(CC_PARALLEL_GRAIN / 4, 1),
+        (int32_t)CC_PARALLEL_GRAIN,
+        (int32_t)CC_PARALLEL_GRAIN * 4
+    };
+    int32_t threadCount = ccs__MaxTuningThreadCount();
+    int32_t candidateCount = 0;
+
+    for (;;) {
+        for (int32_t grainID = 0; grainID < 4; ++grainID) {
+            if (candidates != NULL) {
+                cc_KernelChoice *candidate = &candidates[candidateCount];
+
+                candidate->kernel = grainID < 3 ? CC_KERNEL_GATHER : CC_KERNEL_SCATTER;
+                candidate->grain = grains[grainID < 3 ? grainID : 1];
+                candidate->threadCount = threadCount;
+            }
+
+            ++candidateCount;
+        }
+
+        if (threadCount <= 1) {
+            break;
+        }
+
+        threadCount /= 2;
+    }
+
+    return candidateCount;
+}
+
+CCDEF cc_TuningPlan *ccs_CreateTuningPlan(const cc_Subd *subd, int32_t sampleCount)
+{
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+    const int32_t candidateCount = ccs__TuningCandidates(NULL);
+    const int32_t timeCount = maxDepth * candidateCount;
+    cc_TuningPlan *plan = (cc_TuningPlan *)CC_MALLOC(sizeof(*plan));
+
+    CC_ASSERT(sampleCount > 0);
+
+    plan->maxDepth = maxDepth;
+    plan->sampleCount = sampleCount;
+    plan->candidateCount = candidateCount;
+    plan->runCount = 0;
+    plan->candidates =
+        (cc_KernelChoice *)CC_MALLOC(sizeof(cc_KernelChoice) * candidateCount);
+    plan->times = (double *)CC_MALLOC(sizeof(double) * cc__Max(timeCount, 1));
+    plan->choices =
+        (cc_KernelChoice *)CC_MALLOC(sizeof(cc_KernelChoice) * cc__Max(maxDepth, 1));
+
+    ccs__TuningCandidates(plan->candidates);
+
+    // negative times are yet to be measured
+    for (int32_t timeID = 0; timeID < timeCount; ++timeID) {
+        plan->times[timeID] = -1.0;
+    }
+
+    return plan;
+}
+
+CCDEF void ccs_ReleaseTuningPlan(cc_TuningPlan *plan)
+{
+    if (plan->candidates != NULL) {
+        CC_FREE(plan->candidates);
+        CC_FREE(plan->times);
+    }
+    CC_FREE(plan->choices);
+    CC_FREE(plan);
+}
+
+CCDEF bool ccs_IsTuningPlanLocked(const cc_TuningPlan *plan)
+{
+    return plan->runCount >= plan->sampleCount * plan->candidateCount;
+}
+
+static void ccs__LockTuningPlan(cc_TuningPlan *plan)
+{
+    for (int32_t depth = 0; depth < plan->maxDepth; ++depth) {
+        const double *times = &plan->times[depth * plan->candidateCount];
+        int32_t bestID = 0;
+
+        for (int32_t candidateID = 1; candidateID < plan->candidateCount; ++candidateID) {
+            if (times[candidateID] < times[bestID]) {
+                bestID = candidateID;
+            }
+        }
+
+        plan->choices[depth] = plan->candidates[bestID];
+    }
+}
+
+static void
+ccs__RefineLevelVertexPoints_Tuned(
+    cc_Subd *subd,
+    int32_t depth,
+    const cc_KernelChoice *choice
+) {
+    const ccs__LevelRefiner refiner = choice->kernel == CC_KERNEL_SCATTER
+                                    ? &ccs__RefineLevelVertexPoints_Scatter
+                                    : &ccs__RefineLevelVertexPoints_Gather;
+    const int32_t threadCount = choice->threadCount;
+
+    subd->parallelGrain = choice->grain;
+
+    if (cc__IsOpenMPBackend() && threadCount == 0) {
+CC_PARALLEL
+        (*refiner)(subd, depth);
+    } else if (cc__IsOpenMPBackend() && threadCount > 1) {
+CC_PARALLEL_THREADS(threadCount)
+        (*refiner)(subd, depth);
+    } else {
+        (*refiner)(subd, depth);
+    }
+}
+
+CCDEF void ccs_RefineVertexPoints_Tuned(cc_Subd *subd, cc_TuningPlan *plan)
+{
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+    const cc_Index grain = subd->parallelGrain;
+    const bool isTuning = !ccs_IsTuningPlanLocked(plan);
+    const int32_t candidateID = isTuning ? plan->runCount % plan->candidateCount : 0;
+
+    CC_ASSERT(plan->maxDepth == maxDepth);
+
+#ifdef CC__SIMD_X86
+    // query the CPU before the threads race to do it
+    cc__SimdWidth();
+#endif
+
+    for (int32_t depth = 0; depth < maxDepth; ++depth) {
+        if (ccs__IsFinalLevelOnly(subd)) {
+            ccs__RefineTopologyAtDepth(subd, depth);
+        }
+
+        if (isTuning) {
+            const cc_KernelChoice *candidate = &plan->candidates[candidateID];
+            double *bestTime = &plan->times[depth * plan->candidateCount + candidateID];
+            const double startTime = cc__Time();
+            double time;
+
+            ccs__RefineLevelVertexPoints_Tuned(subd, depth, candidate);
+            time = cc__Time() - startTime;
+
+            if (*bestTime < 0.0 || time < *bestTime) {
+                *bestTime = time;
+            }
+        } else {
+            ccs__RefineLevelVertexPoints_Tuned(subd, depth, &plan->choices[depth]);
+        }
+    }
+
+    subd->parallelGrain = grain;
+
+    if (isTuning && ++plan->runCount == plan->sampleCount * plan->candidateCount) {
+        ccs__LockTuningPlan(plan);
+    }
+}
+
+CCDEF void ccs_Refine_Tuned(cc_Subd *subd, cc_TuningPlan *plan)
+{
+    ccs__RefineTopology(subd);
+    ccs_RefineVertexPoints_Tuned(subd, plan);
+}
+
+
+/*******************************************************************************
+ * SaveTuningPlan / LoadTuningPlan -- Stores the choices of a locked plan
+ *
+ * The file holds an 8-Byte magic identifier, the maximum depth, the OpenMP
+ * thread count of the tuning process (zero with another backend), and the
+ * kernel choice of each depth, as 32-bit integers. The thread counts of the
+ * candidates are fractions of the maximum, so the loader scales the choices
+ * by the OpenMP thread count of the loading process: a plan tuned on 16
+ * threads that picked 8 for a depth runs it on 2 threads out of 4.
+ *
+ */
+static int64_t ccs__TuningPlanMagic()
+{
+    const union {
+        char    string[8];
+        int64_t numeric;
+    } magic = {{'c', 'c', '_', 'P', 'l', 'a', 'n', '2'}};
+
+    return magic.numeric;
+}
+
+static bool ccs__IsKernelChoiceValid(const cc_KernelChoice *choice)
+{
+    return (choice->kernel == CC_KERNEL_GATHER || choice->kernel == CC_KERNEL_SCATTER)
+        && choice->grain > 0
+        && choice->threadCount >= 0;
+}
+
+static int32_t
+ccs__ScaleThreadCount(int32_t threadCount, int32_t fromMax, int32_t toMax)
+{
+    if (threadCount == 0 || fromMax == 0 || toMax == 0) {
+        return 0;
+    }
+
+    const int64_t scaledCount = (int64_t)threadCount * toMax / fromMax;
+
+    return scaledCount > 1 ? (int32_t)scaledCount : 1;
+}
+
+CCDEF bool ccs_SaveTuningPlan(const cc_TuningPlan *plan, const char *filename)
+{
+    const int64_t magic = ccs__TuningPlanMagic();
+    const int32_t maxThreadCount = ccs__MaxTuningThreadCount();
+    FILE *stream;
+
+    if (!ccs_IsTuningPlanLocked(plan)) {
+        CC_LOG("cc: tuning plan not locked yet");
+
+        return false;
+    }
+
+    stream = fopen(filename, "wb");
+
+    if (!stream) {
+        CC_LOG("cc: fopen failed");
+
+        return false;
+    }
+
+    if (
+        fwrite(&magic, sizeof(magic), 1, stream) != 1
+    ||  fwrite(&plan->maxDepth, sizeof(plan->maxDepth), 1, stream) != 1
+    ||  fwrite(&maxThreadCount, sizeof(maxThreadCount), 1, stream) != 1
+    ||  fwrite(plan->choices, sizeof(cc_KernelChoice), plan->maxDepth, stream)
+        != (size_t)plan->maxDepth
+    ) {
+        CC_LOG("cc: tuning plan dump failed");
+        fclose(stream);
+
+        return false;
+    }
+
+    fclose(stream);
+
+    return true;
+}
+
+CCDEF cc_TuningPlan *ccs_LoadTuningPlan(const char *filename)
+{
+    FILE *stream = fopen(filename, "rb");
+    const int32_t maxThreadCount = ccs__MaxTuningThreadCount();
+    int64_t magic;
+    int32_t maxDepth, tunedMaxThreadCount;
+    cc_TuningPlan *plan;
+    bool isSuccess;
+
+    if (!stream) {
+        CC_LOG("cc: fopen failed");
+
+        return NULL;
+    }
+
+    if (
+        fread(&magic, sizeof(magic), 1, stream) != 1
+    ||  fread(&maxDepth, sizeof(maxDepth), 1, stream) != 1
+    ||  fread(&tunedMaxThreadCount, sizeof(tunedMaxThreadCount), 1, stream) != 1
+    ||  magic != ccs__TuningPlanMagic()
+    ||  maxDepth < 0 || maxDepth > 32
+    ||  tunedMaxThreadCount < 0
+    ) {
+        CC_LOG("cc: unsupported file");
+        fclose(stream);
+
+        return NULL;
+    }
+
+    plan = (cc_TuningPlan *)CC_MALLOC(sizeof(*plan));
+    plan->maxDepth = maxDepth;
+    plan->sampleCount = 0;
+    plan->candidateCount = 0;
+    plan->runCount = 0;
+    plan->candidates = NULL;
+    plan->times = NULL;
+    plan->choices =
+        (cc_KernelChoice *)CC_MALLOC(sizeof(cc_KernelChoice) * cc__Max(maxDepth, 1));
+    isSuccess = fread(plan->choices, sizeof(cc_KernelChoice), maxDepth, stream)
+                == (size_t)maxDepth;
+    fclose(stream);
+
+    for (int32_t depth = 0; isSuccess && depth < maxDepth; ++depth) {
+        cc_KernelChoice *choice = &plan->choices[depth];
+
+        isSuccess = ccs__IsKernelChoiceValid(choice);
+        choice->threadCount = ccs__ScaleThreadCount(choice->threadCount,
+                                                    tunedMaxThreadCount,
+                                                    maxThreadCount);
+    }
+
+    if (!isSuccess) {
+        CC_LOG("cc: data reading failed");
+        ccs_ReleaseTuningPlan(plan);
+
+        return NULL;
+    }
+
+    return plan;
+}
+
+
+/*******************************************************************************
+ * RefineTiled -- Streams the subdivision of a cage one cluster at a time
+ *
+ * Refined points that lie over a cage face only depend on the faces that
+ * share a vertex with it (its one-ring). The tiled refinement thus extracts
+ * clusters of consecutive cage faces along with their one-ring halo into a
+ * small local cage, refines it to full depth with the final-level-only
+ * storage, and hands the result to a consumer. Only one tile per worker is
+ * alive at a time, so the working set is bounded by the tile size rather
+ * than by the size of the final level.
+ *
+ * The patch lists the cage halfedges of the cluster along with their IDs in
+ * the tile. Since halfedge h of the tile owns the halfedges [h 4^d, (h+1) 4^d)
+ * at depth d, this locates the refined quads of each cluster face in the
+ * final level of the tile. The vertex, edge, and halfedge IDs of the level
+ * are local to the tile.
+ *
+ * Each worker refines its tiles into a cage and a subd that it reuses from
+ * one tile to the next. With OpenMP and at least as many tiles as threads,
+ * the threads share the tiles and each tile is refined on a single thread,
+ * so the consumer gets called concurrently and must be thread-safe; the
+ * patch is only valid during the call. Otherwise, the tiles are processed
+ * one after the other, each of them in parallel.
+ *
+ */
+static void cc__SortInt64(int64_t *keys, cc_Index count)
+{
+    // heap sort
+    for (cc_Index i = count / 2 - 1, n = count; n > 1;) {
+        cc_Index root, child;
+        int64_t key;
+
+        if (i >= 0) {
+            root = i--;
+        } else {
+            key = keys[0]; keys[0] = keys[--n]; keys[n] = key;
+            root = 0;
+        }
+
+        key = keys[root];
+
+        for (child = 2 * root + 1; child < n; child = 2 * root + 1) {
+            if (child + 1 < n && keys[child + 1] > keys[child]) {
+                ++child;
+            }
+
+            if (keys[child] <= key) {
+                break;
+            }
+
+            keys[root] = keys[child];
+            root = child;
+        }
+
+        keys[root] = key;
+    }
+}
+
+static cc_Index cc__UniqueInt64(int64_t *keys, cc_Index count)
+{
+    cc_Index uniqueCount = 0;
+
+    for (cc_Index i = 0; i < count; ++i) {
+        if (uniqueCount == 0 || keys[uniqueCount - 1] != keys[i]) {
+            keys[uniqueCount++] = keys[i];
+        }
+    }
+
+    return uniqueCount;
+}
+
+// returns the index of the first key whose high 32 bits match, or -1
+static cc_Index cc__FindInt64(const int64_t *keys, cc_Index count, cc_Index value)
+{
+    cc_Index begin = 0, end = count;
+
+    while (begin < end) {
+        const cc_Index middle = begin + (end - begin) / 2;
+
+        if ((cc_Index)(keys[middle] >> 32) < value) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+
+    return (begin < count && (cc_Index)(keys[begin] >> 32) == value) ? begin : -1;
+}
+
+static cc_Index
+ccs__TileLocalID(const int64_t *keys, cc_Index count, cc_Index cageID)
+{
+    const cc_Index keyID = cageID >= 0 ? cc__FindInt64(keys, count, cageID) : -1;
+
+    return keyID >= 0 ? (cc_Index)(keys[keyID] & 0xFFFFFFFF) : -1;
+}
+
+/*
+ * Collects the halo faces of a cluster; only counts them when faceIDs is NULL.
+ */
+static cc_Index
+ccs__TileHaloFaces(
+    const cc_Mesh *cage,
+    cc_Index faceBegin,
+    cc_Index faceEnd,
+    int64_t *faceIDs
+) {
+    cc_Index faceCount = 0;
+
+    for (cc_Index faceID = faceBegin; faceID < faceEnd; ++faceID) {
+        const cc_Index halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
+        cc_Index halfedgeIt = halfedgeID;
+
+        do {
+            cc_Index vertexIt = halfedgeIt;
+
+            do {
+                if (faceIDs != NULL) {
+                    faceIDs[faceCount] = ccm_HalfedgeFaceID(cage, vertexIt);
+                }
+                ++faceCount;
+                vertexIt = ccm_NextVertexHalfedgeID(cage, vertexIt);
+            } while (vertexIt >= 0 && vertexIt != halfedgeIt);
+
+            if (vertexIt < 0) {
+                for (vertexIt = ccm_PrevVertexHalfedgeID(cage, halfedgeIt);
+                     vertexIt >= 0 && vertexIt != halfedgeIt;
+                     vertexIt = ccm_PrevVertexHalfedgeID(cage, vertexIt)) {
+                    if (faceIDs != NULL) {
+                        faceIDs[faceCount] = ccm_HalfedgeFaceID(cage, vertexIt);
+                    }
+                    ++faceCount;
+                }
+            }
+
+            halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt);
+        } while (halfedgeIt != halfedgeID);
+    }
+
+    return faceCount;
+}
+
+/*
+ * Each worker keeps the cage and subd of its last tile, and only reallocates
+ * them when the next tile outgrows them. Since the sizes of the levels grow
+ * with the counts of the cage, a subd fits any tile whose counts are at most
+ * those of the cage it was created for.
+ */
+typedef struct {
+    cc_Mesh *tile;
+    cc_Subd *subd;
+    cc_Index *halfedgeIDs;
+    cc_Index halfedgeIDCapacity;
+    cc_Index tileCapacities[4];     // vertices, halfedges, edges, faces
+    cc_Index subdCapacities[5];     // same and boundary halfedges
+} ccs__TileScratch;
+
+static void ccs__ReleaseTileScratch(ccs__TileScratch *scratch)
+{
+    if (scratch->subd != NULL) {
+        ccs_Release(scratch->subd);
+    }
+    if (scratch->tile != NULL) {
+        ccm_Release(scratch->tile);
+    }
+    CC_FREE(scratch->halfedgeIDs);
+}
+
+static bool
+ccs__IsTileCapacityExceeded(
+    const cc_Index *counts,
+    const cc_Index *capacities,
+    int32_t capacityCount
+) {
+    for (int32_t capacityID = 0; capacityID < capacityCount; ++capacityID) {
+        if (counts[capacityID] > capacities[capacityID]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static cc_Mesh *
+ccs__ReserveTileCage(
+    ccs__TileScratch *scratch,
+    const cc_Mesh *cage,
+    cc_Index vertexCount,
+    cc_Index halfedgeCount,
+    cc_Index edgeCount,
+    cc_Index faceCount
+) {
+    const cc_Index counts[4] = {vertexCount, halfedgeCount, edgeCount, faceCount};
+    const cc_Index uvCount = ccm_UvCount(cage) > 0 ? halfedgeCount : 0;
+    cc_Mesh *tile = scratch->tile;
+
+    if (tile == NULL || ccs__IsTileCapacityExceeded(counts, scratch->tileCapacities, 4)) {
+        if (tile != NULL) {
+            ccm_Release(tile);
+        }
+
+        tile = ccm_Create(vertexCount, uvCount, halfedgeCount, edgeCount, faceCount);
+        CC_MEMCPY(scratch->tileCapacities, counts, sizeof(counts));
+        scratch->tile = tile;
+    }
+
+    tile->vertexCount = vertexCount;
+    tile->uvCount = uvCount;
+    tile->halfedgeCount = halfedgeCount;
+    tile->edgeCount = edgeCount;
+    tile->faceCount = faceCount;
+
+    return tile;
+}
+
+static cc_Subd *ccs__ReserveTileSubd(ccs__TileScratch *scratch, int32_t maxDepth)
+{
+    const cc_Mesh *tile = scratch->tile;
+    const cc_Index counts[5] = {
+        ccm_VertexCount(tile),
+        ccm_HalfedgeCount(tile),
+        ccm_EdgeCount(tile),
+        ccm_FaceCount(tile),
+        ccs__CageBoundaryHalfedgeCount(tile)
+    };
+    cc_Subd *subd = scratch->subd;
+
+    if (subd == NULL || ccs__IsTileCapacityExceeded(counts, scratch->subdCapacities, 5)) {
+        if (subd != NULL) {
+            ccs_Release(subd);
+        }
+
+        subd = ccs_CreateWithFlags(tile, maxDepth, CC_SUBD_FINAL_LEVEL_ONLY);
+        CC_MEMCPY(scratch->subdCapacities, counts, sizeof(counts));
+        scratch->subd = subd;
+    } else {
+        // same state as a newly created subd
+        subd->cage = tile;
+        subd->boundaryHalfedgeCount = counts[4];
+        subd->topologyFingerprint = 0;
+        ccs__RecordCageCounts(subd);
+
+        for (int32_t depth = 0; depth <= maxDepth; ++depth) {
+            subd->maxCreaseSharpness[depth] = 1.0f;
+            subd->minBoundarySharpness[depth] = 0.0f;
+        }
+    }
+
+    return subd;
+}
+
+/*
+ * The local IDs of a tile follow the order of the cage IDs, because the
+ * refinement rules compare halfedge IDs (e.g., to number the edges of the
+ * next depth). Within the one-ring of the cluster, the tile then refines to
+ * the same points as the cage.
+ */
+static cc_Mesh *
+ccs__BuildTileCage(
+    ccs__TileScratch *scratch,
+    const cc_Mesh *cage,
+    cc_Index faceBegin,
+    cc_Index faceEnd,
+    cc_Index *tileHalfedgeIDs,
+    cc_Index *cageHalfedgeIDs
+) {
+    const cc_Index candidateCount = ccs__TileHaloFaces(cage, faceBegin, faceEnd, NULL);
+    int64_t *faceKeys = (int64_t *)CC_MALLOC(sizeof(int64_t) * candidateCount);
+    int64_t *halfedgeKeys, *vertexKeys, *edgeKeys;
+    cc_Index faceCount, halfedgeCount = 0, vertexCount, edgeCount;
+    cc_Mesh *tile;
+
+    // faces: cluster and one-ring halo
+    ccs__TileHaloFaces(cage, faceBegin, faceEnd, faceKeys);
+
+    for (cc_Index i = 0; i < candidateCount; ++i) faceKeys[i]<<= 32;
+
+    cc__SortInt64(faceKeys, candidateCount);
+    faceCount = cc__UniqueInt64(faceKeys, candidateCount);
+
+    for (cc_Index localFaceID = 0; localFaceID < faceCount; ++localFaceID) {
+        const cc_Index halfedgeID = ccm_FaceToHalfedgeID(cage, (cc_Index)(faceKeys[localFaceID] >> 32));
+        cc_Index halfedgeIt = halfedgeID;
+
+        faceKeys[localFaceID]|= localFaceID;
+
+        do {
+            ++halfedgeCount;
+            halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt);
+        } while (halfedgeIt != halfedgeID);
+    }
+
+    // halfedges, vertices, and edges
+    halfedgeKeys = (int64_t *)CC_MALLOC(sizeof(int64_t) * halfedgeCount);
+    vertexKeys = (int64_t *)CC_MALLOC(sizeof(int64_t) * halfedgeCount);
+    edgeKeys = (int64_t *)CC_MALLOC(sizeof(int64_t) * halfedgeCount);
+    halfedgeCount = 0;
+
+    for (cc_Index localFaceID = 0; localFaceID < faceCount; ++localFaceID) {
+        const cc_Index halfedgeID = ccm_FaceToHalfedgeID(cage, (cc_Index)(faceKeys[localFaceID] >> 32));
+        cc_Index halfedgeIt = halfedgeID;
+
+        do {
+            halfedgeKeys[halfedgeCount] = (int64_t)halfedgeIt << 32;
+            vertexKeys[halfedgeCount] = (int64_t)ccm_HalfedgeVertexID(cage, halfedgeIt) << 32;
+            edgeKeys[halfedgeCount] = (int64_t)ccm_HalfedgeEdgeID(cage, halfedgeIt) << 32;
+            ++halfedgeCount;
+            halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt);
+        } while (halfedgeIt != halfedgeID);
+    }
+
+    cc__SortInt64(halfedgeKeys, halfedgeCount);
+    cc__SortInt64(vertexKeys, halfedgeCount);
+    cc__SortInt64(edgeKeys, halfedgeCount);
+    vertexCount = cc__UniqueInt64(vertexKeys, halfedgeCount);
+    edgeCount = cc__UniqueInt64(edgeKeys, halfedgeCount);
+
+    for (cc_Index i = 0; i < halfedgeCount; ++i) halfedgeKeys[i]|= i;
+    for (cc_Index i = 0; i < vertexCount; ++i) vertexKeys[i]|= i;
+    for (cc_Index i = 0; i < edgeCount; ++i) edgeKeys[i]|= i;
+
+    tile = ccs__ReserveTileCage(scratch,
+                                cage,
+                                vertexCount,
+                                halfedgeCount,
+                                edgeCount,
+                                faceCount);
+
+    // halfedges (each one gets its own uv)
+    for (cc_Index localHalfedgeID = 0; localHalfedgeID < halfedgeCount; ++localHalfedgeID) {
+        const cc_Index halfedgeID = (cc_Index)(halfedgeKeys[localHalfedgeID] >> 32);
+        cc_Halfedge *halfedge = &tile->halfedges[localHalfedgeID];
+
+        halfedge->twinID = ccs__TileLocalID(halfedgeKeys,
+                                            halfedgeCount,
+                                            ccm_HalfedgeTwinID(cage, halfedgeID));
+        halfedge->nextID = ccs__TileLocalID(halfedgeKeys,
+                                            halfedgeCount,
+                                            ccm_HalfedgeNextID(cage, halfedgeID));
+        halfedge->prevID = ccs__TileLocalID(halfedgeKeys,
+                                            halfedgeCount,
+                                            ccm_HalfedgePrevID(cage, halfedgeID));
+        halfedge->faceID = ccs__TileLocalID(faceKeys,
+                                            faceCount,
+                                            ccm_HalfedgeFaceID(cage, halfedgeID));
+        halfedge->edgeID = ccs__TileLocalID(edgeKeys,
+                                            edgeCount,
+                                            ccm_HalfedgeEdgeID(cage, halfedgeID));
+        halfedge->vertexID = ccs__TileLocalID(vertexKeys,
+                                              vertexCount,
+                                              ccm_HalfedgeVertexID(cage, halfedgeID));
+        halfedge->uvID = localHalfedgeID;
+
+        if (tile->uvCount > 0) {
+            tile->uvs[localHalfedgeID] = ccm_HalfedgeVertexUv(cage, halfedgeID);
+        }
+    }
+
+    // faces
+    for (cc_Index localFaceID = 0; localFaceID < faceCount; ++localFaceID) {
+        const cc_Index faceID = (cc_Index)(faceKeys[localFaceID] >> 32);
+
+        tile->faceToHalfedgeIDs[localFaceID] =
+            ccs__TileLocalID(halfedgeKeys,
+                             halfedgeCount,
+                             ccm_FaceToHalfedgeID(cage, faceID));
+    }
+
+    // vertices: keep the cage halfedge if the one-ring of the vertex lies in
+    // the tile, otherwise start on a boundary halfedge of the tile
+    for (cc_Index localVertexID = 0; localVertexID < vertexCount; ++localVertexID) {
+        const cc_Index vertexID = (cc_Index)(vertexKeys[localVertexID] >> 32);
+
+        tile->vertexToHalfedgeIDs[localVertexID] =
+            ccs__TileLocalID(halfedgeKeys,
+                             halfedgeCount,
+                             ccm_VertexToHalfedgeID(cage, vertexID));
+        tile->vertexPoints[localVertexID] = ccm_VertexPoint(cage, vertexID);
+    }
+
+    for (cc_Index localHalfedgeID = 0; localHalfedgeID < halfedgeCount; ++localHalfedgeID) {
+        const cc_Index halfedgeID = (cc_Index)(halfedgeKeys[localHalfedgeID] >> 32);
+        const cc_Halfedge *halfedge = &tile->halfedges[localHalfedgeID];
+
+        if (halfedge->twinID < 0 && ccm_HalfedgeTwinID(cage, halfedgeID) >= 0) {
+            tile->vertexToHalfedgeIDs[halfedge->vertexID] = localHalfedgeID;
+        }
+    }
+
+    // edges and creases
+    for (cc_Index localEdgeID = 0; localEdgeID < edgeCount; ++localEdgeID) {
+        const cc_Index edgeID = (cc_Index)(edgeKeys[localEdgeID] >> 32);
+        const cc_Index halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
+        const cc_Index nextID = ccs__TileLocalID(edgeKeys,
+                                                edgeCount,
+                                                ccm_CreaseNextID(cage, edgeID));
+        const cc_Index prevID = ccs__TileLocalID(edgeKeys,
+                                                edgeCount,
+                                                ccm_CreasePrevID(cage, edgeID));
+        cc_Index localHalfedgeID = ccs__TileLocalID(halfedgeKeys, halfedgeCount, halfedgeID);
+
+        if (localHalfedgeID < 0) {
+            localHalfedgeID = ccs__TileLocalID(halfedgeKeys,
+                                               halfedgeCount,
+                                               ccm_HalfedgeTwinID(cage, halfedgeID));
+        }
+
+        tile->edgeToHalfedgeIDs[localEdgeID] = localHalfedgeID;
+        tile->creases[localEdgeID].nextID = nextID >= 0 ? nextID : localEdgeID;
+        tile->creases[localEdgeID].prevID = prevID >= 0 ? prevID : localEdgeID;
+        tile->creases[localEdgeID].sharpness = ccm_CreaseSharpness(cage, edgeID);
+    }
+
+    // cluster halfedges
+    halfedgeCount = 0;
+
+    for (cc_Index faceID = faceBegin; faceID < faceEnd; ++faceID) {
+        const cc_Index halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
+        cc_Index halfedgeIt = halfedgeID;
+
+        do {
+            cageHalfedgeIDs[halfedgeCount] = halfedgeIt;
+            tileHalfedgeIDs[halfedgeCount] = ccs__TileLocalID(halfedgeKeys,
+                                                              tile->halfedgeCount,
+                                                              halfedgeIt);
+            ++halfedgeCount;
+            halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt);
+        } while (halfedgeIt != halfedgeID);
+    }
+
+    CC_FREE(faceKeys);
+    CC_FREE(halfedgeKeys);
+    CC_FREE(vertexKeys);
+    CC_FREE(edgeKeys);
+
+    return tile;
+}
+
+static cc_Index
+ccs__ClusterHalfedgeCount(const cc_Mesh *cage, cc_Index faceBegin, cc_Index faceEnd)
+{
+    cc_Index halfedgeCount = 0;
+
+    for (cc_Index faceID = faceBegin; faceID < faceEnd; ++faceID) {
+        const cc_Index halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
+        cc_Index halfedgeIt = halfedgeID;
+
+        do {
+            ++halfedgeCount;
+            halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt);
+        } while (halfedgeIt != halfedgeID);
+    }
+
+    return halfedgeCount;
+}
+
+static void
+ccs__RefineTile(
+    ccs__TileScratch *scratch,
+    const cc_Mesh *cage,
+    int32_t maxDepth,
+    cc_Index faceBegin,
+    cc_Index faceEnd,
+    bool isNested,
+    cc_PatchConsumer consumer,
+    void *userData
+) {
+    const cc_Index halfedgeCount = ccs__ClusterHalfedgeCount(cage, faceBegin, faceEnd);
+    cc_Subd *subd;
+    cc_Patch patch;
+
+    if (2 * halfedgeCount > scratch->halfedgeIDCapacity) {
+        CC_FREE(scratch->halfedgeIDs);
+        scratch->halfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * 2 * halfedgeCount);
+        scratch->halfedgeIDCapacity = 2 * halfedgeCount;
+    }
+
+    ccs__BuildTileCage(scratch,
+                       cage,
+                       faceBegin,
+                       faceEnd,
+                       &scratch->halfedgeIDs[0],
+                       &scratch->halfedgeIDs[halfedgeCount]);
+    subd = ccs__ReserveTileSubd(scratch, maxDepth);
+
+    // a region of its own keeps the refinement from sharing the tile loop
+    if (isNested) {
+CC_PARALLEL_THREADS(1)
+        ccs_Refine_Gather(subd);
+    } else {
+        ccs_Refine_Gather(subd);
+    }
+
+    patch.faceBegin = faceBegin;
+    patch.faceCount = faceEnd - faceBegin;
+    patch.halfedgeCount = halfedgeCount;
+    patch.tileHalfedgeIDs = &scratch->halfedgeIDs[0];
+    patch.cageHalfedgeIDs = &scratch->halfedgeIDs[halfedgeCount];
+    patch.level = ccs_Level(subd, maxDepth);
+    (*consumer)(&patch, userData);
+}
+
+static bool ccs__IsTileParallel(cc_Index tileCount)
+{
+#ifdef _OPENMP
+    const int32_t threadCount = omp_get_max_threads();
+
+    return cc__IsOpenMPBackend() && threadCount > 1 && tileCount >= threadCount;
+#else
+    (void)tileCount;
+
+    return false;
+#endif
+}
+
+CCDEF void
+ccs_RefineTiled(
+    const cc_Mesh *cage,
+    int32_t maxDepth,
+    cc_Index faceCountPerTile,
+    cc_PatchConsumer consumer,
+    void *userData
+) {
+    const cc_Index faceCount = ccm_FaceCount(cage);
+    const cc_Index tileCount = (faceCount + faceCountPerTile - 1) / faceCountPerTile;
+
+    CC_ASSERT(maxDepth > 0 && faceCountPerTile > 0);
+    // the tile keys pack a cage ID and a tile ID in 32 bits each
+    CC_ASSERT(ccm_HalfedgeCount(cage) <= INT32_MAX);
+
+    if (ccs__IsTileParallel(tileCount)) {
+#ifdef CC__SIMD_X86
+        // query the CPU before the threads race to do it
+        cc__SimdWidth();
+#endif
+
+CC_PARALLEL
+        {
+            ccs__TileScratch scratch = {NULL, NULL, NULL, 0, {0}, {0}};
+
+CC_FOR
+            for (cc_Index tileID = 0; tileID < tileCount; ++tileID) {
+                const cc_Index faceBegin = tileID * faceCountPerTile;
+                const cc_Index faceEnd = cc__Min(faceCount, faceBegin + faceCountPerTile);
+
+                ccs__RefineTile(&scratch,
+                                cage,
+                                maxDepth,
+                                faceBegin,
+                                faceEnd,
+                                true,
+                                consumer,
+                                userData);
+            }
+
+            ccs__ReleaseTileScratch(&scratch);
+        }
+    } else {
+        ccs__TileScratch scratch = {NULL, NULL, NULL, 0, {0}, {0}};
+
+        for (cc_Index tileID = 0; tileID < tileCount; ++tileID) {
+            const cc_Index faceBegin = tileID * faceCountPerTile;
+            const cc_Index faceEnd = cc__Min(faceCount, faceBegin + faceCountPerTile);
+
+            ccs__RefineTile(&scratch,
+                            cage,
+                            maxDepth,
+                            faceBegin,
+                            faceEnd,
+                            false,
+                            consumer,
+                            userData);
+        }
+
+        ccs__ReleaseTileScratch(&scratch);
+    }
+}
+
+
+/*******************************************************************************
+ * Magic -- Generates the magic identifier
+ *
+ * Each cc_Mesh file starts with 8 Bytes that allow us to check if the file
+ * under reading is actually a cc_Mesh file, and which version of the format
+ * it follows (see Container for version 2).
+ *
+ */
+static int64_t ccm__Magic()
+{
+    const union {
+        char    string[8];
+        int64_t numeric;
+    } magic = {{'c', 'c', '_', 'M', 'e', 's', 'h', '1'}};
+
+    return magic.numeric;
+}
+
+static int64_t ccm__MagicV2()
+{
+    const union {
+        char    string[8];
+        int64_t numeric;
+    } magic = {{'c', 'c', '_', 'M', 'e', 's', 'h', '2'}};
+
+    return magic.numeric;
+}
+
+
+/*******************************************************************************
+ * Header File Data Structure
+ *
+ * This represents the header we use to uniquely identify the cc_Mesh files
+ * and provide the fundamental information to properly decode the rest of the
+ * file.
+ *
+ */
+typedef struct {
+    int64_t magic;
+    int32_t vertexCount;
+    int32_t uvCount;
+    int32_t halfedgeCount;
+    int32_t edgeCount;
+    int32_t faceCount;
+} ccm__Header;
+
+
+/*******************************************************************************
+ * Create header
+ *
+ * This procedure initializes a cc_Mesh file header.
+ *
+ */
+static ccm__Header ccm__CreateHeader(const cc_Mesh *mesh)
+{
+    ccm__Header header = {
+        ccm__Magic(),
+        (int32_t)ccm_VertexCount(mesh),
+        (int32_t)ccm_UvCount(mesh),
+        (int32_t)ccm_HalfedgeCount(mesh),
+        (int32_t)ccm_EdgeCount(mesh),
+        (int32_t)ccm_FaceCount(mesh)
+    };
+
+    return header;
+}
+
+
+/*******************************************************************************
+ * IsHeaderCompatible -- Checks that the counts of a mesh fit in a file header
+ *
+ */
+static bool ccm__IsHeaderCompatible(const cc_Mesh *mesh)
+{
+    return ccm_VertexCount(mesh) <= INT32_MAX
+        && ccm_UvCount(mesh) <= INT32_MAX
+        && ccm_HalfedgeCount(mesh) <= INT32_MAX
+        && ccm_EdgeCount(mesh) <= INT32_MAX
+        && ccm_FaceCount(mesh) <= INT32_MAX;
+}
+
+
+/*******************************************************************************
+ * ReadHeader -- Reads a tt_Texture file header from an input stream
+ *
+ */
+static bool ccm__ReadHeader(FILE *stream, ccm__Header *header)
+{
+    if (fread(header, sizeof(*header), 1, stream) != 1) {
+        CC_LOG("cc: fread failed");
+
+        return false;
+    }
+
+    return header->magic == ccm__Magic();
+}
+
+
+/*******************************************************************************
+ * ReadIDs / WriteIDs -- Converts between the 32-bit IDs of the file and cc_Index
+ *
+ * The version 1 file stores 32-bit IDs and floats. With CC_INDEX64, the IDs
+ * are read in the first half of the destination buffer and widened in place
+ * from the back. On write, IDs and reals that are wider than the file are
+ * narrowed through a small staging buffer.
+ *
+ */
+static bool ccm__ReadIDs(cc_Index *ids, cc_Index count, FILE *stream)
+{
+    const bool isSuccess =
+        fread(ids, sizeof(int32_t), count, stream) == (size_t)count;
+
+#ifdef CC_INDEX64
+    for (cc_Index i = count - 1; i >= 0; --i) {
+        ids[i] = ((const int32_t *)ids)[i];
+    }
+#endif
+
+    return isSuccess;
+}
+
+static bool ccm__WriteIDs(const cc_Index *ids, cc_Index count, FILE *stream)
+{
+#ifdef CC_INDEX64
+    int32_t tmp[1024];
+
+    for (cc_Index begin = 0; begin < count; begin+= 1024) {
+        const cc_Index end = cc__Min(count, begin + 1024);
+
+        for (cc_Index i = begin; i < end; ++i) {
+            tmp[i - begin] = (int32_t)ids[i];
+        }
+
+        if (fwrite(tmp, sizeof(int32_t), end - begin, stream) != (size_t)(end - begin)) {
+            return false;
+        }
+    }
+
+    return true;
+#else
+    return fwrite(ids, sizeof(int32_t), count, stream) == (size_t)count;
+#endif
+}
+
+
+static bool ccm__WriteReals(const cc_Real *reals, cc_Index count, FILE *stream)
+{
+#ifndef CC_SINGLE_PRECISION
+    float tmp[1024];
+
+    for (cc_Index begin = 0; begin < count; begin+= 1024) {
+        const cc_Index end = cc__Min(count, begin + 1024);
+
+        for (cc_Index i = begin; i < end; ++i) {
+            tmp[i - begin] = (float)reals[i];
+        }
+
+        if (fwrite(tmp, sizeof(float), end - begin, stream) != (size_t)(end - begin)) {
+            return false;
+        }
+    }
+
+    return true;
+#else
+    return fwrite(reals, sizeof(float), count, stream) == (size_t)count;
+#endif
+}
+
+static bool ccm__WriteCreases(const cc_Crease *creases, cc_Index count, FILE *stream)
+{
+#if !defined(CC_SINGLE_PRECISION) || defined(CC_INDEX64)
+    cc_Crease_f tmp[1024];
+
+    for (cc_Index begin = 0; begin < count; begin+= 1024) {
+        const cc_Index end = cc__Min(count, begin + 1024);
+
+        for (cc_Index i = begin; i < end; ++i) {
+            tmp[i - begin].nextID = (int32_t)creases[i].nextID;
+            tmp[i - begin].prevID = (int32_t)creases[i].prevID;
+            tmp[i - begin].sharpness = (float)creases[i].sharpness;
+        }
+
+        if (fwrite(tmp, sizeof(cc_Crease_f), end - begin, stream) != (size_t)(end - begin)) {
+            return false;
+        }
+    }
+
+    return true;
+#else
+    return fwrite(creases, sizeof(cc_Crease_f), count, stream) == (size_t)count;
+#endif
+}
+
+
+/*******************************************************************************
+ * Widen -- Converts the 32-bit data of the file to cc_Index and cc_Real
+ *
+ * The conversions are independent per element, so they run in parallel on
+ * the backend (see ParallelBackend).
+ *
+ */
+typedef struct {
+    const void *src;
+    void *dst;
+} ccm__WideningTask;
+
+#ifdef CC_INDEX64
+static void ccm__WidenIDsRange(cc_Index begin, cc_Index end, void *userData)
+{
+    const ccm__WideningTask *task = (const ccm__WideningTask *)userData;
+    const int32_t *src = (const int32_t *)task->src;
+    cc_Index *dst = (cc_Index *)task->dst;
+
+    for (cc_Index i = begin; i < end; ++i) {
+        dst[i] = src[i];
+    }
+}
+
+static void ccm__WidenIDs(const int32_t *src, cc_Index *dst, cc_Index count)
+{
+    ccm__WideningTask task = {src, dst};
+
+    cc_ParallelFor(0, count, CC_PARALLEL_GRAIN, &ccm__WidenIDsRange, &task);
+}
+#endif
+
+#if !defined(CC_SINGLE_PRECISION) || defined(CC_INDEX64)
+static void ccm__WidenVertexPointsRange(cc_Index begin, cc_Index end, void *userData)
+{
+    const ccm__WideningTask *task = (const ccm__WideningTask *)userData;
+    const cc_VertexPoint_f *src = (const cc_VertexPoint_f *)task->src;
+    cc_VertexPoint *dst = (cc_VertexPoint *)task->dst;
+
+    for (cc_Index i = begin; i < end; ++i) {
+        dst[i].x = (cc_Real)src[i].x;
+        dst[i].y = (cc_Real)src[i].y;
+        dst[i].z = (cc_Real)src[i].z;
+    }
+}
+
+static void
+ccm__WidenVertexPoints(const cc_VertexPoint_f *src, cc_VertexPoint *dst, cc_Index count)
+{
+    ccm__WideningTask task = {src, dst};
+
+    cc_ParallelFor(0, count, CC_PARALLEL_GRAIN, &ccm__WidenVertexPointsRange, &task);
+}
+
+static void ccm__WidenUvsRange(cc_Index begin, cc_Index end, void *userData)
+{
+    const ccm__WideningTask *task = (const ccm__WideningTask *)userData;
+    const cc_VertexUv_f *src = (const cc_VertexUv_f *)task->src;
+    cc_VertexUv *dst = (cc_VertexUv *)task->dst;
+
+    for (cc_Index i = begin; i < end; ++i) {
+        dst[i].u = (cc_Real)src[i].u;
+        dst[i].v = (cc_Real)src[i].v;
+    }
+}
+
+static void ccm__WidenUvs(const cc_VertexUv_f *src, cc_VertexUv *dst, cc_Index count)
+{
+    ccm__WideningTask task = {src, dst};
+
+    cc_ParallelFor(0, count, CC_PARALLEL_GRAIN, &ccm__WidenUvsRange, &task);
+}
+
+static void ccm__WidenCreasesRange(cc_Index begin, cc_Index end, void *userData)
+{
+    const ccm__WideningTask *task = (const ccm__WideningTask *)userData;
+    const cc_Crease_f *src = (const cc_Crease_f *)task->src;
+    cc_Crease *dst = (cc_Crease *)task->dst;
+
+    for (cc_Index i = begin; i < end; ++i) {
+        dst[i].nextID = src[i].nextID;
+        dst[i].prevID = src[i].prevID;
+        dst[i].sharpness = (cc_Real)src[i].sharpness;
+    }
+}
+
+static void ccm__WidenCreases(const cc_Crease_f *src, cc_Crease *dst, cc_Index count)
+{
+    ccm__WideningTask task = {src, dst};
+
+    cc_ParallelFor(0, count, CC_PARALLEL_GRAIN, &ccm__WidenCreasesRange, &task);
+}
+#endif
+
+
+/*******************************************************************************
+ * Container -- Layout of the version 2 files
+ *
+ * A version 2 file starts with a header and a table of sections. Each
+ * section stores one array of the mesh along with its element count (64-bit),
+ * the number and type of the scalars of each element, and a checksum of its
+ * bytes; the header holds the checksum of the table. Sections start on
+ * 64-Byte boundaries, so that they can be mapped in place and read
+ * independently from one another. The IDs and reals are written in the
+ * precision of the library that saves the file, and converted on load by a
+ * library that differs. Since a section holds a single scalar type, the
+ * creases are split into an ID and a sharpness section. Readers skip the
+ * sections they do not know about. The sections of a mesh may also be
+ * compressed (see Encoding), in which case their byte count and checksum
+ * refer to the encoded bytes. Subd files (see SaveSubd) use the same
+ * container, with sections of their own.
+ *
+ */
+enum {
+    CC__SCALAR_INT32 = 1,
+    CC__SCALAR_INT64 = 2,
+    CC__SCALAR_FLOAT32 = 3,
+    CC__SCALAR_FLOAT64 = 4
+};
+
+#ifdef CC_INDEX64
+#   define CC__SCALAR_INDEX CC__SCALAR_INT64
+#else
+#   define CC__SCALAR_INDEX CC__SCALAR_INT32
+#endif
+
+#ifdef CC_SINGLE_PRECISION
+#   define CC__SCALAR_REAL CC__SCALAR_FLOAT32
+#   define CC__REAL_EPSILON (1.0 / 8388608.0)           // 2^-23
+#else
+#   define CC__SCALAR_REAL CC__SCALAR_FLOAT64
+#   define CC__REAL_EPSILON (1.0 / 4503599627370496.0)  // 2^-52
+#endif
+
+enum {
+    CC__SECTION_VERTEX_TO_HALFEDGE_IDS,
+    CC__SECTION_EDGE_TO_HALFEDGE_IDS,
+    CC__SECTION_FACE_TO_HALFEDGE_IDS,
+    CC__SECTION_VERTEX_POINTS,
+    CC__SECTION_UVS,
+    CC__SECTION_CREASE_IDS,
+    CC__SECTION_CREASE_SHARPNESS,
+    CC__SECTION_HALFEDGES,
+    CC__SECTION_COUNT
+};
+
+enum {
+    CC__SECTION_SUBD_INFO = 64,
+    CC__SECTION_SUBD_HALFEDGES,
+    CC__SECTION_SUBD_VERTEX_POINTS,
+    CC__SECTION_SUBD_CREASE_IDS,
+    CC__SECTION_SUBD_CREASE_SHARPNESS,
+    CC__SECTION_SUBD_BOUNDARY_HALFEDGE_IDS,
+    CC__SECTION_SUBD_MAX_CREASE_SHARPNESS,
+    CC__SECTION_SUBD_MIN_BOUNDARY_SHARPNESS,
+    CC__SECTION_SUBD_VERTEX_TO_HALFEDGE_IDS,
+    CC__SECTION_SUBD_EDGE_TO_HALFEDGE_IDS,
+    CC__SECTION_SUBD_CAGE_RING_OFFSETS,
+    CC__SECTION_SUBD_CAGE_RING_HALFEDGE_IDS,
+    CC__SECTION_SUBD_VERTEX_VALENCES,
+    CC__SECTION_SUBD_VERTEX_CLASS_IDS,
+    CC__SECTION_SUBD_REGULAR_VERTEX_COUNTS
+};
+
+enum {
+    CC__ENCODING_RAW,
+    CC__ENCODING_PACKED,        // predicted IDs or reals, packed per block
+    CC__ENCODING_QUANTIZED      // quantized reals, packed per block
+};
+
+#define CC__SECTION_ALIGNMENT 64
+#define CC__MAX_SECTION_COUNT 256
+
+typedef struct {
+    int64_t magic;
+    int32_t sectionCount;
+    int32_t reserved;
+    uint64_t tableChecksum;
+} ccm__FileHeader;
+
+typedef struct {
+    int32_t type;
+    int32_t scalarType;
+    int32_t componentCount;     // scalars per element
+    int32_t encoding;
+    int64_t count;              // elements
+    int64_t offset;             // from the start of the file
+    int64_t byteCount;
+    uint64_t checksum;
+} ccm__Section;
+
+static bool ccm__IsRealSection(int32_t type)
+{
+    return type == CC__SECTION_VERTEX_POINTS
+        || type == CC__SECTION_UVS
+        || type == CC__SECTION_CREASE_SHARPNESS
+        || type == CC__SECTION_SUBD_VERTEX_POINTS
+        || type == CC__SECTION_SUBD_CREASE_SHARPNESS
+        || type == CC__SECTION_SUBD_MAX_CREASE_SHARPNESS
+        || type == CC__SECTION_SUBD_MIN_BOUNDARY_SHARPNESS;
+}
+
+// sections whose scalars have the same type in every build
+static bool ccm__IsFixedSection(int32_t type)
+{
+    return type == CC__SECTION_SUBD_INFO
+        || type == CC__SECTION_SUBD_VERTEX_VALENCES;
+}
+
+static int32_t ccm__NativeScalarType(int32_t type)
+{
+    switch (type) {
+    case CC__SECTION_SUBD_INFO: return CC__SCALAR_INT64;
+    case CC__SECTION_SUBD_VERTEX_VALENCES: return CC__SCALAR_INT32;
+    default: return ccm__IsRealSection(type) ? CC__SCALAR_REAL : CC__SCALAR_INDEX;
+    }
+}
+
+static int32_t ccm__SectionComponentCount(int32_t type)
+{
+    switch (type) {
+    case CC__SECTION_VERTEX_POINTS: return 3;
+    case CC__SECTION_UVS: return 2;
+    case CC__SECTION_CREASE_IDS: return 2;
+    case CC__SECTION_HALFEDGES: return (int32_t)(sizeof(cc_Halfedge) / sizeof(cc_Index));
+    case CC__SECTION_SUBD_HALFEDGES:
+        return (int32_t)(sizeof(cc_Halfedge_SemiRegular) / sizeof(cc_Index));
+    case CC__SECTION_SUBD_VERTEX_POINTS: return 3;
+    case CC__SECTION_SUBD_CREASE_IDS: return 2;
+    default: return 1;
+    }
+}
+
+static int64_t ccm__ScalarByteCount(int32_t scalarType)
+{
+    return (scalarType == CC__SCALAR_INT32 || scalarType == CC__SCALAR_FLOAT32) ? 4 : 8;
+}
+
+static bool ccm__IsNativeSection(const ccm__Section *section)
+{
+    return section->scalarType == ccm__NativeScalarType(section->type)
+        && section->encoding == CC__ENCODING_RAW;
+}
+
+static ccm__Section ccm__CreateSection(int32_t type, cc_Index count)
+{
+    ccm__Section section;
+
+    section.type = type;
+    section.scalarType = ccm__NativeScalarType(type);
+    section.componentCount = ccm__SectionComponentCount(type);
+    section.encoding = CC__ENCODING_RAW;
+    section.count = count;
+    section.offset = 0;
+    section.byteCount = count * section.componentCount
+                      * ccm__ScalarByteCount(section.scalarType);
+    section.checksum = 0;
+
+    return section;
+}
+
+// only the sections of a mesh are compressed
+static bool ccm__IsEncodingValid(const ccm__Section *section)
+{
+    const bool isMeshSection = section->type >= 0 && section->type < CC__SECTION_COUNT;
+
+    switch (section->encoding) {
+    case CC__ENCODING_RAW:
+        return section->byteCount == section->count * section->componentCount
+                                     * ccm__ScalarByteCount(section->scalarType);
+    case CC__ENCODING_PACKED: return isMeshSection;
+    case CC__ENCODING_QUANTIZED:
+        return isMeshSection && ccm__IsRealSection(section->type)
+            && section->componentCount <= 3;
+    default: return false;
+    }
+}
+
+static bool ccm__IsSectionValid(const ccm__Section *section)
+{
+    const int32_t scalarType = section->scalarType;
+    const bool isScalarTypeValid = ccm__IsFixedSection(section->type)
+        ? scalarType == ccm__NativeScalarType(section->type)
+        : ccm__IsRealSection(section->type)
+        ? (scalarType == CC__SCALAR_FLOAT32 || scalarType == CC__SCALAR_FLOAT64)
+        : (scalarType == CC__SCALAR_INT32 || scalarType == CC__SCALAR_INT64);
+
+    return isScalarTypeValid
+        && section->componentCount == ccm__SectionComponentCount(section->type)
+        && section->count >= 0
+        && section->count <= CC_INDEX_MAX
+        && section->count <= INT64_MAX / 64
+        && section->offset >= 0
+        && section->offset % CC__SECTION_ALIGNMENT == 0
+        && section->byteCount >= 0
+        && ccm__IsEncodingValid(section);
+}
+
+
+/*******************************************************************************
+ * Checksum -- Hashes the bytes of a section
+ *
+ * The bytes are hashed in blocks of 1 MiB, in parallel, and the hashes of the
+ * blocks are then hashed in order, so that the result does not depend on the
+ * thread count. Within a block, four FNV-1a lanes consume interleaved 32-bit
+ * words so that their multiplies overlap. Since the blocks are hashed
+ * independently, a section can also be hashed as it is read (see Loader).
+ *
+ */
+#define CC__CHECKSUM_BLOCK_SIZE ((size_t)1 << 20)
+
+static uint64_t ccm__ChecksumBlock(const uint8_t *bytes, size_t byteCount)
+{
+    uint64_t lanes[4] = {
+        0xCBF29CE484222325ULL,
+        0xCBF29CE484222325ULL ^ 1,
+        0xCBF29CE484222325ULL ^ 2,
+        0xCBF29CE484222325ULL ^ 3
+    };
+    uint64_t hash;
+    size_t i = 0;
+
+    for (; i + 4 * sizeof(uint32_t) <= byteCount; i+= 4 * sizeof(uint32_t)) {
+        uint32_t words[4];
+
+        CC_MEMCPY(words, &bytes[i], sizeof(words));
+
+        for (int32_t laneID = 0; laneID < 4; ++laneID) {
+            lanes[laneID] = (lanes[laneID] ^ words[laneID]) * 0x100000001B3ULL;
+        }
+    }
+
+    hash = cc__HashWords(0xCBF29CE484222325ULL, &bytes[i], byteCount - i);
+
+    return cc__HashWords(hash, lanes, sizeof(lanes));
+}
+
+static int64_t ccm__ChecksumBlockCount(size_t byteCount)
+{
+    return (int64_t)((byteCount + CC__CHECKSUM_BLOCK_SIZE - 1) / CC__CHECKSUM_BLOCK_SIZE);
+}
+
+// hashes the hashes of the blocks; blockHashes has room for one more entry
+static uint64_t ccm__FoldChecksum(uint64_t *blockHashes, size_t byteCount)
+{
+    const int64_t blockCount = ccm__ChecksumBlockCount(byteCount);
+
+    blockHashes[blockCount] = (uint64_t)byteCount;
+
+    return cc__HashWords(0xCBF29CE484222325ULL,
+                         blockHashes,
+                         sizeof(uint64_t) * (blockCount + 1));
+}
+
+typedef struct {
+    const uint8_t *bytes;
+    size_t byteCount;
+    uint64_t *blockHashes;
+} ccm__ChecksumTask;
+
+static void ccm__ChecksumBlocks(cc_Index blockBegin, cc_Index blockEnd, void *userData)
+{
+    const ccm__ChecksumTask *task = (const ccm__ChecksumTask *)userData;
+
+    for (cc_Index blockID = blockBegin; blockID < blockEnd; ++blockID) {
+        const size_t begin = (size_t)blockID * CC__CHECKSUM_BLOCK_SIZE;
+        const size_t end = begin + CC__CHECKSUM_BLOCK_SIZE < task->byteCount
+                         ? begin + CC__CHECKSUM_BLOCK_SIZE
+                         : task->byteCount;
+
+        task->blockHashes[blockID] = ccm__ChecksumBlock(&task->bytes[begin], end - begin);
+    }
+}
+
+static uint64_t ccm__Checksum(const void *data, size_t byteCount)
+{
+    const int64_t blockCount = ccm__ChecksumBlockCount(byteCount);
+    uint64_t *blockHashes = (uint64_t *)CC_MALLOC(sizeof(uint64_t) * (blockCount + 1));
+    ccm__ChecksumTask task = {(const uint8_t *)data, byteCount, blockHashes};
+    uint64_t hash;
+
+    cc_ParallelFor(0, (cc_Index)blockCount, 1, &ccm__ChecksumBlocks, &task);
+    hash = ccm__FoldChecksum(blockHashes, byteCount);
+    CC_FREE(blockHashes);
+
+    return hash;
+}
+
+
+/*******************************************************************************
+ * FindSections -- Validates the section table and locates the mesh sections
+ *
+ * Fills "sections" with the known sections of the table, indexed by type.
+ * Fails if the table is corrupt, or if a section is malformed, missing,
+ * repeated, or inconsistent with the others.
+ *
+ */
+static bool
+ccm__FindSections(
+    const ccm__FileHeader *header,
+    const ccm__Section *table,
+    ccm__Section *sections
+) {
+    const size_t tableByteCount = sizeof(ccm__Section) * header->sectionCount;
+    bool isFound[CC__SECTION_COUNT] = {false};
+
+    if (ccm__Checksum(table, tableByteCount) != header->tableChecksum) {
+        return false;
+    }
+
+    for (int32_t sectionID = 0; sectionID < header->sectionCount; ++sectionID) {
+        const ccm__Section *section = &table[sectionID];
+        const int32_t type = section->type;
+
+        if (type < 0 || type >= CC__SECTION_COUNT) {
+            continue;
+        }
+
+        if (isFound[type] || !ccm__IsSectionValid(section)) {
+            return false;
+        }
+
+        sections[type] = *section;
+        isFound[type] = true;
+    }
+
+    for (int32_t type = 0; type < CC__SECTION_COUNT; ++type) {
+        if (!isFound[type]) {
+            return false;
+        }
+    }
+
+    return sections[CC__SECTION_VERTEX_POINTS].count
+           == sections[CC__SECTION_VERTEX_TO_HALFEDGE_IDS].count
+        && sections[CC__SECTION_CREASE_IDS].count
+           == sections[CC__SECTION_EDGE_TO_HALFEDGE_IDS].count
+        && sections[CC__SECTION_CREASE_SHARPNESS].count
+           == sections[CC__SECTION_EDGE_TO_HALFEDGE_IDS].count;
+}
+
+static bool ccm__IsSectionCountValid(const ccm__FileHeader *header)
+{
+    return header->sectionCount > 0 && header->sectionCount <= CC__MAX_SECTION_COUNT;
+}
+
+
+/*******************************************************************************
+ * Encoding -- Compresses the sections of a mesh
+ *
+ * A compressed section is split into blocks of CC_ENCODING_BLOCK_SIZE
+ * elements that decode independently, in parallel. The encoded bytes start
+ * with a header and the offsets of the blocks. Within a block, each component
+ * is stored as a column of deltas between the values and their predictions
+ * from the values decoded before them. The deltas of a column are shifted by
+ * their common trailing zeros, zigzag-encoded, and bit-packed with the width
+ * that minimizes the size of the column; the deltas that do not fit are
+ * patched by exceptions, which store their high bits as varints.
+ *
+ * IDs are predicted by the ID of the previous element, except for halfedges,
+ * whose faces are decoded first: the next and prev IDs are then implicit
+ * (zero-width) wherever the halfedges of a face are contiguous, and the twin
+ * IDs are predicted by the halfedge ID. Reals are predicted by the previous
+ * element as well, either exactly, from their bits, or quantized: with a
+ * positive tolerance, ccm_SaveCompressed rounds each vertex point coordinate
+ * to a multiple of a step from the minimum of the coordinates. The step is
+ * twice the tolerance minus two ulps of the largest coordinate, which covers
+ * the rounding of the decoded points to cc_Real, so that they stay within
+ * the tolerance in single precision as well; tolerances below that rounding
+ * leave the points lossless. Sections that would not shrink are written raw.
+ *
+ */
+#ifndef CC_ENCODING_BLOCK_SIZE
+#   define CC_ENCODING_BLOCK_SIZE 4096
+#endif
+
+#define CC__MAX_PACKED_WIDTH 56
+
+// component order of cc_Halfedge
+enum {
+    CC__HALFEDGE_TWIN,
+    CC__HALFEDGE_NEXT,
+    CC__HALFEDGE_PREV,
+    CC__HALFEDGE_FACE
+};
+
+typedef struct {
+    int64_t blockSize;          // elements per block
+    int64_t blockCount;
+    double step;                // quantization step of the reals
+    double origin[3];           // quantization origin of each component
+} ccm__EncodingHeader;          // followed by blockCount + 1 block offsets
+
+static uint64_t ccm__ZigZag(uint64_t delta)
+{
+    return (delta << 1) ^ (uint64_t)-(int64_t)(delta >> 63);
+}
+
+static uint64_t ccm__UnZigZag(uint64_t residual)
+{
+    return (residual >> 1) ^ (uint64_t)-(int64_t)(residual & 1);
+}
+
+static int32_t ccm__BitWidth(uint64_t x)
+{
+    int32_t width = 0;
+
+    while (x > 0) {
+        x>>= 1;
+        ++width;
+    }
+
+    return width;
+}
+
+static uint8_t *ccm__WriteVarint(uint8_t *bytes, uint64_t x)
+{
+    while (x >= 0x80) {
+        *bytes++ = (uint8_t)(x | 0x80);
+        x>>= 7;
+    }
+
+    *bytes++ = (uint8_t)x;
+
+    return bytes;
+}
+
+static bool ccm__ReadVarint(const uint8_t **bytes, const uint8_t *end, uint64_t *x)
+{
+    const uint8_t *in = *bytes;
+    int32_t shift = 0;
+    uint8_t byte;
+
+    *x = 0;
+
+    do {
+        if (in == end || shift > 63) {
+            return false;
+        }
+
+        byte = *in++;
+        *x|= (uint64_t)(byte & 0x7F) << shift;
+        shift+= 7;
+    } while (byte & 0x80);
+
+    *bytes = in;
+
+    return true;
+}
+
+// positive and finite
+static bool ccm__IsStepValid(double step)
+{
+    return step > 0.0 && step - step == 0.0;
+}
+
+static int64_t ccm__Quantize(double x, double origin, double step)
+{
+    return (int64_t)((x - origin) / step + 0.5);
+}
+
+static uint64_t ccm__RealBits(cc_Real x)
+{
+#ifdef CC_SINGLE_PRECISION
+    uint32_t bits;
+#else
+    uint64_t bits;
+#endif
+
+    CC_MEMCPY(&bits, &x, sizeof(bits));
+
+    return bits;
+}
+
+static cc_Real ccm__BitsToReal(uint64_t bits, int32_t scalarType)
+{
+    if (scalarType == CC__SCALAR_FLOAT32) {
+        const uint32_t lowBits = (uint32_t)bits;
+        float x;
+
+        CC_MEMCPY(&x, &lowBits, sizeof(x));
+
+        return (cc_Real)x;
+    } else {
+        double x;
+
+        CC_MEMCPY(&x, &bits, sizeof(x));
+
+        return (cc_Real)x;
+    }
+}
+
+// the faces of halfedges come first, as they predict the next and prev IDs
+static int32_t ccm__EncodingComponentID(int32_t type, int32_t columnID)
+{
+    if (type == CC__SECTION_HALFEDGES && columnID <= CC__HALFEDGE_FACE) {
+        return columnID == 0 ? CC__HALFEDGE_FACE : columnID - 1;
+    }
+
+    return columnID;
+}
+
+static int64_t
+ccm__PredictID(
+    int32_t type,
+    const cc_Index *ids,
+    int32_t componentCount,
+    int32_t componentID,
+    int64_t elementID,
+    int64_t begin,
+    int64_t end
+) {
+    if (type == CC__SECTION_HALFEDGES && componentID < CC__HALFEDGE_FACE) {
+        const cc_Index *faceIDs = &ids[CC__HALFEDGE_FACE];
+        const cc_Index faceID = faceIDs[elementID * componentCount];
+        int64_t halfedgeID = elementID;
+
+        switch (componentID) {
+        case CC__HALFEDGE_TWIN: return elementID;
+        case CC__HALFEDGE_NEXT:
+            if (elementID + 1 < end && faceIDs[(elementID + 1) * componentCount] == faceID) {
+                return elementID + 1;
+            }
+
+            // wraps around to the first halfedge of the face
+            while (halfedgeID > begin
+                   && faceIDs[(halfedgeID - 1) * componentCount] == faceID) {
+                --halfedgeID;
+            }
+
+            return halfedgeID;
+        default:
+            if (elementID > begin && faceIDs[(elementID - 1) * componentCount] == faceID) {
+                return elementID - 1;
+            }
+
+            // wraps around to the last halfedge of the face
+            while (halfedgeID + 1 < end
+                   && faceIDs[(halfedgeID + 1) * componentCount] == faceID) {
+                ++halfedgeID;
+            }
+
+            return halfedgeID;
+        }
+    }
+
+    return elementID > begin ? ids[(elementID - 1) * componentCount + componentID] : 0;
+}
+
+// Bytes of a column packed with a given width, estimated from the widths of its residuals
+static int64_t
+ccm__PackedByteCount(const int64_t *widthCounts, int64_t count, int32_t width)
+{
+    int64_t byteCount = (count * width + 7) / 8;
+
+    for (int32_t exceptionWidth = width + 1; exceptionWidth <= 64; ++exceptionWidth) {
+        byteCount+= widthCounts[exceptionWidth] * (1 + (exceptionWidth - width + 6) / 7);
+    }
+
+    return byteCount;
+}
+
+/*
+ * Writes the deltas of a column: its width, shift and exception count, the
+ * packed low bits of the residuals, and the exceptions, as pairs of varints
+ * (distance to the previous exception, high bits). Overwrites the deltas.
+ */
+static int64_t ccm__WriteColumn(uint8_t *bytes, uint64_t *deltas, int64_t count)
+{
+    int64_t widthCounts[65] = {0};
+    int64_t exceptionCount = 0, exceptionID = 0;
+    uint64_t deltaBits = 0, bits = 0;
+    int32_t shift = 0, width = 0, bitCount = 0;
+    uint8_t *out = bytes;
+
+    for (int64_t i = 0; i < count; ++i) {
+        deltaBits|= deltas[i];
+    }
+
+    while (shift < 63 && deltaBits != 0 && ((deltaBits >> shift) & 1) == 0) {
+        ++shift;
+    }
+
+    for (int64_t i = 0; i < count; ++i) {
+        deltas[i] = ccm__ZigZag((uint64_t)((int64_t)deltas[i] >> shift));
+        ++widthCounts[ccm__BitWidth(deltas[i])];
+    }
+
+    for (int32_t candidate = 1; candidate <= CC__MAX_PACKED_WIDTH; ++candidate) {
+        if (ccm__PackedByteCount(widthCounts, count, candidate)
+            < ccm__PackedByteCount(widthCounts, count, width)) {
+            width = candidate;
+        }
+    }
+
+    for (int64_t i = 0; i < count; ++i) {
+        exceptionCount+= (deltas[i] >> width) != 0;
+    }
+
+    *out++ = (uint8_t)width;
+    *out++ = (uint8_t)shift;
+    out = ccm__WriteVarint(out, (uint64_t)exceptionCount);
+
+    for (int64_t i = 0; i < count && width > 0; ++i) {
+        bits|= (deltas[i] & (((uint64_t)1 << width) - 1)) << bitCount;
+        bitCount+= width;
+
+        while (bitCount >= 8) {
+            *out++ = (uint8_t)bits;
+            bits>>= 8;
+            bitCount-= 8;
+        }
+    }
+
+    if (bitCount > 0) {
+        *out++ = (uint8_t)bits;
+    }
+
+    for (int64_t i = 0; i < count; ++i) {
+        if ((deltas[i] >> width) != 0) {
+            out = ccm__WriteVarint(out, (uint64_t)(i - exceptionID));
+            out = ccm__WriteVarint(out, deltas[i] >> width);
+            exceptionID = i;
+        }
+    }
+
+    return out - bytes;
+}
+
+static bool
+ccm__ReadColumn(
+    const uint8_t **bytes,
+    const uint8_t *end,
+    uint64_t *deltas,
+    int64_t count
+) {
+    const uint8_t *in = *bytes;
+    uint64_t exceptionCount, bits = 0;
+    int64_t exceptionID = 0;
+    int32_t width, shift, bitCount = 0;
+
+    if (end - in < 2) {
+        return false;
+    }
+
+    width = *in++;
+    shift = *in++;
+
+    if (width > CC__MAX_PACKED_WIDTH || shift > 63
+        || !ccm__ReadVarint(&in, end, &exceptionCount)
+        || exceptionCount > (uint64_t)count
+        || (count * width + 7) / 8 > end - in) {
+        return false;
+    }
+
+    for (int64_t i = 0; i < count; ++i) {
+        while (bitCount < width) {
+            bits|= (uint64_t)*in++ << bitCount;
+            bitCount+= 8;
+        }
+
+        deltas[i] = bits & (((uint64_t)1 << width) - 1);
+        bits>>= width;
+        bitCount-= width;
+    }
+
+    for (uint64_t i = 0; i < exceptionCount; ++i) {
+        uint64_t distance, highBits;
+
+        if (!ccm__ReadVarint(&in, end, &distance)
+            || !ccm__ReadVarint(&in, end, &highBits)
+            || distance >= (uint64_t)(count - exceptionID)) {
+            return false;
+        }
+
+        exceptionID+= (int64_t)distance;
+        deltas[exceptionID]|= highBits << width;
+    }
+
+    for (int64_t i = 0; i < count; ++i) {
+        deltas[i] = ccm__UnZigZag(deltas[i]) << shift;
+    }
+
+    *bytes = in;
+
+    return true;
+}
+
+// Bytes of a block in the worst case
+static int64_t ccm__EncodedBlockByteCount(int32_t componentCount, int64_t blockSize)
+{
+    return componentCount * (12 + blockSize * (CC__MAX_PACKED_WIDTH / 8 + 20));
+}
+
+static int64_t
+ccm__EncodeBlock(
+    const ccm__Section *section,
+    const ccm__EncodingHeader *header,
+    const void *array,
+    int64_t blockID,
+    uint8_t *bytes
+) {
+    const int32_t componentCount = section->componentCount;
+    const int64_t begin = blockID * header->blockSize;
+    const int64_t end = cc__Min64(begin + header->blockSize, section->count);
+    uint64_t *deltas = (uint64_t *)CC_MALLOC(sizeof(uint64_t) * (end - begin));
+    uint8_t *out = bytes;
+
+    for (int32_t columnID = 0; columnID < componentCount; ++columnID) {
+        const int32_t componentID = ccm__EncodingComponentID(section->type, columnID);
+
+        if (ccm__IsRealSection(section->type)) {
+            const cc_Real *reals = (const cc_Real *)array;
+            uint64_t prevValue = 0;
+
+            for (int64_t i = begin; i < end; ++i) {
+                const cc_Real x = reals[i * componentCount + componentID];
+                const uint64_t value = section->encoding == CC__ENCODING_QUANTIZED
+                    ? (uint64_t)ccm__Quantize(x, header->origin[componentID], header->step)
+                    : ccm__RealBits(x);
+
+                deltas[i - begin] = value - prevValue;
+                prevValue = value;
+            }
+        } else {
+            const cc_Index *ids = (const cc_Index *)array;
+
+            for (int64_t i = begin; i < end; ++i) {
+                const int64_t prediction = ccm__PredictID(section->type, ids, componentCount,
+                                                          componentID, i, begin, end);
+                const int64_t id = ids[i * componentCount + componentID];
+
+                deltas[i - begin] = (uint64_t)id - (uint64_t)prediction;
+            }
+        }
+
+        out+= ccm__WriteColumn(out, deltas, end - begin);
+    }
+
+    CC_FREE(deltas);
+
+    return out - bytes;
+}
+
+static bool
+ccm__DecodeBlock(
+    const ccm__Section *section,
+    const ccm__EncodingHeader *header,
+    const uint8_t *bytes,
+    const uint8_t *bytesEnd,
+    void *array,
+    int64_t blockID
+) {
+    const int32_t componentCount = section->componentCount;
+    const int64_t begin = blockID * header->blockSize;
+    const int64_t end = cc__Min64(begin + header->blockSize, section->count);
+    uint64_t *deltas = (uint64_t *)CC_MALLOC(sizeof(uint64_t) * (end - begin));
+    bool isSuccess = true;
+
+    for (int32_t columnID = 0; isSuccess && columnID < componentCount; ++columnID) {
+        const int32_t componentID = ccm__EncodingComponentID(section->type, columnID);
+
+        if (!ccm__ReadColumn(&bytes, bytesEnd, deltas, end - begin)) {
+            isSuccess = false;
+        } else if (ccm__IsRealSection(section->type)) {
+            const double origin = header->origin[componentID];
+            cc_Real *reals = (cc_Real *)array;
+            uint64_t value = 0;
+
+            for (int64_t i = begin; i < end; ++i) {
+                value+= deltas[i - begin];
+                reals[i * componentCount + componentID] =
+                    section->encoding == CC__ENCODING_QUANTIZED
+                    ? (cc_Real)(origin + (double)(int64_t)value * header->step)
+                    : ccm__BitsToReal(value, section->scalarType);
+            }
+        } else {
+            cc_Index *ids = (cc_Index *)array;
+
+            for (int64_t i = begin; i < end; ++i) {
+                const int64_t prediction = ccm__PredictID(section->type, ids, componentCount,
+                                                          componentID, i, begin, end);
+
+                ids[i * componentCount + componentID] =
+                    (cc_Index)(int64_t)((uint64_t)prediction + deltas[i - begin]);
+            }
+        }
+    }
+
+    CC_FREE(deltas);
+
+    return isSuccess;
+}
+
+// quantizes the reals of a section within a tolerance if their range allows for it
+static bool
+ccm__SetQuantization(
+    const ccm__Section *section,
+    const cc_Real *reals,
+    double tolerance,
+    ccm__EncodingHeader *header
+) {
+    const int32_t componentCount = section->componentCount;
+    double minValues[3], maxValues[3];
+    double maxMagnitude = 0.0, step;
+
+    if (!ccm__IsStepValid(tolerance)) {
+        return false;
+    }
+
+    for (int32_t componentID = 0; componentID < componentCount; ++componentID) {
+        double minValue = 0.0, maxValue = 0.0;
+
+        for (int64_t i = 0; i < section->count; ++i) {
+            const double x = (double)reals[i * componentCount + componentID];
+
+            minValue = (i == 0 || x < minValue) ? x : minValue;
+            maxValue = (i == 0 || x > maxValue) ? x : maxValue;
+        }
+
+        minValues[componentID] = minValue;
+        maxValues[componentID] = maxValue;
+        maxMagnitude = -minValue > maxMagnitude ? -minValue : maxMagnitude;
+        maxMagnitude = maxValue > maxMagnitude ? maxValue : maxMagnitude;
+    }
+
+    // the decoder rounds to cc_Real, which may add up to an ulp to the error
+    step = 2.0 * (tolerance - 2.0 * CC__REAL_EPSILON * maxMagnitude);
+
+    if (!ccm__IsStepValid(step)) {
+        return false;
+    }
+
+    for (int32_t componentID = 0; componentID < componentCount; ++componentID) {
+        const double range = maxValues[componentID] - minValues[componentID];
+
+        // the quanta must be exact in doubles (fails on NaNs and infinities)
+        if (!(range / step < (double)((int64_t)1 << 52))) {
+            return false;
+        }
+
+        header->origin[componentID] = minValues[componentID];
+    }
+
+    header->step = step;
+
+    return true;
+}
+
+/*
+ * Compresses the array of a section, and updates the section accordingly.
+ * Returns NULL if the section is better off raw. A positive tolerance
+ * quantizes reals, which are otherwise compressed losslessly.
+ */
+typedef struct {
+    const ccm__Section *section;
+    const ccm__EncodingHeader *header;
+    const void *array;
+    uint8_t *slots;
+    int64_t slotByteCount;
+    int64_t *blockOffsets;
+} ccm__EncodingTask;
+
+static void ccm__EncodeBlocks(cc_Index blockBegin, cc_Index blockEnd, void *userData)
+{
+    const ccm__EncodingTask *task = (const ccm__EncodingTask *)userData;
+
+    for (int64_t blockID = blockBegin; blockID < blockEnd; ++blockID) {
+        task->blockOffsets[blockID + 1] =
+            ccm__EncodeBlock(task->section,
+                             task->header,
+                             task->array,
+                             blockID,
+                             &task->slots[blockID * task->slotByteCount]);
+    }
+}
+
+static void *ccm__EncodeSection(ccm__Section *section, const void *array, double tolerance)
+{
+    const int64_t count = section->count;
+    const int64_t blockSize = CC_ENCODING_BLOCK_SIZE;
+    const int64_t blockCount = (count + blockSize - 1) / blockSize;
+    const int64_t slotByteCount =
+        ccm__EncodedBlockByteCount(section->componentCount, cc__Min64(blockSize, count));
+    const int64_t tableByteCount = sizeof(ccm__EncodingHeader)
+                                 + sizeof(int64_t) * (blockCount + 1);
+    ccm__EncodingHeader header = {blockSize, blockCount, 0.0, {0.0, 0.0, 0.0}};
+    ccm__Section encodedSection = *section;
+    ccm__EncodingTask task;
+    int64_t *blockOffsets;
+    uint8_t *slots, *data;
+
+    if (ccm__IsRealSection(section->type)
+        && ccm__SetQuantization(section, (const cc_Real *)array, tolerance, &header)) {
+        encodedSection.encoding = CC__ENCODING_QUANTIZED;
+    } else {
+        encodedSection.encoding = CC__ENCODING_PACKED;
+    }
+
+    slots = (uint8_t *)CC_MALLOC((size_t)(slotByteCount * (blockCount > 0 ? blockCount : 1)));
+    blockOffsets = (int64_t *)CC_MALLOC(sizeof(int64_t) * (blockCount + 1));
+    task.section = &encodedSection;
+    task.header = &header;
+    task.array = array;
+    task.slots = slots;
+    task.slotByteCount = slotByteCount;
+    task.blockOffsets = blockOffsets;
+    cc_ParallelFor(0, (cc_Index)blockCount, 1, &ccm__EncodeBlocks, &task);
+
+    blockOffsets[0] = 0;
+
+    for (int64_t blockID = 0; blockID < blockCount; ++blockID) {
+        blockOffsets[blockID + 1]+= blockOffsets[blockID];
+    }
+
+    if (tableByteCount + blockOffsets[blockCount] >= section->byteCount) {
+        CC_FREE(slots);
+        CC_FREE(blockOffsets);
+
+        return NULL;
+    }
+
+    data = (uint8_t *)CC_MALLOC((size_t)(tableByteCount + blockOffsets[blockCount]));
+    CC_MEMCPY(data, &header, sizeof(header));
+    CC_MEMCPY(&data[sizeof(header)], blockOffsets, sizeof(int64_t) * (blockCount + 1));
+
+    for (int64_t blockID = 0; blockID < blockCount; ++blockID) {
+        CC_MEMCPY(&data[tableByteCount + blockOffsets[blockID]],
+                  &slots[blockID * slotByteCount],
+                  (size_t)(blockOffsets[blockID + 1] - blockOffsets[blockID]));
+    }
+
+    encodedSection.byteCount = tableByteCount + blockOffsets[blockCount];
+    *section = encodedSection;
+    CC_FREE(slots);
+    CC_FREE(blockOffsets);
+
+    return data;
+}
+
+typedef struct {
+    const ccm__Section *section;
+    const ccm__EncodingHeader *header;
+    const uint8_t *bytes;
+    const uint8_t *blocks;
+    int64_t blockByteCount;
+    void *array;
+    int64_t failureCount;
+} ccm__DecodingTask;
+
+static void ccm__DecodeBlocks(cc_Index blockBegin, cc_Index blockEnd, void *userData)
+{
+    ccm__DecodingTask *task = (ccm__DecodingTask *)userData;
+    int64_t failureCount = 0;
+
+    for (int64_t blockID = blockBegin; blockID < blockEnd; ++blockID) {
+        int64_t blockOffsets[2];
+
+        CC_MEMCPY(blockOffsets,
+                  &task->bytes[sizeof(ccm__EncodingHeader) + sizeof(int64_t) * blockID],
+                  sizeof(blockOffsets));
+
+        if (blockOffsets[0] < 0
+            || blockOffsets[0] > blockOffsets[1]
+            || blockOffsets[1] > task->blockByteCount
+            || !ccm__DecodeBlock(task->section,
+                                 task->header,
+                                 &task->blocks[blockOffsets[0]],
+                                 &task->blocks[blockOffsets[1]],
+                                 task->array,
+                                 blockID)) {
+            ++failureCount;
+        }
+    }
+
+    if (failureCount > 0) {
+        cc__AtomicAddInt64(&task->failureCount, failureCount);
+    }
+}
+
+static bool
+ccm__DecodeEncodedSection(const ccm__Section *section, const void *data, void *array)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    const int64_t byteCount = section->byteCount;
+    ccm__EncodingHeader header;
+    ccm__DecodingTask task;
+
+    if (byteCount < (int64_t)sizeof(header)) {
+        return false;
+    }
+
+    CC_MEMCPY(&header, bytes, sizeof(header));
+
+    if (header.blockSize <= 0
+        || header.blockSize > INT64_MAX / 2
+        || header.blockCount != (section->count + header.blockSize - 1) / header.blockSize
+        || header.blockCount >= (byteCount - (int64_t)sizeof(header)) / (int64_t)sizeof(int64_t)
+        || (section->encoding == CC__ENCODING_QUANTIZED && !ccm__IsStepValid(header.step))) {
+        return false;
+    }
+
+    task.section = section;
+    task.header = &header;
+    task.bytes = bytes;
+    task.blocks = &bytes[sizeof(header) + sizeof(int64_t) * (header.blockCount + 1)];
+    task.blockByteCount = byteCount - (int64_t)(task.blocks - bytes);
+    task.array = array;
+    task.failureCount = 0;
+#ifdef CC__ATOMICS
+    cc_ParallelFor(0, (cc_Index)header.blockCount, 1, &ccm__DecodeBlocks, &task);
+#else
+    ccm__DecodeBlocks(0, (cc_Index)header.blockCount, &task);
+#endif
+
+    return task.failureCount == 0;
+}
+
+
+/*******************************************************************************
+ * DecodeSection -- Converts the scalars of a section to cc_Index and cc_Real
+ *
+ * The scalars are converted in chunks of CC_PARALLEL_GRAIN on the backend,
+ * so that the chunk IDs fit in a cc_Index whatever the scalar count.
+ *
+ */
+typedef struct {
+    const void *src;
+    int32_t scalarType;
+    void *dst;
+    int64_t count;
+} ccm__ScalarTask;
+
+static int64_t ccm__ScalarChunkCount(int64_t count)
+{
+    return (count + CC_PARALLEL_GRAIN - 1) / CC_PARALLEL_GRAIN;
+}
+
+static void ccm__DecodeIDChunks(cc_Index chunkBegin, cc_Index chunkEnd, void *userData)
+{
+    const ccm__ScalarTask *task = (const ccm__ScalarTask *)userData;
+    const int64_t begin = (int64_t)chunkBegin * CC_PARALLEL_GRAIN;
+    const int64_t end = cc__Min64((int64_t)chunkEnd * CC_PARALLEL_GRAIN, task->count);
+    cc_Index *ids = (cc_Index *)task->dst;
+
+    if (task->scalarType == CC__SCALAR_INT32) {
+        const int32_t *src = (const int32_t *)task->src;
+
+        for (int64_t i = begin; i < end; ++i) {
+            ids[i] = (cc_Index)src[i];
+        }
+    } else {
+        const int64_t *src = (const int64_t *)task->src;
+
+        for (int64_t i = begin; i < end; ++i) {
+            ids[i] = (cc_Index)src[i];
+        }
+    }
+}
+
+static void ccm__DecodeRealChunks(cc_Index chunkBegin, cc_Index chunkEnd, void *userData)
+{
+    const ccm__ScalarTask *task = (const ccm__ScalarTask *)userData;
+    const int64_t begin = (int64_t)chunkBegin * CC_PARALLEL_GRAIN;
+    const int64_t end = cc__Min64((int64_t)chunkEnd * CC_PARALLEL_GRAIN, task->count);
+    cc_Real *reals = (cc_Real *)task->dst;
+
+    if (task->scalarType == CC__SCALAR_FLOAT32) {
+        const float *src = (const float *)task->src;
+
+        for (int64_t i = begin; i < end; ++i) {
+            reals[i] = (cc_Real)src[i];
+        }
+    } else {
+        const double *src = (const double *)task->src;
+
+        for (int64_t i = begin; i < end; ++i) {
+            reals[i] = (cc_Real)src[i];
+        }
+    }
+}
+
+static void
+ccm__DecodeIDs(const void *data, int32_t scalarType, cc_Index *ids, int64_t count)
+{
+    ccm__ScalarTask task = {data, scalarType, ids, count};
+
+    cc_ParallelFor(0, (cc_Index)ccm__ScalarChunkCount(count), 1, &ccm__DecodeIDChunks, &task);
+}
+
+static void
+ccm__DecodeReals(const void *data, int32_t scalarType, cc_Real *reals, int64_t count)
+{
+    ccm__ScalarTask task = {data, scalarType, reals, count};
+
+    cc_ParallelFor(0, (cc_Index)ccm__ScalarChunkCount(count), 1, &ccm__DecodeRealChunks, &task);
+}
+
+// fails if the encoded bytes of a compressed section are corrupt
+static bool
+ccm__DecodeSection(const ccm__Section *section, const void *data, void *array)
+{
+    const int64_t scalarCount = section->count * section->componentCount;
+
+    if (section->encoding != CC__ENCODING_RAW) {
+        return ccm__DecodeEncodedSection(section, data, array);
+    } else if (ccm__IsNativeSection(section)) {
+        CC_MEMCPY(array, data, (size_t)section->byteCount);
+    } else if (ccm__IsRealSection(section->type)) {
+        ccm__DecodeReals(data, section->scalarType, (cc_Real *)array, scalarCount);
+    } else {
+        ccm__DecodeIDs(data, section->scalarType, (cc_Index *)array, scalarCount);
+    }
+
+    return true;
+}
+
+static size_t ccm__SectionArrayByteCount(const ccm__Section *section)
+{
+    const int64_t scalarByteCount =
+        ccm__ScalarByteCount(ccm__NativeScalarType(section->type));
+
+    return (size_t)(section->count * section->componentCount * scalarByteCount);
+}
+
+
+/*******************************************************************************
+ * SplitCreases / JoinCreases -- Converts between cc_Crease and its sections
+ *
+ */
+typedef struct {
+    cc_Crease *creases;
+    cc_Index *creaseIDs;
+    cc_Real *creaseSharpness;
+} ccm__CreaseTask;
+
+static void ccm__SplitCreaseRange(cc_Index begin, cc_Index end, void *userData)
+{
+    const ccm__CreaseTask *task = (const ccm__CreaseTask *)userData;
+
+    for (cc_Index i = begin; i < end; ++i) {
+        task->creaseIDs[2 * i + 0] = task->creases[i].nextID;
+        task->creaseIDs[2 * i + 1] = task->creases[i].prevID;
+        task->creaseSharpness[i] = task->creases[i].sharpness;
+    }
+}
+
+static void ccm__JoinCreaseRange(cc_Index begin, cc_Index end, void *userData)
+{
+    const ccm__CreaseTask *task = (const ccm__CreaseTask *)userData;
+
+    for (cc_Index i = begin; i < end; ++i) {
+        task->creases[i].nextID = task->creaseIDs[2 * i + 0];
+        task->creases[i].prevID = task->creaseIDs[2 * i + 1];
+        task->creases[i].sharpness = task->creaseSharpness[i];
+    }
+}
+
+static void
+ccm__SplitCreases(
+    const cc_Crease *creases,
+    cc_Index *creaseIDs,
+    cc_Real *creaseSharpness,
+    cc_Index count
+) {
+    ccm__CreaseTask task = {(cc_Crease *)creases, creaseIDs, creaseSharpness};
+
+    cc_ParallelFor(0, count, CC_PARALLEL_GRAIN, &ccm__SplitCreaseRange, &task);
+}
+
+static void
+ccm__JoinCreases(
+    const cc_Index *creaseIDs,
+    const cc_Real *creaseSharpness,
+    cc_Crease *creases,
+    cc_Index count
+) {
+    ccm__CreaseTask task = {creases, (cc_Index *)creaseIDs, (cc_Real *)creaseSharpness};
+
+    cc_ParallelFor(0, count, CC_PARALLEL_GRAIN, &ccm__JoinCreaseRange, &task);
+}
+
+
+/*******************************************************************************
+ * WriteSections -- Writes a version 2 file
+ *
+ * Assigns the offsets and checksums of the sections, then writes the header,
+ * the section table, and the data of each section, padded to its offset.
+ *
+ */
+static bool
+ccm__WriteSections(
+    FILE *stream,
+    int64_t magic,
+    ccm__Section *sections,
+    const void *const *arrays,
+    int32_t sectionCount
+) {
+    const uint8_t padding[CC__SECTION_ALIGNMENT] = {0};
+    const int64_t tableByteCount = sizeof(ccm__Section) * sectionCount;
+    int64_t offset = sizeof(ccm__FileHeader) + tableByteCount;
+    ccm__FileHeader header;
+
+    for (int32_t sectionID = 0; sectionID < sectionCount; ++sectionID) {
+        ccm__Section *section = &sections[sectionID];
+
+        offset = (offset + CC__SECTION_ALIGNMENT - 1) / CC__SECTION_ALIGNMENT
+               * CC__SECTION_ALIGNMENT;
+        section->offset = offset;
+        section->checksum = ccm__Checksum(arrays[sectionID], (size_t)section->byteCount);
+        offset+= section->byteCount;
+    }
+
+    header.magic = magic;
+    header.sectionCount = sectionCount;
+    header.reserved = 0;
+    header.tableChecksum = ccm__Checksum(sections, (size_t)tableByteCount);
+
+    if (fwrite(&header, sizeof(header), 1, stream) != 1
+        || fwrite(sections, sizeof(ccm__Section), sectionCount, stream)
+           != (size_t)sectionCount) {
+        return false;
+    }
+
+    offset = sizeof(ccm__FileHeader) + tableByteCount;
+
+    for (int32_t sectionID = 0; sectionID < sectionCount; ++sectionID) {
+        const ccm__Section *section = &sections[sectionID];
+        const size_t paddingByteCount = (size_t)(section->offset - offset);
+        const size_t byteCount = (size_t)section->byteCount;
+
+        if (fwrite(padding, 1, paddingByteCount, stream) != paddingByteCount
+            || fwrite(arrays[sectionID], 1, byteCount, stream) != byteCount) {
+            return false;
+        }
+
+        offset = section->offset + section->byteCount;
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+ * ReadData -- Loads mesh data
+ *
+ */
+static bool ccm__ReadData(cc_Mesh *mesh, FILE *stream)
+{
+    const cc_Index vertexCount = ccm_VertexCount(mesh);
+    const cc_Index uvCount = ccm_UvCount(mesh);
+    const cc_Index halfedgeCount = ccm_HalfedgeCount(mesh);
+    const cc_Index creaseCount = ccm_CreaseCount(mesh);
+    const cc_Index edgeCount = ccm_EdgeCount(mesh);
+    const cc_Index faceCount = ccm_FaceCount(mesh);
+    const cc_Index halfedgeIDCount = halfedgeCount * sizeof(cc_Halfedge) / sizeof(cc_Index);
+#if defined(CC_SINGLE_PRECISION) && !defined(CC_INDEX64)
+    // the in-memory layout matches the file layout: read in place
+    cc_VertexPoint *vertexPts = mesh->vertexPoints;
+    cc_VertexUv *uvs = mesh->uvs;
+    cc_Crease *creases = mesh->creases;
+#else
+    const size_t vertexByteCount = vertexCount * sizeof(cc_VertexPoint_f);
+    const size_t uvByteCount = uvCount * sizeof(cc_VertexUv_f);
+    const size_t creaseByteCount = creaseCount * sizeof(cc_Crease_f);
+
+    cc_Crease_f *creases = (cc_Crease_f *)malloc(creaseByteCount);
+    cc_VertexPoint_f *vertexPts = (cc_VertexPoint_f *)malloc(vertexByteCount);
+    cc_VertexUv_f *uvs = (cc_VertexUv_f *)malloc(uvByteCount);
+#endif
+
+    bool isSuccess = 
+       ccm__ReadIDs(mesh->vertexToHalfedgeIDs, vertexCount, stream)
+    && ccm__ReadIDs(mesh->edgeToHalfedgeIDs, edgeCount, stream)
+    && ccm__ReadIDs(mesh->faceToHalfedgeIDs, faceCount, stream)
+    && (fread(vertexPts                 , sizeof(cc_VertexPoint_f), vertexCount  , stream) == (size_t)vertexCount)
+    && (fread(uvs                       , sizeof(cc_VertexUv_f)   , uvCount      , stream) == (size_t)uvCount)
+    && (fread(creases                   , sizeof(cc_Crease_f)     , creaseCount  , stream) == (size_t)creaseCount)
+    && ccm__ReadIDs((cc_Index *)mesh->halfedges, halfedgeIDCount, stream);
+
+#if !defined(CC_SINGLE_PRECISION) || defined(CC_INDEX64)
+    // now convert all floats to cc_Reals
+    ccm__WidenVertexPoints(vertexPts, mesh->vertexPoints, vertexCount);
+    ccm__WidenUvs(uvs, mesh->uvs, uvCount);
+    ccm__WidenCreases(creases, mesh->creases, creaseCount);
+    free(creases); 
+    free(vertexPts);
+    free(uvs);
+#endif
+    return isSuccess;
+}
+
+
+/*******************************************************************************
+ * Load -- Loads a mesh from a file
+ *
+ * The magic identifier selects the version of the format. In version 2, each
+ * section is read straight into its array when its scalars match those of
+ * the library, and through a staging buffer that gets converted otherwise.
+ *
+ */
+static cc_Mesh *ccm__LoadV1(FILE *stream)
+{
+    ccm__Header header;
+    cc_Mesh *mesh;
+
+    if (!ccm__ReadHeader(stream, &header)) {
+        CC_LOG("cc: unsupported file");
+
+        return NULL;
+    }
+
+    mesh = ccm_Create(header.vertexCount,
+                      header.uvCount,
+                      header.halfedgeCount,
+                      header.edgeCount,
+                      header.faceCount);
+    if (!ccm__ReadData(mesh, stream)) {
+        CC_LOG("cc: data reading failed");
+        ccm_Release(mesh);
+
+        return NULL;
+    }
+
+    return mesh;
+}
+
+static bool ccm__ReadSection(FILE *stream, const ccm__Section *section, void *array)
+{
+    const size_t byteCount = (size_t)section->byteCount;
+    const bool isNative = ccm__IsNativeSection(section);
+    void *data = isNative ? array : CC_MALLOC(byteCount);
+    bool isSuccess = fseek(stream, (long)section->offset, SEEK_SET) == 0
+                  && fread(data, 1, byteCount, stream) == byteCount
+                  && ccm__Checksum(data, byteCount) == section->checksum;
+
+    if (!isNative) {
+        isSuccess = isSuccess && ccm__DecodeSection(section, data, array);
+        CC_FREE(data);
+    }
+
+    return isSuccess;
+}
+
+static cc_Mesh *ccm__LoadV2(FILE *stream)
+{
+    ccm__FileHeader header;
+    ccm__Section sections[CC__SECTION_COUNT];
+    ccm__Section *table;
+    cc_Index *creaseIDs, edgeCount;
+    cc_Real *creaseSharpness;
+    cc_Mesh *mesh;
+    bool isSuccess;
+
+    if (fread(&header, sizeof(header), 1, stream) != 1
+        || !ccm__IsSectionCountValid(&header)) {
+        CC_LOG("cc: unsupported file");
+
+        return NULL;
+    }
+
+    table = (ccm__Section *)CC_MALLOC(sizeof(ccm__Section) * header.sectionCount);
+    isSuccess = fread(table, sizeof(ccm__Section), header.sectionCount, stream)
+                == (size_t)header.sectionCount
+             && ccm__FindSections(&header, table, sections);
+    CC_FREE(table);
+
+    if (!isSuccess) {
+        CC_LOG("cc: unsupported file");
+
+        return NULL;
+    }
+
+    edgeCount = (cc_Index)sections[CC__SECTION_EDGE_TO_HALFEDGE_IDS].count;
+    mesh = ccm_Create((cc_Index)sections[CC__SECTION_VERTEX_POINTS].count,
+                      (cc_Index)sections[CC__SECTION_UVS].count,
+                      (cc_Index)sections[CC__SECTION_HALFEDGES].count,
+                      edgeCount,
+                      (cc_Index)sections[CC__SECTION_FACE_TO_HALFEDGE_IDS].count);
+    creaseIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * 2 * edgeCount);
+    creaseSharpness = (cc_Real *)CC_MALLOC(sizeof(cc_Real) * edgeCount);
+
+    {
+        void *arrays[CC__SECTION_COUNT] = {
+            mesh->vertexToHalfedgeIDs,
+            mesh->edgeToHalfedgeIDs,
+            mesh->faceToHalfedgeIDs,
+            mesh->vertexPoints,
+            mesh->uvs,
+            creaseIDs,
+            creaseSharpness,
+            mesh->halfedges
+        };
+
+        for (int32_t type = 0; isSuccess && type < CC__SECTION_COUNT; ++type) {
+            isSuccess = ccm__ReadSection(stream, &sections[type], arrays[type]);
+        }
+    }
+
+    if (isSuccess) {
+        ccm__JoinCreases(creaseIDs, creaseSharpness, mesh->creases, edgeCount);
+    }
+
+    CC_FREE(creaseIDs);
+    CC_FREE(creaseSharpness);
+
+    if (!isSuccess) {
+        CC_LOG("cc: data reading failed");
+        ccm_Release(mesh);
+
+        return NULL;
+    }
+
+    return mesh;
+}
+
+CCDEF cc_Mesh *ccm_Load(const char *filename)
+{
+    FILE *stream = fopen(filename, "rb");
+    cc_Mesh *mesh = NULL;
+    int64_t magic;
+
+    if (!stream) {
+        CC_LOG("cc: fopen failed");
+
+        return NULL;
+    }
+
+    if (fread(&magic, sizeof(magic), 1, stream) != 1 || fseek(stream, 0, SEEK_SET) != 0) {
+        CC_LOG("cc: unsupported file");
+    } else if (magic == ccm__Magic()) {
+        mesh = ccm__LoadV1(stream);
+    } else if (magic == ccm__MagicV2()) {
+        mesh = ccm__LoadV2(stream);
+    } else {
+        CC_LOG("cc: unsupported file");
+    }
+
+    fclose(stream);
+
+    return mesh;
+}
+
+
+/*******************************************************************************
+ * LoadMapped -- Loads a mesh by mapping its file in memory
+ *
+ * The file is mapped privately, so that the mesh can be edited without
+ * touching the file. The IDs and halfedges of the file are used in place
+ * unless CC_INDEX64 widens them; the vertex points and uvs are used in place
+ * with CC_SINGLE_PRECISION, and the creases when both the reals and the IDs
+ * are 32-bit. Anything else is converted in parallel into arrays of its own.
+ * Version 2 files follow the same rule per section, based on its scalar type;
+ * their creases are always joined into an array of their own. Only the
+ * section table is checksummed here, so that the pages are only read from
+ * disk when first accessed; ccm_Load verifies every section. The file must
+ * not be truncated while the mesh is alive. Without POSIX mappings, this is
+ * ccm_Load.
+ *
+ */
+#ifdef CC__MAPPED_FILES
+static cc_Index *ccm__MapIDs(const int32_t *ids, cc_Index count)
+{
+#ifdef CC_INDEX64
+    cc_Index *array = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * count);
+
+    ccm__WidenIDs(ids, array, count);
+
+    return array;
+#else
+    (void)count;
+
+    return (cc_Index *)ids;
+#endif
+}
+
+static void ccm__MapData(cc_Mesh *mesh, const char *data)
+{
+    const cc_Index vertexCount = ccm_VertexCount(mesh);
+    const cc_Index uvCount = ccm_UvCount(mesh);
+    const cc_Index halfedgeCount = ccm_HalfedgeCount(mesh);
+    const cc_Index creaseCount = ccm_CreaseCount(mesh);
+    const cc_Index edgeCount = ccm_EdgeCount(mesh);
+    const cc_Index faceCount = ccm_FaceCount(mesh);
+    const cc_Index halfedgeIDCount = halfedgeCount * sizeof(cc_Halfedge) / sizeof(cc_Index);
+    const int32_t *vertexToHalfedgeIDs = (const int32_t *)data;
+    const int32_t *edgeToHalfedgeIDs = vertexToHalfedgeIDs + vertexCount;
+    const int32_t *faceToHalfedgeIDs = edgeToHalfedgeIDs + edgeCount;
+    const cc_VertexPoint_f *vertexPoints =
+        (const cc_VertexPoint_f *)(faceToHalfedgeIDs + faceCount);
+    const cc_VertexUv_f *uvs = (const cc_VertexUv_f *)(vertexPoints + vertexCount);
+    const cc_Crease_f *creases = (const cc_Crease_f *)(uvs + uvCount);
+    const int32_t *halfedgeIDs = (const int32_t *)(creases + creaseCount);
+
+    mesh->vertexToHalfedgeIDs = ccm__MapIDs(vertexToHalfedgeIDs, vertexCount);
+    mesh->edgeToHalfedgeIDs = ccm__MapIDs(edgeToHalfedgeIDs, edgeCount);
+    mesh->faceToHalfedgeIDs = ccm__MapIDs(faceToHalfedgeIDs, faceCount);
+    mesh->halfedges = (cc_Halfedge *)ccm__MapIDs(halfedgeIDs, halfedgeIDCount);
+#ifdef CC_SINGLE_PRECISION
+    mesh->vertexPoints = (cc_VertexPoint *)vertexPoints;
+    mesh->uvs = (cc_VertexUv *)uvs;
+#else
+    mesh->vertexPoints = (cc_VertexPoint *)CC_MALLOC(sizeof(cc_VertexPoint) * vertexCount);
+    mesh->uvs = (cc_VertexUv *)CC_MALLOC(sizeof(cc_VertexUv) * uvCount);
+    ccm__WidenVertexPoints(vertexPoints, mesh->vertexPoints, vertexCount);
+    ccm__WidenUvs(uvs, mesh->uvs, uvCount);
+#endif
+#if defined(CC_SINGLE_PRECISION) && !defined(CC_INDEX64)
+    mesh->creases = (cc_Crease *)creases;
+#else
+    mesh->creases = (cc_Crease *)CC_MALLOC(sizeof(cc_Crease) * creaseCount);
+    ccm__WidenCreases(creases, mesh->creases, creaseCount);
+#endif
+}
+
+static size_t ccm__FileByteCount(const ccm__Header *header)
+{
+    const size_t idCount = (size_t)header->vertexCount
+                         + (size_t)header->edgeCount
+                         + (size_t)header->faceCount
+                         + (size_t)header->halfedgeCount
+                         * (sizeof(cc_Halfedge) / sizeof(cc_Index));
+
+    return sizeof(*header)
+         + sizeof(int32_t) * idCount
+         + sizeof(cc_VertexPoint_f) * (size_t)header->vertexCount
+         + sizeof(cc_VertexUv_f) * (size_t)header->uvCount
+         + sizeof(cc_Crease_f) * (size_t)header->edgeCount;
+}
+
+static cc_Mesh *ccm__MapV1(void *data, size_t byteCount)
+{
+    ccm__Header header;
+    cc_Mesh *mesh;
+
+    if (byteCount < sizeof(header)) {
+        return NULL;
+    }
+
+    CC_MEMCPY(&header, data, sizeof(header));
+
+    if (header.vertexCount < 0 || header.uvCount < 0 || header.halfedgeCount < 0
+        || header.edgeCount < 0 || header.faceCount < 0
+        || ccm__FileByteCount(&header) > byteCount) {
+        return NULL;
+    }
+
+    mesh = (cc_Mesh *)CC_MALLOC(sizeof(*mesh));
+    mesh->vertexCount = header.vertexCount;
+    mesh->uvCount = header.uvCount;
+    mesh->halfedgeCount = header.halfedgeCount;
+    mesh->edgeCount = header.edgeCount;
+    mesh->faceCount = header.faceCount;
+    mesh->mappedData = data;
+    mesh->mappedByteCount = byteCount;
+    ccm__MapData(mesh, (const char *)data + sizeof(header));
+
+    return mesh;
+}
+
+// compressed sections are read as a whole anyway: their checksum is verified
+static void *
+ccm__MapSection(const ccm__Section *section, const char *data, bool *isSuccess)
+{
+    const void *sectionData = data + section->offset;
+    void *array;
+
+    if (ccm__IsNativeSection(section) && section->byteCount > 0) {
+        return (void *)sectionData;
+    }
+
+    array = CC_MALLOC(ccm__SectionArrayByteCount(section));
+
+    if ((section->encoding != CC__ENCODING_RAW
+         && ccm__Checksum(sectionData, (size_t)section->byteCount) != section->checksum)
+        || !ccm__DecodeSection(section, sectionData, array)) {
+        *isSuccess = false;
+    }
+
+    return array;
+}
+
+static cc_Mesh *ccm__MapV2(void *data, size_t byteCount)
+{
+    const char *bytes = (const char *)data;
+    ccm__FileHeader header;
+    ccm__Section sections[CC__SECTION_COUNT];
+    ccm__Section *table;
+    cc_Index *creaseIDs;
+    cc_Real *creaseSharpness;
+    cc_Mesh *mesh;
+    bool isValid;
+
+    if (byteCount < sizeof(header)) {
+        return NULL;
+    }
+
+    CC_MEMCPY(&header, data, sizeof(header));
+
+    if (!ccm__IsSectionCountValid(&header)
+        || sizeof(header) + sizeof(ccm__Section) * header.sectionCount > byteCount) {
+        return NULL;
+    }
+
+    table = (ccm__Section *)CC_MALLOC(sizeof(ccm__Section) * header.sectionCount);
+    CC_MEMCPY(table, bytes + sizeof(header), sizeof(ccm__Section) * header.sectionCount);
+    isValid = ccm__FindSections(&header, table, sections);
+    CC_FREE(table);
+
+    for (int32_t type = 0; isValid && type < CC__SECTION_COUNT; ++type) {
+        const ccm__Section *section = &sections[type];
+
+        isValid = (uint64_t)section->offset <= byteCount
+               && (uint64_t)section->byteCount <= byteCount - (uint64_t)section->offset;
+    }
+
+    if (!isValid) {
+        return NULL;
+    }
+
+    mesh = (cc_Mesh *)CC_MALLOC(sizeof(*mesh));
+    mesh->vertexCount = (cc_Index)sections[CC__SECTION_VERTEX_POINTS].count;
+    mesh->uvCount = (cc_Index)sections[CC__SECTION_UVS].count;
+    mesh->halfedgeCount = (cc_Index)sections[CC__SECTION_HALFEDGES].count;
+    mesh->edgeCount = (cc_Index)sections[CC__SECTION_EDGE_TO_HALFEDGE_IDS].count;
+    mesh->faceCount = (cc_Index)sections[CC__SECTION_FACE_TO_HALFEDGE_IDS].count;
+    mesh->mappedData = data;
+    mesh->mappedByteCount = byteCount;
+    mesh->vertexToHalfedgeIDs = (cc_Index *)
+        ccm__MapSection(&sections[CC__SECTION_VERTEX_TO_HALFEDGE_IDS], bytes, &isValid);
+    mesh->edgeToHalfedgeIDs = (cc_Index *)
+        ccm__MapSection(&sections[CC__SECTION_EDGE_TO_HALFEDGE_IDS], bytes, &isValid);
+    mesh->faceToHalfedgeIDs = (cc_Index *)
+        ccm__MapSection(&sections[CC__SECTION_FACE_TO_HALFEDGE_IDS], bytes, &isValid);
+    mesh->vertexPoints = (cc_VertexPoint *)
+        ccm__MapSection(&sections[CC__SECTION_VERTEX_POINTS], bytes, &isValid);
+    mesh->uvs = (cc_VertexUv *)
+        ccm__MapSection(&sections[CC__SECTION_UVS], bytes, &isValid);
+    mesh->halfedges = (cc_Halfedge *)
+        ccm__MapSection(&sections[CC__SECTION_HALFEDGES], bytes, &isValid);
+    creaseIDs = (cc_Index *)
+        ccm__MapSection(&sections[CC__SECTION_CREASE_IDS], bytes, &isValid);
+    creaseSharpness = (cc_Real *)
+        ccm__MapSection(&sections[CC__SECTION_CREASE_SHARPNESS], bytes, &isValid);
+    mesh->creases = (cc_Crease *)CC_MALLOC(sizeof(cc_Crease) * mesh->edgeCount);
+    ccm__JoinCreases(creaseIDs, creaseSharpness, mesh->creases, mesh->edgeCount);
+    ccm__ReleaseArray(mesh, creaseIDs);
+    ccm__ReleaseArray(mesh, creaseSharpness);
+
+    // a compressed section is corrupt; the caller unmaps the file
+    if (!isValid) {
+        void *arrays[] = {
+            mesh->vertexToHalfedgeIDs,
+            mesh->edgeToHalfedgeIDs,
+            mesh->faceToHalfedgeIDs,
+            mesh->vertexPoints,
+            mesh->uvs,
+            mesh->halfedges,
+            mesh->creases
+        };
+        const int32_t arrayCount = (int32_t)(sizeof(arrays) / sizeof(arrays[0]));
+
+        for (int32_t arrayID = 0; arrayID < arrayCount; ++arrayID) {
+            ccm__ReleaseArray(mesh, arrays[arrayID]);
+        }
+
+        CC_FREE(mesh);
+
+        return NULL;
+    }
+
+    return mesh;
+}
+#endif
+
+CCDEF cc_Mesh *ccm_LoadMapped(const char *filename)
+{
+#ifdef CC__MAPPED_FILES
+    const int fileDescriptor = open(filename, O_RDONLY);
+    struct stat fileStatus;
+    int64_t magic;
+    size_t byteCount;
+    void *data;
+    cc_Mesh *mesh;
+
+    if (fileDescriptor < 0) {
+        CC_LOG("cc: open failed");
+
+        return NULL;
+    }
+
+    if (fstat(fileDescriptor, &fileStatus) != 0
+        || (size_t)fileStatus.st_size < sizeof(magic)) {
+        CC_LOG("cc: unsupported file");
+        close(fileDescriptor);
+
+        return NULL;
+    }
+
+    byteCount = (size_t)fileStatus.st_size;
+    data = mmap(NULL, byteCount, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+    close(fileDescriptor);
+
+    if (data == MAP_FAILED) {
+        CC_LOG("cc: mmap failed");
+
+        return NULL;
+    }
+
+    CC_MEMCPY(&magic, data, sizeof(magic));
+
+    if (magic == ccm__Magic()) {
+        mesh = ccm__MapV1(data, byteCount);
+    } else if (magic == ccm__MagicV2()) {
+        mesh = ccm__MapV2(data, byteCount);
+    } else {
+        mesh = NULL;
+    }
+
+    if (!mesh) {
+        CC_LOG("cc: unsupported file");
+        munmap(data, byteCount);
+    }
+
+    return mesh;
+#else
+    return ccm_Load(filename);
+#endif
+}
+
+
+/*******************************************************************************
+ * Loader -- Loads a mesh in chunks, on multiple threads
+ *
+ * The sections of the file are split into chunks of CC_LOAD_CHUNK_SIZE Bytes
+ * that the threads read independently, with pread on POSIX systems (each
+ * chunk opens a stream of its own otherwise). Each thread converts its chunk as
+ * soon as it is read, while the other threads keep reading, and hashes its
+ * checksum blocks; the block hashes are folded once the section completes.
+ * The topology is loaded first, by ccm_LoadTopology, so that its refinement
+ * can start while ccm_LoadVertexPoints reads the vertex points on another
+ * thread. Compressed sections are read into a buffer of their own, and
+ * decoded block-parallel once their checksum is verified. Version 1 files are
+ * described by sections without checksums, where the creases take the place
+ * of the crease IDs. The progress is updated as chunks complete and can be
+ * polled from any thread.
+ *
+ */
+#ifndef CC_LOAD_CHUNK_SIZE
+#   define CC_LOAD_CHUNK_SIZE ((int64_t)4 << 20)
+#endif
+
+#define CC__SECTION_V1_CREASES 32
+
+struct ccm_Loader {
+    char *filename;
+#ifdef CC__PREAD
+    int fileDescriptor;
+#endif
+    bool isChecksummed;
+    ccm__Section sections[CC__SECTION_COUNT];
+    uint64_t *blockHashes[CC__SECTION_COUNT];
+    char *encodedData[CC__SECTION_COUNT];   // compressed sections being loaded
+    cc_Mesh *mesh;
+    cc_Index *creaseIDs;        // version 2 creases, joined once loaded
+    cc_Real *creaseSharpness;
+    int64_t loadedByteCount;
+    int64_t byteCount;
+    int32_t failureCount;
+};
+
+static bool ccm__IsNativeLoaderSection(const ccm__Section *section)
+{
+#if defined(CC_SINGLE_PRECISION) && !defined(CC_INDEX64)
+    if (section->type == CC__SECTION_V1_CREASES) {
+        return true;
+    }
+#else
+    if (section->type == CC__SECTION_V1_CREASES) {
+        return false;
+    }
+#endif
+
+    return ccm__IsNativeSection(section);
+}
+
+// Bytes per converted unit in the file and in memory
+static int64_t ccm__LoaderUnitByteCount(const ccm__Section *section, bool isInMemory)
+{
+    if (section->type == CC__SECTION_V1_CREASES) {
+        return isInMemory ? sizeof(cc_Crease) : sizeof(cc_Crease_f);
+    } else if (isInMemory) {
+        return ccm__ScalarByteCount(ccm__NativeScalarType(section->type));
+    }
+
+    return ccm__ScalarByteCount(section->scalarType);
+}
+
+static int64_t ccm__LoaderChunkByteCount(const ccm_Loader *loader, const ccm__Section *section)
+{
+    const int64_t unitByteCount = ccm__LoaderUnitByteCount(section, false);
+
+    // chunks hold whole checksum blocks in version 2 files
+    if (loader->isChecksummed) {
+        const int64_t blockCount = CC_LOAD_CHUNK_SIZE / CC__CHECKSUM_BLOCK_SIZE;
+
+        return (blockCount > 0 ? blockCount : 1) * CC__CHECKSUM_BLOCK_SIZE;
+    }
+
+    return CC_LOAD_CHUNK_SIZE > unitByteCount
+         ? CC_LOAD_CHUNK_SIZE / unitByteCount * unitByteCount
+         : unitByteCount;
+}
+
+static int64_t ccm__LoaderChunkCount(const ccm_Loader *loader, const ccm__Section *section)
+{
+    const int64_t chunkByteCount = ccm__LoaderChunkByteCount(loader, section);
+
+    return (section->byteCount + chunkByteCount - 1) / chunkByteCount;
+}
+
+static void *ccm__LoaderArray(const ccm_Loader *loader, int32_t type)
+{
+    const cc_Mesh *mesh = loader->mesh;
+
+    switch (type) {
+    case CC__SECTION_VERTEX_TO_HALFEDGE_IDS: return mesh->vertexToHalfedgeIDs;
+    case CC__SECTION_EDGE_TO_HALFEDGE_IDS: return mesh->edgeToHalfedgeIDs;
+    case CC__SECTION_FACE_TO_HALFEDGE_IDS: return mesh->faceToHalfedgeIDs;
+    case CC__SECTION_VERTEX_POINTS: return mesh->vertexPoints;
+    case CC__SECTION_UVS: return mesh->uvs;
+    case CC__SECTION_CREASE_IDS:
+        return loader->isChecksummed ? (void *)loader->creaseIDs : (void *)mesh->creases;
+    case CC__SECTION_CREASE_SHARPNESS: return loader->creaseSharpness;
+    case CC__SECTION_HALFEDGES: return mesh->halfedges;
+    default: return NULL;
+    }
+}
+
+static bool
+ccm__ReadChunk(
+    const ccm_Loader *loader,
+    void *data,
+    int64_t offset,
+    int64_t byteCount
+) {
+#ifdef CC__PREAD
+    char *bytes = (char *)data;
+
+    while (byteCount > 0) {
+        const ssize_t readByteCount = pread(loader->fileDescriptor,
+                                            bytes,
+                                            (size_t)byteCount,
+                                            (off_t)offset);
+
+        if (readByteCount <= 0) {
+            return false;
+        }
+
+        bytes+= readByteCount;
+        offset+= readByteCount;
+        byteCount-= readByteCount;
+    }
+
+    return true;
+#else
+    FILE *stream = fopen(loader->filename, "rb");
+    bool isSuccess;
+
+    if (!stream) {
+        return false;
+    }
+
+    isSuccess = fseek(stream, (long)offset, SEEK_SET) == 0
+             && fread(data, 1, (size_t)byteCount, stream) == (size_t)byteCount;
+    fclose(stream);
+
+    return isSuccess;
+#endif
+}
+
+static void
+ccm__DecodeChunk(
+    const ccm__Section *section,
+    const void *data,
+    void *array,
+    int64_t unitCount
+) {
+    if (section->type == CC__SECTION_V1_CREASES) {
+#if !defined(CC_SINGLE_PRECISION) || defined(CC_INDEX64)
+        ccm__WidenCreases((const cc_Crease_f *)data, (cc_Crease *)array, (cc_Index)unitCount);
+#endif
+    } else if (ccm__IsRealSection(section->type)) {
+        ccm__DecodeReals(data, section->scalarType, (cc_Real *)array, unitCount);
+    } else {
+        ccm__DecodeIDs(data, section->scalarType, (cc_Index *)array, unitCount);
+    }
+}
+
+static bool ccm__LoadChunk(ccm_Loader *loader, int32_t type, int64_t chunkID)
+{
+    const ccm__Section *section = &loader->sections[type];
+    const int64_t chunkByteCount = ccm__LoaderChunkByteCount(loader, section);
+    const int64_t begin = chunkID * chunkByteCount;
+    const int64_t byteCount = cc__Min64(chunkByteCount, section->byteCount - begin);
+    const int64_t fileUnitByteCount = ccm__LoaderUnitByteCount(section, false);
+    const int64_t unitByteCount = ccm__LoaderUnitByteCount(section, true);
+    const bool isEncoded = section->encoding != CC__ENCODING_RAW;
+    const bool isNative = isEncoded || ccm__IsNativeLoaderSection(section);
+    char *array = isEncoded ? &loader->encodedData[type][begin]
+                : (char *)ccm__LoaderArray(loader, type)
+                  + begin / fileUnitByteCount * unitByteCount;
+    char *data = isNative ? array : (char *)CC_MALLOC((size_t)byteCount);
+    const bool isSuccess = ccm__ReadChunk(loader, data, section->offset + begin, byteCount);
+
+    if (isSuccess && loader->isChecksummed) {
+        uint64_t *blockHashes = loader->blockHashes[type];
+
+        for (int64_t i = 0; i < byteCount; i+= CC__CHECKSUM_BLOCK_SIZE) {
+            const int64_t blockByteCount = cc__Min64(CC__CHECKSUM_BLOCK_SIZE, byteCount - i);
+
+            blockHashes[(begin + i) / CC__CHECKSUM_BLOCK_SIZE] =
+                ccm__ChecksumBlock((const uint8_t *)&data[i], (size_t)blockByteCount);
+        }
+    }
+
+    if (!isNative) {
+        if (isSuccess) {
+            ccm__DecodeChunk(section, data, array, byteCount / fileUnitByteCount);
+        }
+
+        CC_FREE(data);
+    }
+
+    cc__AtomicAddInt64(&loader->loadedByteCount, byteCount);
+
+    return isSuccess;
+}
+
+typedef struct {
+    ccm_Loader *loader;
+    const int32_t *types;
+    const int64_t *chunkCounts;
+    int64_t failureCount;
+} ccm__LoadingTask;
+
+static void ccm__LoadChunks(cc_Index begin, cc_Index end, void *userData)
+{
+    ccm__LoadingTask *task = (ccm__LoadingTask *)userData;
+    int64_t failureCount = 0;
+
+    for (int64_t chunkID = begin; chunkID < end; ++chunkID) {
+        int32_t i = 0;
+
+        while (chunkID >= task->chunkCounts[i + 1]) {
+            ++i;
+        }
+
+        if (!ccm__LoadChunk(task->loader, task->types[i], chunkID - task->chunkCounts[i])) {
+            ++failureCount;
+        }
+    }
+
+    if (failureCount > 0) {
+        cc__AtomicAddInt64(&task->failureCount, failureCount);
+    }
+}
+
+// loads the sections of the given types, all of their chunks in parallel
+static bool ccm__LoadSections(ccm_Loader *loader, const int32_t *types, int32_t typeCount)
+{
+    int64_t chunkCounts[CC__SECTION_COUNT + 1] = {0};
+    ccm__LoadingTask task = {loader, types, chunkCounts, 0};
+    bool isSuccess = true;
+
+    for (int32_t i = 0; i < typeCount; ++i) {
+        const ccm__Section *section = &loader->sections[types[i]];
+
+        chunkCounts[i + 1] = chunkCounts[i] + ccm__LoaderChunkCount(loader, section);
+
+        if (section->encoding != CC__ENCODING_RAW) {
+            loader->encodedData[types[i]] = (char *)CC_MALLOC((size_t)section->byteCount);
+        }
+    }
+
+#ifdef CC__ATOMICS
+    cc_ParallelFor(0, (cc_Index)chunkCounts[typeCount], 1, &ccm__LoadChunks, &task);
+#else
+    ccm__LoadChunks(0, (cc_Index)chunkCounts[typeCount], &task);
+#endif
+
+    for (int32_t i = 0; isSuccess && i < typeCount && loader->isChecksummed; ++i) {
+        const ccm__Section *section = &loader->sections[types[i]];
+
+        isSuccess = ccm__FoldChecksum(loader->blockHashes[types[i]],
+                                      (size_t)section->byteCount)
+                    == section->checksum;
+    }
+
+    for (int32_t i = 0; i < typeCount; ++i) {
+        const ccm__Section *section = &loader->sections[types[i]];
+        char *encodedData = loader->encodedData[types[i]];
+
+        if (encodedData != NULL) {
+            isSuccess = isSuccess && task.failureCount == 0
+                     && ccm__DecodeSection(section,
+                                           encodedData,
+                                           ccm__LoaderArray(loader, types[i]));
+            CC_FREE(encodedData);
+            loader->encodedData[types[i]] = NULL;
+        }
+    }
+
+    return isSuccess && task.failureCount == 0;
+}
+
+static ccm__Section
+ccm__CreateV1Section(int32_t type, int32_t scalarType, int64_t count, int64_t *offset)
+{
+    ccm__Section section;
+
+    section.type = type;
+    section.scalarType = scalarType;
+    section.componentCount = ccm__SectionComponentCount(type);
+    section.encoding = CC__ENCODING_RAW;
+    section.count = count;
+    section.offset = *offset;
+    section.byteCount = type == CC__SECTION_V1_CREASES
+                      ? count * (int64_t)sizeof(cc_Crease_f)
+                      : count * section.componentCount * 4;
+    section.checksum = 0;
+    *offset+= section.byteCount;
+
+    return section;
+}
+
+static bool ccm__ReadV1Sections(ccm_Loader *loader, FILE *stream)
+{
+    ccm__Section *sections = loader->sections;
+    int64_t offset = sizeof(ccm__Header);
+    ccm__Header header;
+
+    if (!ccm__ReadHeader(stream, &header)
+        || header.vertexCount < 0 || header.uvCount < 0 || header.halfedgeCount < 0
+        || header.edgeCount < 0 || header.faceCount < 0) {
+        return false;
+    }
+
+    sections[CC__SECTION_VERTEX_TO_HALFEDGE_IDS] =
+        ccm__CreateV1Section(CC__SECTION_VERTEX_TO_HALFEDGE_IDS,
+                             CC__SCALAR_INT32, header.vertexCount, &offset);
+    sections[CC__SECTION_EDGE_TO_HALFEDGE_IDS] =
+        ccm__CreateV1Section(CC__SECTION_EDGE_TO_HALFEDGE_IDS,
+                             CC__SCALAR_INT32, header.edgeCount, &offset);
+    sections[CC__SECTION_FACE_TO_HALFEDGE_IDS] =
+        ccm__CreateV1Section(CC__SECTION_FACE_TO_HALFEDGE_IDS,
+                             CC__SCALAR_INT32, header.faceCount, &offset);
+    sections[CC__SECTION_VERTEX_POINTS] =
+        ccm__CreateV1Section(CC__SECTION_VERTEX_POINTS,
+                             CC__SCALAR_FLOAT32, header.vertexCount, &offset);
+    sections[CC__SECTION_UVS] =
+        ccm__CreateV1Section(CC__SECTION_UVS,
+                             CC__SCALAR_FLOAT32, header.uvCount, &offset);
+    sections[CC__SECTION_CREASE_IDS] =
+        ccm__CreateV1Section(CC__SECTION_V1_CREASES,
+                             CC__SCALAR_INT32, header.edgeCount, &offset);
+    sections[CC__SECTION_CREASE_SHARPNESS] =
+        ccm__CreateV1Section(CC__SECTION_CREASE_SHARPNESS,
+                             CC__SCALAR_FLOAT32, 0, &offset);
+    sections[CC__SECTION_HALFEDGES] =
+        ccm__CreateV1Section(CC__SECTION_HALFEDGES,
+                             CC__SCALAR_INT32, header.halfedgeCount, &offset);
+
+    return true;
+}
+
+static bool ccm__ReadV2Sections(ccm_Loader *loader, FILE *stream)
+{
+    ccm__FileHeader header;
+    ccm__Section *table;
+    bool isSuccess;
+
+    if (fread(&header, sizeof(header), 1, stream) != 1
+        || header.magic != ccm__MagicV2()
+        || !ccm__IsSectionCountValid(&header)) {
+        return false;
+    }
+
+    table = (ccm__Section *)CC_MALLOC(sizeof(ccm__Section) * header.sectionCount);
+    isSuccess = fread(table, sizeof(ccm__Section), header.sectionCount, stream)
+                == (size_t)header.sectionCount
+             && ccm__FindSections(&header, table, loader->sections);
+    CC_FREE(table);
+
+    return isSuccess;
+}
+
+CCDEF ccm_Loader *ccm_CreateLoader(const char *filename)
+{
+    FILE *stream = fopen(filename, "rb");
+    const int filenameLength = snprintf(NULL, 0, "%s", filename);
+    ccm_Loader *loader;
+    int64_t magic;
+    bool isSuccess;
+
+    if (!stream) {
+        CC_LOG("cc: fopen failed");
+
+        return NULL;
+    }
+
+    loader = (ccm_Loader *)CC_MALLOC(sizeof(*loader));
+    isSuccess = fread(&magic, sizeof(magic), 1, stream) == 1
+             && fseek(stream, 0, SEEK_SET) == 0;
+    loader->isChecksummed = isSuccess && magic == ccm__MagicV2();
+    isSuccess = isSuccess && (loader->isChecksummed ? ccm__ReadV2Sections(loader, stream)
+                                                    : ccm__ReadV1Sections(loader, stream));
+    fclose(stream);
+
+    if (!isSuccess) {
+        CC_LOG("cc: unsupported file");
+        CC_FREE(loader);
 
-        for (backwardIterator = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
-             backwardIterator = ccs_HalfedgeTwinID(subd, backwardIterator, depth)) {
-            const int32_t nextID = ccs_HalfedgeNextID(subd, backwardIterator, depth);
-            const double nextS = ccs_HalfedgeSharpness(subd, nextID, depth);
-            const double nextCreaseWeight = cc__Signf(nextS);
+        return NULL;
+    }
 
-            // valence computation
-            ++valence;
+    loader->filename = (char *)CC_MALLOC(filenameLength + 1);
+    CC_MEMCPY(loader->filename, filename, filenameLength + 1);
+#ifdef CC__PREAD
+    loader->fileDescriptor = open(filename, O_RDONLY);
+#endif
+    loader->mesh = NULL;
+    loader->creaseIDs = NULL;
+    loader->creaseSharpness = NULL;
+    loader->loadedByteCount = 0;
+    loader->byteCount = 0;
+
+    for (int32_t type = 0; type < CC__SECTION_COUNT; ++type) {
+        const ccm__Section *section = &loader->sections[type];
+
+        loader->byteCount+= section->byteCount;
+        loader->encodedData[type] = NULL;
+        loader->blockHashes[type] = loader->isChecksummed
+            ? (uint64_t *)CC_MALLOC(sizeof(uint64_t)
+                                    * (ccm__ChecksumBlockCount((size_t)section->byteCount) + 1))
+            : NULL;
+    }
 
-            // crease computation
-            avgS+= nextS;
-            creaseCount+= nextCreaseWeight;
+    return loader;
+}
 
-            // next vertex halfedge
-            backwardIterator = nextID;
+CCDEF void ccm_ReleaseLoader(ccm_Loader *loader)
+{
+#ifdef CC__PREAD
+    if (loader->fileDescriptor >= 0) {
+        close(loader->fileDescriptor);
+    }
+#endif
+
+    for (int32_t type = 0; type < CC__SECTION_COUNT; ++type) {
+        if (loader->blockHashes[type] != NULL) {
+            CC_FREE(loader->blockHashes[type]);
         }
+    }
 
-        // corner point
-        cc__Mul3f(cornerPoint.array, oldPoint.array, 1.0f / valence);
+    if (loader->creaseIDs != NULL) {
+        CC_FREE(loader->creaseIDs);
+        CC_FREE(loader->creaseSharpness);
+    }
 
-        // crease computation: V / 4
-        cc__Mul3f(tmp1, oldPoint.array, 0.25f * creaseWeight);
-        cc__Mul3f(tmp2, newEdgePoint.array, 0.25f * creaseWeight);
-        cc__Add3f(creasePoint.array, tmp1, tmp2);
+    CC_FREE(loader->filename);
+    CC_FREE(loader);
+}
 
-        // smooth computation: (4E - F + (n - 3) V) / N
-        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
-        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
-        cc__Mul3f(tmp1, oldPoint.array, valence - 3.0f);
-        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-        cc__Mul3f(smoothPoint.array,
-                  smoothPoint.array,
-                  1.0f / (valence * valence));
+CCDEF cc_Mesh *ccm_LoadTopology(ccm_Loader *loader)
+{
+    const int32_t types[] = {
+        CC__SECTION_HALFEDGES,
+        CC__SECTION_CREASE_IDS,
+        CC__SECTION_CREASE_SHARPNESS,
+        CC__SECTION_UVS,
+        CC__SECTION_VERTEX_TO_HALFEDGE_IDS,
+        CC__SECTION_EDGE_TO_HALFEDGE_IDS,
+        CC__SECTION_FACE_TO_HALFEDGE_IDS
+    };
+    const ccm__Section *sections = loader->sections;
+    const cc_Index edgeCount = (cc_Index)sections[CC__SECTION_EDGE_TO_HALFEDGE_IDS].count;
+    cc_Mesh *mesh;
 
-        // boundary corrections
-        if (forwardIterator < 0) {
-            creaseCount+= creaseWeight;
-            ++valence;
+    CC_ASSERT(loader->mesh == NULL);
+#ifdef CC__PREAD
+    if (loader->fileDescriptor < 0) {
+        CC_LOG("cc: open failed");
 
-            cc__Mul3f(tmp1, oldPoint.array, 0.25f * prevCreaseWeight);
-            cc__Mul3f(tmp2, newPrevEdgePoint.array, 0.25f * prevCreaseWeight);
-            cc__Add3f(tmp1, tmp1, tmp2);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-        }
+        return NULL;
+    }
+#endif
 
-        // atomicWeight (TODO: make branchless ?)
-        if (creaseCount >= 3.0f || valence == 2.0f) {
-            atomicWeight = cornerPoint;
-        } else if (creaseCount <= 1.0f) {
-            atomicWeight = smoothPoint;
-        } else {
-            cc__Lerp3f(atomicWeight.array,
-                       cornerPoint.array,
-                       creasePoint.array,
-                       cc__Satf(avgS * 0.5f));
-        }
+    mesh = ccm_Create((cc_Index)sections[CC__SECTION_VERTEX_TO_HALFEDGE_IDS].count,
+                      (cc_Index)sections[CC__SECTION_UVS].count,
+                      (cc_Index)sections[CC__SECTION_HALFEDGES].count,
+                      edgeCount,
+                      (cc_Index)sections[CC__SECTION_FACE_TO_HALFEDGE_IDS].count);
+    loader->mesh = mesh;
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newVertexPoints[vertexID].array[i]+= atomicWeight.array[i];
-        }
+    if (loader->isChecksummed) {
+        loader->creaseIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * 2 * edgeCount);
+        loader->creaseSharpness = (cc_Real *)CC_MALLOC(sizeof(cc_Real) * edgeCount);
     }
-CC_BARRIER
-}
 
+    if (!ccm__LoadSections(loader, types, (int32_t)(sizeof(types) / sizeof(types[0])))) {
+        CC_LOG("cc: data reading failed");
+        ccm_Release(mesh);
+        loader->mesh = NULL;
 
+        return NULL;
+    }
 
-/*******************************************************************************
- * RefineVertexPoints -- Computes the result of Catmull Clark subdivision.
- *
- */
-static void ccs__ClearVertexPoints(cc_Subd *subd)
-{
-    const int32_t vertexCount = ccs_CumulativeVertexCount(subd);
-    const int32_t vertexByteCount = vertexCount * sizeof(cc_VertexPoint);
+    if (loader->isChecksummed) {
+        ccm__JoinCreases(loader->creaseIDs, loader->creaseSharpness, mesh->creases, edgeCount);
+    }
 
-    CC_MEMSET(subd->vertexPoints, 0, vertexByteCount);
+    return mesh;
 }
 
-CCDEF void ccs_RefineVertexPoints_Scatter(cc_Subd *subd)
+CCDEF bool ccm_LoadVertexPoints(ccm_Loader *loader)
 {
-    ccs__ClearVertexPoints(subd);
-    ccs__CageFacePoints_Scatter(subd);
-    ccs__CreasedCageEdgePoints_Scatter(subd);
-    ccs__CreasedCageVertexPoints_Scatter(subd);
+    const int32_t type = CC__SECTION_VERTEX_POINTS;
+
+    CC_ASSERT(loader->mesh != NULL);
+
+    if (!ccm__LoadSections(loader, &type, 1)) {
+        CC_LOG("cc: data reading failed");
 
-    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
-        ccs__FacePoints_Scatter(subd, depth);
-        ccs__CreasedEdgePoints_Scatter(subd, depth);
-        ccs__CreasedVertexPoints_Scatter(subd, depth);
+        return false;
     }
+
+    return true;
 }
 
-CCDEF void ccs_RefineVertexPoints_NoCreases_Scatter(cc_Subd *subd)
+CCDEF double ccm_LoaderProgress(const ccm_Loader *loader)
 {
-    ccs__ClearVertexPoints(subd);
-    ccs__CageFacePoints_Scatter(subd);
-    ccs__CageEdgePoints_Scatter(subd);
-    ccs__CageVertexPoints_Scatter(subd);
-
-    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
-        ccs__FacePoints_Scatter(subd, depth);
-        ccs__EdgePoints_Scatter(subd, depth);
-        ccs__VertexPoints_Scatter(subd, depth);
-    }
+    return loader->byteCount > 0
+         ? (double)loader->loadedByteCount / (double)loader->byteCount
+         : 1.0;
 }
 
-CCDEF void ccs_RefineVertexPoints_Gather(cc_Subd *subd)
+CCDEF cc_Mesh *ccm_LoadParallel(const char *filename)
 {
-    ccs__CageFacePoints_Gather(subd);
-    ccs__CreasedCageEdgePoints_Gather(subd);
-    ccs__CreasedCageVertexPoints_Gather(subd);
+    ccm_Loader *loader = ccm_CreateLoader(filename);
+    cc_Mesh *mesh;
 
-    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
-        ccs__FacePoints_Gather(subd, depth);
-        ccs__CreasedEdgePoints_Gather(subd, depth);
-        ccs__CreasedVertexPoints_Gather(subd, depth);
+    if (!loader) {
+        return NULL;
     }
-}
 
-CCDEF void ccs_RefineVertexPoints_NoCreases_Gather(cc_Subd *subd)
-{
-    ccs__CageFacePoints_Gather(subd);
-    ccs__CageEdgePoints_Gather(subd);
-    ccs__CageVertexPoints_Gather(subd);
+    mesh = ccm_LoadTopology(loader);
 
-    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
-        ccs__FacePoints_Gather(subd, depth);
-        ccs__EdgePoints_Gather(subd, depth);
-        ccs__VertexPoints_Gather(subd, depth);
+    if (mesh != NULL && !ccm_LoadVertexPoints(loader)) {
+        ccm_Release(mesh);
+        mesh = NULL;
     }
-}
 
+    ccm_ReleaseLoader(loader);
+
+    return mesh;
+}
 
 /*******************************************************************************
- * RefineCageHalfedges -- Applies halfedge refinement rules on the cage mesh
+ * Save -- Save a mesh to a file
  *
- * This routine computes the halfedges of the control cage after one subdivision
- * step and stores them in the subd.
+ * ccm_Save writes a version 2 file in the precision of the library, and
+ * ccm_Save_V1 a version 1 file, which narrows the reals to floats and fails
+ * if the mesh does not fit 32-bit IDs. ccm_SaveCompressed writes a version 2
+ * file with compressed sections (see Encoding).
  *
  */
-static void ccs__RefineCageHalfedges(cc_Subd *subd)
-{
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t edgeCount = ccm_EdgeCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    cc_Halfedge_SemiRegular *halfedgesOut = subd->halfedges;
+static bool
+ccm__SaveV2(
+    const cc_Mesh *mesh,
+    const char *filename,
+    bool isCompressed,
+    double vertexPointTolerance
+) {
+    const cc_Index edgeCount = ccm_EdgeCount(mesh);
+    cc_Index *creaseIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * 2 * edgeCount);
+    cc_Real *creaseSharpness = (cc_Real *)CC_MALLOC(sizeof(cc_Real) * edgeCount);
+    const void *arrays[CC__SECTION_COUNT] = {
+        mesh->vertexToHalfedgeIDs,
+        mesh->edgeToHalfedgeIDs,
+        mesh->faceToHalfedgeIDs,
+        mesh->vertexPoints,
+        mesh->uvs,
+        creaseIDs,
+        creaseSharpness,
+        mesh->halfedges
+    };
+    void *encodedArrays[CC__SECTION_COUNT] = {NULL};
+    const cc_Index counts[CC__SECTION_COUNT] = {
+        ccm_VertexCount(mesh),
+        edgeCount,
+        ccm_FaceCount(mesh),
+        ccm_VertexCount(mesh),
+        ccm_UvCount(mesh),
+        edgeCount,
+        edgeCount,
+        ccm_HalfedgeCount(mesh)
+    };
+    ccm__Section sections[CC__SECTION_COUNT];
+    FILE *stream = fopen(filename, "wb");
+    bool isSuccess;
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
-        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
-        const int32_t prevTwinID = ccm_HalfedgeTwinID(cage, prevID);
-        const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
-        const int32_t twinNextID =
-            twinID >= 0 ? ccm_HalfedgeNextID(cage, twinID) : -1;
-        cc_Halfedge_SemiRegular *newHalfedges[4] = {
-            &halfedgesOut[(4 * halfedgeID + 0)],
-            &halfedgesOut[(4 * halfedgeID + 1)],
-            &halfedgesOut[(4 * halfedgeID + 2)],
-            &halfedgesOut[(4 * halfedgeID + 3)]
-        };
+    if (!stream) {
+        CC_LOG("cc: fopen failed");
+        CC_FREE(creaseIDs);
+        CC_FREE(creaseSharpness);
+
+        return false;
+    }
 
-        // twinIDs
-        newHalfedges[0]->twinID = 4 * twinNextID + 3;
-        newHalfedges[1]->twinID = 4 * nextID     + 2;
-        newHalfedges[2]->twinID = 4 * prevID     + 1;
-        newHalfedges[3]->twinID = 4 * prevTwinID + 0;
+    for (int32_t type = 0; type < CC__SECTION_COUNT; ++type) {
+        sections[type] = ccm__CreateSection(type, counts[type]);
+    }
+
+    ccm__SplitCreases(mesh->creases, creaseIDs, creaseSharpness, edgeCount);
 
-        // edgeIDs
-        newHalfedges[0]->edgeID = 2 * edgeID + (halfedgeID > twinID ? 0 : 1);
-        newHalfedges[1]->edgeID = 2 * edgeCount + halfedgeID;
-        newHalfedges[2]->edgeID = 2 * edgeCount + prevID;
-        newHalfedges[3]->edgeID = 2 * prevEdgeID + (prevID > prevTwinID ? 1 : 0);
+    for (int32_t type = 0; isCompressed && type < CC__SECTION_COUNT; ++type) {
+        const double tolerance = type == CC__SECTION_VERTEX_POINTS ? vertexPointTolerance
+                                                                   : 0.0;
 
-        // vertexIDs
-        newHalfedges[0]->vertexID = vertexID;
-        newHalfedges[1]->vertexID = vertexCount + faceCount + edgeID;
-        newHalfedges[2]->vertexID = vertexCount + faceID;
-        newHalfedges[3]->vertexID = vertexCount + faceCount + prevEdgeID;
+        encodedArrays[type] = ccm__EncodeSection(&sections[type], arrays[type], tolerance);
 
+        if (encodedArrays[type] != NULL) {
+            arrays[type] = encodedArrays[type];
+        }
     }
-CC_BARRIER
-}
 
+    isSuccess = ccm__WriteSections(stream,
+                                   ccm__MagicV2(),
+                                   sections,
+                                   arrays,
+                                   CC__SECTION_COUNT);
 
-/*******************************************************************************
- * RefineHalfedges -- Applies halfedge refinement on the subd
- *
- * This routine computes the halfedges of the next subd level.
- *
- */
-static void ccs__RefineHalfedges(cc_Subd *subd, int32_t depth)
-{
-    const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(cage, depth);
-    cc_Halfedge_SemiRegular *halfedgesOut = &subd->halfedges[stride];
+    for (int32_t type = 0; type < CC__SECTION_COUNT; ++type) {
+        if (encodedArrays[type] != NULL) {
+            CC_FREE(encodedArrays[type]);
+        }
+    }
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-        const int32_t prevID = ccm_HalfedgePrevID_Quad(halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID_Quad(halfedgeID);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
-        const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
-        const int32_t prevTwinID = ccs_HalfedgeTwinID(subd, prevID, depth);
-        const int32_t twinNextID = ccm_HalfedgeNextID_Quad(twinID);
-        cc_Halfedge_SemiRegular *newHalfedges[4] = {
-            &halfedgesOut[(4 * halfedgeID + 0)],
-            &halfedgesOut[(4 * halfedgeID + 1)],
-            &halfedgesOut[(4 * halfedgeID + 2)],
-            &halfedgesOut[(4 * halfedgeID + 3)]
-        };
+    CC_FREE(creaseIDs);
+    CC_FREE(creaseSharpness);
+    fclose(stream);
 
-        // twinIDs
-        newHalfedges[0]->twinID = 4 * twinNextID + 3;
-        newHalfedges[1]->twinID = 4 * nextID     + 2;
-        newHalfedges[2]->twinID = 4 * prevID     + 1;
-        newHalfedges[3]->twinID = 4 * prevTwinID + 0;
+    if (!isSuccess) {
+        CC_LOG("cc: data dump failed");
+    }
 
-        // edgeIDs
-        newHalfedges[0]->edgeID = 2 * edgeID + (halfedgeID > twinID ? 0 : 1);
-        newHalfedges[1]->edgeID = 2 * edgeCount + halfedgeID;
-        newHalfedges[2]->edgeID = 2 * edgeCount + prevID;
-        newHalfedges[3]->edgeID = 2 * prevEdgeID + (prevID > prevTwinID ? 1 : 0);
+    return isSuccess;
+}
 
-        // vertexIDs
-        newHalfedges[0]->vertexID = vertexID;
-        newHalfedges[1]->vertexID = vertexCount + faceCount + edgeID;
-        newHalfedges[2]->vertexID = vertexCount + faceID;
-        newHalfedges[3]->vertexID = vertexCount + faceCount + prevEdgeID;
-    }
-CC_BARRIER
+CCDEF bool ccm_Save(const cc_Mesh *mesh, const char *filename)
+{
+    return ccm__SaveV2(mesh, filename, false, 0.0);
 }
 
+CCDEF bool
+ccm_SaveCompressed(
+    const cc_Mesh *mesh,
+    const char *filename,
+    double vertexPointTolerance
+) {
+    return ccm__SaveV2(mesh, filename, true, vertexPointTolerance);
+}
 
-/*******************************************************************************
- * RefineHalfedges
- *
- */
-CCDEF void ccs_RefineHalfedges(cc_Subd *subd)
+CCDEF bool ccm_Save_V1(const cc_Mesh *mesh, const char *filename)
 {
-    const int32_t maxDepth = ccs_MaxDepth(subd);
+    const cc_Index vertexCount = ccm_VertexCount(mesh);
+    const cc_Index uvCount = ccm_UvCount(mesh);
+    const cc_Index halfedgeCount = ccm_HalfedgeCount(mesh);
+    const cc_Index creaseCount = ccm_CreaseCount(mesh);
+    const cc_Index edgeCount = ccm_EdgeCount(mesh);
+    const cc_Index faceCount = ccm_FaceCount(mesh);
+    const cc_Index halfedgeIDCount = halfedgeCount * sizeof(cc_Halfedge) / sizeof(cc_Index);
+    const ccm__Header header = ccm__CreateHeader(mesh);
+    FILE *stream;
 
-    ccs__RefineCageHalfedges(subd);
+    if (!ccm__IsHeaderCompatible(mesh)) {
+        CC_LOG("cc: mesh too large for the file format");
 
-    for (int32_t depth = 1; depth < maxDepth; ++depth) {
-        ccs__RefineHalfedges(subd, depth);
+        return false;
     }
-}
 
+    stream = fopen(filename, "wb");
 
-#ifndef CC_DISABLE_UV
-/*******************************************************************************
- * RefineCageVertexUvs -- Refines UVs of the cage mesh
- *
- * This routine computes the UVs of the control cage after one subdivision
- * step and stores them in the subd. Note that since UVs are not linked to
- * the topology of the mesh, we store the results of the UV computation
- * within the halfedge buffer.
- *
- */
-static void ccs__RefineCageVertexUvs(cc_Subd *subd)
-{
-    const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    cc_Halfedge_SemiRegular *halfedgesOut = subd->halfedges;
+    if (!stream) {
+        CC_LOG("cc: fopen failed");
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const cc_VertexUv uv = ccm_HalfedgeVertexUv(cage, halfedgeID);
-        const cc_VertexUv nextUv = ccm_HalfedgeVertexUv(cage, nextID);
-        const cc_VertexUv prevUv = ccm_HalfedgeVertexUv(cage, prevID);
-        cc_VertexUv edgeUv, prevEdgeUv;
-        cc_VertexUv faceUv = uv;
-        int32_t m = 1;
-        cc_Halfedge_SemiRegular *newHalfedges[4] = {
-            &halfedgesOut[(4 * halfedgeID + 0)],
-            &halfedgesOut[(4 * halfedgeID + 1)],
-            &halfedgesOut[(4 * halfedgeID + 2)],
-            &halfedgesOut[(4 * halfedgeID + 3)]
-        };
+        return false;
+    }
 
-        cc__Lerp2f(edgeUv.array    , uv.array, nextUv.array, 0.5f);
-        cc__Lerp2f(prevEdgeUv.array, uv.array, prevUv.array, 0.5f);
+    if (fwrite(&header, sizeof(header), 1, stream) != 1) {
+        CC_LOG("cc: header dump failed");
+        fclose(stream);
 
-        for (int32_t halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
-                     halfedgeIt != halfedgeID;
-                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
-            const cc_VertexUv uv = ccm_HalfedgeVertexUv(cage, halfedgeIt);
+        return false;
+    }
 
-            faceUv.u+= uv.array[0];
-            faceUv.v+= uv.array[1];
-            ++m;
-        }
-        faceUv.u/= (double)m;
-        faceUv.v/= (double)m;
+    if (
+        !ccm__WriteIDs(mesh->vertexToHalfedgeIDs, vertexCount, stream)
+    ||  !ccm__WriteIDs(mesh->edgeToHalfedgeIDs, edgeCount, stream)
+    ||  !ccm__WriteIDs(mesh->faceToHalfedgeIDs, faceCount, stream)
+    ||  !ccm__WriteReals((const cc_Real *)mesh->vertexPoints, 3 * vertexCount, stream)
+    ||  !ccm__WriteReals((const cc_Real *)mesh->uvs, 2 * uvCount, stream)
+    ||  !ccm__WriteCreases(mesh->creases, creaseCount, stream)
+    ||  !ccm__WriteIDs((const cc_Index *)mesh->halfedges, halfedgeIDCount, stream)
+    ) {
+        CC_LOG("cc: data dump failed");
+        fclose(stream);
 
-        newHalfedges[0]->uvID = cc__EncodeUv(uv);
-        newHalfedges[1]->uvID = cc__EncodeUv(edgeUv);
-        newHalfedges[2]->uvID = cc__EncodeUv(faceUv);
-        newHalfedges[3]->uvID = cc__EncodeUv(prevEdgeUv);
+        return false;
     }
-CC_BARRIER
+
+    fclose(stream);
+
+    return true;
 }
 
 
 /*******************************************************************************
- * RefineVertexUvs -- Applies UV refinement on the subd
+ * SubdFile -- Layout of the subd cache files
  *
- * This routine computes the UVs of the next subd level.
+ * A subd file follows the version 2 container (see Container) with its own
+ * magic identifier. An info section holds the maximum depth, the creation
+ * flags, the fingerprints of the topology and of the vertex points of the
+ * cage, and the byte counts of cc_Real and cc_Index, since the arrays are
+ * stored as the build that wrote them lays them out; the other sections store the arrays of the subd at all depths,
+ * including the optional tables of its flags. The sparse crease index is
+ * rebuilt from the cage, whose creases the topology fingerprint covers.
  *
  */
-static void ccs__RefineVertexUvs(cc_Subd *subd, int32_t depth)
+enum {
+    CC__SUBD_INFO_MAX_DEPTH,
+    CC__SUBD_INFO_FLAGS,
+    CC__SUBD_INFO_TOPOLOGY_FINGERPRINT,
+    CC__SUBD_INFO_POINTS_FINGERPRINT,
+    CC__SUBD_INFO_REAL_BYTE_COUNT,
+    CC__SUBD_INFO_INDEX_BYTE_COUNT,
+    CC__SUBD_INFO_COUNT
+};
+
+#define CC__MAX_SUBD_ARRAY_COUNT 16
+
+typedef struct {
+    int32_t type;
+    cc_Index count;
+    void *array;
+} ccs__FileArray;
+
+static int64_t ccs__Magic()
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(cage, depth);
-    cc_Halfedge_SemiRegular *halfedgesOut = &subd->halfedges[stride];
+    const union {
+        char    string[8];
+        int64_t numeric;
+    } magic = {{'c', 'c', '_', 'S', 'u', 'b', 'd', '1'}};
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t prevID = ccm_HalfedgePrevID_Quad(halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
-        const cc_VertexUv uv = ccs_HalfedgeVertexUv(subd, halfedgeID, depth);
-        const cc_VertexUv nextUv = ccs_HalfedgeVertexUv(subd, nextID, depth);
-        const cc_VertexUv prevUv = ccs_HalfedgeVertexUv(subd, prevID, depth);
-        cc_VertexUv edgeUv, prevEdgeUv;
-        cc_VertexUv faceUv = uv;
-        cc_Halfedge_SemiRegular *newHalfedges[4] = {
-            &halfedgesOut[(4 * halfedgeID + 0)],
-            &halfedgesOut[(4 * halfedgeID + 1)],
-            &halfedgesOut[(4 * halfedgeID + 2)],
-            &halfedgesOut[(4 * halfedgeID + 3)]
-        };
+    return magic.numeric;
+}
 
-        cc__Lerp2f(edgeUv.array    , uv.array, nextUv.array, 0.5f);
-        cc__Lerp2f(prevEdgeUv.array, uv.array, prevUv.array, 0.5f);
+static uint64_t ccs__PointsFingerprint(const cc_Mesh *cage)
+{
+    return cc__HashWords(0xCBF29CE484222325ULL,
+                         cage->vertexPoints,
+                         sizeof(cc_VertexPoint) * ccm_VertexCount(cage));
+}
 
-        for (int32_t halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeID, depth);
-                     halfedgeIt != halfedgeID;
-                     halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeIt, depth)) {
-            const cc_VertexUv uv = ccs_HalfedgeVertexUv(subd, halfedgeIt, depth);
+static ccs__FileArray ccs__CreateFileArray(int32_t type, cc_Index count, void *array)
+{
+    ccs__FileArray fileArray;
 
-            faceUv.u+= uv.array[0];
-            faceUv.v+= uv.array[1];
-        }
-        faceUv.u/= 4.0f;
-        faceUv.v/= 4.0f;
+    fileArray.type = type;
+    fileArray.count = count;
+    fileArray.array = array;
 
-        newHalfedges[0]->uvID = ccs__HalfedgeVertexUvID(subd, halfedgeID, depth);
-        newHalfedges[1]->uvID = cc__EncodeUv(edgeUv);
-        newHalfedges[2]->uvID = cc__EncodeUv(faceUv);
-        newHalfedges[3]->uvID = cc__EncodeUv(prevEdgeUv);
-    }
-CC_BARRIER
+    return fileArray;
 }
 
-
-/*******************************************************************************
- * RefineUvs
- *
- */
-CCDEF void ccs_RefineVertexUvs(cc_Subd *subd)
+// lists the arrays of a subd, except for its creases
+static int32_t ccs__FileArrays(const cc_Subd *subd, ccs__FileArray *arrays)
 {
-    if (ccm_UvCount(subd->cage) > 0) {
-        const int32_t maxDepth = ccs_MaxDepth(subd);
+    const cc_Mesh *cage = subd->cage;
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+    const uint32_t flags = subd->flags;
+    const cc_Index halfedgeCount = ccs__LevelStorageCount(cage,
+                                                         maxDepth,
+                                                         flags,
+                                                         &ccm_HalfedgeCountAtDepth,
+                                                         &ccs_CumulativeHalfedgeCountAtDepth);
+    const cc_Index vertexCount = ccs__LevelStorageCount(cage,
+                                                       maxDepth,
+                                                       flags,
+                                                       &ccm_VertexCountAtDepth,
+                                                       &ccs_CumulativeVertexCountAtDepth);
+    const cc_Index boundaryHalfedgeCount =
+        ccs__BoundaryHalfedgeStride(subd->boundaryHalfedgeCount, maxDepth + 1);
+    int32_t arrayCount = 0;
+
+    arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_HALFEDGES,
+                                                halfedgeCount,
+                                                subd->halfedges);
+    arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_VERTEX_POINTS,
+                                                vertexCount,
+                                                subd->vertexPoints);
+    arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_BOUNDARY_HALFEDGE_IDS,
+                                                boundaryHalfedgeCount,
+                                                subd->boundaryHalfedgeIDs);
+    arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_MAX_CREASE_SHARPNESS,
+                                                maxDepth + 1,
+                                                subd->maxCreaseSharpness);
+    arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_MIN_BOUNDARY_SHARPNESS,
+                                                maxDepth + 1,
+                                                subd->minBoundarySharpness);
+
+    if (subd->vertexToHalfedgeIDs != NULL) {
+        const cc_Index edgeCount = ccs__LevelStorageCount(cage,
+                                                          maxDepth,
+                                                          flags,
+                                                          &ccm_EdgeCountAtDepth,
+                                                          &ccs_CumulativeEdgeCountAtDepth);
+
+        arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_VERTEX_TO_HALFEDGE_IDS,
+                                                    vertexCount,
+                                                    subd->vertexToHalfedgeIDs);
+        arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_EDGE_TO_HALFEDGE_IDS,
+                                                    edgeCount,
+                                                    subd->edgeToHalfedgeIDs);
+    }
 
-        ccs__RefineCageVertexUvs(subd);
+    if (subd->vertexValences != NULL) {
+        arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_CAGE_RING_OFFSETS,
+                                                    ccm_VertexCount(cage) + 1,
+                                                    subd->cageRingOffsets);
+        arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_CAGE_RING_HALFEDGE_IDS,
+                                                    ccm_HalfedgeCount(cage),
+                                                    subd->cageRingHalfedgeIDs);
+        arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_VERTEX_VALENCES,
+                                                    vertexCount,
+                                                    subd->vertexValences);
+    }
 
-        for (int32_t depth = 1; depth < maxDepth; ++depth) {
-            ccs__RefineVertexUvs(subd, depth);
-        }
+    if (subd->vertexClassIDs != NULL) {
+        arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_VERTEX_CLASS_IDS,
+                                                    vertexCount,
+                                                    subd->vertexClassIDs);
+        arrays[arrayCount++] = ccs__CreateFileArray(CC__SECTION_SUBD_REGULAR_VERTEX_COUNTS,
+                                                    maxDepth + 1,
+                                                    subd->regularVertexCounts);
+    }
+
+    return arrayCount;
+}
+
+static void ccs__SetFileArray(cc_Subd *subd, int32_t type, void *array)
+{
+    switch (type) {
+    case CC__SECTION_SUBD_HALFEDGES:
+        subd->halfedges = (cc_Halfedge_SemiRegular *)array; break;
+    case CC__SECTION_SUBD_VERTEX_POINTS:
+        subd->vertexPoints = (cc_VertexPoint *)array; break;
+    case CC__SECTION_SUBD_BOUNDARY_HALFEDGE_IDS:
+        subd->boundaryHalfedgeIDs = (cc_Index *)array; break;
+    case CC__SECTION_SUBD_MAX_CREASE_SHARPNESS:
+        subd->maxCreaseSharpness = (cc_Real *)array; break;
+    case CC__SECTION_SUBD_MIN_BOUNDARY_SHARPNESS:
+        subd->minBoundarySharpness = (cc_Real *)array; break;
+    case CC__SECTION_SUBD_VERTEX_TO_HALFEDGE_IDS:
+        subd->vertexToHalfedgeIDs = (cc_Index *)array; break;
+    case CC__SECTION_SUBD_EDGE_TO_HALFEDGE_IDS:
+        subd->edgeToHalfedgeIDs = (cc_Index *)array; break;
+    case CC__SECTION_SUBD_CAGE_RING_OFFSETS:
+        subd->cageRingOffsets = (cc_Index *)array; break;
+    case CC__SECTION_SUBD_CAGE_RING_HALFEDGE_IDS:
+        subd->cageRingHalfedgeIDs = (cc_Index *)array; break;
+    case CC__SECTION_SUBD_VERTEX_VALENCES:
+        subd->vertexValences = (int32_t *)array; break;
+    case CC__SECTION_SUBD_VERTEX_CLASS_IDS:
+        subd->vertexClassIDs = (cc_Index *)array; break;
+    case CC__SECTION_SUBD_REGULAR_VERTEX_COUNTS:
+        subd->regularVertexCounts = (cc_Index *)array; break;
     }
 }
-#endif
 
 
 /*******************************************************************************
- * RefineCageCreases -- Applies crease subdivision on the cage mesh
+ * SaveSubd -- Saves a refined subd to a file
  *
- * This routine computes the creases of the control cage after one subdivision
- * step and stores them in the subd.
+ * The topology of the subd must be refined. The file is written next to its
+ * destination and then renamed, so that concurrent readers never see a
+ * partial file. The points fingerprint is that of the current cage points.
  *
  */
-static void ccs__RefineCageCreases(cc_Subd *subd)
+static bool ccs__WriteFile(const cc_Subd *subd, FILE *stream)
+{
+    const cc_Index creaseCount = ccs__CreaseStorageCount(subd);
+    cc_Index *creaseIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * 2 * creaseCount);
+    cc_Real *creaseSharpness = (cc_Real *)CC_MALLOC(sizeof(cc_Real) * creaseCount);
+    const int64_t info[CC__SUBD_INFO_COUNT] = {
+        ccs_MaxDepth(subd),
+        subd->flags,
+        (int64_t)subd->topologyFingerprint,
+        (int64_t)ccs__PointsFingerprint(subd->cage),
+        (int64_t)sizeof(cc_Real),
+        (int64_t)sizeof(cc_Index)
+    };
+    ccs__FileArray arrays[CC__MAX_SUBD_ARRAY_COUNT];
+    ccm__Section sections[CC__MAX_SUBD_ARRAY_COUNT + 3];
+    const void *sectionArrays[CC__MAX_SUBD_ARRAY_COUNT + 3];
+    const int32_t arrayCount = ccs__FileArrays(subd, arrays);
+    int32_t sectionCount = 0;
+    bool isSuccess;
+
+    sections[sectionCount] = ccm__CreateSection(CC__SECTION_SUBD_INFO, CC__SUBD_INFO_COUNT);
+    sectionArrays[sectionCount++] = info;
+    sections[sectionCount] = ccm__CreateSection(CC__SECTION_SUBD_CREASE_IDS, creaseCount);
+    sectionArrays[sectionCount++] = creaseIDs;
+    sections[sectionCount] = ccm__CreateSection(CC__SECTION_SUBD_CREASE_SHARPNESS, creaseCount);
+    sectionArrays[sectionCount++] = creaseSharpness;
+
+    for (int32_t arrayID = 0; arrayID < arrayCount; ++arrayID) {
+        sections[sectionCount] = ccm__CreateSection(arrays[arrayID].type, arrays[arrayID].count);
+        sectionArrays[sectionCount++] = arrays[arrayID].array;
+    }
+
+    ccm__SplitCreases(subd->creases, creaseIDs, creaseSharpness, creaseCount);
+    isSuccess = ccm__WriteSections(stream, ccs__Magic(), sections, sectionArrays, sectionCount);
+    CC_FREE(creaseIDs);
+    CC_FREE(creaseSharpness);
+
+    return isSuccess;
+}
+
+CCDEF bool ccs_Save(const cc_Subd *subd, const char *filename)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t edgeCount = ccm_EdgeCount(cage);
-    cc_Crease *creasesOut = subd->creases;
+    const int nameLength = snprintf(NULL, 0, "%s.tmp", filename);
+    char *tmpFilename = (char *)CC_MALLOC(nameLength + 1);
+    FILE *stream;
+    bool isSuccess;
 
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t nextID = ccm_CreaseNextID(cage, edgeID);
-        const int32_t prevID = ccm_CreasePrevID(cage, edgeID);
-        const bool t1 = ccm_CreasePrevID(cage, nextID) == edgeID && nextID != edgeID;
-        const bool t2 = ccm_CreaseNextID(cage, prevID) == edgeID && prevID != edgeID;
-        const double thisS = 3.0f * ccm_CreaseSharpness(cage, edgeID);
-        const double nextS = ccm_CreaseSharpness(cage, nextID);
-        const double prevS = ccm_CreaseSharpness(cage, prevID);
-        cc_Crease *newCreases[2] = {
-            &creasesOut[(2 * edgeID + 0)],
-            &creasesOut[(2 * edgeID + 1)]
-        };
+    if (subd->topologyFingerprint == 0) {
+        CC_LOG("cc: subd topology not refined");
+        CC_FREE(tmpFilename);
+
+        return false;
+    }
+
+    snprintf(tmpFilename, nameLength + 1, "%s.tmp", filename);
+    stream = fopen(tmpFilename, "wb");
 
-        // next rule
-        newCreases[0]->nextID = 2 * edgeID + 1;
-        newCreases[1]->nextID = 2 * nextID + (t1 ? 0 : 1);
+    if (!stream) {
+        CC_LOG("cc: fopen failed");
+        CC_FREE(tmpFilename);
+
+        return false;
+    }
 
-        // prev rule
-        newCreases[0]->prevID = 2 * prevID + (t2 ? 1 : 0);
-        newCreases[1]->prevID = 2 * edgeID + 0;
+    isSuccess = ccs__WriteFile(subd, stream);
+    isSuccess = (fclose(stream) == 0) && isSuccess;
 
-        // sharpness rule
-        newCreases[0]->sharpness = cc__Maxf(0.0f, (prevS + thisS) / 4.0f - 1.0f);
-        newCreases[1]->sharpness = cc__Maxf(0.0f, (thisS + nextS) / 4.0f - 1.0f);
+    if (isSuccess && rename(tmpFilename, filename) != 0) {
+        // some platforms do not replace existing files
+        remove(filename);
+        isSuccess = rename(tmpFilename, filename) == 0;
     }
-CC_BARRIER
+
+    if (!isSuccess) {
+        CC_LOG("cc: data dump failed");
+        remove(tmpFilename);
+    }
+
+    CC_FREE(tmpFilename);
+
+    return isSuccess;
 }
 
 
 /*******************************************************************************
- * RefineCreases -- Applies crease subdivision on the subd
+ * LoadSubd -- Loads a refined subd from a file
  *
- * This routine computes the topology of the next subd level.
+ * The file must have been refined from a cage with the same topology. On
+ * POSIX systems, the file is mapped privately and the sections that match
+ * the precision of the library are used in place, so that a warm start
+ * mostly costs the checksums over the page cache. The creases are joined
+ * into a buffer of their own. If the vertex points of the cage changed
+ * since the file was saved, the vertex points are refined again. Loaded
+ * subds ignore CC_SUBD_FIRST_TOUCH, since their pages are already placed.
+ * Note that the topology fingerprint depends on the precision of the
+ * library, so files saved in another precision do not match the cage.
  *
  */
-static void ccs__RefineCreases(cc_Subd *subd, int32_t depth)
-{
-    const cc_Mesh *cage = subd->cage;
-    const int32_t creaseCount = ccm_CreaseCountAtDepth(cage, depth);
-    const int32_t stride = ccs_CumulativeCreaseCountAtDepth(cage, depth);
-    cc_Crease *creasesOut = &subd->creases[stride];
-
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < creaseCount; ++edgeID) {
-        const int32_t nextID = ccs_CreaseNextID_Fast(subd, edgeID, depth);
-        const int32_t prevID = ccs_CreasePrevID_Fast(subd, edgeID, depth);
-        const bool t1 = ccs_CreasePrevID_Fast(subd, nextID, depth) == edgeID && nextID != edgeID;
-        const bool t2 = ccs_CreaseNextID_Fast(subd, prevID, depth) == edgeID && prevID != edgeID;
-        const double thisS = 3.0f * ccs_CreaseSharpness_Fast(subd, edgeID, depth);
-        const double nextS = ccs_CreaseSharpness_Fast(subd, nextID, depth);
-        const double prevS = ccs_CreaseSharpness_Fast(subd, prevID, depth);
-        cc_Crease *newCreases[2] = {
-            &creasesOut[(2 * edgeID + 0)],
-            &creasesOut[(2 * edgeID + 1)]
-        };
+typedef struct {
+    FILE *stream;       // NULL if mapped
+    char *data;         // NULL if streamed
+    size_t byteCount;
+} ccs__File;
 
-        // next rule
-        newCreases[0]->nextID = 2 * edgeID + 1;
-        newCreases[1]->nextID = 2 * nextID + (t1 ? 0 : 1);
+static bool ccs__OpenFile(ccs__File *file, const char *filename)
+{
+#ifdef CC__MAPPED_FILES
+    const int fileDescriptor = open(filename, O_RDONLY);
+    struct stat fileStatus;
+    void *data;
 
-        // prev rule
-        newCreases[0]->prevID = 2 * prevID + (t2 ? 1 : 0);
-        newCreases[1]->prevID = 2 * edgeID + 0;
+    file->stream = NULL;
+    file->data = NULL;
+    file->byteCount = 0;
 
-        // sharpness rule
-        newCreases[0]->sharpness = cc__Maxf(0.0f, (prevS + thisS) / 4.0f - 1.0f);
-        newCreases[1]->sharpness = cc__Maxf(0.0f, (thisS + nextS) / 4.0f - 1.0f);
+    if (fileDescriptor < 0) {
+        return false;
     }
-CC_BARRIER
-}
 
+    if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size <= 0) {
+        close(fileDescriptor);
 
-/*******************************************************************************
- * RefineCreases
- *
- */
-CCDEF void ccs_RefineCreases(cc_Subd *subd)
-{
-    const int32_t maxDepth = ccs_MaxDepth(subd);
+        return false;
+    }
 
-    ccs__RefineCageCreases(subd);
+    file->byteCount = (size_t)fileStatus.st_size;
+    data = mmap(NULL, file->byteCount, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+    close(fileDescriptor);
 
-    for (int32_t depth = 1; depth < maxDepth; ++depth) {
-        ccs__RefineCreases(subd, depth);
+    if (data == MAP_FAILED) {
+        return false;
     }
-}
 
+    file->data = (char *)data;
 
-/*******************************************************************************
- * Refine -- Computes and stores the result of Catmull Clark subdivision.
- *
- * The subdivision is computed down to the maxDepth parameter.
- *
- */
-static void ccs__RefineTopology(cc_Subd *subd)
-{
-    ccs_RefineHalfedges(subd);
-    ccs_RefineCreases(subd);
-#ifndef CC_DISABLE_UV
-    ccs_RefineVertexUvs(subd);
+    return true;
+#else
+    file->stream = fopen(filename, "rb");
+    file->data = NULL;
+    file->byteCount = 0;
+
+    return file->stream != NULL;
 #endif
 }
 
-CCDEF void ccs_Refine_Scatter(cc_Subd *subd)
+static void ccs__CloseFile(ccs__File *file)
 {
-    ccs__RefineTopology(subd);
-    ccs_RefineVertexPoints_Scatter(subd);
+    if (file->stream != NULL) {
+        fclose(file->stream);
+    }
+#ifdef CC__MAPPED_FILES
+    if (file->data != NULL) {
+        munmap(file->data, file->byteCount);
+    }
+#endif
 }
 
-CCDEF void ccs_Refine_Gather(cc_Subd *subd)
+static bool
+ccs__ReadFile(const ccs__File *file, int64_t offset, void *data, size_t byteCount)
 {
-    ccs__RefineTopology(subd);
-    ccs_RefineVertexPoints_Gather(subd);
-}
+    if (file->data != NULL) {
+        if ((uint64_t)offset > file->byteCount || byteCount > file->byteCount - offset) {
+            return false;
+        }
 
-CCDEF void ccs_Refine_NoCreases_Scatter(cc_Subd *subd)
-{
-    ccs__RefineTopology(subd);
-    ccs_RefineVertexPoints_NoCreases_Scatter(subd);
+        CC_MEMCPY(data, file->data + offset, byteCount);
+
+        return true;
+    }
+
+    return fseek(file->stream, (long)offset, SEEK_SET) == 0
+        && fread(data, 1, byteCount, file->stream) == byteCount;
 }
 
-CCDEF void ccs_Refine_NoCreases_Gather(cc_Subd *subd)
+// reads a section into *array, or points *array into the mapping if possible
+static bool
+ccs__ReadSection(const ccs__File *file, const ccm__Section *section, void **array)
 {
-    ccs__RefineTopology(subd);
-    ccs_RefineVertexPoints_NoCreases_Gather(subd);
-}
+    if (file->data != NULL) {
+        const char *data = file->data + section->offset;
+        const size_t byteCount = (size_t)section->byteCount;
 
+        if ((uint64_t)section->offset > file->byteCount
+            || byteCount > file->byteCount - section->offset
+            || ccm__Checksum(data, byteCount) != section->checksum) {
+            return false;
+        }
 
-/*******************************************************************************
- * Magic -- Generates the magic identifier
- *
- * Each cc_Mesh file starts with 8 Bytes that allow us to check if the file
- * under reading is actually a cc_Mesh file.
- *
- */
-static int64_t ccm__Magic()
-{
-    const union {
-        char    string[8];
-        int64_t numeric;
-    } magic = {{'c', 'c', '_', 'M', 'e', 's', 'h', '1'}};
+        if (ccm__IsNativeSection(section) && byteCount > 0) {
+            *array = (void *)data;
 
-    return magic.numeric;
-}
+            return true;
+        }
 
+        return ccm__DecodeSection(section, data, *array);
+    }
 
-/*******************************************************************************
- * Header File Data Structure
- *
- * This represents the header we use to uniquely identify the cc_Mesh files
- * and provide the fundamental information to properly decode the rest of the
- * file.
- *
- */
-typedef struct {
-    int64_t magic;
-    int32_t vertexCount;
-    int32_t uvCount;
-    int32_t halfedgeCount;
-    int32_t edgeCount;
-    int32_t faceCount;
-} ccm__Header;
+    return ccm__ReadSection(file->stream, section, *array);
+}
 
+static const ccm__Section *
+ccs__FindSection(
+    const ccm__Section *table,
+    int32_t sectionCount,
+    int32_t type,
+    cc_Index count
+) {
+    for (int32_t sectionID = 0; sectionID < sectionCount; ++sectionID) {
+        const ccm__Section *section = &table[sectionID];
 
-/*******************************************************************************
- * Create header
- *
- * This procedure initializes a cc_Mesh file header.
- *
- */
-static ccm__Header ccm__CreateHeader(const cc_Mesh *mesh)
-{
-    ccm__Header header = {
-        ccm__Magic(),
-        ccm_VertexCount(mesh),
-        ccm_UvCount(mesh),
-        ccm_HalfedgeCount(mesh),
-        ccm_EdgeCount(mesh),
-        ccm_FaceCount(mesh)
-    };
+        if (section->type == type) {
+            return ccm__IsSectionValid(section) && section->count == count ? section : NULL;
+        }
+    }
 
-    return header;
+    return NULL;
 }
 
+static bool
+ccs__ReadArrays(
+    cc_Subd *subd,
+    const ccs__File *file,
+    const ccm__Section *table,
+    int32_t sectionCount
+) {
+    const cc_Index creaseCount = ccs__CreaseStorageCount(subd);
+    const ccm__Section *creaseIDSection =
+        ccs__FindSection(table, sectionCount, CC__SECTION_SUBD_CREASE_IDS, creaseCount);
+    const ccm__Section *creaseSharpnessSection =
+        ccs__FindSection(table, sectionCount, CC__SECTION_SUBD_CREASE_SHARPNESS, creaseCount);
+    // the reads may point the creases into the mapping instead of the buffers
+    void *creaseBuffers[2] = {
+        CC_MALLOC(sizeof(cc_Index) * 2 * creaseCount),
+        CC_MALLOC(sizeof(cc_Real) * creaseCount)
+    };
+    void *creaseIDs = creaseBuffers[0];
+    void *creaseSharpness = creaseBuffers[1];
+    ccs__FileArray arrays[CC__MAX_SUBD_ARRAY_COUNT];
+    const int32_t arrayCount = ccs__FileArrays(subd, arrays);
+    bool isSuccess = creaseIDSection != NULL && creaseSharpnessSection != NULL
+                  && ccs__ReadSection(file, creaseIDSection, &creaseIDs)
+                  && ccs__ReadSection(file, creaseSharpnessSection, &creaseSharpness);
+
+    for (int32_t arrayID = 0; isSuccess && arrayID < arrayCount; ++arrayID) {
+        const ccs__FileArray *fileArray = &arrays[arrayID];
+        const ccm__Section *section =
+            ccs__FindSection(table, sectionCount, fileArray->type, fileArray->count);
+        void *array = fileArray->array;
+
+        isSuccess = section != NULL && ccs__ReadSection(file, section, &array);
+
+        if (isSuccess && array != fileArray->array) {
+            CC_FREE(fileArray->array);
+            ccs__SetFileArray(subd, fileArray->type, array);
+        }
+    }
 
-/*******************************************************************************
- * ReadHeader -- Reads a tt_Texture file header from an input stream
- *
- */
-static bool ccm__ReadHeader(FILE *stream, ccm__Header *header)
-{
-    if (fread(header, sizeof(*header), 1, stream) != 1) {
-        CC_LOG("cc: fread failed");
-
-        return false;
+    if (isSuccess) {
+        ccm__JoinCreases((const cc_Index *)creaseIDs,
+                         (const cc_Real *)creaseSharpness,
+                         subd->creases,
+                         creaseCount);
     }
 
-    return header->magic == ccm__Magic();
-}
+    CC_FREE(creaseBuffers[0]);
+    CC_FREE(creaseBuffers[1]);
 
+    return isSuccess;
+}
 
-/*******************************************************************************
- * ReadData -- Loads mesh data
- *
- */
-static bool ccm__ReadData(cc_Mesh *mesh, FILE *stream)
+static cc_Subd *ccs__ReadFileSubd(const cc_Mesh *cage, ccs__File *file)
 {
-    const int32_t vertexCount = ccm_VertexCount(mesh);
-    const int32_t uvCount = ccm_UvCount(mesh);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
-    const int32_t creaseCount = ccm_CreaseCount(mesh);
-    const int32_t edgeCount = ccm_EdgeCount(mesh);
-    const int32_t faceCount = ccm_FaceCount(mesh);
+    ccm__FileHeader header;
+    ccm__Section *table;
+    const ccm__Section *infoSection;
+    int64_t info[CC__SUBD_INFO_COUNT];
+    void *infoData = info;
+    cc_Subd *subd;
+    bool isSuccess;
 
-    const int32_t vertexByteCount = vertexCount * sizeof(cc_VertexPoint_f);
-    const int32_t uvByteCount = uvCount * sizeof(cc_VertexUv_f);
-    const int32_t creaseByteCount = edgeCount * sizeof(cc_Crease_f);
+    if (!ccs__ReadFile(file, 0, &header, sizeof(header))
+        || header.magic != ccs__Magic()
+        || !ccm__IsSectionCountValid(&header)) {
+        CC_LOG("cc: unsupported file");
 
-    cc_Crease_f *creases = (cc_Crease_f *)malloc(creaseByteCount);
-    cc_VertexPoint_f *vertexPts = (cc_VertexPoint_f *)malloc(vertexByteCount);
-    cc_VertexUv_f *uvs = (cc_VertexUv_f *)malloc(uvByteCount);
+        return NULL;
+    }
 
-    bool isSuccess = 
-       (fread(mesh->vertexToHalfedgeIDs , sizeof(int32_t)       , vertexCount  , stream) == (size_t)vertexCount)
-    && (fread(mesh->edgeToHalfedgeIDs   , sizeof(int32_t)       , edgeCount    , stream) == (size_t)edgeCount)
-    && (fread(mesh->faceToHalfedgeIDs   , sizeof(int32_t)       , faceCount    , stream) == (size_t)faceCount)
-    && (fread(vertexPts                 , sizeof(cc_VertexPoint_f), vertexCount  , stream) == (size_t)vertexCount)
-    && (fread(uvs                       , sizeof(cc_VertexUv_f)   , uvCount      , stream) == (size_t)uvCount)
-    && (fread(creases                   , sizeof(cc_Crease_f)     , creaseCount  , stream) == (size_t)creaseCount)
-    && (fread(mesh->halfedges           , sizeof(cc_Halfedge)   , halfedgeCount, stream) == (size_t)halfedgeCount);
+    table = (ccm__Section *)CC_MALLOC(sizeof(ccm__Section) * header.sectionCount);
 
-    // now convert all floats to doubles
-    for(int i = 0; i < vertexCount; i++){
-        cc_VertexPoint_f tmp = vertexPts[i];
-        mesh->vertexPoints[i].x = (double) tmp.x;
-        mesh->vertexPoints[i].y = (double) tmp.y;
-        mesh->vertexPoints[i].z = (double) tmp.z;
-    }
+    if (!ccs__ReadFile(file, sizeof(header), table, sizeof(ccm__Section) * header.sectionCount)
+        || ccm__Checksum(table, sizeof(ccm__Section) * header.sectionCount)
+           != header.tableChecksum) {
+        CC_LOG("cc: unsupported file");
+        CC_FREE(table);
 
-    for(int i = 0; i < uvCount; i++){
-        cc_VertexUv_f tmp = uvs[i];
-        mesh->uvs[i].u = (double) tmp.u;
-        mesh->uvs[i].v = (double) tmp.v;
+        return NULL;
     }
 
-    for(int i = 0; i < creaseCount; i++){
-        cc_Crease_f tmp = creases[i];
-        mesh->creases[i].nextID = tmp.nextID;
-        mesh->creases[i].prevID = tmp.prevID;
-        mesh->creases[i].sharpness = (double) tmp.sharpness;
+    infoSection = ccs__FindSection(table,
+                                   header.sectionCount,
+                                   CC__SECTION_SUBD_INFO,
+                                   CC__SUBD_INFO_COUNT);
+
+    if (infoSection == NULL || !ccs__ReadSection(file, infoSection, &infoData)) {
+        CC_LOG("cc: unsupported file");
+        CC_FREE(table);
+
+        return NULL;
     }
-    free(creases); 
-    free(vertexPts);
-    free(uvs);
-    return isSuccess;
-}
 
+    CC_MEMCPY(info, infoData, sizeof(info));
 
-/*******************************************************************************
- * Load -- Loads a mesh from a file
- *
- */
-CCDEF cc_Mesh *ccm_Load(const char *filename)
-{
-    FILE *stream = fopen(filename, "rb");
-    ccm__Header header;
-    cc_Mesh *mesh;
+    if (info[CC__SUBD_INFO_REAL_BYTE_COUNT] != (int64_t)sizeof(cc_Real)
+        || info[CC__SUBD_INFO_INDEX_BYTE_COUNT] != (int64_t)sizeof(cc_Index)) {
+        CC_LOG("cc: subd file was written by a different build configuration");
+        CC_FREE(table);
 
-    if (!stream) {
-        CC_LOG("cc: fopen failed");
+        return NULL;
+    }
+
+    if ((uint64_t)info[CC__SUBD_INFO_TOPOLOGY_FINGERPRINT] != ccm_TopologyFingerprint(cage)) {
+        CC_LOG("cc: subd file does not match the cage");
+        CC_FREE(table);
 
         return NULL;
     }
 
-    if (!ccm__ReadHeader(stream, &header)) {
+    if (info[CC__SUBD_INFO_MAX_DEPTH] < 0 || info[CC__SUBD_INFO_MAX_DEPTH] > 31) {
         CC_LOG("cc: unsupported file");
-        fclose(stream);
+        CC_FREE(table);
 
         return NULL;
     }
 
-    mesh = ccm_Create(header.vertexCount,
-                      header.uvCount,
-                      header.halfedgeCount,
-                      header.edgeCount,
-                      header.faceCount);
-    if (!ccm__ReadData(mesh, stream)) {
+    subd = ccs_CreateWithFlags(cage,
+                               (int32_t)info[CC__SUBD_INFO_MAX_DEPTH],
+                               (uint32_t)info[CC__SUBD_INFO_FLAGS] & ~CC_SUBD_FIRST_TOUCH);
+
+    if (subd == NULL) {
+        CC_FREE(table);
+
+        return NULL;
+    }
+
+    subd->mappedData = file->data;
+    subd->mappedByteCount = file->byteCount;
+    isSuccess = ccs__ReadArrays(subd, file, table, header.sectionCount);
+    CC_FREE(table);
+
+    // the subd owns the mapping from now on
+    file->data = NULL;
+
+    if (!isSuccess) {
         CC_LOG("cc: data reading failed");
-        ccm_Release(mesh);
-        fclose(stream);
+        ccs_Release(subd);
 
         return NULL;
     }
-    fclose(stream);
 
-    return mesh;
-}
+    subd->topologyFingerprint = (uint64_t)info[CC__SUBD_INFO_TOPOLOGY_FINGERPRINT];
 
+    if ((uint64_t)info[CC__SUBD_INFO_POINTS_FINGERPRINT] != ccs__PointsFingerprint(cage)) {
+        ccs_RefineVertexPoints_Gather(subd);
+    }
 
-/*******************************************************************************
- * Save -- Save a mesh to a file
- *
- */
-CCDEF bool ccm_Save(const cc_Mesh *mesh, const char *filename)
+    return subd;
+}
+
+CCDEF cc_Subd *ccs_Load(const cc_Mesh *cage, const char *filename)
 {
-    const int32_t vertexCount = ccm_VertexCount(mesh);
-    const int32_t uvCount = ccm_UvCount(mesh);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
-    const int32_t creaseCount = ccm_CreaseCount(mesh);
-    const int32_t edgeCount = ccm_EdgeCount(mesh);
-    const int32_t faceCount = ccm_FaceCount(mesh);
-    const ccm__Header header = ccm__CreateHeader(mesh);
-    FILE *stream = fopen(filename, "wb");
+    ccs__File file;
+    cc_Subd *subd;
 
-    if (!stream) {
-        CC_LOG("cc: fopen failed");
+    if (!ccs__OpenFile(&file, filename)) {
+        CC_LOG("cc: open failed");
 
-        return false;
+        return NULL;
     }
 
-    if (fwrite(&header, sizeof(header), 1, stream) != 1) {
-        CC_LOG("cc: header dump failed");
-        fclose(stream);
+    subd = ccs__ReadFileSubd(cage, &file);
+    ccs__CloseFile(&file);
 
-        return false;
-    }
+    return subd;
+}
 
-    if (
-        fwrite(mesh->vertexToHalfedgeIDs, sizeof(int32_t)       , vertexCount  , stream) != (size_t)vertexCount
-    ||  fwrite(mesh->edgeToHalfedgeIDs  , sizeof(int32_t)       , edgeCount    , stream) != (size_t)edgeCount
-    ||  fwrite(mesh->faceToHalfedgeIDs  , sizeof(int32_t)       , faceCount    , stream) != (size_t)faceCount
-    ||  fwrite(mesh->vertexPoints       , sizeof(cc_VertexPoint), vertexCount  , stream) != (size_t)vertexCount
-    ||  fwrite(mesh->uvs                , sizeof(cc_VertexUv)   , uvCount      , stream) != (size_t)uvCount
-    ||  fwrite(mesh->creases            , sizeof(cc_Crease)     , creaseCount  , stream) != (size_t)creaseCount
-    ||  fwrite(mesh->halfedges          , sizeof(cc_Halfedge)   , halfedgeCount, stream) != (size_t)halfedgeCount
-    ) {
-        CC_LOG("cc: data dump failed");
+
+/*******************************************************************************
+ * LoadOrCreate -- Loads a refined subd from a cache file, or refines it
+ *
+ * The cache file is reused if it was refined from a cage with the same
+ * topology, to the same depth, and with the same flags. Otherwise, the subd
+ * is refined and the cache file (re)written.
+ *
+ */
+CCDEF cc_Subd *
+ccs_LoadOrCreate(
+    const cc_Mesh *cage,
+    int32_t maxDepth,
+    uint32_t flags,
+    const char *filename
+) {
+    FILE *stream = fopen(filename, "rb");
+    cc_Subd *subd = NULL;
+
+    // a missing cache file is not an error
+    if (stream) {
         fclose(stream);
+        subd = ccs_Load(cage, filename);
 
-        return false;
+        if (subd != NULL
+            && (ccs_MaxDepth(subd) != maxDepth
+                || ((subd->flags ^ flags) & ~CC_SUBD_FIRST_TOUCH) != 0)) {
+            ccs_Release(subd);
+            subd = NULL;
+        }
     }
 
-    fclose(stream);
+    if (subd == NULL) {
+        subd = ccs_CreateWithFlags(cage, maxDepth, flags);
 
-    return true;
-}
+        if (subd != NULL) {
+            ccs_Refine_Gather(subd);
+            ccs_Save(subd, filename);
+        }
+    }
 
+    return subd;
+}
 
 #undef CC_ASSERT
 #undef CC_LOG
@@ -3328,6 +13724,12 @@ CCDEF bool ccm_Save(const cc_Mesh *mesh, const char *filename)
 #undef CC_MEMSET
 #undef CC_ATOMIC
 #undef CC_PARALLEL_FOR
+#undef CC_PARALLEL
+#undef CC_PARALLEL_THREADS
+#undef CC_FOR
+#undef CC_SINGLE
+#undef CC_SINGLE_COPY
+#undef CC__PRAGMA
 #undef CC_BARRIER
 
 #endif //CC_IMPLEMENTATION
@@ -524,6 +524,48 @@ bool ccm__ReadHeader(FILE *stream, ccm__Header *header)
  * ReadData -- Loads mesh data
  *
  */
+typedef struct {
+    cc_Mesh *mesh;
+    const cc_VertexPoint_f *vertexPoints;
+    const cc_VertexUv_f *uvs;
+    const cc_Crease_f *creases;
+} ccm__WideningTask;
+
+static void ccm__WidenVertexPoints(int32_t begin, int32_t end, void *userData)
+{
+    const ccm__WideningTask *task = (const ccm__WideningTask *)userData;
+
+    for (int32_t i = begin; i < end; ++i) {
+        cc_VertexPoint_f tmp = task->vertexPoints[i];
+        task->mesh->vertexPoints[i].x = (double) tmp.x;
+        task->mesh->vertexPoints[i].y = (double) tmp.y;
+        task->mesh->vertexPoints[i].z = (double) tmp.z;
+    }
+}
+
+static void ccm__WidenUvs(int32_t begin, int32_t end, void *userData)
+{
+    const ccm__WideningTask *task = (const ccm__WideningTask *)userData;
+
+    for (int32_t i = begin; i < end; ++i) {
+        cc_VertexUv_f tmp = task->uvs[i];
+        task->mesh->uvs[i].u = (double) tmp.u;
+        task->mesh->uvs[i].v = (double) tmp.v;
+    }
+}
+
+static void ccm__WidenCreases(int32_t begin, int32_t end, void *userData)
+{
+    const ccm__WideningTask *task = (const ccm__WideningTask *)userData;
+
+    for (int32_t i = begin; i < end; ++i) {
+        cc_Crease_f tmp = task->creases[i];
+        task->mesh->creases[i].nextID = tmp.nextID;
+        task->mesh->creases[i].prevID = tmp.prevID;
+        task->mesh->creases[i].sharpness = (double) tmp.sharpness;
+    }
+}
+
 bool ccm__ReadData(cc_Mesh *mesh, FILE *stream)
 {
     const int32_t vertexCount = ccm_VertexCount(mesh);
@@ -551,25 +593,12 @@ bool ccm__ReadData(cc_Mesh *mesh, FILE *stream)
     && (fread(mesh->halfedges           , sizeof(cc_Halfedge)   , halfedgeCount, stream) == (size_t)halfedgeCount);
 
     // now convert all floats to doubles
-    for(int i = 0; i < vertexCount; i++){
-        cc_VertexPoint_f tmp = vertexPts[i];
-        mesh->vertexPoints[i].x = (double) tmp.x;
-        mesh->vertexPoints[i].y = (double) tmp.y;
-        mesh->vertexPoints[i].z = (double) tmp.z;
-    }
+    ccm__WideningTask task = {mesh, vertexPts, uvs, creases};
 
-    for(int i = 0; i < uvCount; i++){
-        cc_VertexUv_f tmp = uvs[i];
-        mesh->uvs[i].u = (double) tmp.u;
-        mesh->uvs[i].v = (double) tmp.v;
-    }
+    cc_ParallelFor(0, vertexCount, CC_PARALLEL_GRAIN, &ccm__WidenVertexPoints, &task);
+    cc_ParallelFor(0, uvCount, CC_PARALLEL_GRAIN, &ccm__WidenUvs, &task);
+    cc_ParallelFor(0, creaseCount, CC_PARALLEL_GRAIN, &ccm__WidenCreases, &task);
 
-    for(int i = 0; i < creaseCount; i++){
-        cc_Crease_f tmp = creases[i];
-        mesh->creases[i].nextID = tmp.nextID;
-        mesh->creases[i].prevID = tmp.prevID;
-        mesh->creases[i].sharpness = (double) tmp.sharpness;
-    }
     free(creases); 
     free(vertexPts);
     free(uvs);
@@ -98,3 +98,98 @@ __host__ __device__   int32_t cc__EncodeUv(const cc_VertexUv uv)
 
     return (int32_t)tmp;
 }
+
+
+/*******************************************************************************
+ * ParallelBackend -- Runs the host loops of the library
+ *
+ * The interface follows the one of the CPU library (see ParallelBackend in
+ * the CatmullClark.h header at the root of the repository): a backend splits
+ * a range into chunks of (at most) "grain" elements and calls the callback
+ * once per chunk. The ranges are int32_t here, so the backends of the CPU
+ * library, which take cc_Index ranges, cannot be installed as such. The
+ * OpenMP backend is the default, and runs serially when the host compiler has
+ * no OpenMP support.
+ *
+ */
+static void
+cc__ParallelFor_Serial(
+    int32_t begin,
+    int32_t end,
+    int32_t grain,
+    cc_ParallelForCallback callback,
+    void *userData,
+    void *backendData
+) {
+    (void)grain;
+    (void)backendData;
+
+    if (begin < end) {
+        (*callback)(begin, end, userData);
+    }
+}
+
+static void
+cc__ParallelFor_OpenMP(
+    int32_t begin,
+    int32_t end,
+    int32_t grain,
+    cc_ParallelForCallback callback,
+    void *userData,
+    void *backendData
+) {
+    const int32_t chunkCount = begin < end ? (end - begin + grain - 1) / grain : 0;
+
+    (void)backendData;
+
+#ifdef _OPENMP
+#   pragma omp parallel for
+#endif
+    for (int32_t chunkID = 0; chunkID < chunkCount; ++chunkID) {
+        const int32_t chunkBegin = begin + chunkID * grain;
+        const int32_t chunkEnd = chunkBegin + (grain < end - chunkBegin ? grain : end - chunkBegin);
+
+        (*callback)(chunkBegin, chunkEnd, userData);
+    }
+}
+
+static const cc_ParallelBackend cc__SerialBackend = {&cc__ParallelFor_Serial, NULL};
+static const cc_ParallelBackend cc__OpenMPBackend = {&cc__ParallelFor_OpenMP, NULL};
+static const cc_ParallelBackend *cc__ParallelBackend = &cc__OpenMPBackend;
+
+const cc_ParallelBackend *cc_SerialBackend(void)
+{
+    return &cc__SerialBackend;
+}
+
+const cc_ParallelBackend *cc_OpenMPBackend(void)
+{
+    return &cc__OpenMPBackend;
+}
+
+void cc_SetParallelBackend(const cc_ParallelBackend *backend)
+{
+    cc__ParallelBackend = backend != NULL ? backend : &cc__OpenMPBackend;
+}
+
+const cc_ParallelBackend *cc_GetParallelBackend(void)
+{
+    return cc__ParallelBackend;
+}
+
+void
+cc_ParallelFor(
+    int32_t begin,
+    int32_t end,
+    int32_t grain,
+    cc_ParallelForCallback callback,
+    void *userData
+) {
+    assert(grain > 0);
+    (*cc__ParallelBackend->parallelFor)(begin,
+                                        end,
+                                        grain,
+                                        callback,
+                                        userData,
+                                        cc__ParallelBackend->backendData);
+}
@@ -35,4 +35,28 @@ __host__ __device__   void cc__Mul3f(double *out, const double *x, double y);
 __host__ __device__  void cc__Addfv(int32_t n, double *out, const double *x, const double *y);
 __host__ __device__  void cc__Add3f(double *out, const double *x, const double *y);
 __host__ __device__  cc_VertexUv cc__DecodeUv(int32_t uvEncoded);
-__host__ __device__  int32_t cc__EncodeUv(const cc_VertexUv uv);
\ No newline at end of file
+__host__ __device__  int32_t cc__EncodeUv(const cc_VertexUv uv);
+
+// parallel backend of the host loops (modeled on the CPU library's, but its
+// ranges are int32_t rather than cc_Index, so the two do not mix)
+#ifndef CC_PARALLEL_GRAIN
+#   define CC_PARALLEL_GRAIN 1024
+#endif
+
+typedef void (*cc_ParallelForCallback)(int32_t begin, int32_t end, void *userData);
+typedef struct {
+    void (*parallelFor)(int32_t begin, int32_t end, int32_t grain,
+                        cc_ParallelForCallback callback, void *userData,
+                        void *backendData);
+    void *backendData;
+} cc_ParallelBackend;
+
+const cc_ParallelBackend *cc_OpenMPBackend(void);
+const cc_ParallelBackend *cc_SerialBackend(void);
+void cc_SetParallelBackend(const cc_ParallelBackend *backend);
+const cc_ParallelBackend *cc_GetParallelBackend(void);
+void cc_ParallelFor(int32_t begin,
+                    int32_t end,
+                    int32_t grain,
+                    cc_ParallelForCallback callback,
+                    void *userData);
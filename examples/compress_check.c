@@ -0,0 +1,81 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#define CC_IMPLEMENTATION
+#include "CatmullClark.h"
+
+#define LOG(fmt, ...) fprintf(stdout, fmt "\n", ##__VA_ARGS__); fflush(stdout);
+
+static void usage(const char *appname)
+{
+    LOG("usage: %s path_to_ccm path_to_output_ccm tolerance", appname);
+}
+
+/*
+ * Returns the largest difference between the vertex points of two meshes.
+ */
+static double MaxError(const cc_Mesh *mesh, const cc_Mesh *reference)
+{
+    double maxError = 0.0;
+
+    for (cc_Index vertexID = 0; vertexID < ccm_VertexCount(mesh); ++vertexID) {
+        for (int32_t i = 0; i < 3; ++i) {
+            const double x = ccm_VertexPoint(mesh, vertexID).array[i];
+            const double y = ccm_VertexPoint(reference, vertexID).array[i];
+            const double error = fabs(x - y);
+
+            if (!(error <= maxError)) {
+                maxError = error;
+            }
+        }
+    }
+
+    return maxError;
+}
+
+int main(int argc, char **argv)
+{
+    double tolerance, error;
+    cc_Mesh *cage, *decoded;
+
+    if (argc < 4) {
+        usage(argv[0]);
+        return 0;
+    }
+
+    cage = ccm_Load(argv[1]);
+    tolerance = atof(argv[3]);
+
+    if (cage == NULL || !(tolerance > 0.0)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!ccm_SaveCompressed(cage, argv[2], tolerance)) {
+        ccm_Release(cage);
+        return EXIT_FAILURE;
+    }
+
+    decoded = ccm_Load(argv[2]);
+
+    if (decoded == NULL || ccm_VertexCount(decoded) != ccm_VertexCount(cage)) {
+        LOG("FAILED (unreadable output)");
+        ccm_Release(cage);
+        return EXIT_FAILURE;
+    }
+
+    error = MaxError(decoded, cage);
+    LOG("quantized vertex points: %e (tolerance: %e)", error, tolerance);
+
+    ccm_Release(decoded);
+    ccm_Release(cage);
+
+    if (error > tolerance) {
+        LOG("FAILED");
+
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -69,20 +69,20 @@ int main(int argc, char **argv)
         nonQuadCount,
         boundaryCount,
         creaseCount);
-    LOG("(UVs: %i)", ccm_UvCount(mesh));
+    LOG("(UVs: %lld)", (long long)ccm_UvCount(mesh));
 
     for (int32_t depth = 0; depth <= maxDepth; ++depth) {
-        LOG("depth %i: H= %i F= %i E= %i V= %i C= %i",
+        LOG("depth %i: H= %lld F= %lld E= %lld V= %lld C= %lld",
             depth,
-            ccm_HalfedgeCountAtDepth(mesh, depth),
-            ccm_FaceCountAtDepth(mesh, depth),
-            ccm_EdgeCountAtDepth(mesh, depth),
-            ccm_VertexCountAtDepth(mesh, depth),
-            ccm_CreaseCountAtDepth(mesh, depth));
+            (long long)ccm_HalfedgeCountAtDepth(mesh, depth),
+            (long long)ccm_FaceCountAtDepth(mesh, depth),
+            (long long)ccm_EdgeCountAtDepth(mesh, depth),
+            (long long)ccm_VertexCountAtDepth(mesh, depth),
+            (long long)ccm_CreaseCountAtDepth(mesh, depth));
     }
 
     for (int32_t depth = 0; depth <= maxDepth; ++depth) {
-        int32_t Href = 0, Vref = 0, Fref = 0, Eref = 0, Cref = 0;
+        cc_Index Href = 0, Vref = 0, Fref = 0, Eref = 0, Cref = 0;
 
         for (int32_t d = 1; d <= depth; ++d) {
             Href+= ccm_HalfedgeCountAtDepth(mesh, d);
@@ -92,22 +92,22 @@ int main(int argc, char **argv)
             Cref+= ccm_CreaseCountAtDepth(mesh, d);
         }
 
-        LOG("depth %i: Hcum= %i (ref: %i)\n"
-            "         Fcum= %i (ref: %i)\n"
-            "         Ecum= %i (ref: %i)\n"
-            "         Vcum= %i (ref: %i)\n"
-            "         Ccum= %i (ref: %i)\n",
+        LOG("depth %i: Hcum= %lld (ref: %lld)\n"
+            "         Fcum= %lld (ref: %lld)\n"
+            "         Ecum= %lld (ref: %lld)\n"
+            "         Vcum= %lld (ref: %lld)\n"
+            "         Ccum= %lld (ref: %lld)\n",
             depth,
-            ccs_CumulativeHalfedgeCountAtDepth(mesh, depth),
-            Href,
-            ccs_CumulativeFaceCountAtDepth(mesh, depth),
-            Fref,
-            ccs_CumulativeEdgeCountAtDepth(mesh, depth),
-            Eref,
-            ccs_CumulativeVertexCountAtDepth(mesh, depth),
-            Vref,
-            ccs_CumulativeCreaseCountAtDepth(mesh, depth),
-            Cref);
+            (long long)ccs_CumulativeHalfedgeCountAtDepth(mesh, depth),
+            (long long)Href,
+            (long long)ccs_CumulativeFaceCountAtDepth(mesh, depth),
+            (long long)Fref,
+            (long long)ccs_CumulativeEdgeCountAtDepth(mesh, depth),
+            (long long)Eref,
+            (long long)ccs_CumulativeVertexCountAtDepth(mesh, depth),
+            (long long)Vref,
+            (long long)ccs_CumulativeCreaseCountAtDepth(mesh, depth),
+            (long long)Cref);
     }
 
     ccm_Release(mesh);
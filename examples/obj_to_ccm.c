@@ -1,3 +1,7 @@
+// the .ccm file format stores single-precision data
+#ifndef CC_SINGLE_PRECISION
+#    define CC_SINGLE_PRECISION
+#endif
 #define CC_IMPLEMENTATION
 #include "CatmullClark.h"
 
@@ -259,7 +263,8 @@ CC_BARRIER
  * Following the Pixar standard, we tag boundary halfedges as sharp.
  * See "Subdivision Surfaces in Character Animation" by DeRose et al.
  * Note that we tag the sharpness value to 16 as subdivision can't go deeper
- * without overflowing 32-bit integers.
+ * without overflowing 32-bit integers (nor practically much deeper with
+ * 64-bit ones, see CC_INDEX64).
  *
  */
 static void MakeBoundariesSharp(cc_Mesh *mesh)
@@ -283,63 +288,63 @@ CC_BARRIER
  * LoadFaceMappings -- Computes the mappings for the faces of the mesh
  *
  */
-static int32_t FaceScroll(int32_t id, int32_t direction, int32_t maxValue)
+static cc_Index FaceScroll(cc_Index id, cc_Index direction, cc_Index maxValue)
 {
-    const int32_t n = maxValue - 1;
-    const int32_t d = direction;
-    const int32_t u = (d + 1) >> 1; // in [0, 1]
-    const int32_t un = u * n; // precomputation
+    const cc_Index n = maxValue - 1;
+    const cc_Index d = direction;
+    const cc_Index u = (d + 1) >> 1; // in [0, 1]
+    const cc_Index un = u * n; // precomputation
 
     return (id == un) ? (n - un) : (id + d);
 }
 
-static int32_t
+static cc_Index
 ScrollFaceHalfedgeID(
-    int32_t halfedgeID,
-    int32_t halfedgeFaceBeginID,
-    int32_t halfedgeFaceEndID,
-    int32_t direction
+    cc_Index halfedgeID,
+    cc_Index halfedgeFaceBeginID,
+    cc_Index halfedgeFaceEndID,
+    cc_Index direction
 ) {
-    const int32_t faceHalfedgeCount = halfedgeFaceEndID - halfedgeFaceBeginID;
-    const int32_t localHalfedgeID = halfedgeID - halfedgeFaceBeginID;
-    const int32_t nextHalfedgeID = FaceScroll(localHalfedgeID,
-                                              direction,
-                                              faceHalfedgeCount);
+    const cc_Index faceHalfedgeCount = halfedgeFaceEndID - halfedgeFaceBeginID;
+    const cc_Index localHalfedgeID = halfedgeID - halfedgeFaceBeginID;
+    const cc_Index nextHalfedgeID = FaceScroll(localHalfedgeID,
+                                               direction,
+                                               faceHalfedgeCount);
 
     return halfedgeFaceBeginID + nextHalfedgeID;
 }
 
 static void LoadFaceMappings(cc_Mesh *mesh, const cbf_BitField *faceIterator)
 {
-    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
-    const int32_t faceCount = cbf_BitCount(faceIterator) - 1;
+    const cc_Index halfedgeCount = ccm_HalfedgeCount(mesh);
+    const cc_Index faceCount = cbf_BitCount(faceIterator) - 1;
 
-    mesh->faceToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * faceCount);
+    mesh->faceToHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * faceCount);
     mesh->faceCount = faceCount;
 
 CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
-        const int32_t tmp = cbf_EncodeBit(faceIterator, halfedgeID);
-        const int32_t faceID = tmp - (cbf_GetBit(faceIterator, halfedgeID) ^ 1);
+    for (cc_Index halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
+        const cc_Index tmp = cbf_EncodeBit(faceIterator, halfedgeID);
+        const cc_Index faceID = tmp - (cbf_GetBit(faceIterator, halfedgeID) ^ 1);
 
         mesh->halfedges[halfedgeID].faceID = faceID;
     }
 CC_BARRIER
 
 CC_PARALLEL_FOR
-    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+    for (cc_Index faceID = 0; faceID < faceCount; ++faceID) {
         mesh->faceToHalfedgeIDs[faceID] = cbf_DecodeBit(faceIterator, faceID);
     }
 CC_BARRIER
 
 
 CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
-        const int32_t faceID = mesh->halfedges[halfedgeID].faceID;
-        const int32_t beginID = cbf_DecodeBit(faceIterator, faceID);
-        const int32_t endID = cbf_DecodeBit(faceIterator, faceID + 1);
-        const int32_t nextID = ScrollFaceHalfedgeID(halfedgeID, beginID, endID, +1);
-        const int32_t prevID = ScrollFaceHalfedgeID(halfedgeID, beginID, endID, -1);
+    for (cc_Index halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
+        const cc_Index faceID = mesh->halfedges[halfedgeID].faceID;
+        const cc_Index beginID = cbf_DecodeBit(faceIterator, faceID);
+        const cc_Index endID = cbf_DecodeBit(faceIterator, faceID + 1);
+        const cc_Index nextID = ScrollFaceHalfedgeID(halfedgeID, beginID, endID, +1);
+        const cc_Index prevID = ScrollFaceHalfedgeID(halfedgeID, beginID, endID, -1);
 
         mesh->halfedges[halfedgeID].nextID = nextID;
         mesh->halfedges[halfedgeID].prevID = prevID;
@@ -363,15 +368,15 @@ CC_BARRIER
  */
 static void LoadEdgeMappings(cc_Mesh *mesh)
 {
-    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const cc_Index halfedgeCount = ccm_HalfedgeCount(mesh);
     cc_Halfedge *halfedges = mesh->halfedges;
     cbf_BitField *edgeIterator = cbf_Create(halfedgeCount);
-    int32_t edgeCount;
+    cc_Index edgeCount;
 
 CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
-        int32_t bitValue = halfedgeID > twinID ? 1 : 0;
+    for (cc_Index halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        cc_Index twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
+        cc_Index bitValue = halfedgeID > twinID ? 1 : 0;
 
         cbf_SetBit(edgeIterator, halfedgeID, bitValue);
     }
@@ -380,20 +385,20 @@ CC_BARRIER
     cbf_Reduce(edgeIterator);
     edgeCount = cbf_BitCount(edgeIterator);
 
-    mesh->edgeToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * edgeCount);
+    mesh->edgeToHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * edgeCount);
     mesh->edgeCount = edgeCount;
 
 CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
-        const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
-        const int32_t bitID = cc__Max(halfedgeID, twinID);
+    for (cc_Index halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
+        const cc_Index twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
+        const cc_Index bitID = cc__Max(halfedgeID, twinID);
 
         halfedges[halfedgeID].edgeID = cbf_EncodeBit(edgeIterator, bitID);
     }
 CC_BARRIER
 
 CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+    for (cc_Index edgeID = 0; edgeID < edgeCount; ++edgeID) {
         mesh->edgeToHalfedgeIDs[edgeID] = cbf_DecodeBit(edgeIterator, edgeID);
     }
 CC_BARRIER
@@ -416,17 +421,17 @@ CC_BARRIER
  */
 static void LoadVertexHalfedges(cc_Mesh *mesh)
 {
-    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
-    const int32_t vertexCount = ccm_VertexCount(mesh);
+    const cc_Index halfedgeCount = ccm_HalfedgeCount(mesh);
+    const cc_Index vertexCount = ccm_VertexCount(mesh);
 
-    mesh->vertexToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * vertexCount);
+    mesh->vertexToHalfedgeIDs = (cc_Index *)CC_MALLOC(sizeof(cc_Index) * vertexCount);
 
 CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID);
-        int32_t maxHalfedgeID = halfedgeID;
-        int32_t boundaryHalfedgeID = halfedgeID;
-        int32_t iterator;
+    for (cc_Index halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const cc_Index vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID);
+        cc_Index maxHalfedgeID = halfedgeID;
+        cc_Index boundaryHalfedgeID = halfedgeID;
+        cc_Index iterator;
 
         for (iterator = ccm_NextVertexHalfedgeID(mesh, halfedgeID);
              iterator >= 0 && iterator != halfedgeID;
@@ -745,13 +750,18 @@ CC_BARRIER
 
 static void Usage(const char *appname)
 {
-    CC_LOG("usage -- %s file1 file2 ...", appname);
+    CC_LOG("usage -- %s [-2 | -c] file1 file2 ...", appname);
+    CC_LOG("  -2  write version 2 files (not readable by cuda-rewrite)");
+    CC_LOG("  -c  write version 2 files with compressed sections");
 }
 
 
 int main(int argc, char **argv)
 {
-    const int32_t meshCount = argc - 1;
+    const bool isCompressed = argc > 1 && strcmp(argv[1], "-c") == 0;
+    const bool isVersion2 = argc > 1 && strcmp(argv[1], "-2") == 0;
+    const int32_t firstArgID = (isCompressed || isVersion2) ? 2 : 1;
+    const int32_t meshCount = argc - firstArgID;
     char buffer[1024];
 
     if (meshCount == 0) {
@@ -759,7 +769,7 @@ int main(int argc, char **argv)
     }
 
     for (int32_t meshID = 0; meshID < meshCount; ++meshID) {
-        const char *file = argv[meshID + 1];
+        const char *file = argv[meshID + firstArgID];
         CC_LOG("Loading: %s", file);
         cc_Mesh *mesh = LoadObj(file);
         char *preFix, *postFix;
@@ -780,16 +790,24 @@ int main(int argc, char **argv)
         }
         CC_LOG("Output file: %s", buffer);
 
-        ccm_Save(mesh, buffer);
+        // version 1 files remain readable by every tool (e.g., cuda-rewrite)
+        if (isCompressed) {
+            ccm_SaveCompressed(mesh, buffer, 0.0);
+        } else if (isVersion2) {
+            ccm_Save(mesh, buffer);
+        } else if (!ccm_Save_V1(mesh, buffer)) {
+            CC_LOG("Writing a version 2 file instead");
+            ccm_Save(mesh, buffer);
+        }
         ccm_Release(mesh);
 
         mesh = ccm_Load(buffer);
-        CC_LOG("V: %i", ccm_VertexCount(mesh));
-        CC_LOG("U: %i", ccm_UvCount(mesh));
-        CC_LOG("H: %i", ccm_HalfedgeCount(mesh));
-        CC_LOG("C: %i", ccm_CreaseCount(mesh));
-        CC_LOG("E: %i", ccm_EdgeCount(mesh));
-        CC_LOG("F: %i", ccm_FaceCount(mesh));
+        CC_LOG("V: %lld", (long long)ccm_VertexCount(mesh));
+        CC_LOG("U: %lld", (long long)ccm_UvCount(mesh));
+        CC_LOG("H: %lld", (long long)ccm_HalfedgeCount(mesh));
+        CC_LOG("C: %lld", (long long)ccm_CreaseCount(mesh));
+        CC_LOG("E: %lld", (long long)ccm_EdgeCount(mesh));
+        CC_LOG("F: %lld", (long long)ccm_FaceCount(mesh));
         ccm_Release(mesh);
     }
 }
@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#define CC_IMPLEMENTATION
+#include "CatmullClark.h"
+
+#define LOG(fmt, ...) fprintf(stdout, fmt "\n", ##__VA_ARGS__); fflush(stdout);
+
+#ifdef CC_SINGLE_PRECISION
+#   define TOLERANCE 1e-4
+#else
+#   define TOLERANCE 1e-10
+#endif
+
+static void usage(const char *appname)
+{
+    LOG("usage: %s path_to_ccm maxDepth", appname);
+}
+
+/*
+ * Returns the largest difference between the vertex points of two subds,
+ * relative to the magnitude of the points of the reference.
+ */
+static double MaxError(const cc_Subd *subd, const cc_Subd *reference)
+{
+    double maxError = 0.0;
+
+    for (int32_t depth = 1; depth <= ccs_MaxDepth(subd); ++depth) {
+        const cc_VertexPoint *points = ccs_Level(subd, depth).vertexPoints;
+        const cc_VertexPoint *referencePoints = ccs_Level(reference, depth).vertexPoints;
+        const cc_Index vertexCount = ccm_VertexCountAtDepth(subd->cage, depth);
+
+        for (cc_Index vertexID = 0; vertexID < vertexCount; ++vertexID) {
+            for (int32_t i = 0; i < 3; ++i) {
+                const double x = points[vertexID].array[i];
+                const double y = referencePoints[vertexID].array[i];
+                const double error = fabs(x - y) / fmax(1.0, fabs(y));
+
+                if (!(error <= maxError)) {
+                    maxError = error;
+                }
+            }
+        }
+    }
+
+    return maxError;
+}
+
+int main(int argc, char **argv)
+{
+    int32_t maxDepth;
+    cc_Mesh *cage;
+    cc_Subd *gather, *scatter, *segmented;
+    cc_ScatterPlan *plan;
+    double scatterError, segmentedError;
+
+    if (argc < 3) {
+        usage(argv[0]);
+        return 0;
+    }
+
+    cage = ccm_Load(argv[1]);
+    maxDepth = atoi(argv[2]);
+
+    if (cage == NULL || maxDepth < 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // reference
+    gather = ccs_Create(cage, maxDepth);
+    ccs_Refine_Gather(gather);
+
+    // atomic scatter
+    scatter = ccs_Create(cage, maxDepth);
+    ccs_Refine_Scatter(scatter);
+
+    // segmented scatter
+    segmented = ccs_Create(cage, maxDepth);
+    ccs_RefineHalfedges(segmented);
+    ccs_RefineCreases(segmented);
+    plan = ccs_CreateScatterPlan(segmented);
+    ccs_RefineVertexPoints_SegmentedScatter(segmented, plan);
+
+    scatterError = MaxError(scatter, gather);
+    segmentedError = MaxError(segmented, scatter);
+    LOG("scatter vs. gather: %e", scatterError);
+    LOG("segmented scatter vs. scatter: %e", segmentedError);
+
+    ccs_ReleaseScatterPlan(plan);
+    ccs_Release(segmented);
+    ccs_Release(scatter);
+    ccs_Release(gather);
+    ccm_Release(cage);
+
+    if (scatterError > TOLERANCE || segmentedError > TOLERANCE) {
+        LOG("FAILED (tolerance: %e)", TOLERANCE);
+
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -10,6 +10,7 @@
 
 #define LOG(fmt, ...) fprintf(stdout, fmt "\n", ##__VA_ARGS__); fflush(stdout);
 
+//#define CC_SINGLE_PRECISION
 //#define CC_DISABLE_UV
 #define CC_IMPLEMENTATION
 #include "CatmullClark.h"
@@ -26,38 +27,38 @@ ExportToObj(
     const char *filename
 ) {
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexPointCount = ccm_VertexCountAtDepth(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth(cage, depth);
+    const cc_Index vertexPointCount = ccm_VertexCountAtDepth(cage, depth);
+    const cc_Index faceCount = ccm_FaceCountAtDepth(cage, depth);
     FILE *pf = fopen(filename, "w");
 
     // write vertices
     fprintf(pf, "# Vertices\n");
     if (depth == 0) {
-        const int32_t vertexUvCount = ccm_UvCount(cage);
+        const cc_Index vertexUvCount = ccm_UvCount(cage);
 
-        for (int32_t vertexID = 0; vertexID < vertexPointCount; ++vertexID) {
-            const double *v = ccm_VertexPoint(cage, vertexID).array;
+        for (cc_Index vertexID = 0; vertexID < vertexPointCount; ++vertexID) {
+            const cc_Real *v = ccm_VertexPoint(cage, vertexID).array;
 
             fprintf(pf, "v %f %f %f\n", v[0], v[1], v[2]);
         }
 
-        for (int32_t vertexID = 0; vertexID < vertexUvCount; ++vertexID) {
-            const double *v = ccm_Uv(cage, vertexID).array;
+        for (cc_Index vertexID = 0; vertexID < vertexUvCount; ++vertexID) {
+            const cc_Real *v = ccm_Uv(cage, vertexID).array;
 
             fprintf(pf, "vt %f %f\n", v[0], v[1]);
         }
     } else {
-        const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+        const cc_Index halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
 
-        for (int32_t vertexID = 0; vertexID < vertexPointCount; ++vertexID) {
-            const double *v = ccs_VertexPoint(subd, vertexID, depth).array;
+        for (cc_Index vertexID = 0; vertexID < vertexPointCount; ++vertexID) {
+            const cc_Real *v = ccs_VertexPoint(subd, vertexID, depth).array;
 
             fprintf(pf, "v %f %f %f\n", v[0], v[1], v[2]);
         }
 
 #ifndef CC_DISABLE_UV
-        for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-            const double *uv = ccs_HalfedgeVertexUv(subd, halfedgeID, depth).array;
+        for (cc_Index halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+            const cc_Real *uv = ccs_HalfedgeVertexUv(subd, halfedgeID, depth).array;
 
             fprintf(pf, "vt %f %f\n", uv[0], uv[1]);
         }
@@ -68,44 +69,44 @@ ExportToObj(
     // write topology
     fprintf(pf, "# Topology\n");
     if (depth == 0) {
-        for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
-            const int32_t halfEdgeID = ccm_FaceToHalfedgeID(cage, faceID);
+        for (cc_Index faceID = 0; faceID < faceCount; ++faceID) {
+            const cc_Index halfEdgeID = ccm_FaceToHalfedgeID(cage, faceID);
 
             fprintf(pf,
-                    "f %i/%i",
-                    ccm_HalfedgeVertexID(cage, halfEdgeID) + 1,
-                    ccm_HalfedgeUvID(cage, halfEdgeID) + 1);
+                    "f %lld/%lld",
+                    (long long)ccm_HalfedgeVertexID(cage, halfEdgeID) + 1,
+                    (long long)ccm_HalfedgeUvID(cage, halfEdgeID) + 1);
 
-            for (int32_t halfEdgeIt = ccm_HalfedgeNextID(cage, halfEdgeID);
+            for (cc_Index halfEdgeIt = ccm_HalfedgeNextID(cage, halfEdgeID);
                          halfEdgeIt != halfEdgeID;
                          halfEdgeIt = ccm_HalfedgeNextID(cage, halfEdgeIt)) {
                 fprintf(pf,
-                        " %i/%i",
-                        ccm_HalfedgeVertexID(cage, halfEdgeIt) + 1,
-                        ccm_HalfedgeUvID(cage, halfEdgeIt) + 1);
+                        " %lld/%lld",
+                        (long long)ccm_HalfedgeVertexID(cage, halfEdgeIt) + 1,
+                        (long long)ccm_HalfedgeUvID(cage, halfEdgeIt) + 1);
             }
             fprintf(pf, "\n");
         }
     } else {
-        for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        for (cc_Index faceID = 0; faceID < faceCount; ++faceID) {
 #ifndef CC_DISABLE_UV
             fprintf(pf,
-                    "f %i/%i %i/%i %i/%i %i/%i\n",
-                    ccs_HalfedgeVertexID(subd, 4 * faceID + 0, depth) + 1,
-                    4 * faceID + 1,
-                    ccs_HalfedgeVertexID(subd, 4 * faceID + 1, depth) + 1,
-                    4 * faceID + 2,
-                    ccs_HalfedgeVertexID(subd, 4 * faceID + 2, depth) + 1,
-                    4 * faceID + 3,
-                    ccs_HalfedgeVertexID(subd, 4 * faceID + 3, depth) + 1,
-                    4 * faceID + 4);
+                    "f %lld/%lld %lld/%lld %lld/%lld %lld/%lld\n",
+                    (long long)ccs_HalfedgeVertexID(subd, 4 * faceID + 0, depth) + 1,
+                    (long long)(4 * faceID + 1),
+                    (long long)ccs_HalfedgeVertexID(subd, 4 * faceID + 1, depth) + 1,
+                    (long long)(4 * faceID + 2),
+                    (long long)ccs_HalfedgeVertexID(subd, 4 * faceID + 2, depth) + 1,
+                    (long long)(4 * faceID + 3),
+                    (long long)ccs_HalfedgeVertexID(subd, 4 * faceID + 3, depth) + 1,
+                    (long long)(4 * faceID + 4));
 #else
             fprintf(pf,
-                    "f %i %i %i %i\n",
-                    ccs_HalfedgeVertexID(subd, 4 * faceID + 0, depth) + 1,
-                    ccs_HalfedgeVertexID(subd, 4 * faceID + 1, depth) + 1,
-                    ccs_HalfedgeVertexID(subd, 4 * faceID + 2, depth) + 1,
-                    ccs_HalfedgeVertexID(subd, 4 * faceID + 3, depth) + 1);
+                    "f %lld %lld %lld %lld\n",
+                    (long long)ccs_HalfedgeVertexID(subd, 4 * faceID + 0, depth) + 1,
+                    (long long)ccs_HalfedgeVertexID(subd, 4 * faceID + 1, depth) + 1,
+                    (long long)ccs_HalfedgeVertexID(subd, 4 * faceID + 2, depth) + 1,
+                    (long long)ccs_HalfedgeVertexID(subd, 4 * faceID + 3, depth) + 1);
 #endif
         }
         fprintf(pf, "\n");
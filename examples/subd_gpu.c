@@ -9,6 +9,7 @@
 #define LOG(fmt, ...) fprintf(stdout, fmt "\n", ##__VA_ARGS__); fflush(stdout);
 
 #define CC_DISABLE_UV
+#define CC_SINGLE_PRECISION
 #define CC_IMPLEMENTATION
 #include "CatmullClark.h"
 
@@ -739,13 +740,13 @@ ExportToObj(
         const int32_t vertexUvCount = ccm_UvCount(cage);
 
         for (int32_t vertexID = 0; vertexID < vertexPointCount; ++vertexID) {
-            const double *v = ccm_VertexPoint(cage, vertexID).array;
+            const cc_Real *v = ccm_VertexPoint(cage, vertexID).array;
 
             fprintf(pf, "v %f %f %f\n", v[0], v[1], v[2]);
         }
 
         for (int32_t vertexID = 0; vertexID < vertexUvCount; ++vertexID) {
-            const double *v = ccm_Uv(cage, vertexID).array;
+            const cc_Real *v = ccm_Uv(cage, vertexID).array;
 
             fprintf(pf, "vt %f %f\n", v[0], v[1]);
         }
@@ -753,14 +754,14 @@ ExportToObj(
         const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
 
         for (int32_t vertexID = 0; vertexID < vertexPointCount; ++vertexID) {
-            const double *v = ccs_VertexPoint(subd, vertexID, depth).array;
+            const cc_Real *v = ccs_VertexPoint(subd, vertexID, depth).array;
 
             fprintf(pf, "v %f %f %f\n", v[0], v[1], v[2]);
         }
 
 #ifndef CC_DISABLE_UV
         for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-            const double *uv = ccs_HalfedgeVertexUv(subd, halfedgeID, depth).array;
+            const cc_Real *uv = ccs_HalfedgeVertexUv(subd, halfedgeID, depth).array;
 
             fprintf(pf, "vt %f %f\n", uv[0], uv[1]);
         }